@@ -0,0 +1,125 @@
+/**
+ * @file arstream2_shm_transport.h
+ * @brief Parrot Streaming Library - Shared memory transport
+ * @date 10/16/2026
+ * @author aurelien.barre@parrot.com
+ */
+
+#ifndef _ARSTREAM2_SHM_TRANSPORT_H_
+#define _ARSTREAM2_SHM_TRANSPORT_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* #ifdef __cplusplus */
+
+#include <inttypes.h>
+#include <libARStream2/arstream2_error.h>
+
+
+/**
+ * @brief Default number of RTP packet slots
+ */
+#define ARSTREAM2_SHM_TRANSPORT_DEFAULT_SLOT_COUNT          (1024)
+
+
+/**
+ * @brief Default RTP packet slot size in bytes
+ */
+#define ARSTREAM2_SHM_TRANSPORT_DEFAULT_SLOT_SIZE           (1500)
+
+
+/**
+ * @brief Shared memory transport
+ * A shared memory transport replaces the network between a StreamSender and a StreamReceiver
+ * running on the same host (in the same process or in two processes). The RTP and RTCP packets
+ * are exchanged through single-producer/single-consumer packet rings in a shared memory segment
+ * and an eventfd per ring signals the consumer only when it has no more packets to process.
+ * The RTP/RTCP semantics are unchanged: a packet that does not fit in the ring is dropped,
+ * like on a full socket buffer.
+ *
+ * The transport is reference counted: the StreamSender and the StreamReceiver take their own
+ * reference and the creator must call ARSTREAM2_ShmTransport_Unref() when it no longer uses it.
+ * To share the transport with another process, pass the file descriptors returned by
+ * ARSTREAM2_ShmTransport_GetFds() (through inheritance or SCM_RIGHTS) and call
+ * ARSTREAM2_ShmTransport_Attach() in the other process.
+ */
+typedef struct ARSTREAM2_ShmTransport_s ARSTREAM2_ShmTransport_t;
+
+
+/**
+ * @brief Create a shared memory transport
+ *
+ * @param[out] transport Pointer to the new transport
+ * @param[in] slotCount Number of RTP packet slots (rounded up to a power of 2, 0 for the default)
+ * @param[in] slotSize Maximum RTP and RTCP packet size in bytes (0 for the default)
+ *
+ * @return ARSTREAM2_OK if no error occured.
+ * @return ARSTREAM2_ERROR_BAD_PARAMETERS if transport is invalid.
+ * @return ARSTREAM2_ERROR_ALLOC if the shared memory segment or the eventfds cannot be created.
+ * @return ARSTREAM2_ERROR_UNSUPPORTED if the platform does not support the shared memory transport.
+ */
+eARSTREAM2_ERROR ARSTREAM2_ShmTransport_Create(ARSTREAM2_ShmTransport_t **transport, int slotCount, int slotSize);
+
+
+/**
+ * @brief Attach to a shared memory transport created in another process
+ * The file descriptors are duplicated; the caller keeps ownership of the originals.
+ *
+ * @param[out] transport Pointer to the new transport
+ * @param[in] shmFd Shared memory segment file descriptor
+ * @param[in] streamFd RTP ring eventfd
+ * @param[in] senderControlFd Sender RTCP ring eventfd
+ * @param[in] receiverControlFd Receiver RTCP ring eventfd
+ *
+ * @return ARSTREAM2_OK if no error occured.
+ * @return ARSTREAM2_ERROR_BAD_PARAMETERS if transport or a file descriptor is invalid.
+ * @return ARSTREAM2_ERROR_ALLOC if the shared memory segment cannot be mapped.
+ * @return ARSTREAM2_ERROR_UNSUPPORTED if the platform does not support the shared memory transport.
+ */
+eARSTREAM2_ERROR ARSTREAM2_ShmTransport_Attach(ARSTREAM2_ShmTransport_t **transport, int shmFd, int streamFd, int senderControlFd, int receiverControlFd);
+
+
+/**
+ * @brief Get the shared memory transport file descriptors
+ * The file descriptors remain owned by the transport.
+ *
+ * @param[in] transport The transport instance
+ * @param[out] shmFd Shared memory segment file descriptor (optional, can be NULL)
+ * @param[out] streamFd RTP ring eventfd (optional, can be NULL)
+ * @param[out] senderControlFd Sender RTCP ring eventfd (optional, can be NULL)
+ * @param[out] receiverControlFd Receiver RTCP ring eventfd (optional, can be NULL)
+ *
+ * @return ARSTREAM2_OK if no error occured.
+ * @return ARSTREAM2_ERROR_BAD_PARAMETERS if transport is invalid.
+ */
+eARSTREAM2_ERROR ARSTREAM2_ShmTransport_GetFds(ARSTREAM2_ShmTransport_t *transport, int *shmFd, int *streamFd, int *senderControlFd, int *receiverControlFd);
+
+
+/**
+ * @brief Take a reference on a shared memory transport
+ *
+ * @param[in] transport The transport instance
+ *
+ * @return ARSTREAM2_OK if no error occured.
+ * @return ARSTREAM2_ERROR_BAD_PARAMETERS if transport is invalid.
+ */
+eARSTREAM2_ERROR ARSTREAM2_ShmTransport_Ref(ARSTREAM2_ShmTransport_t *transport);
+
+
+/**
+ * @brief Release a reference on a shared memory transport
+ * The transport is destroyed when the last reference is released.
+ *
+ * @param[in] transport The transport instance
+ *
+ * @return ARSTREAM2_OK if no error occured.
+ * @return ARSTREAM2_ERROR_BAD_PARAMETERS if transport is invalid.
+ */
+eARSTREAM2_ERROR ARSTREAM2_ShmTransport_Unref(ARSTREAM2_ShmTransport_t *transport);
+
+
+#ifdef __cplusplus
+}
+#endif /* #ifdef __cplusplus */
+
+#endif /* _ARSTREAM2_SHM_TRANSPORT_H_ */
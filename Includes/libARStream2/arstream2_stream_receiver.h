@@ -13,9 +13,11 @@ extern "C" {
 #endif /* #ifdef __cplusplus */
 
 #include <inttypes.h>
+#include <sys/uio.h>
 #include <libARStream2/arstream2_error.h>
 #include <libARStream2/arstream2_stream_stats.h>
 #include <libARStream2/arstream2_stream_metadata.h>
+#include <libARStream2/arstream2_shm_transport.h>
 #include <libARSAL/ARSAL_Socket.h>
 
 
@@ -40,6 +42,12 @@ extern "C" {
 #define ARSTREAM2_STREAM_RECEIVER_RESENDER_DEFAULT_SERVER_CONTROL_PORT  (5005)
 
 
+/**
+ * @brief Number of buckets in the reception stats histograms
+ */
+#define ARSTREAM2_STREAM_RECEIVER_RECV_STATS_HISTOGRAM_BUCKET_COUNT     (24)
+
+
 /**
  * @brief ARSTREAM2 StreamReceiver instance handle.
  */
@@ -182,6 +190,86 @@ typedef eARSTREAM2_ERROR (*ARSTREAM2_StreamReceiver_AuReadyCallback_t)(uint8_t *
                                                                        void *auBufferUserPtr, void *userPtr);
 
 
+/**
+ * @brief Access unit view handle.
+ *
+ * Opaque handle to an access unit held by the application in zero-copy output mode.
+ * The view must be released using ARSTREAM2_StreamReceiver_ReleaseAuView().
+ */
+typedef void* ARSTREAM2_StreamReceiver_AuView_Handle;
+
+
+/**
+ * @brief Access unit view ready callback function
+ *
+ * To be used with the zero-copy application output feature.
+ * The mandatory AU view ready callback function is called to output an access unit
+ * without copying it: the NAL units are referenced in place in the receiver buffers.
+ * The NAL units are in byte stream format (4 bytes start codes) and must not be modified.
+ *
+ * If the callback function returns ARSTREAM2_OK, the application holds a reference on the access unit
+ * and must release it by calling ARSTREAM2_StreamReceiver_ReleaseAuView() once done with the NAL units;
+ * the naluIov, auMetadata->auMetadata, auMetadata->auUserData and auMetadata->mbStatus pointers are valid
+ * until then. The auMetadata->videoStats pointer is only valid within the callback function.
+ * If the callback function returns an error the access unit is released by the receiver.
+ *
+ * @param auView AU view handle
+ * @param naluIov NAL units I/O vector
+ * @param naluCount NAL units count in naluIov
+ * @param auSize AU size in bytes (sum of the NAL units sizes)
+ * @param auTimestamps AU timestamps
+ * @param auSyncType AU synchronization type
+ * @param auMetadata AU metadata
+ * @param userPtr AU view ready callback user pointer
+ *
+ * @return ARSTREAM2_OK if no error occurred.
+ * @return ARSTREAM2_ERROR_RESYNC_REQUIRED if a decoding error occurred and re-sync is needed.
+ * @return an eARSTREAM2_ERROR error code if another error occurred.
+ *
+ * @warning This callback function is mandatory.
+ * @warning ARSTREAM2_StreamReceiver_* functions must not be called within the callback function
+ * except the ARSTREAM2_StreamReceiver_GetFrameMacroblockStatus() and ARSTREAM2_StreamReceiver_ReleaseAuView() functions.
+ */
+typedef eARSTREAM2_ERROR (*ARSTREAM2_StreamReceiver_AuViewReadyCallback_t)(ARSTREAM2_StreamReceiver_AuView_Handle auView,
+                                                                           const struct iovec *naluIov, int naluCount, int auSize,
+                                                                           ARSTREAM2_StreamReceiver_AuReadyCallbackTimestamps_t *auTimestamps,
+                                                                           eARSTREAM2_STREAM_RECEIVER_AU_SYNC_TYPE auSyncType,
+                                                                           ARSTREAM2_StreamReceiver_AuReadyCallbackMetadata_t *auMetadata,
+                                                                           void *userPtr);
+
+
+/**
+ * @brief ARSTREAM2 StreamReceiver network reception stats.
+ *
+ * Histograms use power of two buckets: bucket 0 counts null values and
+ * bucket i counts values in [2^(i-1), 2^i - 1]; the last bucket also counts
+ * all larger values.
+ */
+typedef struct
+{
+    uint32_t msgVecCount;                                           /**< Maximum number of datagrams per recvmmsg call */
+    uint64_t batchCount;                                            /**< Number of non-empty recvmmsg batches */
+    uint64_t datagramCount;                                         /**< Total number of received datagrams */
+    uint64_t byteCount;                                             /**< Total number of received bytes */
+    uint64_t fullBatchCount;                                        /**< Number of batches that filled the whole msgVecCount */
+    uint64_t packetFifoAddTime;                                     /**< Total time spent in RTP packet FIFO insertion (in microseconds) */
+    uint64_t auFifoAddTime;                                         /**< Total time spent in RTP H.264 depayloading (in microseconds) */
+    uint32_t batchDatagramsHistogram[ARSTREAM2_STREAM_RECEIVER_RECV_STATS_HISTOGRAM_BUCKET_COUNT];     /**< Datagrams per recvmmsg batch */
+    uint32_t batchBytesHistogram[ARSTREAM2_STREAM_RECEIVER_RECV_STATS_HISTOGRAM_BUCKET_COUNT];         /**< Bytes per recvmmsg batch */
+    uint32_t packetFifoAddTimeHistogram[ARSTREAM2_STREAM_RECEIVER_RECV_STATS_HISTOGRAM_BUCKET_COUNT];  /**< Time per RTP packet FIFO insertion (in microseconds) */
+    uint32_t auFifoAddTimeHistogram[ARSTREAM2_STREAM_RECEIVER_RECV_STATS_HISTOGRAM_BUCKET_COUNT];      /**< Time per RTP H.264 depayloading call (in microseconds) */
+    uint64_t packetFifoFootprint;                                   /**< RTP packet FIFO memory footprint in bytes (items, buffers and packet buffers) */
+    uint32_t packetFifoItemCount;                                   /**< RTP packet FIFO item pool size */
+    uint32_t packetFifoItemHighWatermark;                           /**< Maximum number of RTP packet FIFO items in use */
+    uint32_t packetFifoBufferCount;                                 /**< RTP packet FIFO buffer pool size */
+    uint32_t packetFifoBufferHighWatermark;                         /**< Maximum number of RTP packet FIFO buffers in use */
+    uint32_t packetFifoOverflowBufferCount;                         /**< RTP packet FIFO overflow buffer pool size (datagrams larger than the packet buffers) */
+    uint64_t packetFifoOverflowCount;                               /**< Number of datagrams received in an overflow buffer */
+    uint64_t packetFifoTruncatedCount;                              /**< Number of datagrams dropped because they did not fit in a packet buffer */
+
+} ARSTREAM2_StreamReceiver_RecvStats_t;
+
+
 /**
  * @brief ARSTREAM2 StreamReceiver net configuration for initialization.
  */
@@ -195,6 +283,9 @@ typedef struct
     int clientStreamPort;                           /**< Client stream port */
     int clientControlPort;                          /**< Client control port */
     eARSAL_SOCKET_CLASS_SELECTOR classSelector;     /**< Type of Service class selector */
+    int useGro;                                     /**< Boolean-like (0-1) flag: if active receive coalesced RTP packets with UDP generic receive offload (Linux only, falls back to recvmmsg when not supported) */
+    int useIoUring;                                 /**< Boolean-like (0-1) flag: if active receive RTP packets with an io_uring multishot recvmsg (Linux only, falls back to recvmmsg when not supported; disables useGro) */
+    ARSTREAM2_ShmTransport_t *shmTransport;         /**< Shared memory transport to a co-located StreamSender instead of the network (optional, can be NULL; the addresses and ports are then ignored), @see ARSTREAM2_ShmTransport_Create() */
 
 } ARSTREAM2_StreamReceiver_NetConfig_t;
 
@@ -223,6 +314,8 @@ typedef struct
     const char *applicationName;                    /**< Untimed metadata: application name (such as software name and version) (optional, can be NULL) */
     int maxPacketSize;                              /**< Maximum network packet size in bytes (should be provided by the server, if 0 the maximum UDP packet size is used) */
     int generateReceiverReports;                    /**< if true, generate RTCP receiver reports */
+    int generateNack;                               /**< if true, request retransmission of missing packets with RTCP generic NACK feedback (requires generateReceiverReports) */
+    int useFec;                                     /**< if true, recover missing packets from the sender XOR FEC repair packets */
     int waitForSync;                                /**< if true, wait for SPS/PPS sync before outputting access anits */
     int outputIncompleteAu;                         /**< if true, output incomplete access units */
     int filterOutSpsPps;                            /**< if true, filter out SPS and PPS NAL units */
@@ -231,6 +324,9 @@ typedef struct
     int generateSkippedPSlices;                     /**< if true, generate skipped P slices to replace missing slices for pre-decoder error concealment */
     int generateFirstGrayIFrame;                    /**< if true, generate a first gray IDR frame to initialize the decoding (waitForSync must be enabled) */
     int ardiscoveryProductType;                     /**< ARDiscovery product type (used for the recording feature) */
+    int usePacketFifoArena;                         /**< if true, allocate all the RTP packet FIFO items and buffers in a single mmap'd region */
+    int packetFifoArenaHugePages;                   /**< if true, back the packet FIFO arena with huge pages (MAP_HUGETLB, or transparent huge pages as a fallback) */
+    int packetFifoArenaLock;                        /**< if true, lock the packet FIFO arena in memory (mlock, the RLIMIT_MEMLOCK limit applies) */
     const char *debugPath;                          /**< Optional path for writing debug files (optional, can be NULL) */
 
 } ARSTREAM2_StreamReceiver_Config_t;
@@ -254,6 +350,7 @@ typedef struct ARSTREAM2_StreamReceiver_ResenderConfig_t
     eARSAL_SOCKET_CLASS_SELECTOR classSelector;     /**< Type of Service class selector */
     int streamSocketBufferSize;                     /**< Send buffer size for the stream socket (optional, can be 0) */
     int maxNetworkLatencyMs;                        /**< Maximum acceptable network latency in milliseconds */
+    int useThread;                                  /**< Boolean-like (0-1) flag: if active the resender sends from its own thread so that a slow destination does not delay the stream reception */
 
 } ARSTREAM2_StreamReceiver_ResenderConfig_t;
 
@@ -339,6 +436,32 @@ eARSTREAM2_ERROR ARSTREAM2_StreamReceiver_StartAppOutput(ARSTREAM2_StreamReceive
                                                          ARSTREAM2_StreamReceiver_AuReadyCallback_t auReadyCallback, void *auReadyCallbackUserPtr);
 
 
+/**
+ * @brief Start the zero-copy application output.
+ *
+ * The function starts the output to the application though callback functions
+ * without copying the access units: the application gets a read-only view of the
+ * receiver buffers which must be released using ARSTREAM2_StreamReceiver_ReleaseAuView().
+ * The replaceStartCodesWithNaluSize configuration parameter is not applied in this mode.
+ * The processing can be stopped using ARSTREAM2_StreamReceiver_StopAppOutput().
+ *
+ * @param streamReceiverHandle Instance handle.
+ * @param spsPpsCallback SPS/PPS callback function.
+ * @param spsPpsCallbackUserPtr SPS/PPS callback user pointer.
+ * @param auViewReadyCallback Access unit view ready callback function.
+ * @param auViewReadyCallbackUserPtr Access unit view ready callback user pointer.
+ *
+ * @return ARSTREAM2_OK if no error occurred.
+ * @return an eARSTREAM2_ERROR error code if an error occurred.
+ *
+ * @note Held access units are taken from the receiver access unit pool: the application
+ * should release them as soon as possible to avoid starving the receiver.
+ */
+eARSTREAM2_ERROR ARSTREAM2_StreamReceiver_StartAppOutputZeroCopy(ARSTREAM2_StreamReceiver_Handle streamReceiverHandle,
+                                                                 ARSTREAM2_StreamReceiver_SpsPpsCallback_t spsPpsCallback, void *spsPpsCallbackUserPtr,
+                                                                 ARSTREAM2_StreamReceiver_AuViewReadyCallback_t auViewReadyCallback, void *auViewReadyCallbackUserPtr);
+
+
 /**
  * @brief Stop the applicaiton output.
  *
@@ -354,6 +477,23 @@ eARSTREAM2_ERROR ARSTREAM2_StreamReceiver_StartAppOutput(ARSTREAM2_StreamReceive
 eARSTREAM2_ERROR ARSTREAM2_StreamReceiver_StopAppOutput(ARSTREAM2_StreamReceiver_Handle streamReceiverHandle);
 
 
+/**
+ * @brief Release an access unit view.
+ *
+ * The function releases an access unit held by the application in zero-copy output mode.
+ * All the access unit views must be released before calling ARSTREAM2_StreamReceiver_Free().
+ * This function can be called from any thread, including within the AU view ready callback function.
+ *
+ * @param streamReceiverHandle Instance handle.
+ * @param auView AU view handle.
+ *
+ * @return ARSTREAM2_OK if no error occurred.
+ * @return an eARSTREAM2_ERROR error code if an error occurred.
+ */
+eARSTREAM2_ERROR ARSTREAM2_StreamReceiver_ReleaseAuView(ARSTREAM2_StreamReceiver_Handle streamReceiverHandle,
+                                                        ARSTREAM2_StreamReceiver_AuView_Handle auView);
+
+
 /**
  * @brief Run a StreamReceiver application output thread.
  *
@@ -496,6 +636,24 @@ eARSTREAM2_ERROR ARSTREAM2_StreamReceiver_GetPeerUntimedMetadata(ARSTREAM2_Strea
                                                                  ARSTREAM2_Stream_UntimedMetadata_t *metadata);
 
 
+/**
+ * @brief Get the network reception stats
+ *
+ * The stats are accumulated by the network thread since the receiver was created
+ * or since the last reset. They are intended to tune the datagram batch size,
+ * the socket buffers and the packet FIFO size.
+ *
+ * @param streamReceiverHandle Instance handle.
+ * @param[out] stats Pointer to the reception stats structure to fill
+ * @param[in] reset Boolean-like (0-1) flag: if active reset the stats after reading them
+ *
+ * @return ARSTREAM2_OK if no error happened
+ * @return ARSTREAM2_ERROR_BAD_PARAMETERS if the streamReceiverHandle or stats pointer are invalid
+ */
+eARSTREAM2_ERROR ARSTREAM2_StreamReceiver_GetRecvStats(ARSTREAM2_StreamReceiver_Handle streamReceiverHandle,
+                                                       ARSTREAM2_StreamReceiver_RecvStats_t *stats, int reset);
+
+
 #ifdef __cplusplus
 }
 #endif /* #ifdef __cplusplus */
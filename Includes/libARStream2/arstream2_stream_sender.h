@@ -16,6 +16,7 @@ extern "C" {
 #include <libARStream2/arstream2_error.h>
 #include <libARStream2/arstream2_stream_stats.h>
 #include <libARStream2/arstream2_stream_metadata.h>
+#include <libARStream2/arstream2_shm_transport.h>
 #include <libARSAL/ARSAL_Socket.h>
 
 
@@ -55,6 +56,12 @@ extern "C" {
 typedef struct ARSTREAM2_StreamSender_s *ARSTREAM2_StreamSender_Handle;
 
 
+/**
+ * @brief ARSTREAM2 StreamSender destination handle.
+ */
+typedef struct ARSTREAM2_StreamSender_Destination_s *ARSTREAM2_StreamSender_DestinationHandle;
+
+
 /**
  * @brief Callback status values
  */
@@ -150,6 +157,17 @@ typedef void (*ARSTREAM2_StreamSender_VideoStatsCallback_t) (const ARSTREAM2_Str
 typedef void (*ARSTREAM2_StreamSender_DisconnectionCallback_t) (void *userPtr);
 
 
+/**
+ * @brief Callback function for the target bitrate
+ * This callback function is called when the congestion controller available bandwidth estimate changes significantly.
+ * The application should set the encoder bitrate to the target bitrate.
+ *
+ * @param[in] targetBitrate Target encoder bitrate in bit/s
+ * @param[in] userPtr Global bitrate callback user pointer
+ */
+typedef void (*ARSTREAM2_StreamSender_BitrateCallback_t) (uint32_t targetBitrate, void *userPtr);
+
+
 /**
  * @brief StreamSender configuration parameters
  */
@@ -177,18 +195,56 @@ typedef struct ARSTREAM2_StreamSender_Config_t
     void *videoStatsCallbackUserPtr;                /**< Video stats reception callback function user pointer (optional, can be NULL) */
     ARSTREAM2_StreamSender_DisconnectionCallback_t disconnectionCallback;   /**< Disconnection callback function (optional, can be NULL) */
     void *disconnectionCallbackUserPtr;             /**< Disconnection callback function user pointer (optional, can be NULL) */
+    ARSTREAM2_StreamSender_BitrateCallback_t bitrateCallback;   /**< Congestion control target bitrate callback function (optional, can be NULL) */
+    void *bitrateCallbackUserPtr;                   /**< Congestion control target bitrate callback function user pointer (optional, can be NULL) */
     int naluFifoSize;                               /**< NAL unit FIFO size, @see ARSTREAM2_STREAM_SENDER_DEFAULT_NALU_FIFO_SIZE */
+    int naluFifoLockFree;                           /**< Boolean-like (0-1) flag: if active use a lock-free single-producer/single-consumer NAL unit FIFO (SendNewNalu/SendNNewNalu must then always be called from the same thread) */
     int maxPacketSize;                              /**< Maximum network packet size in bytes (example: the interface MTU) */
     int targetPacketSize;                           /**< Target network packet size in bytes */
     int maxBitrate;                                 /**< Maximum streaming bitrate in bit/s (optional, can be 0) */
+    int minBitrate;                                 /**< Minimum streaming bitrate in bit/s for the congestion control (optional, can be 0) */
     int maxLatencyMs;                               /**< Maximum acceptable total latency in milliseconds (optional, can be 0) */
     int maxNetworkLatencyMs[ARSTREAM2_STREAM_SENDER_MAX_IMPORTANCE_LEVELS];  /**< Maximum acceptable network latency in milliseconds for each NALU importance level */
+    int useCongestionControl;                       /**< Boolean-like (0-1) flag: if active estimate the available bandwidth from the RTCP feedback (delay gradient, loss and RTT), adjust the streaming bitrate up to maxBitrate and report the target encoder bitrate through bitrateCallback */
     int useRtpHeaderExtensions;                     /**< Boolean-like (0-1) flag: if active insert access unit metadata as RTP header extensions */
+    int useGso;                                     /**< Boolean-like (0-1) flag: if active send same-size consecutive RTP packets (e.g. FU-A fragments) with UDP generic segmentation offload (Linux only, falls back to sendmmsg when not supported) */
+    int useRtcpNack;                                /**< Boolean-like (0-1) flag: if active keep recently sent RTP packets in a bounded retransmission cache and resend them on RTCP generic NACK (RFC4585) feedback */
+    int fecGroupSize;                               /**< Number of consecutive RTP packets protected by each XOR FEC repair packet (optional, 0 disables FEC, max 16) */
+    int fecRowCount;                                /**< Number of FEC rows for additional column protection of importance level 0 NAL units (optional, 0 or 1 for row protection only, max 16) */
+    int fecImportanceLevelCount;                    /**< Only NAL units with an importance below this value are FEC protected (optional, 0 for all importance levels) */
+    int pacingWindowPercent;                        /**< Percentage of the frame interval over which the RTP packets of an access unit are spread to avoid line-rate bursts (optional, 0 disables pacing, max 100) */
+    int useTxTime;                                  /**< Hand the pacing to the kernel: each RTP packet gets an SO_TXTIME launch time within the pacing window and whole access units are sent at once (Linux only, optional, 0 for user-space pacing, 1 for CLOCK_MONOTONIC launch times with the fq qdisc, 2 for CLOCK_TAI launch times with the etf qdisc; disables useGso) */
+    int usePacketFifoArena;                         /**< Boolean-like (0-1) flag: if active allocate all the RTP packet FIFO items and buffers in a single mmap'd region */
+    int packetFifoArenaHugePages;                   /**< Boolean-like (0-1) flag: if active back the packet FIFO arena with huge pages (MAP_HUGETLB, or transparent huge pages as a fallback) */
+    int packetFifoArenaLock;                        /**< Boolean-like (0-1) flag: if active lock the packet FIFO arena in memory (mlock, the RLIMIT_MEMLOCK limit applies) */
+    ARSTREAM2_ShmTransport_t *shmTransport;         /**< Shared memory transport to a co-located StreamReceiver instead of the network (optional, can be NULL; disables useGso and useTxTime), @see ARSTREAM2_ShmTransport_Create() */
+    int maxDestinationCount;                        /**< Maximum number of additional destinations, @see ARSTREAM2_StreamSender_StartDestination() (optional, can be 0) */
     const char *debugPath;                          /**< Optional path for writing debug files (optional, can be NULL) */
 
 } ARSTREAM2_StreamSender_Config_t;
 
 
+/**
+ * @brief StreamSender additional destination configuration parameters
+ */
+typedef struct ARSTREAM2_StreamSender_DestinationConfig_t
+{
+    const char *clientAddr;                         /**< Client address */
+    const char *mcastAddr;                          /**< Multicast send address (optional, NULL for no multicast) */
+    const char *mcastIfaceAddr;                     /**< Multicast output interface address (required if mcastAddr is not NULL) */
+    int serverStreamPort;                           /**< Server stream port (must differ from the main and other destinations server ports) */
+    int serverControlPort;                          /**< Server control port (must differ from the main and other destinations server ports) */
+    int clientStreamPort;                           /**< Client stream port */
+    int clientControlPort;                          /**< Client control port */
+    eARSAL_SOCKET_CLASS_SELECTOR classSelector;     /**< Type of Service class selector */
+    int streamSocketBufferSize;                     /**< Send buffer size for the stream socket (optional, can be 0) */
+    int maxLatencyMs;                               /**< Maximum acceptable total latency in milliseconds (optional, can be 0) */
+    int maxNetworkLatencyMs[ARSTREAM2_STREAM_SENDER_MAX_IMPORTANCE_LEVELS];  /**< Maximum acceptable network latency in milliseconds for each NALU importance level */
+    int useRtcpNack;                                /**< Boolean-like (0-1) flag: if active resend packets on RTCP generic NACK feedback from this destination */
+
+} ARSTREAM2_StreamSender_DestinationConfig_t;
+
+
 /**
  * @brief StreamSender dynamic configuration parameters
  */
@@ -199,6 +255,10 @@ typedef struct ARSTREAM2_StreamSender_DynamicConfig_t
     int maxBitrate;                                 /**< Maximum streaming bitrate in bit/s (optional, can be 0) */
     int maxLatencyMs;                               /**< Maximum acceptable total latency in milliseconds (optional, can be 0) */
     int maxNetworkLatencyMs[ARSTREAM2_STREAM_SENDER_MAX_IMPORTANCE_LEVELS];  /**< Maximum acceptable network latency in milliseconds for each NALU importance level */
+    int fecGroupSize;                               /**< Number of consecutive RTP packets protected by each XOR FEC repair packet (0 disables FEC, max 16) */
+    int fecRowCount;                                /**< Number of FEC rows for additional column protection of importance level 0 NAL units (0 or 1 for row protection only, max 16) */
+    int fecImportanceLevelCount;                    /**< Only NAL units with an importance below this value are FEC protected (0 for all importance levels) */
+    int pacingWindowPercent;                        /**< Percentage of the frame interval over which the RTP packets of an access unit are spread (0 disables pacing, max 100) */
 
 } ARSTREAM2_StreamSender_DynamicConfig_t;
 
@@ -285,6 +345,7 @@ eARSTREAM2_ERROR ARSTREAM2_StreamSender_SendNewNalu(ARSTREAM2_StreamSender_Handl
 /**
  * @brief Sends multiple new NAL units
  * @warning The NAL unit buffers must remain available for the sender until the NAL unit or access unit callback functions are called.
+ * @warning With a lock-free NAL unit FIFO (naluFifoLockFree) this function and ARSTREAM2_StreamSender_SendNewNalu() must always be called from the same thread.
  *
  * @param[in] sender The sender instance
  * @param[in] nalu Pointer to a NAL unit descriptor array
@@ -302,6 +363,7 @@ eARSTREAM2_ERROR ARSTREAM2_StreamSender_SendNNewNalu(ARSTREAM2_StreamSender_Hand
 
 /**
  * @brief Flush all currently queued NAL units
+ * @note With a lock-free NAL unit FIFO the flush is performed asynchronously by the sender thread.
  *
  * @param[in] sender The sender instance
  *
@@ -410,6 +472,45 @@ eARSTREAM2_ERROR ARSTREAM2_StreamSender_GetMonitoring(ARSTREAM2_StreamSender_Han
                                                       ARSTREAM2_StreamSender_MonitoringData_t *monitoringData);
 
 
+/**
+ * @brief Start streaming to an additional destination.
+ *
+ * The NAL units are packetized once and the RTP packets are sent both to the main client and to each
+ * additional destination. Each destination has its own packet queue, timeouts and RTCP session.
+ * The library allocates the required resources. The user must call ARSTREAM2_StreamSender_StopDestination()
+ * to free the resources.
+ *
+ * @param streamSenderHandle StreamSender instance handle.
+ * @param destinationHandle Pointer to the destination handle used in future calls to the library.
+ * @param config The destination configuration.
+ *
+ * @return ARSTREAM2_OK if no error occurred.
+ * @return ARSTREAM2_ERROR_RESOURCE_UNAVAILABLE if the maxDestinationCount limit is reached.
+ * @return an eARSTREAM2_ERROR error code if another error occurred.
+ *
+ * @see ARSTREAM2_StreamSender_StopDestination()
+ */
+eARSTREAM2_ERROR ARSTREAM2_StreamSender_StartDestination(ARSTREAM2_StreamSender_Handle streamSenderHandle,
+                                                         ARSTREAM2_StreamSender_DestinationHandle *destinationHandle,
+                                                         const ARSTREAM2_StreamSender_DestinationConfig_t *config);
+
+
+/**
+ * @brief Stop streaming to an additional destination.
+ *
+ * The library stops the destination and frees the allocated resources.
+ * On success the destinationHandle is set to NULL.
+ *
+ * @param streamSenderHandle StreamSender instance handle.
+ * @param destinationHandle Pointer to the destination handle used in future calls to the library.
+ *
+ * @return ARSTREAM2_OK if no error occurred.
+ * @return an eARSTREAM2_ERROR error code if an error occurred.
+ */
+eARSTREAM2_ERROR ARSTREAM2_StreamSender_StopDestination(ARSTREAM2_StreamSender_Handle streamSenderHandle,
+                                                        ARSTREAM2_StreamSender_DestinationHandle *destinationHandle);
+
+
 #ifdef __cplusplus
 }
 #endif /* #ifdef __cplusplus */
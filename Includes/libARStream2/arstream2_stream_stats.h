@@ -65,6 +65,11 @@ typedef struct
         uint64_t inputToSentTimeIntegralSq;         /**< Input to sent time squared integral value (microseconds^2) */
         uint64_t inputToDroppedTimeIntegral;        /**< Input to dropped time integral value (microseconds) */
         uint64_t inputToDroppedTimeIntegralSq;      /**< Input to dropped time squared integral value (microseconds^2) */
+        uint32_t pacedPacketCount;                  /**< Total packets sent through the pacer */
+        uint64_t pacingDelayIntegral;               /**< Pacing delay (access unit start of transmission to packet sent time) integral value (microseconds) */
+        uint64_t pacingDelayIntegralSq;             /**< Pacing delay squared integral value (microseconds^2) */
+        uint32_t fecRepairPacketCount;              /**< Total FEC repair packets generated */
+        uint32_t fecUnprotectedPacketCount;         /**< Total packets that should have been FEC protected but exceeded the max protected size */
 
     } senderStats;
 
@@ -35,7 +35,10 @@ LOCAL_SRC_FILES := \
 	src/arstream2_rtp_sender.c \
 	src/arstream2_rtp.c \
 	src/arstream2_rtp_h264.c \
+	src/arstream2_rtp_fec.c \
+	src/arstream2_rtp_cc.c \
 	src/arstream2_rtcp.c \
+	src/arstream2_shm_transport.c \
 	src/arstream2_stream_recorder.c \
 	src/arstream2_stream_stats.c \
 	src/arstream2_stream_sender.c \
@@ -49,17 +52,18 @@ LOCAL_INSTALL_HEADERS := \
 	Includes/libARStream2/arstream2_stream_sender.h:usr/include/libARStream2/ \
 	Includes/libARStream2/arstream2_stream_receiver.h:usr/include/libARStream2/ \
 	Includes/libARStream2/arstream2_stream_stats.h:usr/include/libARStream2/ \
-	Includes/libARStream2/arstream2_stream_metadata.h:usr/include/libARStream2/
+	Includes/libARStream2/arstream2_stream_metadata.h:usr/include/libARStream2/ \
+	Includes/libARStream2/arstream2_shm_transport.h:usr/include/libARStream2/
 
 
 ifeq ("$(TARGET_OS)","linux")
   ifeq ("$(TARGET_OS_FLAVOUR)","android")
     ANDROID_API_HAS_MMSG = $(shell test $(TARGET_ANDROID_APILEVEL) -ge 21 && echo 1)
     ifeq ("$(ANDROID_API_HAS_MMSG)","1")
-      LOCAL_CFLAGS += -DHAS_MMSG
+      LOCAL_CFLAGS += -DHAS_MMSG -DHAS_EPOLL
     endif
   else
-    LOCAL_CFLAGS += -DHAS_MMSG
+    LOCAL_CFLAGS += -DHAS_MMSG -DHAS_EPOLL -DHAS_IO_URING
   endif
 endif
 
@@ -137,7 +137,68 @@ void ARSTREAM2_H264_AuCopy(ARSTREAM2_H264_AccessUnit_t *dst, const ARSTREAM2_H26
 }
 
 
-int ARSTREAM2_H264_NaluFifoInit(ARSTREAM2_H264_NaluFifo_t *fifo, int maxCount)
+static int ARSTREAM2_H264_NaluRingInit(ARSTREAM2_H264_NaluRing_t *ring, int maxCount)
+{
+    unsigned int size = 1;
+
+    while (size < (unsigned int)maxCount)
+    {
+        size <<= 1;
+    }
+
+    ring->item = malloc(size * sizeof(ARSTREAM2_H264_NaluFifoItem_t*));
+    if (!ring->item)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_H264_TAG, "FIFO allocation failed (size %zu)", size * sizeof(ARSTREAM2_H264_NaluFifoItem_t*));
+        return -1;
+    }
+    memset(ring->item, 0, size * sizeof(ARSTREAM2_H264_NaluFifoItem_t*));
+    ring->mask = size - 1;
+    ring->head = 0;
+    ring->tail = 0;
+
+    return 0;
+}
+
+
+/* Producer side: only the producer thread writes the tail index */
+static int ARSTREAM2_H264_NaluRingPush(ARSTREAM2_H264_NaluRing_t *ring, ARSTREAM2_H264_NaluFifoItem_t *item)
+{
+    unsigned int tail = ring->tail;
+    unsigned int head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+
+    if (tail - head > ring->mask)
+    {
+        return -2;
+    }
+
+    ring->item[tail & ring->mask] = item;
+    __atomic_store_n(&ring->tail, tail + 1, __ATOMIC_RELEASE);
+
+    return 0;
+}
+
+
+/* Consumer side: only the consumer thread writes the head index */
+static ARSTREAM2_H264_NaluFifoItem_t* ARSTREAM2_H264_NaluRingPop(ARSTREAM2_H264_NaluRing_t *ring)
+{
+    ARSTREAM2_H264_NaluFifoItem_t* item;
+    unsigned int head = ring->head;
+    unsigned int tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+
+    if (head == tail)
+    {
+        return NULL;
+    }
+
+    item = ring->item[head & ring->mask];
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+
+    return item;
+}
+
+
+int ARSTREAM2_H264_NaluFifoInit(ARSTREAM2_H264_NaluFifo_t *fifo, int maxCount, int lockFree)
 {
     int i;
     ARSTREAM2_H264_NaluFifoItem_t* cur;
@@ -172,6 +233,28 @@ int ARSTREAM2_H264_NaluFifoInit(ARSTREAM2_H264_NaluFifo_t *fifo, int maxCount)
     }
     memset(fifo->pool, 0, maxCount * sizeof(ARSTREAM2_H264_NaluFifoItem_t));
 
+    if (lockFree)
+    {
+        /* Both rings can hold all the items so that a push never fails */
+        if ((ARSTREAM2_H264_NaluRingInit(&fifo->ring, maxCount) != 0)
+                || (ARSTREAM2_H264_NaluRingInit(&fifo->freeRing, maxCount) != 0))
+        {
+            free(fifo->ring.item);
+            free(fifo->pool);
+            fifo->ring.item = NULL;
+            fifo->pool = NULL;
+            return -1;
+        }
+        fifo->lockFree = 1;
+
+        for (i = 0; i < maxCount; i++)
+        {
+            ARSTREAM2_H264_NaluRingPush(&fifo->freeRing, &fifo->pool[i]);
+        }
+
+        return 0;
+    }
+
     for (i = 0; i < maxCount; i++)
     {
         cur = &fifo->pool[i];
@@ -197,6 +280,8 @@ int ARSTREAM2_H264_NaluFifoFree(ARSTREAM2_H264_NaluFifo_t *fifo)
     }
 
     ARSAL_Mutex_Destroy(&(fifo->mutex));
+    free(fifo->ring.item);
+    free(fifo->freeRing.item);
     free(fifo->pool);
     memset(fifo, 0, sizeof(ARSTREAM2_H264_NaluFifo_t));
 
@@ -212,6 +297,27 @@ ARSTREAM2_H264_NaluFifoItem_t* ARSTREAM2_H264_NaluFifoPopFreeItem(ARSTREAM2_H264
         return NULL;
     }
 
+    if (fifo->lockFree)
+    {
+        ARSTREAM2_H264_NaluFifoItem_t* cur = fifo->producerSpare;
+        if (cur)
+        {
+            fifo->producerSpare = cur->next;
+            cur->prev = NULL;
+            cur->next = NULL;
+            return cur;
+        }
+        cur = ARSTREAM2_H264_NaluRingPop(&fifo->freeRing);
+        if (!cur)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_H264_TAG, "NALU FIFO is full");
+            return NULL;
+        }
+        cur->prev = NULL;
+        cur->next = NULL;
+        return cur;
+    }
+
     ARSAL_Mutex_Lock(&(fifo->mutex));
 
     if (fifo->free)
@@ -241,6 +347,11 @@ int ARSTREAM2_H264_NaluFifoPushFreeItem(ARSTREAM2_H264_NaluFifo_t *fifo, ARSTREA
         return -1;
     }
 
+    if (fifo->lockFree)
+    {
+        return ARSTREAM2_H264_NaluRingPush(&fifo->freeRing, item);
+    }
+
     ARSAL_Mutex_Lock(&(fifo->mutex));
 
     if (fifo->free)
@@ -261,6 +372,27 @@ int ARSTREAM2_H264_NaluFifoPushFreeItem(ARSTREAM2_H264_NaluFifo_t *fifo, ARSTREA
 }
 
 
+int ARSTREAM2_H264_NaluFifoUnpopFreeItem(ARSTREAM2_H264_NaluFifo_t *fifo, ARSTREAM2_H264_NaluFifoItem_t *item)
+{
+    if ((!fifo) || (!item))
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_H264_TAG, "Invalid pointer");
+        return -1;
+    }
+
+    if (fifo->lockFree)
+    {
+        /* The free ring is written by the consumer only: keep the item on the producer side */
+        item->prev = NULL;
+        item->next = fifo->producerSpare;
+        fifo->producerSpare = item;
+        return 0;
+    }
+
+    return ARSTREAM2_H264_NaluFifoPushFreeItem(fifo, item);
+}
+
+
 int ARSTREAM2_H264_NaluFifoEnqueueItem(ARSTREAM2_H264_NaluFifo_t *fifo, ARSTREAM2_H264_NaluFifoItem_t *item)
 {
     if ((!fifo) || (!item))
@@ -269,6 +401,16 @@ int ARSTREAM2_H264_NaluFifoEnqueueItem(ARSTREAM2_H264_NaluFifo_t *fifo, ARSTREAM
         return -1;
     }
 
+    if (fifo->lockFree)
+    {
+        if (ARSTREAM2_H264_NaluRingPush(&fifo->ring, item) != 0)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_H264_TAG, "NALU FIFO is full");
+            return -2;
+        }
+        return 0;
+    }
+
     ARSAL_Mutex_Lock(&(fifo->mutex));
 
     if (fifo->count >= fifo->size)
@@ -311,6 +453,11 @@ ARSTREAM2_H264_NaluFifoItem_t* ARSTREAM2_H264_NaluFifoDequeueItem(ARSTREAM2_H264
         return NULL;
     }
 
+    if (fifo->lockFree)
+    {
+        return ARSTREAM2_H264_NaluRingPop(&fifo->ring);
+    }
+
     ARSAL_Mutex_Lock(&(fifo->mutex));
 
     if ((!fifo->head) || (!fifo->count))
@@ -366,6 +513,259 @@ int ARSTREAM2_H264_NaluFifoFlush(ARSTREAM2_H264_NaluFifo_t *fifo)
 }
 
 
+static int ARSTREAM2_H264_AuRingInit(ARSTREAM2_H264_AuRing_t *ring, int maxCount)
+{
+    unsigned int size = 1, i;
+
+    while (size < (unsigned int)maxCount)
+    {
+        size <<= 1;
+    }
+
+    ring->cell = malloc(size * sizeof(ARSTREAM2_H264_AuRingCell_t));
+    if (!ring->cell)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_H264_TAG, "FIFO allocation failed (size %zu)", size * sizeof(ARSTREAM2_H264_AuRingCell_t));
+        return -1;
+    }
+    for (i = 0; i < size; i++)
+    {
+        ring->cell[i].seq = i;
+        ring->cell[i].ptr = NULL;
+    }
+    ring->mask = size - 1;
+    ring->head = 0;
+    ring->tail = 0;
+
+    return 0;
+}
+
+
+static void ARSTREAM2_H264_AuRingFree(ARSTREAM2_H264_AuRing_t *ring)
+{
+    free(ring->cell);
+    ring->cell = NULL;
+    ring->mask = 0;
+    ring->head = 0;
+    ring->tail = 0;
+}
+
+
+/* Bounded MPMC ring: each cell sequence number tells whether it is ready
+ * to be written (seq == pos) or to be read (seq == pos + 1) */
+static int ARSTREAM2_H264_AuRingPush(ARSTREAM2_H264_AuRing_t *ring, void *ptr)
+{
+    ARSTREAM2_H264_AuRingCell_t *cell;
+    unsigned int pos = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+    unsigned int seq;
+    int diff;
+
+    for (;;)
+    {
+        cell = &ring->cell[pos & ring->mask];
+        seq = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE);
+        diff = (int)(seq - pos);
+        if (diff == 0)
+        {
+            if (__atomic_compare_exchange_n(&ring->tail, &pos, pos + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            {
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            return -2;
+        }
+        else
+        {
+            pos = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+        }
+    }
+
+    cell->ptr = ptr;
+    __atomic_store_n(&cell->seq, pos + 1, __ATOMIC_RELEASE);
+
+    return 0;
+}
+
+
+static void* ARSTREAM2_H264_AuRingPop(ARSTREAM2_H264_AuRing_t *ring)
+{
+    ARSTREAM2_H264_AuRingCell_t *cell;
+    unsigned int pos = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+    unsigned int seq;
+    void *ptr;
+    int diff;
+
+    if (!ring->cell)
+    {
+        return NULL;
+    }
+
+    for (;;)
+    {
+        cell = &ring->cell[pos & ring->mask];
+        seq = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE);
+        diff = (int)(seq - (pos + 1));
+        if (diff == 0)
+        {
+            if (__atomic_compare_exchange_n(&ring->head, &pos, pos + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            {
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            return NULL;
+        }
+        else
+        {
+            pos = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+        }
+    }
+
+    ptr = cell->ptr;
+    __atomic_store_n(&cell->seq, pos + ring->mask + 1, __ATOMIC_RELEASE);
+
+    return ptr;
+}
+
+
+static int ARSTREAM2_H264_AuBufferSlabInit(ARSTREAM2_H264_AuBufferSlab_t *slab, int bufferMaxCount, unsigned int auBufferSize)
+{
+    ARSTREAM2_H264_AuBufferClass_t *bufferClass;
+    unsigned int i;
+    int c;
+
+    memset(slab, 0, sizeof(ARSTREAM2_H264_AuBufferSlab_t));
+    slab->classCount = ARSTREAM2_H264_AU_BUFFER_CLASS_COUNT;
+
+    for (c = 0; c < slab->classCount; c++)
+    {
+        bufferClass = &slab->bufferClass[c];
+        bufferClass->blockSize = auBufferSize << c;
+        bufferClass->blockMaxCount = (c == 0) ? (unsigned int)bufferMaxCount : (unsigned int)bufferMaxCount >> (c + 1);
+        if (bufferClass->blockMaxCount == 0)
+        {
+            bufferClass->blockMaxCount = 1;
+        }
+        bufferClass->block = calloc(bufferClass->blockMaxCount, sizeof(uint8_t*));
+        if (!bufferClass->block)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_H264_TAG, "Slab allocation failed (size %zu)", bufferClass->blockMaxCount * sizeof(uint8_t*));
+            return -1;
+        }
+        if (ARSTREAM2_H264_AuRingInit(&bufferClass->blockFree, bufferClass->blockMaxCount) != 0)
+        {
+            return -1;
+        }
+    }
+
+    /* class 0 blocks are allocated upfront, one for each pool buffer */
+    bufferClass = &slab->bufferClass[0];
+    for (i = 0; i < bufferClass->blockMaxCount; i++)
+    {
+        bufferClass->block[i] = malloc(bufferClass->blockSize);
+        if (!bufferClass->block[i])
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_H264_TAG, "FIFO buffer allocation failed (size %d)", bufferClass->blockSize);
+            return -1;
+        }
+        bufferClass->blockCount++;
+    }
+
+    return 0;
+}
+
+
+static void ARSTREAM2_H264_AuBufferSlabFree(ARSTREAM2_H264_AuBufferSlab_t *slab)
+{
+    ARSTREAM2_H264_AuBufferClass_t *bufferClass;
+    unsigned int i;
+    int c;
+
+    for (c = 0; c < slab->classCount; c++)
+    {
+        bufferClass = &slab->bufferClass[c];
+        if (bufferClass->block)
+        {
+            for (i = 0; i < bufferClass->blockCount; i++)
+            {
+                free(bufferClass->block[i]);
+            }
+            free(bufferClass->block);
+        }
+        ARSTREAM2_H264_AuRingFree(&bufferClass->blockFree);
+    }
+
+    memset(slab, 0, sizeof(ARSTREAM2_H264_AuBufferSlab_t));
+}
+
+
+static uint8_t* ARSTREAM2_H264_AuBufferSlabGetBlock(ARSTREAM2_H264_AuBufferSlab_t *slab, int c)
+{
+    ARSTREAM2_H264_AuBufferClass_t *bufferClass = &slab->bufferClass[c];
+    uint8_t *block;
+    unsigned int idx;
+
+    block = (uint8_t*)ARSTREAM2_H264_AuRingPop(&bufferClass->blockFree);
+    if (block)
+    {
+        return block;
+    }
+
+    /* upper class blocks are allocated on first use and then kept in the slab */
+    idx = __atomic_fetch_add(&bufferClass->blockCount, 1, __ATOMIC_RELAXED);
+    if ((c == 0) || (idx >= bufferClass->blockMaxCount))
+    {
+        __atomic_fetch_sub(&bufferClass->blockCount, 1, __ATOMIC_RELAXED);
+        return NULL;
+    }
+    block = malloc(bufferClass->blockSize);
+    if (!block)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_H264_TAG, "Slab block allocation failed (size %u)", bufferClass->blockSize);
+        __atomic_fetch_sub(&bufferClass->blockCount, 1, __ATOMIC_RELAXED);
+        return NULL;
+    }
+    bufferClass->block[idx] = block;
+
+    return block;
+}
+
+
+/* Give back an upper class or heap block and restore a class 0 block in the buffer */
+static void ARSTREAM2_H264_AuBufferSlabRestore(ARSTREAM2_H264_AuFifoBuffer_t *buffer)
+{
+    ARSTREAM2_H264_AuBufferSlab_t *slab = buffer->slab;
+    uint8_t *block;
+
+    if ((!slab) || (buffer->auBufferClass == 0))
+    {
+        return;
+    }
+
+    block = (uint8_t*)ARSTREAM2_H264_AuRingPop(&slab->bufferClass[0].blockFree);
+    if (!block)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_H264_TAG, "No free class 0 block in slab");
+        return;
+    }
+
+    if (buffer->auBufferClass > 0)
+    {
+        ARSTREAM2_H264_AuRingPush(&slab->bufferClass[buffer->auBufferClass].blockFree, buffer->auBuffer);
+    }
+    else
+    {
+        free(buffer->auBuffer);
+    }
+    buffer->auBuffer = block;
+    buffer->auBufferSize = slab->bufferClass[0].blockSize;
+    buffer->auBufferClass = 0;
+}
+
+
 int ARSTREAM2_H264_AuFifoInit(ARSTREAM2_H264_AuFifo_t *fifo, int itemMaxCount, int itemNaluMaxCount, int bufferMaxCount,
                               int auBufferSize, int metadataBufferSize, int userDataBufferSize, int videoStatsBufferSize)
 {
@@ -398,6 +798,13 @@ int ARSTREAM2_H264_AuFifoInit(ARSTREAM2_H264_AuFifo_t *fifo, int itemMaxCount, i
         return -1;
     }
 
+    if ((ARSTREAM2_H264_AuRingInit(&fifo->itemFree, itemMaxCount) != 0)
+            || (ARSTREAM2_H264_AuRingInit(&fifo->bufferFree, bufferMaxCount) != 0))
+    {
+        ARSTREAM2_H264_AuFifoFree(fifo);
+        return -1;
+    }
+
     fifo->itemPoolSize = itemMaxCount;
     fifo->itemPool = malloc(itemMaxCount * sizeof(ARSTREAM2_H264_AuFifoItem_t));
     if (!fifo->itemPool)
@@ -418,13 +825,9 @@ int ARSTREAM2_H264_AuFifoInit(ARSTREAM2_H264_AuFifo_t *fifo, int itemMaxCount, i
             ARSTREAM2_H264_AuFifoFree(fifo);
             return -1;
         }
-        if (fifo->itemFree)
-        {
-            fifo->itemFree->prev = curItem;
-        }
-        curItem->next = fifo->itemFree;
+        curItem->next = NULL;
         curItem->prev = NULL;
-        fifo->itemFree = curItem;
+        ARSTREAM2_H264_AuRingPush(&fifo->itemFree, curItem);
     }
 
     fifo->bufferPoolSize = bufferMaxCount;
@@ -440,27 +843,29 @@ int ARSTREAM2_H264_AuFifoInit(ARSTREAM2_H264_AuFifo_t *fifo, int itemMaxCount, i
     for (i = 0; i < bufferMaxCount; i++)
     {
         curBuffer = &fifo->bufferPool[i];
-        if (fifo->bufferFree)
-        {
-            fifo->bufferFree->prev = curBuffer;
-        }
-        curBuffer->next = fifo->bufferFree;
+        curBuffer->next = NULL;
         curBuffer->prev = NULL;
-        fifo->bufferFree = curBuffer;
+        ARSTREAM2_H264_AuRingPush(&fifo->bufferFree, curBuffer);
+    }
+
+    for (i = 0; i < bufferMaxCount; i++)
+    {
+        fifo->bufferPool[i].auBufferClass = -1;
     }
 
     if (auBufferSize > 0)
     {
+        if (ARSTREAM2_H264_AuBufferSlabInit(&fifo->slab, bufferMaxCount, (unsigned int)auBufferSize) != 0)
+        {
+            ARSTREAM2_H264_AuFifoFree(fifo);
+            return -1;
+        }
         for (i = 0; i < bufferMaxCount; i++)
         {
-            fifo->bufferPool[i].auBuffer = malloc(auBufferSize);
-            if (!fifo->bufferPool[i].auBuffer)
-            {
-                ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_H264_TAG, "FIFO buffer allocation failed (size %d)", auBufferSize);
-                ARSTREAM2_H264_AuFifoFree(fifo);
-                return -1;
-            }
-            fifo->bufferPool[i].auBufferSize = auBufferSize;
+            fifo->bufferPool[i].auBuffer = fifo->slab.bufferClass[0].block[i];
+            fifo->bufferPool[i].auBufferSize = fifo->slab.bufferClass[0].blockSize;
+            fifo->bufferPool[i].auBufferClass = 0;
+            fifo->bufferPool[i].slab = &fifo->slab;
         }
     }
 
@@ -538,12 +943,17 @@ int ARSTREAM2_H264_AuFifoFree(ARSTREAM2_H264_AuFifo_t *fifo)
     }
 
     ARSAL_Mutex_Destroy(&(fifo->mutex));
+    ARSTREAM2_H264_AuRingFree(&fifo->itemFree);
+    ARSTREAM2_H264_AuRingFree(&fifo->bufferFree);
 
     if (fifo->bufferPool)
     {
         for (i = 0; i < fifo->bufferPoolSize; i++)
         {
-            free(fifo->bufferPool[i].auBuffer);
+            if (fifo->bufferPool[i].auBufferClass < 0)
+            {
+                free(fifo->bufferPool[i].auBuffer);
+            }
             fifo->bufferPool[i].auBuffer = NULL;
             free(fifo->bufferPool[i].metadataBuffer);
             fifo->bufferPool[i].metadataBuffer = NULL;
@@ -558,6 +968,8 @@ int ARSTREAM2_H264_AuFifoFree(ARSTREAM2_H264_AuFifo_t *fifo)
         free(fifo->bufferPool);
     }
 
+    ARSTREAM2_H264_AuBufferSlabFree(&fifo->slab);
+
     memset(fifo, 0, sizeof(ARSTREAM2_H264_AuFifo_t));
 
     return 0;
@@ -572,18 +984,14 @@ int ARSTREAM2_H264_AuFifoAddQueue(ARSTREAM2_H264_AuFifo_t *fifo, ARSTREAM2_H264_
         return -1;
     }
 
-    int mutexRet = ARSAL_Mutex_Init(&(queue->mutex));
-    if (mutexRet != 0)
+    /* The queue can hold all the FIFO items so that an enqueue never fails */
+    if (ARSTREAM2_H264_AuRingInit(&queue->ring, fifo->itemPoolSize) != 0)
     {
-        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_H264_TAG, "Mutex creation failed (%d)", mutexRet);
         return -1;
     }
 
     ARSAL_Mutex_Lock(&(fifo->mutex));
 
-    queue->count = 0;
-    queue->head = NULL;
-    queue->tail = NULL;
     queue->prev = NULL;
     queue->next = fifo->queue;
     if (queue->next)
@@ -626,13 +1034,10 @@ int ARSTREAM2_H264_AuFifoRemoveQueue(ARSTREAM2_H264_AuFifo_t *fifo, ARSTREAM2_H2
 
     queue->prev = NULL;
     queue->next = NULL;
-    queue->count = 0;
-    queue->head = NULL;
-    queue->tail = NULL;
 
     ARSAL_Mutex_Unlock(&(fifo->mutex));
 
-    ARSAL_Mutex_Destroy(&(queue->mutex));
+    ARSTREAM2_H264_AuRingFree(&queue->ring);
 
     return 0;
 }
@@ -640,31 +1045,24 @@ int ARSTREAM2_H264_AuFifoRemoveQueue(ARSTREAM2_H264_AuFifo_t *fifo, ARSTREAM2_H2
 
 ARSTREAM2_H264_AuFifoBuffer_t* ARSTREAM2_H264_AuFifoGetBuffer(ARSTREAM2_H264_AuFifo_t *fifo)
 {
+    ARSTREAM2_H264_AuFifoBuffer_t* cur;
+
     if (!fifo)
     {
         ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_H264_TAG, "Invalid pointer");
         return NULL;
     }
 
-    ARSAL_Mutex_Lock(&(fifo->mutex));
-
-    if (fifo->bufferFree)
-    {
-        ARSTREAM2_H264_AuFifoBuffer_t* cur = fifo->bufferFree;
-        fifo->bufferFree = cur->next;
-        if (cur->next) cur->next->prev = NULL;
-        cur->prev = NULL;
-        cur->next = NULL;
-        cur->refCount = 1;
-        ARSAL_Mutex_Unlock(&(fifo->mutex));
-        return cur;
-    }
-    else
+    cur = (ARSTREAM2_H264_AuFifoBuffer_t*)ARSTREAM2_H264_AuRingPop(&fifo->bufferFree);
+    if (!cur)
     {
-        ARSAL_Mutex_Unlock(&(fifo->mutex));
         ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_H264_TAG, "No free buffer in pool");
         return NULL;
     }
+
+    __atomic_store_n(&cur->refCount, 1, __ATOMIC_RELAXED);
+
+    return cur;
 }
 
 
@@ -676,11 +1074,7 @@ int ARSTREAM2_H264_AuFifoBufferAddRef(ARSTREAM2_H264_AuFifo_t *fifo, ARSTREAM2_H
         return -1;
     }
 
-    ARSAL_Mutex_Lock(&(fifo->mutex));
-
-    buffer->refCount++;
-
-    ARSAL_Mutex_Unlock(&(fifo->mutex));
+    __atomic_add_fetch(&buffer->refCount, 1, __ATOMIC_RELAXED);
 
     return 0;
 }
@@ -688,70 +1082,61 @@ int ARSTREAM2_H264_AuFifoBufferAddRef(ARSTREAM2_H264_AuFifo_t *fifo, ARSTREAM2_H
 
 int ARSTREAM2_H264_AuFifoUnrefBuffer(ARSTREAM2_H264_AuFifo_t *fifo, ARSTREAM2_H264_AuFifoBuffer_t *buffer)
 {
+    unsigned int refCount;
+
     if ((!fifo) || (!buffer))
     {
         ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_H264_TAG, "Invalid pointer");
         return -1;
     }
 
-    ARSAL_Mutex_Lock(&(fifo->mutex));
-
-    if (buffer->refCount != 0)
-    {
-        buffer->refCount--;
-    }
-    else
+    refCount = __atomic_load_n(&buffer->refCount, __ATOMIC_RELAXED);
+    do
     {
-        ARSAL_PRINT(ARSAL_PRINT_WARNING, ARSTREAM2_H264_TAG, "FIXME! Ref count is already null, this should not happen!");
+        if (refCount == 0)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_WARNING, ARSTREAM2_H264_TAG, "FIXME! Ref count is already null, this should not happen!");
+            return 0;
+        }
     }
+    while (!__atomic_compare_exchange_n(&buffer->refCount, &refCount, refCount - 1, 1, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED));
 
-    if (buffer->refCount == 0)
+    if (refCount == 1)
     {
-        if (fifo->bufferFree)
-        {
-            fifo->bufferFree->prev = buffer;
-            buffer->next = fifo->bufferFree;
-        }
-        else
+        /* Last reference: give the buffer back to the pool */
+        ARSTREAM2_H264_AuBufferSlabRestore(buffer);
+        if (ARSTREAM2_H264_AuRingPush(&fifo->bufferFree, buffer) != 0)
         {
-            buffer->next = NULL;
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_H264_TAG, "Failed to push free buffer in pool");
+            return -1;
         }
-        fifo->bufferFree = buffer;
-        buffer->prev = NULL;
     }
 
-    ARSAL_Mutex_Unlock(&(fifo->mutex));
-
     return 0;
 }
 
 
 ARSTREAM2_H264_AuFifoItem_t* ARSTREAM2_H264_AuFifoPopFreeItem(ARSTREAM2_H264_AuFifo_t *fifo)
 {
+    ARSTREAM2_H264_AuFifoItem_t* cur;
+
     if (!fifo)
     {
         ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_H264_TAG, "Invalid pointer");
         return NULL;
     }
 
-    ARSAL_Mutex_Lock(&(fifo->mutex));
-
-    if (fifo->itemFree)
-    {
-        ARSTREAM2_H264_AuFifoItem_t* cur = fifo->itemFree;
-        fifo->itemFree = cur->next;
-        if (cur->next) cur->next->prev = NULL;
-        cur->prev = NULL;
-        cur->next = NULL;
-        ARSAL_Mutex_Unlock(&(fifo->mutex));
-        return cur;
-    }
-    else
+    cur = (ARSTREAM2_H264_AuFifoItem_t*)ARSTREAM2_H264_AuRingPop(&fifo->itemFree);
+    if (!cur)
     {
         ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_H264_TAG, "AU FIFO is full");
-        ARSAL_Mutex_Unlock(&(fifo->mutex));
         return NULL;
     }
+
+    cur->prev = NULL;
+    cur->next = NULL;
+
+    return cur;
 }
 
 
@@ -770,21 +1155,11 @@ int ARSTREAM2_H264_AuFifoPushFreeItem(ARSTREAM2_H264_AuFifo_t *fifo, ARSTREAM2_H
         return -1;
     }
 
-    ARSAL_Mutex_Lock(&(fifo->mutex));
-
-    if (fifo->itemFree)
+    if (ARSTREAM2_H264_AuRingPush(&fifo->itemFree, item) != 0)
     {
-        fifo->itemFree->prev = item;
-        item->next = fifo->itemFree;
-    }
-    else
-    {
-        item->next = NULL;
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_H264_TAG, "Failed to push free item in pool");
+        return -1;
     }
-    fifo->itemFree = item;
-    item->prev = NULL;
-
-    ARSAL_Mutex_Unlock(&(fifo->mutex));
 
     return 0;
 }
@@ -798,26 +1173,11 @@ int ARSTREAM2_H264_AuFifoEnqueueItem(ARSTREAM2_H264_AuFifoQueue_t *queue, ARSTRE
         return -1;
     }
 
-    ARSAL_Mutex_Lock(&(queue->mutex));
-
-    item->next = NULL;
-    if (queue->tail)
-    {
-        queue->tail->next = item;
-        item->prev = queue->tail;
-    }
-    else
+    if (ARSTREAM2_H264_AuRingPush(&queue->ring, item) != 0)
     {
-        item->prev = NULL;
-    }
-    queue->tail = item;
-    if (!queue->head)
-    {
-        queue->head = item;
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_H264_TAG, "AU FIFO queue is full");
+        return -2;
     }
-    queue->count++;
-
-    ARSAL_Mutex_Unlock(&(queue->mutex));
 
     return 0;
 }
@@ -825,42 +1185,13 @@ int ARSTREAM2_H264_AuFifoEnqueueItem(ARSTREAM2_H264_AuFifoQueue_t *queue, ARSTRE
 
 ARSTREAM2_H264_AuFifoItem_t* ARSTREAM2_H264_AuFifoDequeueItem(ARSTREAM2_H264_AuFifoQueue_t *queue)
 {
-    ARSTREAM2_H264_AuFifoItem_t* cur;
-
     if (!queue)
     {
         ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_H264_TAG, "Invalid pointer");
         return NULL;
     }
 
-    ARSAL_Mutex_Lock(&(queue->mutex));
-
-    if ((!queue->head) || (!queue->count))
-    {
-        ARSAL_Mutex_Unlock(&(queue->mutex));
-        //ARSAL_PRINT(ARSAL_PRINT_VERBOSE, ARSTREAM2_H264_TAG, "FIFO is empty");
-        return NULL;
-    }
-
-    cur = queue->head;
-    if (cur->next)
-    {
-        cur->next->prev = NULL;
-        queue->head = cur->next;
-        queue->count--;
-    }
-    else
-    {
-        queue->head = NULL;
-        queue->count = 0;
-        queue->tail = NULL;
-    }
-    cur->prev = NULL;
-    cur->next = NULL;
-
-    ARSAL_Mutex_Unlock(&(queue->mutex));
-
-    return cur;
+    return (ARSTREAM2_H264_AuFifoItem_t*)ARSTREAM2_H264_AuRingPop(&queue->ring);
 }
 
 
@@ -949,6 +1280,32 @@ int ARSTREAM2_H264_AuFifoFlush(ARSTREAM2_H264_AuFifo_t *fifo)
 }
 
 
+int ARSTREAM2_H264_AuFifoGetBufferStats(ARSTREAM2_H264_AuFifo_t *fifo, ARSTREAM2_H264_AuBufferStats_t *stats)
+{
+    int c;
+
+    if ((!fifo) || (!stats))
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_H264_TAG, "Invalid pointer");
+        return -1;
+    }
+
+    memset(stats, 0, sizeof(ARSTREAM2_H264_AuBufferStats_t));
+    stats->classCount = fifo->slab.classCount;
+    for (c = 0; c < fifo->slab.classCount; c++)
+    {
+        stats->blockSize[c] = fifo->slab.bufferClass[c].blockSize;
+        stats->blockCount[c] = __atomic_load_n(&fifo->slab.bufferClass[c].blockCount, __ATOMIC_RELAXED);
+        stats->auCount[c] = __atomic_load_n(&fifo->slab.bufferClass[c].auCount, __ATOMIC_RELAXED);
+        stats->overflowCount[c] = __atomic_load_n(&fifo->slab.bufferClass[c].overflowCount, __ATOMIC_RELAXED);
+        stats->exhaustedCount[c] = __atomic_load_n(&fifo->slab.bufferClass[c].exhaustedCount, __ATOMIC_RELAXED);
+    }
+    stats->heapCount = __atomic_load_n(&fifo->slab.heapCount, __ATOMIC_RELAXED);
+
+    return 0;
+}
+
+
 int ARSTREAM2_H264_AuNaluFifoInit(ARSTREAM2_H264_AccessUnit_t *au, int naluItemMaxCount)
 {
     int i;
@@ -968,6 +1325,14 @@ int ARSTREAM2_H264_AuNaluFifoInit(ARSTREAM2_H264_AccessUnit_t *au, int naluItemM
         return -1;
     }
     memset(au->naluPool, 0, naluItemMaxCount * sizeof(ARSTREAM2_H264_NaluFifoItem_t));
+    au->naluIov = malloc(naluItemMaxCount * sizeof(struct iovec));
+    if (!au->naluIov)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_H264_TAG, "FIFO allocation failed (size %zu)", naluItemMaxCount * sizeof(struct iovec));
+        free(au->naluPool);
+        au->naluPool = NULL;
+        return -1;
+    }
 
     for (i = 0; i < naluItemMaxCount; i++)
     {
@@ -994,6 +1359,7 @@ int ARSTREAM2_H264_AuNaluFifoFree(ARSTREAM2_H264_AccessUnit_t *au)
     }
 
     free(au->naluPool);
+    free(au->naluIov);
     memset(au, 0, sizeof(ARSTREAM2_H264_AccessUnit_t));
 
     return 0;
@@ -1236,6 +1602,31 @@ ARSTREAM2_H264_AuFifoItem_t* ARSTREAM2_H264_AuFifoDuplicateItem(ARSTREAM2_H264_A
 }
 
 
+/* Translate all NALU pointers to a new AU buffer */
+/* The old buffer is already released: its address is only used as an integer to compute the offsets */
+static int ARSTREAM2_H264_AuTranslateNalus(ARSTREAM2_H264_AccessUnit_t *au, uintptr_t oldAddr, uint8_t *newPtr, unsigned int newSize)
+{
+    ARSTREAM2_H264_NaluFifoItem_t *naluItem;
+
+    for (naluItem = au->naluHead; naluItem; naluItem = naluItem->next)
+    {
+        unsigned int offset = (unsigned int)((uintptr_t)naluItem->nalu.nalu - oldAddr);
+        if (offset < newSize)
+        {
+            naluItem->nalu.nalu = newPtr + offset;
+        }
+        else
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_H264_TAG, "Invalid NALU offset in AU buffer (%d)", offset);
+            naluItem->nalu.nalu = NULL;
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+
 int ARSTREAM2_H264_AuCheckSizeRealloc(ARSTREAM2_H264_AccessUnit_t *au, unsigned int size)
 {
     if ((!au) || (!au->buffer))
@@ -1246,37 +1637,80 @@ int ARSTREAM2_H264_AuCheckSizeRealloc(ARSTREAM2_H264_AccessUnit_t *au, unsigned
 
     if (au->auSize + size > au->buffer->auBufferSize)
     {
+        ARSTREAM2_H264_AuFifoBuffer_t *buffer = au->buffer;
+        ARSTREAM2_H264_AuBufferSlab_t *slab = buffer->slab;
         unsigned int newSize = au->auSize + size;
-        uint8_t *newPtr;
-        if (newSize < au->buffer->auBufferSize + ARSTREAM2_H264_AU_MIN_REALLOC_SIZE)
-            newSize = au->buffer->auBufferSize + ARSTREAM2_H264_AU_MIN_REALLOC_SIZE;
-        newPtr = realloc(au->buffer->auBuffer, newSize);
-        if (newPtr == NULL)
-        {
-            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_H264_TAG, "Access unit realloc failed (size %u)", newSize);
-            return -1;
-        }
-        else
+        uint8_t *oldPtr = buffer->auBuffer;
+        uintptr_t oldAddr = (uintptr_t)oldPtr;
+        uint8_t *newPtr = NULL;
+        int oldClass = buffer->auBufferClass, newClass = -1, c;
+
+        if ((slab) && (oldClass >= 0))
         {
-            /* translate all NALU pointers to the new AU buffer */
-            ARSTREAM2_H264_NaluFifoItem_t *naluItem;
-            for (naluItem = au->naluHead; naluItem; naluItem = naluItem->next)
+            /* move the access unit to the smallest larger size class with a free block */
+            __atomic_add_fetch(&slab->bufferClass[oldClass].overflowCount, 1, __ATOMIC_RELAXED);
+            for (c = oldClass + 1; (c < slab->classCount) && (!newPtr); c++)
             {
-                unsigned int offset = (unsigned int)(naluItem->nalu.nalu - au->buffer->auBuffer);
-                if (offset < newSize)
+                if (slab->bufferClass[c].blockSize < newSize)
+                {
+                    continue;
+                }
+                newPtr = ARSTREAM2_H264_AuBufferSlabGetBlock(slab, c);
+                if (newPtr)
                 {
-                    naluItem->nalu.nalu = newPtr + offset;
+                    newClass = c;
+                    newSize = slab->bufferClass[c].blockSize;
+                    __atomic_add_fetch(&slab->bufferClass[c].auCount, 1, __ATOMIC_RELAXED);
                 }
                 else
                 {
-                    ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_H264_TAG, "Invalid NALU offset in AU buffer (%d)", offset);
-                    naluItem->nalu.nalu = NULL;
+                    __atomic_add_fetch(&slab->bufferClass[c].exhaustedCount, 1, __ATOMIC_RELAXED);
+                }
+            }
+            if (!newPtr)
+            {
+                /* no suitable class: fall back to a heap buffer */
+                if (newSize < buffer->auBufferSize + ARSTREAM2_H264_AU_MIN_REALLOC_SIZE)
+                    newSize = buffer->auBufferSize + ARSTREAM2_H264_AU_MIN_REALLOC_SIZE;
+                newPtr = malloc(newSize);
+                if (newPtr == NULL)
+                {
+                    ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_H264_TAG, "Access unit alloc failed (size %u)", newSize);
                     return -1;
                 }
+                __atomic_add_fetch(&slab->heapCount, 1, __ATOMIC_RELAXED);
+            }
+
+            memcpy(newPtr, oldPtr, au->auSize);
+            if (oldClass > 0)
+            {
+                ARSTREAM2_H264_AuRingPush(&slab->bufferClass[oldClass].blockFree, oldPtr);
+            }
+            else
+            {
+                ARSTREAM2_H264_AuRingPush(&slab->bufferClass[0].blockFree, oldPtr);
             }
+            buffer->auBuffer = newPtr;
+            buffer->auBufferSize = newSize;
+            buffer->auBufferClass = newClass;
+
+            return ARSTREAM2_H264_AuTranslateNalus(au, oldAddr, newPtr, newSize);
+        }
+
+        if (newSize < buffer->auBufferSize + ARSTREAM2_H264_AU_MIN_REALLOC_SIZE)
+            newSize = buffer->auBufferSize + ARSTREAM2_H264_AU_MIN_REALLOC_SIZE;
+        newPtr = realloc(oldPtr, newSize);
+        if (newPtr == NULL)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_H264_TAG, "Access unit realloc failed (size %u)", newSize);
+            return -1;
+        }
+        else
+        {
+            buffer->auBuffer = newPtr;
+            buffer->auBufferSize = newSize;
 
-            au->buffer->auBuffer = newPtr;
-            au->buffer->auBufferSize = newSize;
+            return ARSTREAM2_H264_AuTranslateNalus(au, oldAddr, newPtr, newSize);
         }
     }
 
@@ -10,6 +10,7 @@
 #define _ARSTREAM2_H264_H_
 
 #include <inttypes.h>
+#include <sys/uio.h>
 #include <libARSAL/ARSAL_Mutex.h>
 
 
@@ -17,6 +18,8 @@
  * Macros
  */
 
+#define ARSTREAM2_H264_CACHE_LINE_SIZE 64
+
 #define ARSTREAM2_H264_BYTE_STREAM_NALU_START_CODE 0x00000001
 #define ARSTREAM2_H264_BYTE_STREAM_NALU_START_CODE_LENGTH 4
 
@@ -48,6 +51,7 @@
 
 #define ARSTREAM2_H264_AU_NALU_MAX_COUNT    (128)
 #define ARSTREAM2_H264_AU_MIN_REALLOC_SIZE  (10 * 1024)
+#define ARSTREAM2_H264_AU_BUFFER_CLASS_COUNT (4)
 
 #define ARSTREAM2_H264_MB_STATUS_CLASS_MAX_COUNT (12)
 #define ARSTREAM2_H264_MB_STATUS_ZONE_MAX_COUNT (68)
@@ -200,6 +204,22 @@ typedef struct ARSTREAM2_H264_NaluFifoItem_s
 } ARSTREAM2_H264_NaluFifoItem_t;
 
 
+/**
+ * @brief NAL unit single-producer/single-consumer ring
+ */
+typedef struct ARSTREAM2_H264_NaluRing_s
+{
+    ARSTREAM2_H264_NaluFifoItem_t **item;
+    unsigned int mask;
+    uint8_t pad0[ARSTREAM2_H264_CACHE_LINE_SIZE];
+    unsigned int head;  /* written by the consumer only */
+    uint8_t pad1[ARSTREAM2_H264_CACHE_LINE_SIZE - sizeof(unsigned int)];
+    unsigned int tail;  /* written by the producer only */
+    uint8_t pad2[ARSTREAM2_H264_CACHE_LINE_SIZE - sizeof(unsigned int)];
+
+} ARSTREAM2_H264_NaluRing_t;
+
+
 /**
  * @brief NAL unit FIFO
  */
@@ -213,6 +233,13 @@ typedef struct ARSTREAM2_H264_NaluFifo_s
     ARSTREAM2_H264_NaluFifoItem_t *pool;
     ARSAL_Mutex_t mutex;
 
+    /* Lock-free mode: items are queued in 'ring' by the producer
+     * and given back in 'freeRing' by the consumer */
+    int lockFree;
+    ARSTREAM2_H264_NaluRing_t ring;
+    ARSTREAM2_H264_NaluRing_t freeRing;
+    ARSTREAM2_H264_NaluFifoItem_t *producerSpare;   /* items given back by the producer (producer only) */
+
 } ARSTREAM2_H264_NaluFifo_t;
 
 
@@ -232,6 +259,9 @@ typedef struct ARSTREAM2_H264_AuFifoBuffer_s
     uint8_t *mbStatusBuffer;
     unsigned int mbStatusBufferSize;
 
+    int auBufferClass;  /* size class of auBuffer in the slab, -1 if heap allocated */
+    struct ARSTREAM2_H264_AuBufferSlab_s *slab;
+
     unsigned int refCount;
     struct ARSTREAM2_H264_AuFifoBuffer_s* prev;
     struct ARSTREAM2_H264_AuFifoBuffer_s* next;
@@ -267,6 +297,7 @@ typedef struct ARSTREAM2_H264_AccessUnit_s
     ARSTREAM2_H264_NaluFifoItem_t *naluTail;
     ARSTREAM2_H264_NaluFifoItem_t *naluFree;
     ARSTREAM2_H264_NaluFifoItem_t *naluPool;
+    struct iovec *naluIov; /* NAL units I/O vector for zero-copy output (naluPoolSize entries) */
 
 } ARSTREAM2_H264_AccessUnit_t;
 
@@ -284,15 +315,86 @@ typedef struct ARSTREAM2_H264_AuFifoItem_s
 } ARSTREAM2_H264_AuFifoItem_t;
 
 
+/**
+ * @brief Access unit FIFO lock-free ring cell
+ */
+typedef struct ARSTREAM2_H264_AuRingCell_s
+{
+    unsigned int seq;
+    void *ptr;
+
+} ARSTREAM2_H264_AuRingCell_t;
+
+
+/**
+ * @brief Access unit FIFO lock-free multi-producer/multi-consumer ring
+ */
+typedef struct ARSTREAM2_H264_AuRing_s
+{
+    ARSTREAM2_H264_AuRingCell_t *cell;
+    unsigned int mask;
+    uint8_t pad0[ARSTREAM2_H264_CACHE_LINE_SIZE];
+    unsigned int head;  /* dequeue position */
+    uint8_t pad1[ARSTREAM2_H264_CACHE_LINE_SIZE - sizeof(unsigned int)];
+    unsigned int tail;  /* enqueue position */
+    uint8_t pad2[ARSTREAM2_H264_CACHE_LINE_SIZE - sizeof(unsigned int)];
+
+} ARSTREAM2_H264_AuRing_t;
+
+
+/**
+ * @brief Access unit buffer size class
+ */
+typedef struct ARSTREAM2_H264_AuBufferClass_s
+{
+    unsigned int blockSize;
+    unsigned int blockMaxCount;
+    unsigned int blockCount;        /* blocks allocated so far (up to blockMaxCount) */
+    uint8_t **block;
+    ARSTREAM2_H264_AuRing_t blockFree;
+    unsigned int auCount;           /* access units moved to this class */
+    unsigned int overflowCount;     /* access units that outgrew this class */
+    unsigned int exhaustedCount;    /* no free block left in this class */
+
+} ARSTREAM2_H264_AuBufferClass_t;
+
+
+/**
+ * @brief Access unit buffer slab
+ * Class 0 blocks have the FIFO auBufferSize and are owned by the pool buffers;
+ * each upper class doubles the block size and blocks are allocated on first use.
+ */
+typedef struct ARSTREAM2_H264_AuBufferSlab_s
+{
+    int classCount;
+    ARSTREAM2_H264_AuBufferClass_t bufferClass[ARSTREAM2_H264_AU_BUFFER_CLASS_COUNT];
+    unsigned int heapCount;         /* access units that did not fit in any class */
+
+} ARSTREAM2_H264_AuBufferSlab_t;
+
+
+/**
+ * @brief Access unit buffer slab statistics
+ */
+typedef struct ARSTREAM2_H264_AuBufferStats_s
+{
+    int classCount;
+    unsigned int blockSize[ARSTREAM2_H264_AU_BUFFER_CLASS_COUNT];
+    unsigned int blockCount[ARSTREAM2_H264_AU_BUFFER_CLASS_COUNT];
+    unsigned int auCount[ARSTREAM2_H264_AU_BUFFER_CLASS_COUNT];
+    unsigned int overflowCount[ARSTREAM2_H264_AU_BUFFER_CLASS_COUNT];
+    unsigned int exhaustedCount[ARSTREAM2_H264_AU_BUFFER_CLASS_COUNT];
+    unsigned int heapCount;
+
+} ARSTREAM2_H264_AuBufferStats_t;
+
+
 /**
  * @brief Access unit FIFO queue
  */
 typedef struct ARSTREAM2_H264_AuFifoQueue_s
 {
-    int count;
-    ARSTREAM2_H264_AuFifoItem_t *head;
-    ARSTREAM2_H264_AuFifoItem_t *tail;
-    ARSAL_Mutex_t mutex;
+    ARSTREAM2_H264_AuRing_t ring;
 
     struct ARSTREAM2_H264_AuFifoQueue_s* prev;
     struct ARSTREAM2_H264_AuFifoQueue_s* next;
@@ -309,11 +411,12 @@ typedef struct ARSTREAM2_H264_AuFifo_s
     ARSTREAM2_H264_AuFifoQueue_t *queue;
     int itemPoolSize;
     ARSTREAM2_H264_AuFifoItem_t *itemPool;
-    ARSTREAM2_H264_AuFifoItem_t *itemFree;
+    ARSTREAM2_H264_AuRing_t itemFree;
     int bufferPoolSize;
     ARSTREAM2_H264_AuFifoBuffer_t *bufferPool;
-    ARSTREAM2_H264_AuFifoBuffer_t *bufferFree;
-    ARSAL_Mutex_t mutex;
+    ARSTREAM2_H264_AuRing_t bufferFree;
+    ARSTREAM2_H264_AuBufferSlab_t slab;
+    ARSAL_Mutex_t mutex;    /* protects the queue list only */
 
 } ARSTREAM2_H264_AuFifo_t;
 
@@ -365,7 +468,11 @@ void ARSTREAM2_H264_AuReset(ARSTREAM2_H264_AccessUnit_t *au);
 
 void ARSTREAM2_H264_AuCopy(ARSTREAM2_H264_AccessUnit_t *dst, const ARSTREAM2_H264_AccessUnit_t *src);
 
-int ARSTREAM2_H264_NaluFifoInit(ARSTREAM2_H264_NaluFifo_t *fifo, int maxCount);
+/* WARNING: in lock-free mode, ARSTREAM2_H264_NaluFifoPopFreeItem and ARSTREAM2_H264_NaluFifoEnqueueItem
+   (and ARSTREAM2_H264_NaluFifoUnpopFreeItem) must be called from a single producer thread and
+   ARSTREAM2_H264_NaluFifoDequeueItem, ARSTREAM2_H264_NaluFifoPushFreeItem and ARSTREAM2_H264_NaluFifoFlush
+   from a single consumer thread */
+int ARSTREAM2_H264_NaluFifoInit(ARSTREAM2_H264_NaluFifo_t *fifo, int maxCount, int lockFree);
 
 int ARSTREAM2_H264_NaluFifoFree(ARSTREAM2_H264_NaluFifo_t *fifo);
 
@@ -373,6 +480,9 @@ ARSTREAM2_H264_NaluFifoItem_t* ARSTREAM2_H264_NaluFifoPopFreeItem(ARSTREAM2_H264
 
 int ARSTREAM2_H264_NaluFifoPushFreeItem(ARSTREAM2_H264_NaluFifo_t *fifo, ARSTREAM2_H264_NaluFifoItem_t *item);
 
+/* Give back an item obtained with ARSTREAM2_H264_NaluFifoPopFreeItem that could not be enqueued (producer side) */
+int ARSTREAM2_H264_NaluFifoUnpopFreeItem(ARSTREAM2_H264_NaluFifo_t *fifo, ARSTREAM2_H264_NaluFifoItem_t *item);
+
 int ARSTREAM2_H264_NaluFifoEnqueueItem(ARSTREAM2_H264_NaluFifo_t *fifo, ARSTREAM2_H264_NaluFifoItem_t *item);
 
 ARSTREAM2_H264_NaluFifoItem_t* ARSTREAM2_H264_NaluFifoDequeueItem(ARSTREAM2_H264_NaluFifo_t *fifo);
@@ -406,6 +516,8 @@ int ARSTREAM2_H264_AuFifoFlushQueue(ARSTREAM2_H264_AuFifo_t *fifo, ARSTREAM2_H26
 
 int ARSTREAM2_H264_AuFifoFlush(ARSTREAM2_H264_AuFifo_t *fifo);
 
+int ARSTREAM2_H264_AuFifoGetBufferStats(ARSTREAM2_H264_AuFifo_t *fifo, ARSTREAM2_H264_AuBufferStats_t *stats);
+
 int ARSTREAM2_H264_AuNaluFifoInit(ARSTREAM2_H264_AccessUnit_t *au, int naluItemMaxCount);
 
 int ARSTREAM2_H264_AuNaluFifoFree(ARSTREAM2_H264_AccessUnit_t *au);
@@ -426,6 +538,7 @@ int ARSTREAM2_H264_AuNaluFifoFlush(ARSTREAM2_H264_AccessUnit_t *au);
 ARSTREAM2_H264_AuFifoItem_t* ARSTREAM2_H264_AuFifoDuplicateItem(ARSTREAM2_H264_AuFifo_t *auFifo,
                                                                 ARSTREAM2_H264_AuFifoItem_t *auItem);
 
+/* WARNING: ARSTREAM2_H264_AuCheckSizeRealloc must only be called by the access unit producer thread */
 int ARSTREAM2_H264_AuCheckSizeRealloc(ARSTREAM2_H264_AccessUnit_t *au, unsigned int size);
 
 int ARSTREAM2_H264_AuMbStatusCheckSizeRealloc(ARSTREAM2_H264_AccessUnit_t *au, unsigned int mbCount);
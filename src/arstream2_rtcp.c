@@ -8,6 +8,7 @@
 #include "arstream2_rtcp.h"
 
 #include <stdlib.h>
+#include <string.h>
 #include <netinet/in.h>
 #include <libARSAL/ARSAL_Print.h>
 
@@ -1272,6 +1273,317 @@ int ARSTREAM2_RTCP_ProcessExtendedReport(const uint8_t *buffer, unsigned int buf
 }
 
 
+int ARSTREAM2_RTCP_NackAddMissing(ARSTREAM2_RTCP_NackContext_t *context, uint32_t firstExtSeqNum, uint32_t lastExtSeqNum, uint64_t lossTimestamp)
+{
+    uint32_t extSeqNum;
+    int missingCount, dropCount;
+
+    if (!context)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTCP_TAG, "Invalid pointer");
+        return -1;
+    }
+
+    /* missing packets are detected in increasing order, never add a sequence number twice */
+    if ((context->count > 0) && (firstExtSeqNum <= context->item[context->count - 1].extSeqNum))
+    {
+        firstExtSeqNum = context->item[context->count - 1].extSeqNum + 1;
+    }
+    if (lastExtSeqNum < firstExtSeqNum)
+    {
+        return 0;
+    }
+
+    if (lastExtSeqNum - firstExtSeqNum + 1 > ARSTREAM2_RTCP_NACK_MAX_MISSING_COUNT)
+    {
+        /* only keep the most recent losses */
+        context->abandonedCount += lastExtSeqNum - firstExtSeqNum + 1 - ARSTREAM2_RTCP_NACK_MAX_MISSING_COUNT;
+        firstExtSeqNum = lastExtSeqNum - ARSTREAM2_RTCP_NACK_MAX_MISSING_COUNT + 1;
+    }
+    missingCount = (int)(lastExtSeqNum - firstExtSeqNum + 1);
+
+    if (context->count + missingCount > ARSTREAM2_RTCP_NACK_MAX_MISSING_COUNT)
+    {
+        /* drop the oldest items */
+        dropCount = context->count + missingCount - ARSTREAM2_RTCP_NACK_MAX_MISSING_COUNT;
+        memmove(&context->item[0], &context->item[dropCount], (context->count - dropCount) * sizeof(ARSTREAM2_RTCP_NackItem_t));
+        context->count -= dropCount;
+        context->abandonedCount += dropCount;
+    }
+
+    for (extSeqNum = firstExtSeqNum; extSeqNum <= lastExtSeqNum; extSeqNum++)
+    {
+        ARSTREAM2_RTCP_NackItem_t *item = &context->item[context->count];
+        item->extSeqNum = extSeqNum;
+        item->lossTimestamp = lossTimestamp;
+        item->lastSendTime = 0;
+        item->sendCount = 0;
+        context->count++;
+    }
+
+    return 0;
+}
+
+
+int ARSTREAM2_RTCP_NackSetReceived(ARSTREAM2_RTCP_NackContext_t *context, uint32_t extSeqNum)
+{
+    int lo, hi, mid;
+
+    if (!context)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTCP_TAG, "Invalid pointer");
+        return -1;
+    }
+
+    if ((context->count == 0) || (extSeqNum < context->item[0].extSeqNum) || (extSeqNum > context->item[context->count - 1].extSeqNum))
+    {
+        return 0;
+    }
+
+    lo = 0;
+    hi = context->count - 1;
+    while (lo <= hi)
+    {
+        mid = (lo + hi) / 2;
+        if (context->item[mid].extSeqNum == extSeqNum)
+        {
+            if (context->item[mid].sendCount > 0)
+            {
+                context->recoveredCount++;
+            }
+            memmove(&context->item[mid], &context->item[mid + 1], (context->count - mid - 1) * sizeof(ARSTREAM2_RTCP_NackItem_t));
+            context->count--;
+            return 1;
+        }
+        else if (context->item[mid].extSeqNum < extSeqNum)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid - 1;
+        }
+    }
+
+    return 0;
+}
+
+
+static void ARSTREAM2_RTCP_NackPurge(ARSTREAM2_RTCP_NackContext_t *context, uint64_t curTime)
+{
+    int i, j;
+
+    /* give up on packets that are too old or have exhausted their retries */
+    for (i = 0, j = 0; i < context->count; i++)
+    {
+        ARSTREAM2_RTCP_NackItem_t *item = &context->item[i];
+        if ((curTime >= item->lossTimestamp + ARSTREAM2_RTCP_NACK_MAX_AGE)
+                || ((item->sendCount >= ARSTREAM2_RTCP_NACK_MAX_RETRY_COUNT) && (curTime >= item->lastSendTime + context->retryInterval)))
+        {
+            context->abandonedCount++;
+            continue;
+        }
+        if (i != j)
+        {
+            context->item[j] = *item;
+        }
+        j++;
+    }
+    context->count = j;
+}
+
+
+int ARSTREAM2_RTCP_NackIsPending(ARSTREAM2_RTCP_NackContext_t *context, uint64_t curTime)
+{
+    int i;
+
+    if (!context)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTCP_TAG, "Invalid pointer");
+        return -1;
+    }
+
+    if (context->count == 0)
+    {
+        return 0;
+    }
+
+    ARSTREAM2_RTCP_NackPurge(context, curTime);
+
+    for (i = 0; i < context->count; i++)
+    {
+        if ((context->item[i].sendCount == 0) || (curTime >= context->item[i].lastSendTime + context->retryInterval))
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+
+int ARSTREAM2_RTCP_GenerateGenericNack(ARSTREAM2_RTCP_TransportFeedback_t *fb,
+                                       unsigned int maxSize, uint64_t sendTimestamp, uint32_t receiverSsrc, uint32_t senderSsrc,
+                                       ARSTREAM2_RTCP_NackContext_t *context, unsigned int *size)
+{
+    ARSTREAM2_RTCP_GenericNackFci_t *fci = (ARSTREAM2_RTCP_GenericNackFci_t*)((uint8_t*)fb + sizeof(ARSTREAM2_RTCP_TransportFeedback_t));
+    unsigned int fciCount = 0, maxFciCount;
+    uint32_t pid = 0;
+    uint16_t blp = 0;
+    int i;
+
+    if ((!fb) || (!context))
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTCP_TAG, "Invalid pointer");
+        return -1;
+    }
+
+    if (size) *size = 0;
+
+    if (maxSize < sizeof(ARSTREAM2_RTCP_TransportFeedback_t) + sizeof(ARSTREAM2_RTCP_GenericNackFci_t))
+    {
+        /* Not enough space left */
+        return 0;
+    }
+    maxFciCount = (maxSize - sizeof(ARSTREAM2_RTCP_TransportFeedback_t)) / sizeof(ARSTREAM2_RTCP_GenericNackFci_t);
+    if (maxFciCount > ARSTREAM2_RTCP_NACK_MAX_FCI_COUNT) maxFciCount = ARSTREAM2_RTCP_NACK_MAX_FCI_COUNT;
+
+    ARSTREAM2_RTCP_NackPurge(context, sendTimestamp);
+
+    for (i = 0; i < context->count; i++)
+    {
+        ARSTREAM2_RTCP_NackItem_t *item = &context->item[i];
+        if ((item->sendCount > 0) && (sendTimestamp < item->lastSendTime + context->retryInterval))
+        {
+            /* wait for the retransmission */
+            continue;
+        }
+
+        if ((fciCount > 0) && (item->extSeqNum - pid <= 16))
+        {
+            /* items are sorted so extSeqNum > pid */
+            blp |= (1 << (item->extSeqNum - pid - 1));
+        }
+        else
+        {
+            if (fciCount > 0)
+            {
+                fci[fciCount - 1].blp = htons(blp);
+            }
+            if (fciCount >= maxFciCount)
+            {
+                break;
+            }
+            pid = item->extSeqNum;
+            blp = 0;
+            fci[fciCount].pid = htons((uint16_t)(pid & 0xFFFF));
+            fciCount++;
+        }
+        item->lastSendTime = sendTimestamp;
+        item->sendCount++;
+        context->requestedCount++;
+    }
+
+    if (fciCount == 0)
+    {
+        /* Nothing to request */
+        return 0;
+    }
+    fci[fciCount - 1].blp = htons(blp);
+
+    fb->flags = (2 << 6) | ARSTREAM2_RTCP_RTPFB_GENERIC_NACK_FMT;
+    fb->packetType = ARSTREAM2_RTCP_RTPFB_PACKET_TYPE;
+    fb->length = htons((uint16_t)(fciCount + 2));
+    fb->senderSsrc = htonl(receiverSsrc);
+    fb->mediaSsrc = htonl(senderSsrc);
+    context->lastSendTime = sendTimestamp;
+
+    if (size) *size = sizeof(ARSTREAM2_RTCP_TransportFeedback_t) + fciCount * sizeof(ARSTREAM2_RTCP_GenericNackFci_t);
+
+    return 0;
+}
+
+
+int ARSTREAM2_RTCP_ProcessGenericNack(const uint8_t *buffer, unsigned int bufferSize,
+                                      uint64_t receptionTimestamp, uint32_t receiverSsrc, uint32_t senderSsrc,
+                                      ARSTREAM2_RTCP_NackRequestContext_t *context, int *gotNack)
+{
+    const ARSTREAM2_RTCP_TransportFeedback_t *fb = (const ARSTREAM2_RTCP_TransportFeedback_t*)buffer;
+    const ARSTREAM2_RTCP_GenericNackFci_t *fci = (const ARSTREAM2_RTCP_GenericNackFci_t*)(buffer + sizeof(ARSTREAM2_RTCP_TransportFeedback_t));
+    unsigned int fciCount, i, j;
+
+    if ((!buffer) || (!context))
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTCP_TAG, "Invalid pointer");
+        return -1;
+    }
+    if (bufferSize < sizeof(ARSTREAM2_RTCP_TransportFeedback_t))
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTCP_TAG, "Invalid buffer size");
+        return -1;
+    }
+
+    uint8_t version = (fb->flags >> 6) & 0x3;
+    if (version != 2)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTCP_TAG, "Invalid transport feedback protocol version (%d)", version);
+        return -1;
+    }
+
+    if (fb->packetType != ARSTREAM2_RTCP_RTPFB_PACKET_TYPE)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTCP_TAG, "Invalid transport feedback packet type (%d)", fb->packetType);
+        return -1;
+    }
+
+    if ((fb->flags & 0x1F) != ARSTREAM2_RTCP_RTPFB_GENERIC_NACK_FMT)
+    {
+        /* Unsupported feedback message type */
+        return 0;
+    }
+
+    uint16_t length = ntohs(fb->length);
+    if (((unsigned int)length * 4 + 4 > bufferSize) || (length < 2))
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTCP_TAG, "Invalid transport feedback length");
+        return -1;
+    }
+
+    if ((ntohl(fb->senderSsrc) != receiverSsrc) || (ntohl(fb->mediaSsrc) != senderSsrc))
+    {
+        /* Not for this stream */
+        return 0;
+    }
+
+    fciCount = (unsigned int)length - 2;
+    for (i = 0; i < fciCount; i++)
+    {
+        uint16_t pid = ntohs(fci[i].pid);
+        uint16_t blp = ntohs(fci[i].blp);
+        if (context->count < ARSTREAM2_RTCP_NACK_MAX_REQUEST_COUNT)
+        {
+            context->seqNum[context->count++] = pid;
+        }
+        for (j = 0; j < 16; j++)
+        {
+            if ((blp & (1 << j)) && (context->count < ARSTREAM2_RTCP_NACK_MAX_REQUEST_COUNT))
+            {
+                context->seqNum[context->count++] = (uint16_t)(pid + j + 1);
+            }
+        }
+    }
+
+    context->lastReceptionTimestamp = receptionTimestamp;
+    context->receivedCount++;
+    if ((gotNack) && (context->count > 0))
+    {
+        *gotNack = 1;
+    }
+
+    return 0;
+}
+
+
 int ARSTREAM2_RTCP_GetApplicationPacketSubtype(const uint8_t *buffer, unsigned int bufferSize)
 {
     const ARSTREAM2_RTCP_Application_t *app = (const ARSTREAM2_RTCP_Application_t*)buffer;
@@ -1853,7 +2165,7 @@ int ARSTREAM2_RTCP_Receiver_GenerateCompoundPacket(uint8_t *packet, unsigned int
                                                    uint64_t sendTimestamp, int generateReceiverReport,
                                                    int generateSourceDescription, int generateApplicationClockDelta,
                                                    int generateApplicationVideoStats, int generateLossReport, int generateDjbReport,
-                                                   ARSTREAM2_RTCP_ReceiverContext_t *context, unsigned int *size)
+                                                   int generateNack, ARSTREAM2_RTCP_ReceiverContext_t *context, unsigned int *size)
 {
     int ret = 0;
     unsigned int totalSize = 0;
@@ -1919,6 +2231,23 @@ int ARSTREAM2_RTCP_Receiver_GenerateCompoundPacket(uint8_t *packet, unsigned int
         }
     }
 
+    /* feedback messages must follow the RR and SDES packets (RFC 4585 section 3.1) */
+    if ((ret == 0) && (generateNack))
+    {
+        unsigned int nackSize = 0;
+        ret = ARSTREAM2_RTCP_GenerateGenericNack((ARSTREAM2_RTCP_TransportFeedback_t*)(packet + totalSize),
+                                                 maxPacketSize - totalSize, sendTimestamp, context->receiverSsrc, context->senderSsrc,
+                                                 &context->nackCtx, &nackSize);
+        if (ret != 0)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTCP_TAG, "Failed to generate generic NACK (%d)", ret);
+        }
+        else
+        {
+            totalSize += nackSize;
+        }
+    }
+
     if ((ret == 0) && (generateApplicationClockDelta) && (totalSize + sizeof(ARSTREAM2_RTCP_Application_t) + sizeof(ARSTREAM2_RTCP_ClockDelta_t) <= maxPacketSize))
     {
         if ((context->clockDeltaCtx.expectedOriginateTimestamp == 0) || (sendTimestamp >= context->clockDeltaCtx.expectedOriginateTimestamp + ARSTREAM2_RTCP_CLOCKDELTA_TIMEOUT))
@@ -1964,7 +2293,7 @@ int ARSTREAM2_RTCP_Sender_ProcessCompoundPacket(const uint8_t *buffer, unsigned
                                                 uint64_t receptionTimestamp,
                                                 ARSTREAM2_RTCP_SenderContext_t *context,
                                                 int *gotReceptionReport, int *gotVideoStats,
-                                                int *gotLossReport, int *gotDjbReport)
+                                                int *gotLossReport, int *gotDjbReport, int *gotNack)
 {
     unsigned int readSize = 0, size = 0;
     int receptionReportCount = 0, type, subType, ret, _ret = 0;
@@ -2014,6 +2343,15 @@ int ARSTREAM2_RTCP_Sender_ProcessCompoundPacket(const uint8_t *buffer, unsigned
                     ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTCP_TAG, "Failed to process extended report (%d)", ret);
                 }
                 break;
+            case ARSTREAM2_RTCP_RTPFB_PACKET_TYPE:
+                ret = ARSTREAM2_RTCP_ProcessGenericNack(buffer, bufferSize - readSize, receptionTimestamp,
+                                                        context->receiverSsrc, context->senderSsrc,
+                                                        &context->nackRequestCtx, gotNack);
+                if (ret != 0)
+                {
+                    ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTCP_TAG, "Failed to process generic NACK (%d)", ret);
+                }
+                break;
             case ARSTREAM2_RTCP_SDES_PACKET_TYPE:
                 ret = ARSTREAM2_RTCP_ProcessSourceDescription(buffer, bufferSize - readSize, context->peerSdesItem,
                                                               ARSTREAM2_RTCP_SDES_ITEM_MAX_COUNT, &context->peerSdesItemCount);
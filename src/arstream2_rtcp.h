@@ -21,6 +21,7 @@
 #define ARSTREAM2_RTCP_SDES_PACKET_TYPE 202
 #define ARSTREAM2_RTCP_BYE_PACKET_TYPE 203
 #define ARSTREAM2_RTCP_APP_PACKET_TYPE 204
+#define ARSTREAM2_RTCP_RTPFB_PACKET_TYPE 205
 #define ARSTREAM2_RTCP_EXTENDED_REPORT_PACKET_TYPE 207
 
 #define ARSTREAM2_RTCP_SDES_CNAME_ITEM 1
@@ -45,6 +46,18 @@
 
 #define ARSTREAM2_RTCP_LOSS_REPORT_INITIAL_WORD_COUNT 32
 
+#define ARSTREAM2_RTCP_RTPFB_GENERIC_NACK_FMT 1
+
+#define ARSTREAM2_RTCP_NACK_MAX_MISSING_COUNT 256
+#define ARSTREAM2_RTCP_NACK_MAX_FCI_COUNT 64
+#define ARSTREAM2_RTCP_NACK_MAX_RETRY_COUNT 3
+#define ARSTREAM2_RTCP_NACK_MAX_AGE 300000
+#define ARSTREAM2_RTCP_NACK_MIN_RETRY_INTERVAL 10000
+#define ARSTREAM2_RTCP_NACK_MAX_RETRY_INTERVAL 100000
+#define ARSTREAM2_RTCP_NACK_DEFAULT_RETRY_INTERVAL 50000
+#define ARSTREAM2_RTCP_NACK_MIN_PACKET_TIME_INTERVAL 5000
+#define ARSTREAM2_RTCP_NACK_MAX_REQUEST_COUNT (ARSTREAM2_RTCP_NACK_MAX_FCI_COUNT * 17)
+
 #define ARSTREAM2_RTCP_LOSS_RLE_REPORT_BLOCK_TYPE 1
 #define ARSTREAM2_RTCP_DJB_METRICS_REPORT_BLOCK_TYPE 23
 
@@ -158,6 +171,25 @@ typedef struct {
     uint16_t djbLowWatermark;
 } __attribute__ ((packed)) ARSTREAM2_RTCP_DjbMetricsReportBlock_t;
 
+/**
+ * @brief RTCP Transport Layer Feedback (RTPFB) Packet (see RFC4585)
+ */
+typedef struct {
+    uint8_t flags;
+    uint8_t packetType;
+    uint16_t length;
+    uint32_t senderSsrc;
+    uint32_t mediaSsrc;
+} __attribute__ ((packed)) ARSTREAM2_RTCP_TransportFeedback_t;
+
+/**
+ * @brief RTCP Generic NACK Feedback Control Information (see RFC4585)
+ */
+typedef struct {
+    uint16_t pid;
+    uint16_t blp;
+} __attribute__ ((packed)) ARSTREAM2_RTCP_GenericNackFci_t;
+
 /**
  * @brief RTCP Application-Defined (APP) Packet (see RFC3550)
  */
@@ -258,6 +290,46 @@ typedef struct ARSTREAM2_RTCP_DjbReportContext_s
 
 } ARSTREAM2_RTCP_DjbReportContext_t;
 
+/**
+ * @brief Generic NACK missing packet
+ */
+typedef struct ARSTREAM2_RTCP_NackItem_s
+{
+    uint32_t extSeqNum;
+    uint64_t lossTimestamp;
+    uint64_t lastSendTime;
+    int sendCount;
+
+} ARSTREAM2_RTCP_NackItem_t;
+
+/**
+ * @brief Generic NACK context (receiver side)
+ */
+typedef struct ARSTREAM2_RTCP_NackContext_s
+{
+    int enabled;
+    ARSTREAM2_RTCP_NackItem_t item[ARSTREAM2_RTCP_NACK_MAX_MISSING_COUNT];
+    int count; /* items are sorted by increasing extSeqNum */
+    uint32_t retryInterval;
+    uint64_t lastSendTime;
+    uint32_t requestedCount;
+    uint32_t recoveredCount;
+    uint32_t abandonedCount;
+
+} ARSTREAM2_RTCP_NackContext_t;
+
+/**
+ * @brief Generic NACK request context (sender side)
+ */
+typedef struct ARSTREAM2_RTCP_NackRequestContext_s
+{
+    uint16_t seqNum[ARSTREAM2_RTCP_NACK_MAX_REQUEST_COUNT];
+    int count;
+    uint64_t lastReceptionTimestamp;
+    uint32_t receivedCount;
+
+} ARSTREAM2_RTCP_NackRequestContext_t;
+
 /**
  * @brief Application clock delta context
  */
@@ -321,6 +393,7 @@ typedef struct ARSTREAM2_RTCP_SenderContext_s {
     ARSTREAM2_RTCP_VideoStatsContext_t videoStatsCtx;
     ARSTREAM2_RTCP_LossReportContext_t lossReportCtx;
     ARSTREAM2_RTCP_DjbReportContext_t djbReportCtx;
+    ARSTREAM2_RTCP_NackRequestContext_t nackRequestCtx;
 } ARSTREAM2_RTCP_SenderContext_t;
 
 /**
@@ -365,6 +438,7 @@ typedef struct ARSTREAM2_RTCP_ReceiverContext_s {
     ARSTREAM2_RTCP_VideoStatsContext_t videoStatsCtx;
     ARSTREAM2_RTCP_LossReportContext_t lossReportCtx;
     ARSTREAM2_RTCP_DjbReportContext_t djbReportCtx;
+    ARSTREAM2_RTCP_NackContext_t nackCtx;
 } ARSTREAM2_RTCP_ReceiverContext_t;
 
 
@@ -417,6 +491,20 @@ int ARSTREAM2_RTCP_ProcessExtendedReport(const uint8_t *buffer, unsigned int buf
                                          ARSTREAM2_RTCP_DjbReportContext_t *djbReportCtx,
                                          int *gotLossReport, int *gotDjbReport);
 
+int ARSTREAM2_RTCP_NackAddMissing(ARSTREAM2_RTCP_NackContext_t *context, uint32_t firstExtSeqNum, uint32_t lastExtSeqNum, uint64_t lossTimestamp);
+
+int ARSTREAM2_RTCP_NackSetReceived(ARSTREAM2_RTCP_NackContext_t *context, uint32_t extSeqNum);
+
+int ARSTREAM2_RTCP_NackIsPending(ARSTREAM2_RTCP_NackContext_t *context, uint64_t curTime);
+
+int ARSTREAM2_RTCP_GenerateGenericNack(ARSTREAM2_RTCP_TransportFeedback_t *fb,
+                                       unsigned int maxSize, uint64_t sendTimestamp, uint32_t receiverSsrc, uint32_t senderSsrc,
+                                       ARSTREAM2_RTCP_NackContext_t *context, unsigned int *size);
+
+int ARSTREAM2_RTCP_ProcessGenericNack(const uint8_t *buffer, unsigned int bufferSize,
+                                      uint64_t receptionTimestamp, uint32_t receiverSsrc, uint32_t senderSsrc,
+                                      ARSTREAM2_RTCP_NackRequestContext_t *context, int *gotNack);
+
 int ARSTREAM2_RTCP_GenerateApplicationClockDelta(ARSTREAM2_RTCP_Application_t *app, ARSTREAM2_RTCP_ClockDelta_t *clockDelta,
                                                  uint64_t sendTimestamp, uint32_t ssrc,
                                                  ARSTREAM2_RTCP_ClockDeltaContext_t *context);
@@ -444,13 +532,13 @@ int ARSTREAM2_RTCP_Receiver_GenerateCompoundPacket(uint8_t *packet, unsigned int
                                                    uint64_t sendTimestamp, int generateReceiverReport,
                                                    int generateSourceDescription, int generateApplicationClockDelta,
                                                    int generateApplicationVideoStats, int generateLossReport, int generateDjbReport,
-                                                   ARSTREAM2_RTCP_ReceiverContext_t *context, unsigned int *size);
+                                                   int generateNack, ARSTREAM2_RTCP_ReceiverContext_t *context, unsigned int *size);
 
 int ARSTREAM2_RTCP_Sender_ProcessCompoundPacket(const uint8_t *packet, unsigned int packetSize,
                                                 uint64_t receptionTimestamp,
                                                 ARSTREAM2_RTCP_SenderContext_t *context,
                                                 int *gotReceptionReport, int *gotVideoStats,
-                                                int *gotLossReport, int *gotDjbReport);
+                                                int *gotLossReport, int *gotDjbReport, int *gotNack);
 
 int ARSTREAM2_RTCP_Receiver_ProcessCompoundPacket(const uint8_t *packet, unsigned int packetSize,
                                                   uint64_t receptionTimestamp,
@@ -7,9 +7,13 @@
 
 #include "arstream2_rtp.h"
 #include "arstream2_rtcp.h"
+#include "arstream2_rtp_fec.h"
 
 #include <stdlib.h>
 #include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
 #include <netinet/in.h>
 #include <libARSAL/ARSAL_Print.h>
 
@@ -45,6 +49,7 @@ void ARSTREAM2_RTP_PacketReset(ARSTREAM2_RTP_Packet_t *packet)
     packet->importance = 0;
     packet->priority = 0;
     packet->msgIovLength = 0;
+    packet->retransmitted = 0;
 }
 
 
@@ -74,39 +79,120 @@ void ARSTREAM2_RTP_PacketCopy(ARSTREAM2_RTP_Packet_t *dst, const ARSTREAM2_RTP_P
     dst->importance = src->importance;
     dst->priority = src->priority;
     dst->msgIovLength = src->msgIovLength;
+    dst->retransmitted = src->retransmitted;
 }
 
 
-int ARSTREAM2_RTP_PacketFifoInit(ARSTREAM2_RTP_PacketFifo_t *fifo, int itemMaxCount, int bufferMaxCount, int packetBufferSize)
+/* Allocate a block for the FIFO pools: carved out of the arena (already zeroed) if there is one,
+ * otherwise allocated on the heap; the arena layout must match ARSTREAM2_RTP_PacketFifoArenaSize() */
+static void* ARSTREAM2_RTP_PacketFifoAlloc(ARSTREAM2_RTP_PacketFifo_t *fifo, size_t size)
 {
-    int i;
-    ARSTREAM2_RTP_PacketFifoItem_t* curItem = NULL;
-    ARSTREAM2_RTP_PacketFifoBuffer_t* curBuffer = NULL;
+    void *ptr;
 
-    if (!fifo)
+    if (fifo->arena)
     {
-        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "Invalid pointer");
-        return -1;
+        size = (size + ARSTREAM2_RTP_PACKET_FIFO_ARENA_ALIGN - 1) & ~((size_t)ARSTREAM2_RTP_PACKET_FIFO_ARENA_ALIGN - 1);
+        if (fifo->arenaUsed + size > fifo->arenaSize)
+        {
+            return NULL;
+        }
+        ptr = fifo->arena + fifo->arenaUsed;
+        fifo->arenaUsed += size;
+        return ptr;
     }
-    if (itemMaxCount <= 0)
+
+    ptr = malloc(size);
+    if (ptr)
     {
-        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "Invalid item max count (%d)", itemMaxCount);
-        return -1;
+        fifo->footprint += size;
     }
-    if (bufferMaxCount <= 0)
+    return ptr;
+}
+
+
+static size_t ARSTREAM2_RTP_PacketFifoArenaSize(int itemMaxCount, int bufferMaxCount, int packetBufferSize)
+{
+    size_t align = ARSTREAM2_RTP_PACKET_FIFO_ARENA_ALIGN;
+    size_t size;
+
+    size = (itemMaxCount * sizeof(ARSTREAM2_RTP_PacketFifoItem_t) + align - 1) & ~(align - 1);
+    if (bufferMaxCount > 0)
     {
-        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "Invalid buffer max count (%d)", bufferMaxCount);
-        return -1;
+        size += (bufferMaxCount * sizeof(ARSTREAM2_RTP_PacketFifoBuffer_t) + align - 1) & ~(align - 1);
+        if (packetBufferSize > 0)
+        {
+            size += bufferMaxCount * (((size_t)packetBufferSize + align - 1) & ~(align - 1));
+        }
+        size += bufferMaxCount * ((sizeof(ARSTREAM2_RTP_Header_t) + align - 1) & ~(align - 1));
     }
 
-    memset(fifo, 0, sizeof(ARSTREAM2_RTP_PacketFifo_t));
+    return size;
+}
+
+
+static int ARSTREAM2_RTP_PacketFifoArenaMap(ARSTREAM2_RTP_PacketFifo_t *fifo, size_t size, int arenaFlags)
+{
+    size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+    void *arena = MAP_FAILED;
+
+#ifdef MAP_HUGETLB
+    if (arenaFlags & ARSTREAM2_RTP_PACKET_FIFO_ARENA_HUGE_PAGES)
+    {
+        size_t hugeSize = (size + ARSTREAM2_RTP_PACKET_FIFO_ARENA_HUGE_PAGE_SIZE - 1) & ~((size_t)ARSTREAM2_RTP_PACKET_FIFO_ARENA_HUGE_PAGE_SIZE - 1);
+        arena = mmap(NULL, hugeSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (arena != MAP_FAILED)
+        {
+            size = hugeSize;
+        }
+        else
+        {
+            ARSAL_PRINT(ARSAL_PRINT_WARNING, ARSTREAM2_RTP_TAG, "Huge pages arena mapping failed (size %zu), using regular pages: error=%d (%s)", hugeSize, errno, strerror(errno));
+        }
+    }
+#endif
+
+    if (arena == MAP_FAILED)
+    {
+        size = (size + pageSize - 1) & ~(pageSize - 1);
+        arena = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (arena == MAP_FAILED)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "Arena mapping failed (size %zu): error=%d (%s)", size, errno, strerror(errno));
+            return -1;
+        }
+#ifdef MADV_HUGEPAGE
+        if ((arenaFlags & ARSTREAM2_RTP_PACKET_FIFO_ARENA_HUGE_PAGES) && (madvise(arena, size, MADV_HUGEPAGE) != 0))
+        {
+            ARSAL_PRINT(ARSAL_PRINT_WARNING, ARSTREAM2_RTP_TAG, "Transparent huge pages are not available: error=%d (%s)", errno, strerror(errno));
+        }
+#endif
+    }
+
+    if ((arenaFlags & ARSTREAM2_RTP_PACKET_FIFO_ARENA_LOCK) && (mlock(arena, size) != 0))
+    {
+        ARSAL_PRINT(ARSAL_PRINT_WARNING, ARSTREAM2_RTP_TAG, "Failed to lock the arena in memory (size %zu): error=%d (%s)", size, errno, strerror(errno));
+    }
+
+    fifo->arena = arena;
+    fifo->arenaSize = size;
+    fifo->arenaUsed = 0;
+    fifo->footprint = size;
+
+    return 0;
+}
+
+
+static int ARSTREAM2_RTP_PacketFifoSetup(ARSTREAM2_RTP_PacketFifo_t *fifo, int itemMaxCount, int bufferMaxCount, int packetBufferSize)
+{
+    int i;
+    ARSTREAM2_RTP_PacketFifoItem_t* curItem = NULL;
+    ARSTREAM2_RTP_PacketFifoBuffer_t* curBuffer = NULL;
 
     fifo->itemPoolSize = itemMaxCount;
-    fifo->itemPool = malloc(itemMaxCount * sizeof(ARSTREAM2_RTP_PacketFifoItem_t));
+    fifo->itemPool = ARSTREAM2_RTP_PacketFifoAlloc(fifo, itemMaxCount * sizeof(ARSTREAM2_RTP_PacketFifoItem_t));
     if (!fifo->itemPool)
     {
         ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "FIFO allocation failed (size %zu)", itemMaxCount * sizeof(ARSTREAM2_RTP_PacketFifoItem_t));
-        ARSTREAM2_RTP_PacketFifoFree(fifo);
         return -1;
     }
     memset(fifo->itemPool, 0, itemMaxCount * sizeof(ARSTREAM2_RTP_PacketFifoItem_t));
@@ -123,12 +209,17 @@ int ARSTREAM2_RTP_PacketFifoInit(ARSTREAM2_RTP_PacketFifo_t *fifo, int itemMaxCo
         fifo->itemFree = curItem;
     }
 
+    if (bufferMaxCount == 0)
+    {
+        /* item-only FIFO */
+        return 0;
+    }
+
     fifo->bufferPoolSize = bufferMaxCount;
-    fifo->bufferPool = malloc(bufferMaxCount * sizeof(ARSTREAM2_RTP_PacketFifoBuffer_t));
+    fifo->bufferPool = ARSTREAM2_RTP_PacketFifoAlloc(fifo, bufferMaxCount * sizeof(ARSTREAM2_RTP_PacketFifoBuffer_t));
     if (!fifo->bufferPool)
     {
         ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "FIFO allocation failed (size %zu)", bufferMaxCount * sizeof(ARSTREAM2_RTP_PacketFifoBuffer_t));
-        ARSTREAM2_RTP_PacketFifoFree(fifo);
         return -1;
     }
     memset(fifo->bufferPool, 0, bufferMaxCount * sizeof(ARSTREAM2_RTP_PacketFifoBuffer_t));
@@ -142,6 +233,7 @@ int ARSTREAM2_RTP_PacketFifoInit(ARSTREAM2_RTP_PacketFifo_t *fifo, int itemMaxCo
         }
         curBuffer->next = fifo->bufferFree;
         curBuffer->prev = NULL;
+        curBuffer->owner = fifo;
         fifo->bufferFree = curBuffer;
     }
 
@@ -149,11 +241,10 @@ int ARSTREAM2_RTP_PacketFifoInit(ARSTREAM2_RTP_PacketFifo_t *fifo, int itemMaxCo
     {
         for (i = 0; i < bufferMaxCount; i++)
         {
-            fifo->bufferPool[i].buffer = malloc(packetBufferSize);
+            fifo->bufferPool[i].buffer = ARSTREAM2_RTP_PacketFifoAlloc(fifo, packetBufferSize);
             if (!fifo->bufferPool[i].buffer)
             {
                 ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "FIFO packet buffer allocation failed (size %d)", packetBufferSize);
-                ARSTREAM2_RTP_PacketFifoFree(fifo);
                 return -1;
             }
             fifo->bufferPool[i].bufferSize = packetBufferSize;
@@ -162,11 +253,10 @@ int ARSTREAM2_RTP_PacketFifoInit(ARSTREAM2_RTP_PacketFifo_t *fifo, int itemMaxCo
 
     for (i = 0; i < bufferMaxCount; i++)
     {
-        fifo->bufferPool[i].header = malloc(sizeof(ARSTREAM2_RTP_Header_t));
+        fifo->bufferPool[i].header = ARSTREAM2_RTP_PacketFifoAlloc(fifo, sizeof(ARSTREAM2_RTP_Header_t));
         if (!fifo->bufferPool[i].header)
         {
             ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "FIFO packet buffer allocation failed (size %zu)", sizeof(ARSTREAM2_RTP_Header_t));
-            ARSTREAM2_RTP_PacketFifoFree(fifo);
             return -1;
         }
         fifo->bufferPool[i].headerSize = sizeof(ARSTREAM2_RTP_Header_t);
@@ -176,6 +266,131 @@ int ARSTREAM2_RTP_PacketFifoInit(ARSTREAM2_RTP_PacketFifo_t *fifo, int itemMaxCo
 }
 
 
+int ARSTREAM2_RTP_PacketFifoInit(ARSTREAM2_RTP_PacketFifo_t *fifo, int itemMaxCount, int bufferMaxCount, int packetBufferSize)
+{
+    if (!fifo)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "Invalid pointer");
+        return -1;
+    }
+    if (itemMaxCount <= 0)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "Invalid item max count (%d)", itemMaxCount);
+        return -1;
+    }
+    if (bufferMaxCount < 0)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "Invalid buffer max count (%d)", bufferMaxCount);
+        return -1;
+    }
+
+    memset(fifo, 0, sizeof(ARSTREAM2_RTP_PacketFifo_t));
+
+    if (ARSTREAM2_RTP_PacketFifoSetup(fifo, itemMaxCount, bufferMaxCount, packetBufferSize) != 0)
+    {
+        ARSTREAM2_RTP_PacketFifoFree(fifo);
+        return -1;
+    }
+
+    return 0;
+}
+
+
+int ARSTREAM2_RTP_PacketFifoInitArena(ARSTREAM2_RTP_PacketFifo_t *fifo, int itemMaxCount, int bufferMaxCount, int packetBufferSize, int arenaFlags)
+{
+    if (!fifo)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "Invalid pointer");
+        return -1;
+    }
+    if (itemMaxCount <= 0)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "Invalid item max count (%d)", itemMaxCount);
+        return -1;
+    }
+    if (bufferMaxCount < 0)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "Invalid buffer max count (%d)", bufferMaxCount);
+        return -1;
+    }
+
+    memset(fifo, 0, sizeof(ARSTREAM2_RTP_PacketFifo_t));
+
+    if (ARSTREAM2_RTP_PacketFifoArenaMap(fifo, ARSTREAM2_RTP_PacketFifoArenaSize(itemMaxCount, bufferMaxCount, packetBufferSize), arenaFlags) != 0)
+    {
+        return -1;
+    }
+
+    if (ARSTREAM2_RTP_PacketFifoSetup(fifo, itemMaxCount, bufferMaxCount, packetBufferSize) != 0)
+    {
+        ARSTREAM2_RTP_PacketFifoFree(fifo);
+        return -1;
+    }
+
+    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARSTREAM2_RTP_TAG, "Packet FIFO arena: %zu bytes (%d items, %d buffers of %d bytes)",
+                fifo->arenaSize, itemMaxCount, bufferMaxCount, packetBufferSize);
+
+    return 0;
+}
+
+
+int ARSTREAM2_RTP_PacketFifoInitOverflow(ARSTREAM2_RTP_PacketFifo_t *fifo, int bufferMaxCount, int packetBufferSize)
+{
+    ARSTREAM2_RTP_PacketFifoBuffer_t* curBuffer = NULL;
+    int i;
+
+    if (!fifo)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "Invalid pointer");
+        return -1;
+    }
+    if ((bufferMaxCount <= 0) || (fifo->overflowPool))
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "Invalid overflow buffer max count (%d)", bufferMaxCount);
+        return -1;
+    }
+    if ((!fifo->bufferPool) || (packetBufferSize <= (int)fifo->bufferPool[0].bufferSize))
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "Invalid overflow packet buffer size (%d)", packetBufferSize);
+        return -1;
+    }
+
+    /* the overflow class is allocated on the heap, even with an arena */
+    fifo->overflowSpillSize = (unsigned int)packetBufferSize - fifo->bufferPool[0].bufferSize;
+    fifo->overflowSpill = malloc(fifo->overflowSpillSize);
+    fifo->overflowPool = malloc(bufferMaxCount * sizeof(ARSTREAM2_RTP_PacketFifoBuffer_t));
+    if ((!fifo->overflowSpill) || (!fifo->overflowPool))
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "FIFO overflow allocation failed (size %zu)", bufferMaxCount * sizeof(ARSTREAM2_RTP_PacketFifoBuffer_t));
+        return -1;
+    }
+    memset(fifo->overflowPool, 0, bufferMaxCount * sizeof(ARSTREAM2_RTP_PacketFifoBuffer_t));
+    fifo->overflowPoolSize = bufferMaxCount;
+    fifo->footprint += fifo->overflowSpillSize + bufferMaxCount * sizeof(ARSTREAM2_RTP_PacketFifoBuffer_t);
+
+    for (i = 0; i < bufferMaxCount; i++)
+    {
+        curBuffer = &fifo->overflowPool[i];
+        curBuffer->buffer = malloc(packetBufferSize);
+        curBuffer->header = malloc(sizeof(ARSTREAM2_RTP_Header_t));
+        if ((!curBuffer->buffer) || (!curBuffer->header))
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "FIFO overflow packet buffer allocation failed (size %d)", packetBufferSize);
+            return -1;
+        }
+        curBuffer->bufferSize = packetBufferSize;
+        curBuffer->headerSize = sizeof(ARSTREAM2_RTP_Header_t);
+        curBuffer->owner = fifo;
+        curBuffer->overflow = 1;
+        curBuffer->next = fifo->overflowFree;
+        fifo->overflowFree = curBuffer;
+        fifo->footprint += packetBufferSize + sizeof(ARSTREAM2_RTP_Header_t);
+    }
+
+    return 0;
+}
+
+
 int ARSTREAM2_RTP_PacketFifoFree(ARSTREAM2_RTP_PacketFifo_t *fifo)
 {
     int i;
@@ -186,19 +401,55 @@ int ARSTREAM2_RTP_PacketFifoFree(ARSTREAM2_RTP_PacketFifo_t *fifo)
         return -1;
     }
 
-    free(fifo->itemPool);
+    ARSTREAM2_RTP_PacketFifoQueue_t *queue;
+    for (queue = fifo->queue; queue; queue = queue->next)
+    {
+        free(queue->seqNumIndex);
+        queue->seqNumIndex = NULL;
+        queue->seqNumIndexSize = 0;
+        free(queue->timeoutHeap);
+        queue->timeoutHeap = NULL;
+        queue->timeoutHeapSize = 0;
+        queue->timeoutHeapCount = 0;
+    }
+
+    if (fifo->itemPool)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARSTREAM2_RTP_TAG, "Packet FIFO usage: %zu bytes, items high watermark %d/%d, buffers high watermark %d/%d",
+                    fifo->footprint, fifo->itemHighWatermark, fifo->itemPoolSize, fifo->bufferHighWatermark, fifo->bufferPoolSize);
+    }
 
-    if (fifo->bufferPool)
+    if (fifo->overflowPool)
     {
-        for (i = 0; i < fifo->bufferPoolSize; i++)
+        for (i = 0; i < fifo->overflowPoolSize; i++)
         {
-            free(fifo->bufferPool[i].buffer);
-            fifo->bufferPool[i].buffer = NULL;
-            free(fifo->bufferPool[i].header);
-            fifo->bufferPool[i].header = NULL;
+            free(fifo->overflowPool[i].buffer);
+            free(fifo->overflowPool[i].header);
         }
+        free(fifo->overflowPool);
+    }
+    free(fifo->overflowSpill);
+
+    if (fifo->arena)
+    {
+        munmap(fifo->arena, fifo->arenaSize);
+    }
+    else
+    {
+        free(fifo->itemPool);
+
+        if (fifo->bufferPool)
+        {
+            for (i = 0; i < fifo->bufferPoolSize; i++)
+            {
+                free(fifo->bufferPool[i].buffer);
+                fifo->bufferPool[i].buffer = NULL;
+                free(fifo->bufferPool[i].header);
+                fifo->bufferPool[i].header = NULL;
+            }
 
-        free(fifo->bufferPool);
+            free(fifo->bufferPool);
+        }
     }
 
     memset(fifo, 0, sizeof(ARSTREAM2_RTP_PacketFifo_t));
@@ -207,6 +458,49 @@ int ARSTREAM2_RTP_PacketFifoFree(ARSTREAM2_RTP_PacketFifo_t *fifo)
 }
 
 
+int ARSTREAM2_RTP_PacketFifoGetUsage(ARSTREAM2_RTP_PacketFifo_t *fifo, ARSTREAM2_RTP_PacketFifoUsage_t *usage, int reset)
+{
+    if ((!fifo) || (!usage))
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "Invalid pointer");
+        return -1;
+    }
+
+    usage->footprint = fifo->footprint;
+    usage->isArena = (fifo->arena) ? 1 : 0;
+    usage->itemPoolSize = fifo->itemPoolSize;
+    usage->itemUsedCount = __atomic_load_n(&fifo->itemUsedCount, __ATOMIC_RELAXED);
+    usage->itemHighWatermark = __atomic_load_n(&fifo->itemHighWatermark, __ATOMIC_RELAXED);
+    usage->bufferPoolSize = fifo->bufferPoolSize;
+    usage->bufferUsedCount = __atomic_load_n(&fifo->bufferUsedCount, __ATOMIC_RELAXED);
+    usage->bufferHighWatermark = __atomic_load_n(&fifo->bufferHighWatermark, __ATOMIC_RELAXED);
+    usage->overflowPoolSize = fifo->overflowPoolSize;
+    usage->overflowCount = __atomic_load_n(&fifo->overflowCount, __ATOMIC_RELAXED);
+    usage->truncatedCount = __atomic_load_n(&fifo->truncatedCount, __ATOMIC_RELAXED);
+
+    if (reset)
+    {
+        __atomic_store_n(&fifo->itemHighWatermark, usage->itemUsedCount, __ATOMIC_RELAXED);
+        __atomic_store_n(&fifo->bufferHighWatermark, usage->bufferUsedCount, __ATOMIC_RELAXED);
+    }
+
+    return 0;
+}
+
+
+/* Usage count update (owner thread only; the count is read atomically from other threads) */
+static inline void ARSTREAM2_RTP_PacketFifoUsageAdd(int *usedCount, int *highWatermark, int delta)
+{
+    int count = *usedCount + delta;
+
+    __atomic_store_n(usedCount, count, __ATOMIC_RELAXED);
+    if (count > __atomic_load_n(highWatermark, __ATOMIC_RELAXED))
+    {
+        __atomic_store_n(highWatermark, count, __ATOMIC_RELAXED);
+    }
+}
+
+
 int ARSTREAM2_RTP_PacketFifoAddQueue(ARSTREAM2_RTP_PacketFifo_t *fifo, ARSTREAM2_RTP_PacketFifoQueue_t *queue)
 {
     if ((!fifo) || (!queue))
@@ -218,6 +512,18 @@ int ARSTREAM2_RTP_PacketFifoAddQueue(ARSTREAM2_RTP_PacketFifo_t *fifo, ARSTREAM2
     queue->count = 0;
     queue->head = NULL;
     queue->tail = NULL;
+    queue->seqNumIndex = NULL;
+    queue->seqNumIndexSize = 0;
+    queue->seqNumIndexValid = 0;
+    memset(queue->priorityHead, 0, sizeof(queue->priorityHead));
+    memset(queue->priorityTail, 0, sizeof(queue->priorityTail));
+    queue->priorityMask = 0;
+    queue->priorityRtpTimestamp = 0;
+    queue->priorityValid = 0;
+    queue->timeoutHeap = NULL;
+    queue->timeoutHeapSize = 0;
+    queue->timeoutHeapCount = 0;
+    queue->timeoutHeapValid = 0;
 
     queue->prev = NULL;
     queue->next = fifo->queue;
@@ -258,113 +564,426 @@ int ARSTREAM2_RTP_PacketFifoRemoveQueue(ARSTREAM2_RTP_PacketFifo_t *fifo, ARSTRE
     queue->count = 0;
     queue->head = NULL;
     queue->tail = NULL;
+    free(queue->seqNumIndex);
+    queue->seqNumIndex = NULL;
+    queue->seqNumIndexSize = 0;
+    queue->seqNumIndexValid = 0;
+    queue->priorityMask = 0;
+    queue->priorityValid = 0;
+    free(queue->timeoutHeap);
+    queue->timeoutHeap = NULL;
+    queue->timeoutHeapSize = 0;
+    queue->timeoutHeapCount = 0;
+    queue->timeoutHeapValid = 0;
 
     return 0;
 }
 
 
-ARSTREAM2_RTP_PacketFifoBuffer_t* ARSTREAM2_RTP_PacketFifoGetBuffer(ARSTREAM2_RTP_PacketFifo_t *fifo)
+int ARSTREAM2_RTP_PacketFifoQueueEnableSeqNumIndex(ARSTREAM2_RTP_PacketFifoQueue_t *queue, unsigned int windowSize)
 {
-    if (!fifo)
+    unsigned int size;
+
+    if (!queue)
     {
         ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "Invalid pointer");
-        return NULL;
+        return -1;
     }
 
-    if (fifo->bufferFree)
+    if ((windowSize == 0) || (windowSize > 65536))
     {
-        ARSTREAM2_RTP_PacketFifoBuffer_t* cur = fifo->bufferFree;
-        fifo->bufferFree = cur->next;
-        if (cur->next) cur->next->prev = NULL;
-        cur->prev = NULL;
-        cur->next = NULL;
-        cur->refCount = 1;
-        return cur;
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "Invalid window size (%d)", windowSize);
+        return -1;
     }
-    else
+
+    if (queue->count)
     {
-        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "No free buffer in pool");
-        return NULL;
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "Queue is not empty");
+        return -1;
     }
-}
 
+    for (size = 1; size < windowSize; size <<= 1);
 
-int ARSTREAM2_RTP_PacketFifoBufferAddRef(ARSTREAM2_RTP_PacketFifoBuffer_t *buffer)
-{
-    if (!buffer)
+    free(queue->seqNumIndex);
+    queue->seqNumIndex = calloc(size, sizeof(ARSTREAM2_RTP_PacketFifoItem_t*));
+    if (!queue->seqNumIndex)
     {
-        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "Invalid pointer");
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "Index allocation failed (size %zu)", size * sizeof(ARSTREAM2_RTP_PacketFifoItem_t*));
+        queue->seqNumIndexSize = 0;
+        queue->seqNumIndexValid = 0;
         return -1;
     }
-
-    buffer->refCount++;
+    queue->seqNumIndexSize = size;
+    queue->seqNumIndexValid = 1;
 
     return 0;
 }
 
 
-int ARSTREAM2_RTP_PacketFifoUnrefBuffer(ARSTREAM2_RTP_PacketFifo_t *fifo, ARSTREAM2_RTP_PacketFifoBuffer_t *buffer)
+int ARSTREAM2_RTP_PacketFifoQueueEnableTimeoutHeap(ARSTREAM2_RTP_PacketFifoQueue_t *queue, unsigned int maxCount)
 {
-    if ((!fifo) || (!buffer))
+    if (!queue)
     {
         ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "Invalid pointer");
         return -1;
     }
 
-    if (buffer->refCount != 0)
+    if (maxCount == 0)
     {
-        buffer->refCount--;
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "Invalid heap size (%d)", maxCount);
+        return -1;
     }
-    else
+
+    if (queue->count)
     {
-        ARSAL_PRINT(ARSAL_PRINT_WARNING, ARSTREAM2_RTP_TAG, "FIXME! Ref count is already null, this should not happen!");
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "Queue is not empty");
+        return -1;
     }
 
-    if (buffer->refCount == 0)
+    free(queue->timeoutHeap);
+    queue->timeoutHeapCount = 0;
+    queue->timeoutHeap = malloc(maxCount * sizeof(ARSTREAM2_RTP_PacketFifoItem_t*));
+    if (!queue->timeoutHeap)
     {
-        if (fifo->bufferFree)
-        {
-            fifo->bufferFree->prev = buffer;
-            buffer->next = fifo->bufferFree;
-        }
-        else
-        {
-            buffer->next = NULL;
-        }
-        fifo->bufferFree = buffer;
-        buffer->prev = NULL;
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "Heap allocation failed (size %zu)", maxCount * sizeof(ARSTREAM2_RTP_PacketFifoItem_t*));
+        queue->timeoutHeapSize = 0;
+        queue->timeoutHeapValid = 0;
+        return -1;
     }
+    queue->timeoutHeapSize = maxCount;
+    queue->timeoutHeapValid = 1;
 
     return 0;
 }
 
 
-ARSTREAM2_RTP_PacketFifoItem_t* ARSTREAM2_RTP_PacketFifoPopFreeItem(ARSTREAM2_RTP_PacketFifo_t *fifo)
+uint64_t ARSTREAM2_RTP_PacketFifoQueueGetNextTimeout(ARSTREAM2_RTP_PacketFifoQueue_t *queue)
 {
-    if (!fifo)
+    if ((!queue) || (!queue->timeoutHeapValid) || (!queue->timeoutHeapCount))
     {
-        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "Invalid pointer");
-        return NULL;
+        return 0;
     }
 
-    if (fifo->itemFree)
-    {
-        ARSTREAM2_RTP_PacketFifoItem_t* cur = fifo->itemFree;
-        fifo->itemFree = cur->next;
-        if (cur->next) cur->next->prev = NULL;
-        cur->prev = NULL;
-        cur->next = NULL;
-        return cur;
-    }
-    else
-    {
-        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "Packet FIFO is full");
-        return NULL;
-    }
+    return queue->timeoutHeap[0]->packet.timeoutTimestamp;
 }
 
 
-int ARSTREAM2_RTP_PacketFifoPushFreeItem(ARSTREAM2_RTP_PacketFifo_t *fifo, ARSTREAM2_RTP_PacketFifoItem_t *item)
+static void ARSTREAM2_RTP_PacketFifoQueueTimeoutHeapSiftUp(ARSTREAM2_RTP_PacketFifoQueue_t *queue, unsigned int index)
+{
+    ARSTREAM2_RTP_PacketFifoItem_t **heap = queue->timeoutHeap;
+    ARSTREAM2_RTP_PacketFifoItem_t *item = heap[index];
+
+    while (index > 0)
+    {
+        unsigned int parent = (index - 1) / 2;
+        if (heap[parent]->packet.timeoutTimestamp <= item->packet.timeoutTimestamp)
+        {
+            break;
+        }
+        heap[index] = heap[parent];
+        heap[index]->timeoutHeapIndex = index;
+        index = parent;
+    }
+    heap[index] = item;
+    item->timeoutHeapIndex = index;
+}
+
+
+static void ARSTREAM2_RTP_PacketFifoQueueTimeoutHeapSiftDown(ARSTREAM2_RTP_PacketFifoQueue_t *queue, unsigned int index)
+{
+    ARSTREAM2_RTP_PacketFifoItem_t **heap = queue->timeoutHeap;
+    ARSTREAM2_RTP_PacketFifoItem_t *item = heap[index];
+    unsigned int count = queue->timeoutHeapCount;
+
+    while (2 * index + 1 < count)
+    {
+        unsigned int child = 2 * index + 1;
+        if ((child + 1 < count) && (heap[child + 1]->packet.timeoutTimestamp < heap[child]->packet.timeoutTimestamp))
+        {
+            child++;
+        }
+        if (item->packet.timeoutTimestamp <= heap[child]->packet.timeoutTimestamp)
+        {
+            break;
+        }
+        heap[index] = heap[child];
+        heap[index]->timeoutHeapIndex = index;
+        index = child;
+    }
+    heap[index] = item;
+    item->timeoutHeapIndex = index;
+}
+
+
+/* must be called after the item has been linked in the queue */
+static inline void ARSTREAM2_RTP_PacketFifoQueueHeapItem(ARSTREAM2_RTP_PacketFifoQueue_t *queue, ARSTREAM2_RTP_PacketFifoItem_t *item)
+{
+    if ((!queue->timeoutHeap) || (!queue->timeoutHeapValid) || (item->packet.timeoutTimestamp == 0))
+    {
+        return;
+    }
+
+    if (queue->timeoutHeapCount >= queue->timeoutHeapSize)
+    {
+        /* scan the queue until it is empty */
+        ARSAL_PRINT(ARSAL_PRINT_WARNING, ARSTREAM2_RTP_TAG, "Timeout heap is full (%d items)", queue->timeoutHeapCount);
+        queue->timeoutHeapValid = 0;
+        queue->timeoutHeapCount = 0;
+        return;
+    }
+
+    queue->timeoutHeap[queue->timeoutHeapCount] = item;
+    ARSTREAM2_RTP_PacketFifoQueueTimeoutHeapSiftUp(queue, queue->timeoutHeapCount++);
+}
+
+
+/* must be called after the item has been unlinked from the queue and the count updated */
+static inline void ARSTREAM2_RTP_PacketFifoQueueUnindexItem(ARSTREAM2_RTP_PacketFifoQueue_t *queue, ARSTREAM2_RTP_PacketFifoItem_t *item)
+{
+    if (queue->seqNumIndex)
+    {
+        unsigned int slot = item->packet.extSeqNum & (queue->seqNumIndexSize - 1);
+        if (queue->seqNumIndex[slot] == item)
+        {
+            queue->seqNumIndex[slot] = NULL;
+        }
+        if (queue->count == 0)
+        {
+            /* all indexed items are gone, the index can be used again */
+            queue->seqNumIndexValid = 1;
+        }
+    }
+
+    if (queue->timeoutHeap)
+    {
+        unsigned int index = item->timeoutHeapIndex;
+        if ((queue->timeoutHeapValid) && (index < queue->timeoutHeapCount) && (queue->timeoutHeap[index] == item))
+        {
+            ARSTREAM2_RTP_PacketFifoItem_t *last = queue->timeoutHeap[--queue->timeoutHeapCount];
+            if (last != item)
+            {
+                queue->timeoutHeap[index] = last;
+                last->timeoutHeapIndex = index;
+                if ((index > 0) && (last->packet.timeoutTimestamp < queue->timeoutHeap[(index - 1) / 2]->packet.timeoutTimestamp))
+                {
+                    ARSTREAM2_RTP_PacketFifoQueueTimeoutHeapSiftUp(queue, index);
+                }
+                else
+                {
+                    ARSTREAM2_RTP_PacketFifoQueueTimeoutHeapSiftDown(queue, index);
+                }
+            }
+        }
+        if (queue->count == 0)
+        {
+            /* all items are gone, the heap can be used again */
+            queue->timeoutHeapCount = 0;
+            queue->timeoutHeapValid = 1;
+        }
+    }
+}
+
+
+/* must be called before the item is unlinked from the queue */
+static inline void ARSTREAM2_RTP_PacketFifoQueueUnbucketItem(ARSTREAM2_RTP_PacketFifoQueue_t *queue, ARSTREAM2_RTP_PacketFifoItem_t *item)
+{
+    uint32_t priority = item->packet.priority;
+
+    if ((queue->priorityValid) && (queue->priorityMask) && (item->packet.rtpTimestamp == queue->priorityRtpTimestamp)
+            && (priority < ARSTREAM2_STREAM_SENDER_MAX_PRIORITY_LEVELS) && (queue->priorityMask & (1 << priority)))
+    {
+        if (queue->priorityHead[priority] == queue->priorityTail[priority])
+        {
+            queue->priorityHead[priority] = NULL;
+            queue->priorityTail[priority] = NULL;
+            queue->priorityMask &= ~(1 << priority);
+        }
+        else if (queue->priorityHead[priority] == item)
+        {
+            queue->priorityHead[priority] = item->next;
+        }
+        else if (queue->priorityTail[priority] == item)
+        {
+            queue->priorityTail[priority] = item->prev;
+        }
+    }
+}
+
+
+ARSTREAM2_RTP_PacketFifoBuffer_t* ARSTREAM2_RTP_PacketFifoGetBuffer(ARSTREAM2_RTP_PacketFifo_t *fifo)
+{
+    if (!fifo)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "Invalid pointer");
+        return NULL;
+    }
+
+    if (!fifo->bufferFree)
+    {
+        ARSTREAM2_RTP_PacketFifoReclaimBuffers(fifo);
+    }
+
+    if (fifo->bufferFree)
+    {
+        ARSTREAM2_RTP_PacketFifoBuffer_t* cur = fifo->bufferFree;
+        fifo->bufferFree = cur->next;
+        if (cur->next) cur->next->prev = NULL;
+        cur->prev = NULL;
+        cur->next = NULL;
+        __atomic_store_n(&cur->refCount, 1, __ATOMIC_RELAXED);
+        ARSTREAM2_RTP_PacketFifoUsageAdd(&fifo->bufferUsedCount, &fifo->bufferHighWatermark, 1);
+        return cur;
+    }
+    else
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "No free buffer in pool");
+        return NULL;
+    }
+}
+
+
+int ARSTREAM2_RTP_PacketFifoBufferAddRef(ARSTREAM2_RTP_PacketFifoBuffer_t *buffer)
+{
+    if (!buffer)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "Invalid pointer");
+        return -1;
+    }
+
+    __atomic_add_fetch(&buffer->refCount, 1, __ATOMIC_RELAXED);
+
+    return 0;
+}
+
+
+int ARSTREAM2_RTP_PacketFifoUnrefBuffer(ARSTREAM2_RTP_PacketFifo_t *fifo, ARSTREAM2_RTP_PacketFifoBuffer_t *buffer)
+{
+    unsigned int refCount;
+
+    if ((!fifo) || (!buffer))
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "Invalid pointer");
+        return -1;
+    }
+
+    refCount = __atomic_load_n(&buffer->refCount, __ATOMIC_RELAXED);
+    do
+    {
+        if (refCount == 0)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_WARNING, ARSTREAM2_RTP_TAG, "FIXME! Ref count is already null, this should not happen!");
+            return 0;
+        }
+    }
+    while (!__atomic_compare_exchange_n(&buffer->refCount, &refCount, refCount - 1, 1, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED));
+
+    if ((refCount == 1) && (buffer->owner) && (buffer->owner != fifo))
+    {
+        /* Last reference released from another FIFO: push the buffer on the owner return stack */
+        ARSTREAM2_RTP_PacketFifo_t *owner = buffer->owner;
+        ARSTREAM2_RTP_PacketFifoBuffer_t *head = __atomic_load_n(&owner->bufferReturn, __ATOMIC_RELAXED);
+        buffer->prev = NULL;
+        do
+        {
+            buffer->next = head;
+        }
+        while (!__atomic_compare_exchange_n(&owner->bufferReturn, &head, buffer, 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+    }
+    else if ((refCount == 1) && (buffer->overflow))
+    {
+        buffer->prev = NULL;
+        buffer->next = fifo->overflowFree;
+        fifo->overflowFree = buffer;
+    }
+    else if (refCount == 1)
+    {
+        if (fifo->bufferFree)
+        {
+            fifo->bufferFree->prev = buffer;
+            buffer->next = fifo->bufferFree;
+        }
+        else
+        {
+            buffer->next = NULL;
+        }
+        fifo->bufferFree = buffer;
+        buffer->prev = NULL;
+        ARSTREAM2_RTP_PacketFifoUsageAdd(&fifo->bufferUsedCount, &fifo->bufferHighWatermark, -1);
+    }
+
+    return 0;
+}
+
+
+int ARSTREAM2_RTP_PacketFifoReclaimBuffers(ARSTREAM2_RTP_PacketFifo_t *fifo)
+{
+    ARSTREAM2_RTP_PacketFifoBuffer_t *cur, *next;
+    int count = 0;
+
+    if (!fifo)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "Invalid pointer");
+        return -1;
+    }
+
+    if (!__atomic_load_n(&fifo->bufferReturn, __ATOMIC_RELAXED))
+    {
+        return 0;
+    }
+
+    /* Taking the whole stack at once is not subject to ABA */
+    for (cur = __atomic_exchange_n(&fifo->bufferReturn, NULL, __ATOMIC_ACQUIRE); cur; cur = next)
+    {
+        next = cur->next;
+        if (cur->overflow)
+        {
+            cur->prev = NULL;
+            cur->next = fifo->overflowFree;
+            fifo->overflowFree = cur;
+            continue;
+        }
+        if (fifo->bufferFree)
+        {
+            fifo->bufferFree->prev = cur;
+        }
+        cur->next = fifo->bufferFree;
+        cur->prev = NULL;
+        fifo->bufferFree = cur;
+        count++;
+    }
+    ARSTREAM2_RTP_PacketFifoUsageAdd(&fifo->bufferUsedCount, &fifo->bufferHighWatermark, -count);
+
+    return count;
+}
+
+
+ARSTREAM2_RTP_PacketFifoItem_t* ARSTREAM2_RTP_PacketFifoPopFreeItem(ARSTREAM2_RTP_PacketFifo_t *fifo)
+{
+    if (!fifo)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "Invalid pointer");
+        return NULL;
+    }
+
+    if (fifo->itemFree)
+    {
+        ARSTREAM2_RTP_PacketFifoItem_t* cur = fifo->itemFree;
+        fifo->itemFree = cur->next;
+        if (cur->next) cur->next->prev = NULL;
+        cur->prev = NULL;
+        cur->next = NULL;
+        ARSTREAM2_RTP_PacketFifoUsageAdd(&fifo->itemUsedCount, &fifo->itemHighWatermark, 1);
+        return cur;
+    }
+    else
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "Packet FIFO is full");
+        return NULL;
+    }
+}
+
+
+int ARSTREAM2_RTP_PacketFifoPushFreeItem(ARSTREAM2_RTP_PacketFifo_t *fifo, ARSTREAM2_RTP_PacketFifoItem_t *item)
 {
     if ((!fifo) || (!item))
     {
@@ -383,252 +1002,723 @@ int ARSTREAM2_RTP_PacketFifoPushFreeItem(ARSTREAM2_RTP_PacketFifo_t *fifo, ARSTR
     }
     fifo->itemFree = item;
     item->prev = NULL;
+    ARSTREAM2_RTP_PacketFifoUsageAdd(&fifo->itemUsedCount, &fifo->itemHighWatermark, -1);
+
+    return 0;
+}
+
+
+int ARSTREAM2_RTP_PacketFifoEnqueueItem(ARSTREAM2_RTP_PacketFifoQueue_t *queue, ARSTREAM2_RTP_PacketFifoItem_t *item)
+{
+    if ((!queue) || (!item))
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "Invalid pointer");
+        return -1;
+    }
+
+    item->next = NULL;
+    if (queue->tail)
+    {
+        queue->tail->next = item;
+        item->prev = queue->tail;
+    }
+    else
+    {
+        item->prev = NULL;
+    }
+    queue->tail = item;
+    if (!queue->head)
+    {
+        queue->head = item;
+    }
+    queue->count++;
+
+    ARSTREAM2_RTP_PacketFifoQueueHeapItem(queue, item);
+
+    return 0;
+}
+
+
+int ARSTREAM2_RTP_PacketFifoEnqueueItemOrderedByPriority(ARSTREAM2_RTP_PacketFifoQueue_t *queue, ARSTREAM2_RTP_PacketFifoItem_t *item)
+{
+    ARSTREAM2_RTP_PacketFifoItem_t* cur;
+    uint32_t priority;
+
+    if ((!queue) || (!item))
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "Invalid pointer");
+        return -1;
+    }
+
+    priority = item->packet.priority;
+    if ((!queue->tail) || (queue->tail->packet.rtpTimestamp < item->packet.rtpTimestamp))
+    {
+        /* new access unit: append and restart the priority levels */
+        cur = queue->tail;
+        queue->priorityMask = 0;
+        queue->priorityRtpTimestamp = item->packet.rtpTimestamp;
+        queue->priorityValid = (priority < ARSTREAM2_STREAM_SENDER_MAX_PRIORITY_LEVELS) ? 1 : 0;
+    }
+    else if ((queue->priorityValid) && (item->packet.rtpTimestamp == queue->priorityRtpTimestamp)
+            && (priority < ARSTREAM2_STREAM_SENDER_MAX_PRIORITY_LEVELS))
+    {
+        /* newest access unit: insert after the last item of the highest non-empty level <= priority,
+         * or before the first item of the lowest non-empty level */
+        uint32_t lower = queue->priorityMask & ((2 << priority) - 1);
+        if (lower)
+        {
+            cur = queue->priorityTail[31 - __builtin_clz(lower)];
+        }
+        else if (queue->priorityMask)
+        {
+            cur = queue->priorityHead[__builtin_ctz(queue->priorityMask)]->prev;
+        }
+        else
+        {
+            cur = queue->tail;
+        }
+    }
+    else
+    {
+        /* older access unit (e.g. retransmission) or out of range priority: ordered insertion */
+        for (cur = queue->tail; cur; cur = cur->prev)
+        {
+            if (cur->packet.rtpTimestamp == item->packet.rtpTimestamp)
+            {
+                if (cur->packet.priority <= item->packet.priority)
+                {
+                    break;
+                }
+            }
+            else if (cur->packet.rtpTimestamp < item->packet.rtpTimestamp)
+            {
+                break;
+            }
+        }
+        if ((item->packet.rtpTimestamp == queue->priorityRtpTimestamp) && (priority >= ARSTREAM2_STREAM_SENDER_MAX_PRIORITY_LEVELS))
+        {
+            /* the newest access unit is no longer fully bucketed */
+            queue->priorityValid = 0;
+        }
+        priority = ARSTREAM2_STREAM_SENDER_MAX_PRIORITY_LEVELS;
+    }
+
+    if (cur)
+    {
+        /* insert after cur */
+        item->next = cur->next;
+        if (item->next)
+        {
+            item->next->prev = item;
+        }
+        else
+        {
+            queue->tail = item;
+        }
+        item->prev = cur;
+        cur->next = item;
+        queue->count++;
+    }
+    else
+    {
+        /* insert at head */
+        item->next = queue->head;
+        if (queue->head)
+        {
+            queue->head->prev = item;
+        }
+        item->prev = NULL;
+        queue->head = item;
+        if (!queue->tail)
+        {
+            queue->tail = item;
+        }
+        queue->count++;
+    }
+
+    if ((queue->priorityValid) && (priority < ARSTREAM2_STREAM_SENDER_MAX_PRIORITY_LEVELS))
+    {
+        if (!(queue->priorityMask & (1 << priority)))
+        {
+            queue->priorityHead[priority] = item;
+            queue->priorityMask |= (1 << priority);
+        }
+        queue->priorityTail[priority] = item;
+    }
+
+    ARSTREAM2_RTP_PacketFifoQueueHeapItem(queue, item);
+
+    return 0;
+}
+
+
+int ARSTREAM2_RTP_PacketFifoEnqueueItemOrderedBySeqNum(ARSTREAM2_RTP_PacketFifoQueue_t *queue, ARSTREAM2_RTP_PacketFifoItem_t *item)
+{
+    ARSTREAM2_RTP_PacketFifoItem_t* cur = NULL;
+    int outOfOrder = 0, duplicate = 0, indexed = 0;
+
+    if ((!queue) || (!item))
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "Invalid pointer");
+        return -1;
+    }
+
+    if ((queue->seqNumIndex) && (queue->seqNumIndexValid))
+    {
+        uint32_t extSeqNum = item->packet.extSeqNum;
+        uint32_t mask = queue->seqNumIndexSize - 1;
+        uint32_t low = ((queue->head) && (queue->head->packet.extSeqNum < extSeqNum)) ? queue->head->packet.extSeqNum : extSeqNum;
+        uint32_t high = ((queue->tail) && (queue->tail->packet.extSeqNum > extSeqNum)) ? queue->tail->packet.extSeqNum : extSeqNum;
+
+        if (high - low < queue->seqNumIndexSize)
+        {
+            indexed = 1;
+            if (queue->seqNumIndex[extSeqNum & mask])
+            {
+                /* the whole queue fits in the window: an occupied slot has the same extSeqNum */
+                return -3;
+            }
+            else if ((!queue->tail) || (queue->tail->packet.extSeqNum < extSeqNum))
+            {
+                cur = queue->tail;
+            }
+            else if (queue->head->packet.extSeqNum > extSeqNum)
+            {
+                cur = NULL;
+                outOfOrder = 1;
+            }
+            else
+            {
+                /* the closest lower indexed seqNum is the predecessor; the head
+                 * bounds the search, usually only the missing packets are probed */
+                uint32_t s;
+                for (s = extSeqNum - 1, cur = NULL; !cur; s--)
+                {
+                    cur = queue->seqNumIndex[s & mask];
+                }
+                outOfOrder = 1;
+            }
+            queue->seqNumIndex[extSeqNum & mask] = item;
+        }
+        else
+        {
+            /* out of window: fall back to the linear walk until the queue is empty */
+            queue->seqNumIndexValid = 0;
+        }
+    }
+
+    if (!indexed)
+    {
+        for (cur = queue->tail; cur; cur = cur->prev)
+        {
+            if (cur->packet.extSeqNum == item->packet.extSeqNum)
+            {
+                duplicate = 1;
+                break;
+            }
+            else if (cur->packet.extSeqNum < item->packet.extSeqNum)
+            {
+                break;
+            }
+            else
+            {
+                outOfOrder = 1;
+            }
+        }
+    }
+
+    if (duplicate)
+    {
+        return -3;
+    }
+
+    if (cur)
+    {
+        /* insert after cur */
+        item->next = cur->next;
+        if (item->next)
+        {
+            item->next->prev = item;
+        }
+        else
+        {
+            queue->tail = item;
+        }
+        item->prev = cur;
+        cur->next = item;
+        queue->count++;
+    }
+    else
+    {
+        /* insert at head */
+        item->next = queue->head;
+        if (queue->head)
+        {
+            queue->head->prev = item;
+        }
+        item->prev = NULL;
+        queue->head = item;
+        if (!queue->tail)
+        {
+            queue->tail = item;
+        }
+        queue->count++;
+    }
+
+    ARSTREAM2_RTP_PacketFifoQueueHeapItem(queue, item);
+
+    return (outOfOrder) ? 1 : 0;
+}
+
+
+ARSTREAM2_RTP_PacketFifoItem_t* ARSTREAM2_RTP_PacketFifoDequeueItem(ARSTREAM2_RTP_PacketFifoQueue_t *queue)
+{
+    ARSTREAM2_RTP_PacketFifoItem_t* cur;
+
+    if (!queue)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "Invalid pointer");
+        return NULL;
+    }
+
+    if ((!queue->head) || (!queue->count))
+    {
+        //ARSAL_PRINT(ARSAL_PRINT_VERBOSE, ARSTREAM2_RTP_TAG, "Packet FIFO is empty");
+        return NULL;
+    }
+
+    cur = queue->head;
+    ARSTREAM2_RTP_PacketFifoQueueUnbucketItem(queue, cur);
+    if (cur->next)
+    {
+        cur->next->prev = NULL;
+        queue->head = cur->next;
+        queue->count--;
+    }
+    else
+    {
+        queue->head = NULL;
+        queue->count = 0;
+        queue->tail = NULL;
+    }
+    cur->prev = NULL;
+    cur->next = NULL;
+    ARSTREAM2_RTP_PacketFifoQueueUnindexItem(queue, cur);
+
+    return cur;
+}
+
+
+ARSTREAM2_RTP_PacketFifoItem_t* ARSTREAM2_RTP_PacketFifoPeekItem(ARSTREAM2_RTP_PacketFifoQueue_t *queue)
+{
+    ARSTREAM2_RTP_PacketFifoItem_t* cur;
+
+    if (!queue)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "Invalid pointer");
+        return NULL;
+    }
+
+    if ((!queue->head) || (!queue->count))
+    {
+        //ARSAL_PRINT(ARSAL_PRINT_VERBOSE, ARSTREAM2_RTP_TAG, "Packet FIFO is empty");
+        return NULL;
+    }
+
+    cur = queue->head;
+
+    return cur;
+}
+
+
+ARSTREAM2_RTP_PacketFifoItem_t* ARSTREAM2_RTP_PacketFifoDuplicateItem(ARSTREAM2_RTP_PacketFifo_t *fifo,
+                                                                      ARSTREAM2_RTP_PacketFifoItem_t *item)
+{
+    ARSTREAM2_RTP_PacketFifoItem_t *copyItem;
+
+    if ((!fifo) || (!item))
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "Invalid pointer");
+        return NULL;
+    }
+
+    copyItem = ARSTREAM2_RTP_PacketFifoPopFreeItem(fifo);
+    if (copyItem)
+    {
+        ARSTREAM2_RTP_PacketCopy(&copyItem->packet, &item->packet);
+    }
+    else
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "Failed to pop free item from the AU FIFO");
+    }
+
+    return copyItem;
+}
+
+
+int ARSTREAM2_RTP_PacketRingInit(ARSTREAM2_RTP_PacketRing_t *ring, int maxCount)
+{
+    unsigned int size = 1;
+
+    if (!ring)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "Invalid pointer");
+        return -1;
+    }
+    if (maxCount <= 0)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "Invalid max count (%d)", maxCount);
+        return -1;
+    }
+
+    while (size < (unsigned int)maxCount)
+    {
+        size <<= 1;
+    }
+
+    memset(ring, 0, sizeof(ARSTREAM2_RTP_PacketRing_t));
+    ring->packet = malloc(size * sizeof(ARSTREAM2_RTP_Packet_t));
+    if (!ring->packet)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "Ring allocation failed (size %zu)", size * sizeof(ARSTREAM2_RTP_Packet_t));
+        return -1;
+    }
+    memset(ring->packet, 0, size * sizeof(ARSTREAM2_RTP_Packet_t));
+    ring->mask = size - 1;
+
+    return 0;
+}
+
+
+int ARSTREAM2_RTP_PacketRingFree(ARSTREAM2_RTP_PacketRing_t *ring)
+{
+    if (!ring)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "Invalid pointer");
+        return -1;
+    }
+
+    free(ring->packet);
+    memset(ring, 0, sizeof(ARSTREAM2_RTP_PacketRing_t));
+
+    return 0;
+}
+
+
+/* Producer side: only the producer thread writes the tail index */
+int ARSTREAM2_RTP_PacketRingPush(ARSTREAM2_RTP_PacketRing_t *ring, const ARSTREAM2_RTP_Packet_t *packet)
+{
+    unsigned int tail = ring->tail;
+    unsigned int head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+
+    if (tail - head > ring->mask)
+    {
+        return -2;
+    }
+
+    ARSTREAM2_RTP_PacketCopy(&ring->packet[tail & ring->mask], packet);
+    __atomic_store_n(&ring->tail, tail + 1, __ATOMIC_RELEASE);
+
+    return 0;
+}
+
+
+/* Consumer side: only the consumer thread writes the head index */
+int ARSTREAM2_RTP_PacketRingPop(ARSTREAM2_RTP_PacketRing_t *ring, ARSTREAM2_RTP_Packet_t *packet)
+{
+    unsigned int head = ring->head;
+    unsigned int tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+
+    if (head == tail)
+    {
+        return -2;
+    }
+
+    ARSTREAM2_RTP_PacketCopy(packet, &ring->packet[head & ring->mask]);
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
 
     return 0;
 }
 
 
-int ARSTREAM2_RTP_PacketFifoEnqueueItem(ARSTREAM2_RTP_PacketFifoQueue_t *queue, ARSTREAM2_RTP_PacketFifoItem_t *item)
+int ARSTREAM2_RTP_Sender_RetransmitCacheInit(ARSTREAM2_RTP_SenderContext_t *context, unsigned int size, uint32_t timeout)
 {
-    if ((!queue) || (!item))
+    unsigned int _size;
+
+    if (!context)
     {
         ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "Invalid pointer");
         return -1;
     }
 
-    item->next = NULL;
-    if (queue->tail)
+    if ((size == 0) || (size > 32768) || (timeout == 0))
     {
-        queue->tail->next = item;
-        item->prev = queue->tail;
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "Invalid retransmission cache size (%d) or timeout (%d)", size, timeout);
+        return -1;
     }
-    else
+
+    if (context->retransmitCache)
     {
-        item->prev = NULL;
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "Retransmission cache is already initialized");
+        return -1;
     }
-    queue->tail = item;
-    if (!queue->head)
+
+    for (_size = 1; _size < size; _size <<= 1);
+
+    context->retransmitCache = calloc(_size, sizeof(ARSTREAM2_RTP_RetransmitCacheEntry_t));
+    if (!context->retransmitCache)
     {
-        queue->head = item;
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "Retransmission cache allocation failed (size %zu)", _size * sizeof(ARSTREAM2_RTP_RetransmitCacheEntry_t));
+        context->retransmitCacheSize = 0;
+        return -1;
     }
-    queue->count++;
+    context->retransmitCacheSize = _size;
+    context->retransmitCacheOldest = 0;
+    context->retransmitCacheNewest = 0;
+    context->retransmitCacheTimeout = timeout;
+    context->retransmittedPacketCount = 0;
+    context->retransmitMissCount = 0;
 
     return 0;
 }
 
 
-int ARSTREAM2_RTP_PacketFifoEnqueueItemOrderedByPriority(ARSTREAM2_RTP_PacketFifoQueue_t *queue, ARSTREAM2_RTP_PacketFifoItem_t *item)
+static inline void ARSTREAM2_RTP_Sender_RetransmitCacheRelease(ARSTREAM2_RTP_PacketFifo_t *fifo, ARSTREAM2_RTP_RetransmitCacheEntry_t *entry)
 {
-    ARSTREAM2_RTP_PacketFifoItem_t* cur;
-
-    if ((!queue) || (!item))
+    if (entry->packet.buffer)
     {
-        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "Invalid pointer");
-        return -1;
+        int ret = ARSTREAM2_RTP_PacketFifoUnrefBuffer(fifo, entry->packet.buffer);
+        if (ret != 0)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "ARSTREAM2_RTP_PacketFifoUnrefBuffer() failed (%d)", ret);
+        }
+        entry->packet.buffer = NULL;
     }
+    entry->valid = 0;
+}
+
 
-    for (cur = queue->tail; cur; cur = cur->prev)
+static void ARSTREAM2_RTP_Sender_RetransmitCacheStore(ARSTREAM2_RTP_SenderContext_t *context, ARSTREAM2_RTP_PacketFifo_t *fifo,
+                                                      ARSTREAM2_RTP_Packet_t *packet, uint64_t curTime)
+{
+    unsigned int mask = context->retransmitCacheSize - 1;
+    unsigned int idx = packet->seqNum & mask;
+    ARSTREAM2_RTP_RetransmitCacheEntry_t *entry = &context->retransmitCache[idx];
+    ARSTREAM2_RTP_RetransmitCacheEntry_t *newest = &context->retransmitCache[context->retransmitCacheNewest];
+
+    if ((entry->valid) && (entry->packet.seqNum == packet->seqNum) && (entry->packet.buffer == packet->buffer))
     {
-        if (cur->packet.rtpTimestamp == item->packet.rtpTimestamp)
-        {
-            if (cur->packet.priority <= item->packet.priority)
-            {
-                break;
-            }
-        }
-        else if (cur->packet.rtpTimestamp < item->packet.rtpTimestamp)
-        {
-            break;
-        }
+        /* retransmitted packet: keep the original send time so that the entry still expires */
+        return;
     }
 
-    if (cur)
+    if (entry->valid)
     {
-        /* insert after cur */
-        item->next = cur->next;
-        if (item->next)
-        {
-            item->next->prev = item;
-        }
-        else
+        ARSTREAM2_RTP_Sender_RetransmitCacheRelease(fifo, entry);
+    }
+    if (packet->buffer)
+    {
+        ARSTREAM2_RTP_PacketCopy(&entry->packet, packet);
+        ARSTREAM2_RTP_PacketFifoBufferAddRef(entry->packet.buffer);
+        entry->sendTimestamp = curTime;
+        entry->valid = 1;
+        if ((!newest->valid) || ((int16_t)(packet->seqNum - newest->packet.seqNum) > 0))
         {
-            queue->tail = item;
+            context->retransmitCacheNewest = idx;
         }
-        item->prev = cur;
-        cur->next = item;
-        queue->count++;
     }
-    else
+
+    /* release the expired entries, starting from the oldest */
+    while (1)
     {
-        /* insert at head */
-        item->next = queue->head;
-        if (queue->head)
+        entry = &context->retransmitCache[context->retransmitCacheOldest];
+        if (entry->valid)
         {
-            queue->head->prev = item;
+            if (curTime < entry->sendTimestamp + context->retransmitCacheTimeout)
+            {
+                break;
+            }
+            ARSTREAM2_RTP_Sender_RetransmitCacheRelease(fifo, entry);
         }
-        item->prev = NULL;
-        queue->head = item;
-        if (!queue->tail)
+        if (context->retransmitCacheOldest == context->retransmitCacheNewest)
         {
-            queue->tail = item;
+            break;
         }
-        queue->count++;
+        context->retransmitCacheOldest = (context->retransmitCacheOldest + 1) & mask;
     }
-
-    return 0;
 }
 
 
-int ARSTREAM2_RTP_PacketFifoEnqueueItemOrderedBySeqNum(ARSTREAM2_RTP_PacketFifoQueue_t *queue, ARSTREAM2_RTP_PacketFifoItem_t *item)
+int ARSTREAM2_RTP_Sender_RetransmitCacheFlush(ARSTREAM2_RTP_SenderContext_t *context, ARSTREAM2_RTP_PacketFifo_t *fifo)
 {
-    ARSTREAM2_RTP_PacketFifoItem_t* cur;
-    int outOfOrder = 0, duplicate = 0;
+    unsigned int i;
 
-    if ((!queue) || (!item))
+    if ((!context) || (!fifo))
     {
         ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "Invalid pointer");
         return -1;
     }
 
-    for (cur = queue->tail; cur; cur = cur->prev)
+    if (!context->retransmitCache)
     {
-        if (cur->packet.extSeqNum == item->packet.extSeqNum)
-        {
-            duplicate = 1;
-            break;
-        }
-        else if (cur->packet.extSeqNum < item->packet.extSeqNum)
-        {
-            break;
-        }
-        else
-        {
-            outOfOrder = 1;
-        }
+        return 0;
     }
 
-    if (duplicate)
+    for (i = 0; i < context->retransmitCacheSize; i++)
     {
-        return -3;
+        if (context->retransmitCache[i].valid)
+        {
+            ARSTREAM2_RTP_Sender_RetransmitCacheRelease(fifo, &context->retransmitCache[i]);
+        }
     }
+    context->retransmitCacheOldest = 0;
+    context->retransmitCacheNewest = 0;
 
-    if (cur)
+    return 0;
+}
+
+
+int ARSTREAM2_RTP_Sender_RetransmitCacheFree(ARSTREAM2_RTP_SenderContext_t *context, ARSTREAM2_RTP_PacketFifo_t *fifo)
+{
+    if (!context)
     {
-        /* insert after cur */
-        item->next = cur->next;
-        if (item->next)
-        {
-            item->next->prev = item;
-        }
-        else
-        {
-            queue->tail = item;
-        }
-        item->prev = cur;
-        cur->next = item;
-        queue->count++;
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "Invalid pointer");
+        return -1;
     }
-    else
+
+    if (fifo)
     {
-        /* insert at head */
-        item->next = queue->head;
-        if (queue->head)
-        {
-            queue->head->prev = item;
-        }
-        item->prev = NULL;
-        queue->head = item;
-        if (!queue->tail)
-        {
-            queue->tail = item;
-        }
-        queue->count++;
+        ARSTREAM2_RTP_Sender_RetransmitCacheFlush(context, fifo);
     }
+    free(context->retransmitCache);
+    context->retransmitCache = NULL;
+    context->retransmitCacheSize = 0;
 
-    return (outOfOrder) ? 1 : 0;
+    return 0;
 }
 
 
-ARSTREAM2_RTP_PacketFifoItem_t* ARSTREAM2_RTP_PacketFifoDequeueItem(ARSTREAM2_RTP_PacketFifoQueue_t *queue)
+int ARSTREAM2_RTP_Sender_PacketFifoRetransmit(ARSTREAM2_RTP_SenderContext_t *context,
+                                              ARSTREAM2_RTP_PacketFifo_t *fifo,
+                                              ARSTREAM2_RTP_PacketFifoQueue_t *queue, uint16_t seqNum, uint64_t curTime)
 {
-    ARSTREAM2_RTP_PacketFifoItem_t* cur;
+    ARSTREAM2_RTP_RetransmitCacheEntry_t *entry;
+    ARSTREAM2_RTP_PacketFifoItem_t *item;
+    int ret;
 
-    if (!queue)
+    if ((!context) || (!fifo) || (!queue))
     {
         ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "Invalid pointer");
-        return NULL;
+        return -1;
     }
 
-    if ((!queue->head) || (!queue->count))
+    if (!context->retransmitCache)
     {
-        //ARSAL_PRINT(ARSAL_PRINT_VERBOSE, ARSTREAM2_RTP_TAG, "Packet FIFO is empty");
-        return NULL;
+        return -2;
     }
 
-    cur = queue->head;
-    if (cur->next)
+    entry = &context->retransmitCache[seqNum & (context->retransmitCacheSize - 1)];
+    if ((!entry->valid) || (entry->packet.seqNum != seqNum))
     {
-        cur->next->prev = NULL;
-        queue->head = cur->next;
-        queue->count--;
+        /* not (or no longer) in the cache */
+        context->retransmitMissCount++;
+        return -2;
     }
-    else
+    if (curTime >= entry->sendTimestamp + context->retransmitCacheTimeout)
     {
-        queue->head = NULL;
-        queue->count = 0;
-        queue->tail = NULL;
+        ARSTREAM2_RTP_Sender_RetransmitCacheRelease(fifo, entry);
+        context->retransmitMissCount++;
+        return -2;
     }
-    cur->prev = NULL;
-    cur->next = NULL;
-
-    return cur;
-}
-
-
-ARSTREAM2_RTP_PacketFifoItem_t* ARSTREAM2_RTP_PacketFifoPeekItem(ARSTREAM2_RTP_PacketFifoQueue_t *queue)
-{
-    ARSTREAM2_RTP_PacketFifoItem_t* cur;
 
-    if (!queue)
+    item = ARSTREAM2_RTP_PacketFifoPopFreeItem(fifo);
+    if (!item)
     {
-        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "Invalid pointer");
-        return NULL;
+        return -1;
     }
+    ARSTREAM2_RTP_PacketCopy(&item->packet, &entry->packet);
+    ARSTREAM2_RTP_PacketFifoBufferAddRef(item->packet.buffer);
+    item->packet.timeoutTimestamp = entry->sendTimestamp + context->retransmitCacheTimeout;
+    item->packet.retransmitted = 1;
 
-    if ((!queue->head) || (!queue->count))
+    /* the RTP timestamp is older than the queued packets: the retransmission goes near the head of the queue */
+    ret = ARSTREAM2_RTP_PacketFifoEnqueueItemOrderedByPriority(queue, item);
+    if (ret != 0)
     {
-        //ARSAL_PRINT(ARSAL_PRINT_VERBOSE, ARSTREAM2_RTP_TAG, "Packet FIFO is empty");
-        return NULL;
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "ARSTREAM2_RTP_PacketFifoEnqueueItemOrderedByPriority() failed (%d)", ret);
+        ARSTREAM2_RTP_PacketFifoUnrefBuffer(fifo, item->packet.buffer);
+        ARSTREAM2_RTP_PacketFifoPushFreeItem(fifo, item);
+        return -1;
     }
+    context->retransmittedPacketCount++;
 
-    cur = queue->head;
-
-    return cur;
+    return 0;
 }
 
 
-ARSTREAM2_RTP_PacketFifoItem_t* ARSTREAM2_RTP_PacketFifoDuplicateItem(ARSTREAM2_RTP_PacketFifo_t *fifo,
-                                                                      ARSTREAM2_RTP_PacketFifoItem_t *item)
+int ARSTREAM2_RTP_Sender_PacketFifoFanOut(ARSTREAM2_RTP_SenderContext_t *context,
+                                          ARSTREAM2_RTP_PacketFifo_t *fifo,
+                                          ARSTREAM2_RTP_PacketFifoItem_t *item, int updateCounts)
 {
     ARSTREAM2_RTP_PacketFifoItem_t *copyItem;
+    unsigned int i;
+    int ret, count = 0;
 
-    if ((!fifo) || (!item))
+    if ((!context) || (!fifo) || (!item))
     {
         ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "Invalid pointer");
-        return NULL;
+        return -1;
     }
 
-    copyItem = ARSTREAM2_RTP_PacketFifoPopFreeItem(fifo);
-    if (copyItem)
-    {
-        ARSTREAM2_RTP_PacketCopy(&copyItem->packet, &item->packet);
-    }
-    else
+    for (i = 0; i < context->fanOutCount; i++)
     {
-        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "Failed to pop free item from the AU FIFO");
+        ARSTREAM2_RTP_SenderFanOut_t *fanOut = &context->fanOut[i];
+        uint32_t importance = item->packet.importance;
+        uint64_t timeoutTimestamp1 = ((fanOut->maxLatencyUs > 0) && (item->packet.ntpTimestamp > 0)) ? item->packet.ntpTimestamp + fanOut->maxLatencyUs : 0;
+        uint64_t timeoutTimestamp2 = ((importance < ARSTREAM2_STREAM_SENDER_MAX_IMPORTANCE_LEVELS) && (fanOut->maxNetworkLatencyUs[importance] > 0) && (item->packet.inputTimestamp > 0))
+                ? item->packet.inputTimestamp + fanOut->maxNetworkLatencyUs[importance] : 0;
+
+        /* add ref to packet buffer */
+        ret = ARSTREAM2_RTP_PacketFifoBufferAddRef(item->packet.buffer);
+        if (ret < 0)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "ARSTREAM2_RTP_PacketFifoBufferAddRef() failed (%d)", ret);
+            return -1;
+        }
+
+        /* duplicate the packet item */
+        copyItem = ARSTREAM2_RTP_PacketFifoDuplicateItem(fifo, item);
+        if (!copyItem)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "Failed to pop free item from the packet FIFO");
+            ARSTREAM2_RTP_PacketFifoUnrefBuffer(fifo, item->packet.buffer);
+            return -1;
+        }
+        copyItem->packet.buffer = item->packet.buffer;
+        copyItem->packet.timeoutTimestamp = timeoutTimestamp1;
+        if ((timeoutTimestamp1 == 0) || ((timeoutTimestamp2 > 0) && (timeoutTimestamp2 < timeoutTimestamp1)))
+        {
+            copyItem->packet.timeoutTimestamp = timeoutTimestamp2;
+        }
+
+        ret = ARSTREAM2_RTP_PacketFifoEnqueueItemOrderedByPriority(fanOut->queue, copyItem);
+        if (ret != 0)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "ARSTREAM2_RTP_PacketFifoEnqueueItemOrderedByPriority() failed (%d)", ret);
+            ARSTREAM2_RTP_PacketFifoUnrefBuffer(fifo, copyItem->packet.buffer);
+            ARSTREAM2_RTP_PacketFifoPushFreeItem(fifo, copyItem);
+            return -1;
+        }
+
+        if ((updateCounts) && (fanOut->context))
+        {
+            fanOut->context->packetCount++;
+            fanOut->context->byteCount += item->packet.payloadSize;
+        }
+        count++;
     }
 
-    return copyItem;
+    return count;
 }
 
 
@@ -708,6 +1798,7 @@ int ARSTREAM2_RTP_Sender_PacketFifoCleanFromMsgVec(ARSTREAM2_RTP_SenderContext_t
             ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "ARSTREAM2_RTP_Sender_FinishPacket() failed (%d)", ret);
         }
 
+        ARSTREAM2_RTP_PacketFifoQueueUnbucketItem(queue, cur);
         if (cur->next)
         {
             cur->next->prev = NULL;
@@ -720,6 +1811,13 @@ int ARSTREAM2_RTP_Sender_PacketFifoCleanFromMsgVec(ARSTREAM2_RTP_SenderContext_t
             queue->count = 0;
             queue->tail = NULL;
         }
+        ARSTREAM2_RTP_PacketFifoQueueUnindexItem(queue, cur);
+
+        if ((context->retransmitCache) && (!ARSTREAM2_RTPFEC_IS_REPAIR_PACKET(ntohs(cur->packet.header->flags))))
+        {
+            /* FEC repair packets have their own sequence number space and are not retransmitted */
+            ARSTREAM2_RTP_Sender_RetransmitCacheStore(context, fifo, &cur->packet, curTime);
+        }
 
         if (cur->packet.buffer)
         {
@@ -741,6 +1839,61 @@ int ARSTREAM2_RTP_Sender_PacketFifoCleanFromMsgVec(ARSTREAM2_RTP_SenderContext_t
 }
 
 
+static int ARSTREAM2_RTP_Sender_PacketFifoDropTimeoutItem(ARSTREAM2_RTP_SenderContext_t *context,
+                                                          ARSTREAM2_RTP_PacketFifo_t *fifo,
+                                                          ARSTREAM2_RTP_PacketFifoQueue_t *queue,
+                                                          ARSTREAM2_RTP_PacketFifoItem_t *cur, uint64_t curTime,
+                                                          unsigned int *dropCount, unsigned int importanceLevelCount)
+{
+    if ((dropCount) && (cur->packet.importance < importanceLevelCount))
+    {
+        dropCount[cur->packet.importance]++;
+    }
+    int ret = ARSTREAM2_RTP_Sender_FinishPacket(context, &cur->packet, curTime, 1);
+    if (ret < 0)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "ARSTREAM2_RTP_Sender_FinishPacket() failed (%d)", ret);
+    }
+
+    ARSTREAM2_RTP_PacketFifoQueueUnbucketItem(queue, cur);
+    if (cur->next)
+    {
+        cur->next->prev = cur->prev;
+    }
+    else
+    {
+        queue->tail = cur->prev;
+    }
+    if (cur->prev)
+    {
+        cur->prev->next = cur->next;
+    }
+    else
+    {
+        queue->head = cur->next;
+    }
+    queue->count--;
+    ARSTREAM2_RTP_PacketFifoQueueUnindexItem(queue, cur);
+
+    if (cur->packet.buffer)
+    {
+        ret = ARSTREAM2_RTP_PacketFifoUnrefBuffer(fifo, cur->packet.buffer);
+        if (ret != 0)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "ARSTREAM2_RTP_PacketFifoUnrefBuffer() failed (%d)", ret);
+        }
+    }
+    ret = ARSTREAM2_RTP_PacketFifoPushFreeItem(fifo, cur);
+    if (ret < 0)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "Failed to push free FIFO item");
+        return -1;
+    }
+
+    return 0;
+}
+
+
 int ARSTREAM2_RTP_Sender_PacketFifoCleanFromTimeout(ARSTREAM2_RTP_SenderContext_t *context,
                                                     ARSTREAM2_RTP_PacketFifo_t *fifo,
                                                     ARSTREAM2_RTP_PacketFifoQueue_t *queue, uint64_t curTime,
@@ -775,59 +1928,30 @@ int ARSTREAM2_RTP_Sender_PacketFifoCleanFromTimeout(ARSTREAM2_RTP_SenderContext_
         return -2;
     }
 
+    if ((queue->timeoutHeap) && (queue->timeoutHeapValid))
+    {
+        /* only the expired items are touched */
+        for (count = 0; (queue->timeoutHeapCount > 0) && (queue->timeoutHeap[0]->packet.timeoutTimestamp <= curTime); count++)
+        {
+            if (ARSTREAM2_RTP_Sender_PacketFifoDropTimeoutItem(context, fifo, queue, queue->timeoutHeap[0], curTime, dropCount, importanceLevelCount) < 0)
+            {
+                return -1;
+            }
+        }
+
+        return count;
+    }
+
     for (cur = queue->head, count = 0; cur != NULL; cur = next)
     {
+        next = cur->next;
         if ((cur->packet.timeoutTimestamp != 0) && (cur->packet.timeoutTimestamp <= curTime))
         {
-            if ((dropCount) && (cur->packet.importance < importanceLevelCount))
+            if (ARSTREAM2_RTP_Sender_PacketFifoDropTimeoutItem(context, fifo, queue, cur, curTime, dropCount, importanceLevelCount) < 0)
             {
-                dropCount[cur->packet.importance]++;
-            }
-            int ret = ARSTREAM2_RTP_Sender_FinishPacket(context, &cur->packet, curTime, 1);
-            if (ret < 0)
-            {
-                ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "ARSTREAM2_RTP_Sender_FinishPacket() failed (%d)", ret);
-            }
-
-            if (cur->next)
-            {
-                cur->next->prev = cur->prev;
-            }
-            else
-            {
-                queue->tail = cur->prev;
-            }
-            if (cur->prev)
-            {
-                cur->prev->next = cur->next;
-            }
-            else
-            {
-                queue->head = cur->next;
-            }
-            queue->count--;
-            count++;
-
-            next = cur->next;
-
-            if (cur->packet.buffer)
-            {
-                ret = ARSTREAM2_RTP_PacketFifoUnrefBuffer(fifo, cur->packet.buffer);
-                if (ret != 0)
-                {
-                    ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "ARSTREAM2_RTP_PacketFifoUnrefBuffer() failed (%d)", ret);
-                }
-            }
-            ret = ARSTREAM2_RTP_PacketFifoPushFreeItem(fifo, cur);
-            if (ret < 0)
-            {
-                ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "Failed to push free FIFO item");
                 return -1;
             }
-        }
-        else
-        {
-            next = cur->next;
+            count++;
         }
     }
 
@@ -869,6 +1993,7 @@ int ARSTREAM2_RTP_Sender_PacketFifoRandomDrop(ARSTREAM2_RTP_SenderContext_t *con
                 ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "ARSTREAM2_RTP_Sender_FinishPacket() failed (%d)", ret);
             }
 
+            ARSTREAM2_RTP_PacketFifoQueueUnbucketItem(queue, cur);
             if (cur->next)
             {
                 cur->next->prev = cur->prev;
@@ -887,6 +2012,7 @@ int ARSTREAM2_RTP_Sender_PacketFifoRandomDrop(ARSTREAM2_RTP_SenderContext_t *con
             }
             queue->count--;
             count++;
+            ARSTREAM2_RTP_PacketFifoQueueUnindexItem(queue, cur);
 
             next = cur->next;
 
@@ -1117,7 +2243,9 @@ int ARSTREAM2_RTP_Sender_FinishPacket(ARSTREAM2_RTP_SenderContext_t *context, AR
         return -1;
     }
 
-    if (dropped)
+    /* like an RFC 4588 retransmission stream, the NACK retransmissions are kept out of the
+     * sent and dropped packet statistics (the packet was already counted when first sent) */
+    if ((dropped) && (!packet->retransmitted))
     {
         context->droppedPacketCount++;
         context->droppedByteIntegral += packet->payloadSize;
@@ -1125,7 +2253,7 @@ int ARSTREAM2_RTP_Sender_FinishPacket(ARSTREAM2_RTP_SenderContext_t *context, AR
         context->inputToDroppedTimeIntegral += (curTime - packet->inputTimestamp);
         context->inputToDroppedTimeIntegralSq += ((curTime - packet->inputTimestamp) * (curTime - packet->inputTimestamp));
     }
-    else
+    else if (!packet->retransmitted)
     {
         context->sentPacketCount++;
         context->sentByteIntegral += packet->payloadSize;
@@ -1160,6 +2288,8 @@ int ARSTREAM2_RTP_Receiver_PacketFifoFillMsgVec(ARSTREAM2_RTP_PacketFifo_t *fifo
         return -1;
     }
 
+    ARSTREAM2_RTP_PacketFifoReclaimBuffers(fifo);
+
     if (!fifo->bufferFree)
     {
         ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "Packet FIFO is full => flush to recover");
@@ -1188,6 +2318,14 @@ int ARSTREAM2_RTP_Receiver_PacketFifoFillMsgVec(ARSTREAM2_RTP_PacketFifo_t *fifo
         msgVec[i].msg_hdr.msg_namelen = 0;
         msgVec[i].msg_hdr.msg_iov = cur->msgIov;
         msgVec[i].msg_hdr.msg_iovlen = 2;
+
+        if (fifo->overflowSpill)
+        {
+            /* large datagrams spill into the shared overflow area */
+            cur->msgIov[2].iov_base = fifo->overflowSpill;
+            cur->msgIov[2].iov_len = fifo->overflowSpillSize;
+            msgVec[i].msg_hdr.msg_iovlen = 3;
+        }
         msgVec[i].msg_hdr.msg_control = NULL;
         msgVec[i].msg_hdr.msg_controllen = 0;
         msgVec[i].msg_hdr.msg_flags = 0;
@@ -1198,6 +2336,142 @@ int ARSTREAM2_RTP_Receiver_PacketFifoFillMsgVec(ARSTREAM2_RTP_PacketFifo_t *fifo
 }
 
 
+/* WARNING: the call sequence ARSTREAM2_RTP_Receiver_PacketFifoFillGroMsg -> recvmsg -> ARSTREAM2_RTP_Receiver_PacketFifoSplitGroMsg
+   -> ARSTREAM2_RTP_Receiver_PacketFifoAddFromMsgVec must not be broken (no change made to the free items list) */
+int ARSTREAM2_RTP_Receiver_PacketFifoFillGroMsg(ARSTREAM2_RTP_PacketFifo_t *fifo, struct msghdr *msg, struct iovec *iov,
+                                                unsigned int maxBufferCount, unsigned int *segmentSize)
+{
+    ARSTREAM2_RTP_PacketFifoBuffer_t* cur = NULL;
+    unsigned int i;
+
+    if ((!fifo) || (!msg) || (!iov) || (!segmentSize))
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "Invalid pointer");
+        return -1;
+    }
+
+    ARSTREAM2_RTP_PacketFifoReclaimBuffers(fifo);
+
+    if ((!fifo->bufferFree) || (!fifo->bufferPoolSize))
+    {
+        return 0;
+    }
+
+    if ((*segmentSize <= sizeof(ARSTREAM2_RTP_Header_t)) || (*segmentSize > sizeof(ARSTREAM2_RTP_Header_t) + fifo->bufferFree->bufferSize))
+    {
+        *segmentSize = sizeof(ARSTREAM2_RTP_Header_t) + fifo->bufferFree->bufferSize;
+    }
+
+    for (cur = fifo->bufferFree, i = 0; ((cur) && (i < maxBufferCount)); cur = cur->next, i++)
+    {
+        /* RTP header */
+        cur->msgIov[0].iov_base = cur->header;
+        cur->msgIov[0].iov_len = cur->headerSize;
+        iov[2 * i] = cur->msgIov[0];
+
+        /* RTP payload */
+        cur->msgIov[1].iov_base = cur->buffer;
+        cur->msgIov[1].iov_len = cur->bufferSize;
+        iov[2 * i + 1].iov_base = cur->buffer;
+        iov[2 * i + 1].iov_len = *segmentSize - cur->headerSize;
+    }
+
+    msg->msg_name = NULL;
+    msg->msg_namelen = 0;
+    msg->msg_iov = iov;
+    msg->msg_iovlen = 2 * i;
+    msg->msg_flags = 0;
+
+    return i;
+}
+
+
+int ARSTREAM2_RTP_Receiver_PacketFifoSplitGroMsg(struct iovec *iov, unsigned int bufferCount, unsigned int bufferSize,
+                                                 unsigned int layoutSegmentSize, unsigned int recvSize, unsigned int recvSegmentSize,
+                                                 uint8_t *copyBuffer, struct mmsghdr *msgVec, unsigned int msgVecCount)
+{
+    unsigned int i, k, offset, size, segmentCount;
+
+    if ((!iov) || (!msgVec))
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "Invalid pointer");
+        return -1;
+    }
+
+    if ((recvSegmentSize == 0) || (recvSegmentSize > sizeof(ARSTREAM2_RTP_Header_t) + bufferSize))
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "Invalid GRO segment size (%d)", recvSegmentSize);
+        return -1;
+    }
+
+    segmentCount = (recvSize + recvSegmentSize - 1) / recvSegmentSize;
+    if (segmentCount > bufferCount)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_WARNING, ARSTREAM2_RTP_TAG, "GRO segments dropped (%d segments for %d buffers)", segmentCount, bufferCount);
+        segmentCount = bufferCount;
+    }
+    if (segmentCount > msgVecCount)
+    {
+        segmentCount = msgVecCount;
+    }
+
+    if ((recvSegmentSize != layoutSegmentSize) && (segmentCount > 1))
+    {
+        /* the segments are not aligned on the buffers: gather then scatter */
+        if (!copyBuffer)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_TAG, "Invalid copy buffer");
+            return -1;
+        }
+        for (k = 0, offset = 0; (k < 2 * bufferCount) && (offset < recvSize); k++)
+        {
+            size = (iov[k].iov_len < recvSize - offset) ? iov[k].iov_len : recvSize - offset;
+            memcpy(copyBuffer + offset, iov[k].iov_base, size);
+            offset += size;
+        }
+        for (i = 0, offset = 0; i < segmentCount; i++, offset += recvSegmentSize)
+        {
+            size = (recvSegmentSize < recvSize - offset) ? recvSegmentSize : recvSize - offset;
+            if (size > iov[2 * i].iov_len)
+            {
+                memcpy(iov[2 * i].iov_base, copyBuffer + offset, iov[2 * i].iov_len);
+                memcpy(iov[2 * i + 1].iov_base, copyBuffer + offset + iov[2 * i].iov_len, size - iov[2 * i].iov_len);
+            }
+            else
+            {
+                memcpy(iov[2 * i].iov_base, copyBuffer + offset, size);
+            }
+        }
+    }
+    else if ((segmentCount == 1) && (recvSize > layoutSegmentSize))
+    {
+        /* single datagram larger than the layout segment: move the tail back to the first buffer */
+        offset = layoutSegmentSize;
+        for (k = 2; (k < 2 * bufferCount) && (offset < recvSize); k++)
+        {
+            size = (iov[k].iov_len < recvSize - offset) ? iov[k].iov_len : recvSize - offset;
+            memcpy((uint8_t*)iov[1].iov_base + offset - iov[0].iov_len, iov[k].iov_base, size);
+            offset += size;
+        }
+    }
+
+    for (i = 0, offset = 0; i < segmentCount; i++, offset += recvSegmentSize)
+    {
+        /* each segment is complete in its own buffer (no spill, no truncation) */
+        msgVec[i].msg_hdr.msg_name = NULL;
+        msgVec[i].msg_hdr.msg_namelen = 0;
+        msgVec[i].msg_hdr.msg_iov = &iov[2 * i];
+        msgVec[i].msg_hdr.msg_iovlen = 2;
+        msgVec[i].msg_hdr.msg_control = NULL;
+        msgVec[i].msg_hdr.msg_controllen = 0;
+        msgVec[i].msg_hdr.msg_flags = 0;
+        msgVec[i].msg_len = (recvSegmentSize < recvSize - offset) ? recvSegmentSize : recvSize - offset;
+    }
+
+    return segmentCount;
+}
+
+
 static int ARSTREAM2_RTP_Receiver_PacketFifoResendEnqueue(ARSTREAM2_RTP_PacketFifo_t *fifo, ARSTREAM2_RTP_PacketFifoQueue_t *queue, ARSTREAM2_RTP_PacketFifoItem_t *item, uint64_t curTime, uint32_t timeout)
 {
     int err = 0, ret = 0, needUnref = 0, needFree = 0;
@@ -1268,6 +2542,147 @@ static int ARSTREAM2_RTP_Receiver_PacketFifoResendEnqueue(ARSTREAM2_RTP_PacketFi
 }
 
 
+/* Reclaim only the overflow class buffers from the return stack; the regular buffers are pushed back
+   for the next ARSTREAM2_RTP_PacketFifoReclaimBuffers call as this runs between
+   ARSTREAM2_RTP_Receiver_PacketFifoFillMsgVec and ARSTREAM2_RTP_Receiver_PacketFifoAddFromMsgVec
+   where the free buffers list must not change */
+static void ARSTREAM2_RTP_Receiver_PacketFifoReclaimOverflowBuffers(ARSTREAM2_RTP_PacketFifo_t *fifo)
+{
+    ARSTREAM2_RTP_PacketFifoBuffer_t *cur, *next, *keepHead = NULL, *keepTail = NULL, *head;
+
+    if (!__atomic_load_n(&fifo->bufferReturn, __ATOMIC_RELAXED))
+    {
+        return;
+    }
+
+    for (cur = __atomic_exchange_n(&fifo->bufferReturn, NULL, __ATOMIC_ACQUIRE); cur; cur = next)
+    {
+        next = cur->next;
+        if (cur->overflow)
+        {
+            cur->prev = NULL;
+            cur->next = fifo->overflowFree;
+            fifo->overflowFree = cur;
+        }
+        else
+        {
+            cur->next = NULL;
+            if (keepTail)
+            {
+                keepTail->next = cur;
+            }
+            else
+            {
+                keepHead = cur;
+            }
+            keepTail = cur;
+        }
+    }
+
+    if (keepHead)
+    {
+        head = __atomic_load_n(&fifo->bufferReturn, __ATOMIC_RELAXED);
+        do
+        {
+            keepTail->next = head;
+        }
+        while (!__atomic_compare_exchange_n(&fifo->bufferReturn, &head, keepHead, 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+    }
+}
+
+
+static ARSTREAM2_RTP_PacketFifoBuffer_t* ARSTREAM2_RTP_Receiver_PacketFifoGetOverflowBuffer(ARSTREAM2_RTP_PacketFifo_t *fifo)
+{
+    ARSTREAM2_RTP_PacketFifoBuffer_t* cur;
+
+    if (!fifo->overflowFree)
+    {
+        ARSTREAM2_RTP_Receiver_PacketFifoReclaimOverflowBuffers(fifo);
+    }
+
+    cur = fifo->overflowFree;
+    if (cur)
+    {
+        fifo->overflowFree = cur->next;
+        cur->prev = NULL;
+        cur->next = NULL;
+        cur->msgIov[0].iov_base = cur->header;
+        cur->msgIov[1].iov_base = cur->buffer;
+        __atomic_store_n(&cur->refCount, 1, __ATOMIC_RELAXED);
+    }
+
+    return cur;
+}
+
+
+void ARSTREAM2_RTP_Receiver_ClockSkewAddSample(ARSTREAM2_RTP_ReceiverContext_t *context, int64_t clockSkew, uint64_t curTime)
+{
+    unsigned int head = context->clockSkewWindowHead;
+    unsigned int size = context->clockSkewWindowSize;
+
+    if (context->clockSkewWindowStartTimestamp == 0)
+    {
+        context->clockSkewWindowStartTimestamp = curTime;
+        context->clockSkewUpdateTimestamp = curTime;
+    }
+
+    /* the samples greater than or equal to the new one can no longer be the minimum */
+    while ((size > 0) && (context->clockSkewWindow[(head + size - 1) % ARSTREAM2_RTP_CLOCKSKEW_WINDOW_SIZE] >= clockSkew))
+    {
+        size--;
+    }
+
+    /* remove the samples older than the window duration */
+    while ((size > 0) && (curTime >= context->clockSkewWindowTimestamp[head] + ARSTREAM2_RTP_CLOCKSKEW_WINDOW_DURATION))
+    {
+        head = (head + 1) % ARSTREAM2_RTP_CLOCKSKEW_WINDOW_SIZE;
+        size--;
+    }
+
+    if (size < ARSTREAM2_RTP_CLOCKSKEW_WINDOW_SIZE)
+    {
+        context->clockSkewWindow[(head + size) % ARSTREAM2_RTP_CLOCKSKEW_WINDOW_SIZE] = clockSkew;
+        context->clockSkewWindowTimestamp[(head + size) % ARSTREAM2_RTP_CLOCKSKEW_WINDOW_SIZE] = curTime;
+        size++;
+    }
+    else
+    {
+        /* on a long increasing run the deque is full: drop the new sample, which is greater
+           than all the others, rather than the front one which is the window minimum */
+        context->clockSkewWindowDropCount++;
+    }
+    context->clockSkewWindowHead = head;
+    context->clockSkewWindowSize = size;
+
+    if ((curTime < context->clockSkewWindowStartTimestamp + ARSTREAM2_RTP_CLOCKSKEW_WINDOW_DURATION)
+            || (curTime < context->clockSkewUpdateTimestamp + ARSTREAM2_RTP_CLOCKSKEW_UPDATE_INTERVAL))
+    {
+        /* the window does not span its full duration yet or the last update is too recent */
+        return;
+    }
+
+    /* Minimum clock skew in the window */
+    context->clockSkewMin = context->clockSkewWindow[head];
+    context->clockSkewUpdateTimestamp = curTime;
+
+    /* Average min clock skew */
+    if (!context->clockSkewInit)
+    {
+        context->clockSkewOffset = context->clockSkewMin;
+        context->clockSkewMinAvg = 0;
+        context->clockSkewInit = 1;
+    }
+    else
+    {
+        /* Sliding average, alpha = 1 / ARSTREAM2_RTP_CLOCKSKEW_AVG_ALPHA; the average is kept scaled by
+           ARSTREAM2_RTP_CLOCKSKEW_AVG_ALPHA so that deviations smaller than alpha are not rounded away */
+        context->clockSkewMinAvg = context->clockSkewMinAvg + (context->clockSkewMin - context->clockSkewOffset)
+                                   - context->clockSkewMinAvg / ARSTREAM2_RTP_CLOCKSKEW_AVG_ALPHA;
+    }
+    context->clockSkew = (context->clockSkewMinAvg * 1000000 / ARSTREAM2_RTP_CLOCKSKEW_AVG_ALPHA + context->rtpClockRate / 2) / context->rtpClockRate;
+}
+
+
 /* WARNING: the call sequence ARSTREAM2_RTP_Receiver_PacketFifoFillMsgVec -> recvmmsg -> ARSTREAM2_RTP_Receiver_PacketFifoAddFromMsgVec
    must not be broken (no change made to the free items list) */
 int ARSTREAM2_RTP_Receiver_PacketFifoAddFromMsgVec(ARSTREAM2_RTP_ReceiverContext_t *context,
@@ -1279,8 +2694,9 @@ int ARSTREAM2_RTP_Receiver_PacketFifoAddFromMsgVec(ARSTREAM2_RTP_ReceiverContext
     ARSTREAM2_RTP_PacketFifoItem_t* item = NULL;
     ARSTREAM2_RTP_PacketFifoBuffer_t *buffer = NULL;
     ARSTREAM2_RTP_PacketFifoItem_t* garbage = NULL;
+    ARSTREAM2_RTP_PacketFifoBuffer_t *released = NULL;
     int ret = 0, resendRet, garbageCount = 0, garbageCount2 = 0;
-    unsigned int i, k, popCount = 0, enqueueCount = 0;
+    unsigned int i, k, popCount = 0, enqueueCount = 0, lastSpill = msgVecCount;
 
     if ((!context) || (!fifo) || (!rtcpContext))
     {
@@ -1302,6 +2718,18 @@ int ARSTREAM2_RTP_Receiver_PacketFifoAddFromMsgVec(ARSTREAM2_RTP_ReceiverContext
 
     uint64_t recvRtpTimestamp = (curTime * context->rtpClockRate + 500000) / 1000000;
 
+    if (fifo->overflowSpill)
+    {
+        /* the spill area is shared: only the last datagram that spilled into it is intact */
+        for (i = 0; i < msgVecCount; i++)
+        {
+            if ((msgVec[i].msg_hdr.msg_iovlen > 2) && (msgVec[i].msg_len > msgVec[i].msg_hdr.msg_iov[0].iov_len + msgVec[i].msg_hdr.msg_iov[1].iov_len))
+            {
+                lastSpill = i;
+            }
+        }
+    }
+
     for (i = 0; i < msgVecCount; i++)
     {
         buffer = ARSTREAM2_RTP_PacketFifoGetBuffer(fifo);
@@ -1311,7 +2739,58 @@ int ARSTREAM2_RTP_Receiver_PacketFifoAddFromMsgVec(ARSTREAM2_RTP_ReceiverContext
             ARSTREAM2_RTP_PacketReset(&item->packet);
             item->packet.buffer = buffer;
             popCount++;
-            if (msgVec[i].msg_len > sizeof(ARSTREAM2_RTP_Header_t))
+            if ((msgVec[i].msg_hdr.msg_flags & MSG_TRUNC) || (msgVec[i].msg_len > sizeof(ARSTREAM2_RTP_Header_t) + buffer->bufferSize))
+            {
+                /* datagram larger than the packet buffer: move it to an overflow buffer
+                 * (the packet buffer is released after the loop to keep the free list order) */
+                ARSTREAM2_RTP_PacketFifoBuffer_t *overflow = ((i == lastSpill) && (!(msgVec[i].msg_hdr.msg_flags & MSG_TRUNC)))
+                        ? ARSTREAM2_RTP_Receiver_PacketFifoGetOverflowBuffer(fifo) : NULL;
+                if (overflow)
+                {
+                    memcpy(overflow->header, buffer->header, sizeof(ARSTREAM2_RTP_Header_t));
+                    memcpy(overflow->buffer, buffer->buffer, buffer->bufferSize);
+                    memcpy(overflow->buffer + buffer->bufferSize, fifo->overflowSpill, msgVec[i].msg_len - sizeof(ARSTREAM2_RTP_Header_t) - buffer->bufferSize);
+                    buffer->next = released;
+                    released = buffer;
+                    buffer = overflow;
+                    item->packet.buffer = overflow;
+                    __atomic_store_n(&fifo->overflowCount, fifo->overflowCount + 1, __ATOMIC_RELAXED);
+                }
+                else
+                {
+                    ARSAL_PRINT(ARSAL_PRINT_WARNING, ARSTREAM2_RTP_TAG, "Truncated datagram dropped (%d bytes)", msgVec[i].msg_len);
+                    __atomic_store_n(&fifo->truncatedCount, fifo->truncatedCount + 1, __ATOMIC_RELAXED);
+                    msgVec[i].msg_len = 0;
+                }
+            }
+            if ((msgVec[i].msg_len > sizeof(ARSTREAM2_RTP_Header_t))
+                    && (ARSTREAM2_RTPFEC_IS_REPAIR_PACKET(ntohs(((ARSTREAM2_RTP_Header_t*)buffer->header)->flags))))
+            {
+                /* FEC repair packet: not part of the media sequence number space */
+                ret = ((context->fecCtx) && (context->previousExtSeqNum != -1))
+                        ? ARSTREAM2_RTPFEC_Receiver_AddRepairPacket(context->fecCtx, item, context->extHighestSeqNum, msgVec[i].msg_len, curTime)
+                        : -2;
+                if (ret == 0)
+                {
+                    enqueueCount++;
+                }
+                else
+                {
+                    /* unused repair packet, flag the item for garbage collection */
+                    garbageCount++;
+                    if (!garbage)
+                    {
+                        garbage = item;
+                    }
+                    else
+                    {
+                        item->next = garbage;
+                        garbage->prev = item;
+                        garbage = item;
+                    }
+                }
+            }
+            else if (msgVec[i].msg_len > sizeof(ARSTREAM2_RTP_Header_t))
             {
                 uint16_t flags;
                 int seqNumDelta = 0;
@@ -1339,6 +2818,18 @@ int ARSTREAM2_RTP_Receiver_PacketFifoAddFromMsgVec(ARSTREAM2_RTP_ReceiverContext
                         context->extHighestSeqNum = item->packet.extSeqNum;
                         rtcpContext->extHighestSeqNum = context->extHighestSeqNum;
                     }
+                    if (rtcpContext->nackCtx.enabled)
+                    {
+                        if (seqNumDelta > 1)
+                        {
+                            ARSTREAM2_RTCP_NackAddMissing(&rtcpContext->nackCtx, item->packet.extSeqNum - seqNumDelta + 1, item->packet.extSeqNum - 1, curTime);
+                        }
+                        else if (seqNumDelta < 0)
+                        {
+                            /* out of order or retransmitted packet */
+                            ARSTREAM2_RTCP_NackSetReceived(&rtcpContext->nackCtx, item->packet.extSeqNum);
+                        }
+                    }
                     item->packet.extRtpTimestamp = (context->extHighestRtpTimestamp & 0xFFFFFFFF00000000ULL) | ((uint64_t)item->packet.rtpTimestamp & 0xFFFFFFFFULL);
                     if ((int64_t)item->packet.extRtpTimestamp - (int64_t)context->previousExtRtpTimestamp < -2147483648LL)
                     {
@@ -1435,50 +2926,7 @@ int ARSTREAM2_RTP_Receiver_PacketFifoAddFromMsgVec(ARSTREAM2_RTP_ReceiverContext
                         int64_t clockSkew = ((int64_t)recvRtpTimestamp - (int64_t)context->firstRecvRtpTimestamp)
                                             - ((int64_t)item->packet.extRtpTimestamp - (int64_t)context->firstExtRtpTimestamp);
 
-                        /* initialize the window */
-                        if (context->clockSkewWindowSize == 0)
-                        {
-                            context->clockSkewWindowStartTimestamp = curTime;
-                        }
-
-                        /* fill the window */
-                        context->clockSkewWindow[context->clockSkewWindowSize] = clockSkew;
-                        context->clockSkewWindowSize++;
-
-                        if ((context->clockSkewWindowSize >= ARSTREAM2_RTP_CLOCKSKEW_WINDOW_SIZE)
-                                || ((context->clockSkewWindowSize >= ARSTREAM2_RTP_CLOCKSKEW_WINDOW_SIZE / 2) && (curTime >= context->clockSkewWindowStartTimestamp + ARSTREAM2_RTP_CLOCKSKEW_WINDOW_TIMEOUT)))
-                        {
-                            /* window is full or half-full and on timeout */
-                            int i;
-                            context->clockSkewMin = context->clockSkewWindow[0];
-
-                            /* Find the minimum clock skew in the window */
-                            for (i = 0; i < context->clockSkewWindowSize; i++)
-                            {
-                                if (context->clockSkewWindow[i] < context->clockSkewMin)
-                                {
-                                    context->clockSkewMin = context->clockSkewWindow[i];
-                                }
-                            }
-
-                            /* Average min clock skew */
-                            if (!context->clockSkewInit)
-                            {
-                                context->clockSkewOffset = context->clockSkewMin;
-                                context->clockSkewMinAvg = context->clockSkewMin - context->clockSkewOffset;
-                                context->clockSkewInit = 1;
-                            }
-                            else
-                            {
-                                /* Sliding average, alpha = 1 / ARSTREAM2_RTP_CLOCKSKEW_AVG_ALPHA */
-                                context->clockSkewMinAvg = context->clockSkewMinAvg
-                                                           + (context->clockSkewMin - context->clockSkewOffset - context->clockSkewMinAvg + ARSTREAM2_RTP_CLOCKSKEW_AVG_ALPHA / 2) / ARSTREAM2_RTP_CLOCKSKEW_AVG_ALPHA;
-                            }
-                            context->clockSkew = (context->clockSkewMinAvg * 1000000 + context->rtpClockRate / 2) / context->rtpClockRate;
-
-                            /* Reset the window */
-                            context->clockSkewWindowSize = 0;
-                        }
+                        ARSTREAM2_RTP_Receiver_ClockSkewAddSample(context, clockSkew, curTime);
                     }
 
                     /* interarrival jitter computation */
@@ -1499,6 +2947,15 @@ int ARSTREAM2_RTP_Receiver_PacketFifoAddFromMsgVec(ARSTREAM2_RTP_ReceiverContext
                 item->packet.ntpTimestampLocal = ((rtcpContext->clockDeltaCtx.clockDeltaAvg != 0) && (item->packet.ntpTimestamp != 0)) ? (item->packet.ntpTimestamp - rtcpContext->clockDeltaCtx.clockDeltaAvg) : 0;
                 item->packet.timeoutTimestamp = curTime + context->nominalDelay; //TODO: compute the expected arrival time
 
+                if ((ret >= 0) && (context->fecCtx))
+                {
+                    int fecRet = ARSTREAM2_RTPFEC_Receiver_AddMediaPacket(context->fecCtx, &item->packet);
+                    if (fecRet < 0)
+                    {
+                        ARSAL_PRINT(ARSAL_PRINT_VERBOSE, ARSTREAM2_RTP_TAG, "ARSTREAM2_RTPFEC_Receiver_AddMediaPacket() failed (%d)", fecRet);
+                    }
+                }
+
                 if (ret >= 0)
                 {
                     for (k = 0; k < resendCount; k++)
@@ -1536,6 +2993,14 @@ int ARSTREAM2_RTP_Receiver_PacketFifoAddFromMsgVec(ARSTREAM2_RTP_ReceiverContext
         }
     }
 
+    while (released)
+    {
+        ARSTREAM2_RTP_PacketFifoBuffer_t* next = released->next;
+        released->next = NULL;
+        ARSTREAM2_RTP_PacketFifoUnrefBuffer(fifo, released);
+        released = next;
+    }
+
     while (garbage)
     {
         garbageCount2++;
@@ -13,6 +13,7 @@
 #include <sys/socket.h>
 #undef __USE_GNU
 
+#include <libARStream2/arstream2_stream_sender.h>
 #include "arstream2_rtcp.h"
 
 
@@ -26,9 +27,22 @@
 #define ARSTREAM2_RTP_SENDER_SSRC 0x41525353
 #define ARSTREAM2_RTP_RECEIVER_SSRC 0x41525352
 
-#define ARSTREAM2_RTP_CLOCKSKEW_WINDOW_SIZE 400
-#define ARSTREAM2_RTP_CLOCKSKEW_WINDOW_TIMEOUT 5000000
-#define ARSTREAM2_RTP_CLOCKSKEW_AVG_ALPHA 64
+#define ARSTREAM2_RTP_CLOCKSKEW_WINDOW_SIZE 1024            /* sliding minimum deque capacity (power of 2, one sample per access unit: up to 200 fps over the window duration) */
+#define ARSTREAM2_RTP_CLOCKSKEW_WINDOW_DURATION 5000000
+#define ARSTREAM2_RTP_CLOCKSKEW_UPDATE_INTERVAL 1000000
+#define ARSTREAM2_RTP_CLOCKSKEW_AVG_ALPHA 16                /* one update per interval: 16 s averaging */
+
+#define ARSTREAM2_RTP_PACKET_MAX_IOV_COUNT 3
+
+#define ARSTREAM2_RTP_SENDER_RETRANSMIT_CACHE_DEFAULT_SIZE 256
+#define ARSTREAM2_RTP_SENDER_RETRANSMIT_CACHE_DEFAULT_TIMEOUT 300000
+
+/* Packet FIFO arena flags */
+#define ARSTREAM2_RTP_PACKET_FIFO_ARENA_HUGE_PAGES (1 << 0)     /* explicit huge pages (MAP_HUGETLB), transparent huge pages as a fallback */
+#define ARSTREAM2_RTP_PACKET_FIFO_ARENA_LOCK (1 << 1)           /* lock the arena in memory (mlock) */
+
+#define ARSTREAM2_RTP_PACKET_FIFO_ARENA_ALIGN 64
+#define ARSTREAM2_RTP_PACKET_FIFO_ARENA_HUGE_PAGE_SIZE (2 * 1024 * 1024)
 
 
 /*
@@ -77,6 +91,11 @@ typedef struct ARSTREAM2_RTP_RtpStats_s
         uint64_t inputToSentTimeIntegralSq;
         uint64_t inputToDroppedTimeIntegral;
         uint64_t inputToDroppedTimeIntegralSq;
+        uint32_t pacedPacketCount;
+        uint64_t pacingDelayIntegral;
+        uint64_t pacingDelayIntegralSq;
+        uint32_t fecRepairPacketCount;
+        uint32_t fecUnprotectedPacketCount;
     } senderStats;
     struct {
         uint64_t timestamp;
@@ -124,9 +143,11 @@ typedef struct ARSTREAM2_RTP_PacketFifoBuffer_s
     unsigned int bufferSize;
     uint8_t *header;
     unsigned int headerSize;
-    struct iovec msgIov[3];
+    struct iovec msgIov[ARSTREAM2_RTP_PACKET_MAX_IOV_COUNT];
 
     unsigned int refCount;
+    struct ARSTREAM2_RTP_PacketFifo_s *owner;   /* FIFO of the buffer pool (the buffer is given back to it when unreferenced from another FIFO) */
+    int overflow;                               /* buffer of the overflow class (given back to the owner overflowFree list) */
     struct ARSTREAM2_RTP_PacketFifoBuffer_s* prev;
     struct ARSTREAM2_RTP_PacketFifoBuffer_s* next;
 
@@ -159,6 +180,7 @@ typedef struct ARSTREAM2_RTP_Packet_s
     uint32_t importance;
     uint32_t priority;
     size_t msgIovLength;
+    int retransmitted;                          /* sender: NACK retransmission of an already sent packet */
 
 } ARSTREAM2_RTP_Packet_t;
 
@@ -173,6 +195,8 @@ typedef struct ARSTREAM2_RTP_PacketFifoItem_s
     struct ARSTREAM2_RTP_PacketFifoItem_s* prev;
     struct ARSTREAM2_RTP_PacketFifoItem_s* next;
 
+    unsigned int timeoutHeapIndex;
+
 } ARSTREAM2_RTP_PacketFifoItem_t;
 
 
@@ -185,6 +209,25 @@ typedef struct ARSTREAM2_RTP_PacketFifoQueue_s
     ARSTREAM2_RTP_PacketFifoItem_t *head;
     ARSTREAM2_RTP_PacketFifoItem_t *tail;
 
+    /* optional extSeqNum indexed ring (power of two size), used by ARSTREAM2_RTP_PacketFifoEnqueueItemOrderedBySeqNum */
+    ARSTREAM2_RTP_PacketFifoItem_t **seqNumIndex;
+    unsigned int seqNumIndexSize;
+    int seqNumIndexValid;
+
+    /* per priority level FIFOs of the newest access unit (contiguous runs at the tail of the queue)
+       with a bitmap of the non-empty levels, used by ARSTREAM2_RTP_PacketFifoEnqueueItemOrderedByPriority */
+    ARSTREAM2_RTP_PacketFifoItem_t *priorityHead[ARSTREAM2_STREAM_SENDER_MAX_PRIORITY_LEVELS];
+    ARSTREAM2_RTP_PacketFifoItem_t *priorityTail[ARSTREAM2_STREAM_SENDER_MAX_PRIORITY_LEVELS];
+    uint32_t priorityMask;
+    uint32_t priorityRtpTimestamp;
+    int priorityValid;
+
+    /* optional min-heap of the items with a timeout, used by ARSTREAM2_RTP_Sender_PacketFifoCleanFromTimeout */
+    ARSTREAM2_RTP_PacketFifoItem_t **timeoutHeap;
+    unsigned int timeoutHeapSize;
+    unsigned int timeoutHeapCount;
+    int timeoutHeapValid;
+
     struct ARSTREAM2_RTP_PacketFifoQueue_s* prev;
     struct ARSTREAM2_RTP_PacketFifoQueue_s* next;
 
@@ -205,9 +248,100 @@ typedef struct ARSTREAM2_RTP_PacketFifo_s
     ARSTREAM2_RTP_PacketFifoBuffer_t *bufferPool;
     ARSTREAM2_RTP_PacketFifoBuffer_t *bufferFree;
 
+    /* buffers released from other threads (lock-free stack, moved back
+       to bufferFree by the owner thread in ARSTREAM2_RTP_PacketFifoReclaimBuffers) */
+    ARSTREAM2_RTP_PacketFifoBuffer_t *bufferReturn;
+
+    /* overflow buffer class for the rare received datagrams larger than the pool packet buffers;
+       the bytes beyond the packet buffer spill into overflowSpill and the datagram is copied to an overflow buffer */
+    int overflowPoolSize;
+    ARSTREAM2_RTP_PacketFifoBuffer_t *overflowPool;
+    ARSTREAM2_RTP_PacketFifoBuffer_t *overflowFree;
+    uint8_t *overflowSpill;
+    unsigned int overflowSpillSize;
+    uint64_t overflowCount;
+    uint64_t truncatedCount;
+
+    /* single mmap'd region holding the pools and the packet buffers (NULL for heap allocations) */
+    uint8_t *arena;
+    size_t arenaSize;
+    size_t arenaUsed;
+    size_t footprint;
+
+    /* usage (the counts are only written by the owner thread, the high watermarks can be reset from any thread) */
+    int itemUsedCount;
+    int itemHighWatermark;
+    int bufferUsedCount;
+    int bufferHighWatermark;
+
 } ARSTREAM2_RTP_PacketFifo_t;
 
 
+/**
+ * @brief RTP packet FIFO memory usage
+ */
+typedef struct ARSTREAM2_RTP_PacketFifoUsage_s
+{
+    size_t footprint;
+    int isArena;
+    int itemPoolSize;
+    int itemUsedCount;
+    int itemHighWatermark;
+    int bufferPoolSize;
+    int bufferUsedCount;
+    int bufferHighWatermark;
+    int overflowPoolSize;
+    uint64_t overflowCount;
+    uint64_t truncatedCount;
+
+} ARSTREAM2_RTP_PacketFifoUsage_t;
+
+
+/**
+ * @brief RTP packet ring
+ * Lock-free single-producer/single-consumer handoff of packets between threads;
+ * the packet buffer reference is transferred with the packet.
+ */
+typedef struct ARSTREAM2_RTP_PacketRing_s
+{
+    ARSTREAM2_RTP_Packet_t *packet;
+    unsigned int mask;
+    unsigned int head;
+    unsigned int tail;
+
+} ARSTREAM2_RTP_PacketRing_t;
+
+
+/**
+ * @brief RTP sender retransmission cache entry
+ */
+typedef struct ARSTREAM2_RTP_RetransmitCacheEntry_s
+{
+    ARSTREAM2_RTP_Packet_t packet;
+    uint64_t sendTimestamp;
+    int valid;
+
+} ARSTREAM2_RTP_RetransmitCacheEntry_t;
+
+
+struct ARSTREAM2_RTPFEC_SenderContext_s;
+struct ARSTREAM2_RTPFEC_ReceiverContext_s;
+struct ARSTREAM2_RTP_SenderContext_s;
+
+
+/**
+ * @brief RTP sender fan-out destination
+ */
+typedef struct ARSTREAM2_RTP_SenderFanOut_s
+{
+    struct ARSTREAM2_RTP_SenderContext_s *context;  /* destination sender context (packet and byte counts for the sender reports) */
+    ARSTREAM2_RTP_PacketFifoQueue_t *queue;         /* destination queue (in the same packet FIFO) */
+    uint32_t maxLatencyUs;
+    uint32_t maxNetworkLatencyUs[ARSTREAM2_STREAM_SENDER_MAX_IMPORTANCE_LEVELS];
+
+} ARSTREAM2_RTP_SenderFanOut_t;
+
+
 typedef void (*ARSTREAM2_RTP_SenderMonitoringCallback_t)(uint64_t inputTimestamp, uint64_t outputTimestamp,
                                                          uint64_t ntpTimestamp, uint32_t rtpTimestamp,
                                                          uint16_t seqNum, uint16_t markerBit,
@@ -259,6 +393,22 @@ typedef struct ARSTREAM2_RTP_SenderContext_s
     uint64_t inputToDroppedTimeIntegral;
     uint64_t inputToDroppedTimeIntegralSq;
 
+    /* optional retransmission cache (power of two size, indexed by seqNum), holds a reference on sent packet buffers */
+    ARSTREAM2_RTP_RetransmitCacheEntry_t *retransmitCache;
+    unsigned int retransmitCacheSize;
+    unsigned int retransmitCacheOldest;
+    unsigned int retransmitCacheNewest;
+    uint32_t retransmitCacheTimeout;
+    uint32_t retransmittedPacketCount;
+    uint32_t retransmitMissCount;
+
+    /* optional FEC stage, repair packets are generated after each enqueued media packet */
+    struct ARSTREAM2_RTPFEC_SenderContext_s *fecCtx;
+
+    /* optional fan-out destinations, each enqueued packet is duplicated to the destination queues (the buffer is shared) */
+    ARSTREAM2_RTP_SenderFanOut_t *fanOut;
+    unsigned int fanOutCount;
+
     void *auCallback;
     void *auCallbackUserPtr;
     uint64_t lastAuCallbackTimestamp;
@@ -285,15 +435,24 @@ typedef struct ARSTREAM2_RTP_ReceiverContext_s
     uint64_t previousRecvRtpTimestamp;
     uint64_t firstExtRtpTimestamp;
     uint64_t firstRecvRtpTimestamp;
+    /* clock skew sliding minimum: monotonic deque of the samples that can still
+       become the window minimum (increasing values, the front is the minimum) */
     int64_t clockSkewWindow[ARSTREAM2_RTP_CLOCKSKEW_WINDOW_SIZE];
-    int clockSkewWindowSize;
+    uint64_t clockSkewWindowTimestamp[ARSTREAM2_RTP_CLOCKSKEW_WINDOW_SIZE];
+    unsigned int clockSkewWindowHead;
+    unsigned int clockSkewWindowSize;
+    uint32_t clockSkewWindowDropCount;  /* samples dropped because the deque was full */
     uint64_t clockSkewWindowStartTimestamp;
+    uint64_t clockSkewUpdateTimestamp;
     int clockSkewInit;
     int64_t clockSkewOffset;
     int64_t clockSkewMin;
-    int64_t clockSkewMinAvg;
+    int64_t clockSkewMinAvg;    /* scaled by ARSTREAM2_RTP_CLOCKSKEW_AVG_ALPHA */
     int64_t clockSkew;
 
+    /* optional FEC stage, repair packets are diverted from the receive queue */
+    struct ARSTREAM2_RTPFEC_ReceiverContext_s *fecCtx;
+
 } ARSTREAM2_RTP_ReceiverContext_t;
 
 
@@ -305,20 +464,53 @@ void ARSTREAM2_RTP_PacketReset(ARSTREAM2_RTP_Packet_t *packet);
 
 void ARSTREAM2_RTP_PacketCopy(ARSTREAM2_RTP_Packet_t *dst, const ARSTREAM2_RTP_Packet_t *src);
 
+/* A bufferMaxCount of 0 creates an item-only FIFO, carrying buffers that belong to another FIFO */
 int ARSTREAM2_RTP_PacketFifoInit(ARSTREAM2_RTP_PacketFifo_t *fifo, int itemMaxCount, int bufferMaxCount, int packetBufferSize);
 
+/* Same as ARSTREAM2_RTP_PacketFifoInit but the items, buffers and packet buffers are carved out
+   of a single mmap'd region; arenaFlags is a combination of ARSTREAM2_RTP_PACKET_FIFO_ARENA_* flags
+   (huge pages and memory locking are best effort) */
+int ARSTREAM2_RTP_PacketFifoInitArena(ARSTREAM2_RTP_PacketFifo_t *fifo, int itemMaxCount, int bufferMaxCount, int packetBufferSize, int arenaFlags);
+
+/* Add an overflow buffer class of bufferMaxCount buffers of packetBufferSize bytes (larger than the pool packet buffers)
+   for receiving datagrams larger than the pool packet buffers; must be called after the FIFO init */
+int ARSTREAM2_RTP_PacketFifoInitOverflow(ARSTREAM2_RTP_PacketFifo_t *fifo, int bufferMaxCount, int packetBufferSize);
+
 int ARSTREAM2_RTP_PacketFifoFree(ARSTREAM2_RTP_PacketFifo_t *fifo);
 
+/* Can be called from any thread; the used counts are approximate when not called from the owner thread.
+   If reset is true the high watermarks restart from the current usage */
+int ARSTREAM2_RTP_PacketFifoGetUsage(ARSTREAM2_RTP_PacketFifo_t *fifo, ARSTREAM2_RTP_PacketFifoUsage_t *usage, int reset);
+
 int ARSTREAM2_RTP_PacketFifoAddQueue(ARSTREAM2_RTP_PacketFifo_t *fifo, ARSTREAM2_RTP_PacketFifoQueue_t *queue);
 
 int ARSTREAM2_RTP_PacketFifoRemoveQueue(ARSTREAM2_RTP_PacketFifo_t *fifo, ARSTREAM2_RTP_PacketFifoQueue_t *queue);
 
+/* Index the queue items by extSeqNum in a ring of windowSize (rounded up to a power of two) slots,
+   so that ARSTREAM2_RTP_PacketFifoEnqueueItemOrderedBySeqNum does not walk the queue. When the
+   queued sequence numbers span more than the window, the linear walk is used until the queue is empty. */
+int ARSTREAM2_RTP_PacketFifoQueueEnableSeqNumIndex(ARSTREAM2_RTP_PacketFifoQueue_t *queue, unsigned int windowSize);
+
+/* Keep the queue items that have a timeout in a min-heap of maxCount entries, so that
+   ARSTREAM2_RTP_Sender_PacketFifoCleanFromTimeout only touches the expired items. If the heap
+   overflows, the whole queue is scanned until it is empty. */
+int ARSTREAM2_RTP_PacketFifoQueueEnableTimeoutHeap(ARSTREAM2_RTP_PacketFifoQueue_t *queue, unsigned int maxCount);
+
+/* Returns the earliest packet timeout in the queue, or 0 if there is none or if the timeout heap is not in use */
+uint64_t ARSTREAM2_RTP_PacketFifoQueueGetNextTimeout(ARSTREAM2_RTP_PacketFifoQueue_t *queue);
+
 ARSTREAM2_RTP_PacketFifoBuffer_t* ARSTREAM2_RTP_PacketFifoGetBuffer(ARSTREAM2_RTP_PacketFifo_t *fifo);
 
 int ARSTREAM2_RTP_PacketFifoBufferAddRef(ARSTREAM2_RTP_PacketFifoBuffer_t *buffer);
 
+/* The buffer can be unreferenced from a FIFO that does not own it (possibly from another thread):
+   it is then given back to its owner FIFO through the lock-free return stack */
 int ARSTREAM2_RTP_PacketFifoUnrefBuffer(ARSTREAM2_RTP_PacketFifo_t *fifo, ARSTREAM2_RTP_PacketFifoBuffer_t *buffer);
 
+/* Move the buffers released from other threads back to the free list; must be called from the FIFO owner thread.
+   Returns the number of reclaimed buffers */
+int ARSTREAM2_RTP_PacketFifoReclaimBuffers(ARSTREAM2_RTP_PacketFifo_t *fifo);
+
 ARSTREAM2_RTP_PacketFifoItem_t* ARSTREAM2_RTP_PacketFifoPopFreeItem(ARSTREAM2_RTP_PacketFifo_t *fifo);
 
 int ARSTREAM2_RTP_PacketFifoPushFreeItem(ARSTREAM2_RTP_PacketFifo_t *fifo, ARSTREAM2_RTP_PacketFifoItem_t *item);
@@ -336,6 +528,32 @@ ARSTREAM2_RTP_PacketFifoItem_t* ARSTREAM2_RTP_PacketFifoPeekItem(ARSTREAM2_RTP_P
 ARSTREAM2_RTP_PacketFifoItem_t* ARSTREAM2_RTP_PacketFifoDuplicateItem(ARSTREAM2_RTP_PacketFifo_t *fifo,
                                                                       ARSTREAM2_RTP_PacketFifoItem_t *item);
 
+int ARSTREAM2_RTP_PacketRingInit(ARSTREAM2_RTP_PacketRing_t *ring, int maxCount);
+
+int ARSTREAM2_RTP_PacketRingFree(ARSTREAM2_RTP_PacketRing_t *ring);
+
+/* Producer side; returns -2 if the ring is full */
+int ARSTREAM2_RTP_PacketRingPush(ARSTREAM2_RTP_PacketRing_t *ring, const ARSTREAM2_RTP_Packet_t *packet);
+
+/* Consumer side; returns -2 if the ring is empty */
+int ARSTREAM2_RTP_PacketRingPop(ARSTREAM2_RTP_PacketRing_t *ring, ARSTREAM2_RTP_Packet_t *packet);
+
+int ARSTREAM2_RTP_Sender_RetransmitCacheInit(ARSTREAM2_RTP_SenderContext_t *context, unsigned int size, uint32_t timeout);
+
+int ARSTREAM2_RTP_Sender_RetransmitCacheFlush(ARSTREAM2_RTP_SenderContext_t *context, ARSTREAM2_RTP_PacketFifo_t *fifo);
+
+int ARSTREAM2_RTP_Sender_RetransmitCacheFree(ARSTREAM2_RTP_SenderContext_t *context, ARSTREAM2_RTP_PacketFifo_t *fifo);
+
+int ARSTREAM2_RTP_Sender_PacketFifoRetransmit(ARSTREAM2_RTP_SenderContext_t *context,
+                                              ARSTREAM2_RTP_PacketFifo_t *fifo,
+                                              ARSTREAM2_RTP_PacketFifoQueue_t *queue, uint16_t seqNum, uint64_t curTime);
+
+/* Duplicate an enqueued packet to the fan-out destination queues, with the destination timeouts; if updateCounts
+   is true the destination sender report packet and byte counts are updated. Returns the number of copies or -1 on error */
+int ARSTREAM2_RTP_Sender_PacketFifoFanOut(ARSTREAM2_RTP_SenderContext_t *context,
+                                          ARSTREAM2_RTP_PacketFifo_t *fifo,
+                                          ARSTREAM2_RTP_PacketFifoItem_t *item, int updateCounts);
+
 int ARSTREAM2_RTP_Sender_PacketFifoFillMsgVec(ARSTREAM2_RTP_PacketFifoQueue_t *queue, struct mmsghdr *msgVec, unsigned int msgVecCount, void *msgName, socklen_t msgNamelen);
 
 int ARSTREAM2_RTP_Sender_PacketFifoCleanFromMsgVec(ARSTREAM2_RTP_SenderContext_t *context,
@@ -368,10 +586,30 @@ int ARSTREAM2_RTP_Sender_GeneratePacket(ARSTREAM2_RTP_SenderContext_t *context,
 
 int ARSTREAM2_RTP_Sender_FinishPacket(ARSTREAM2_RTP_SenderContext_t *context, ARSTREAM2_RTP_Packet_t *packet, uint64_t curTime, int dropped);
 
+/* Add a clock skew sample (in RTP clock units) to the sliding minimum window and update the
+   averaged clock skew every ARSTREAM2_RTP_CLOCKSKEW_UPDATE_INTERVAL; amortized O(1) per sample */
+void ARSTREAM2_RTP_Receiver_ClockSkewAddSample(ARSTREAM2_RTP_ReceiverContext_t *context, int64_t clockSkew, uint64_t curTime);
+
 /* WARNING: the call sequence ARSTREAM2_RTP_Receiver_PacketFifoFillMsgVec -> recvmmsg -> ARSTREAM2_RTP_Receiver_PacketFifoAddFromMsgVec
    must not be broken (no change made to the free items list) */
 int ARSTREAM2_RTP_Receiver_PacketFifoFillMsgVec(ARSTREAM2_RTP_PacketFifo_t *fifo, struct mmsghdr *msgVec, unsigned int msgVecCount);
 
+/* Scatter a single UDP GRO receive over consecutive free buffers: each buffer gets
+   *segmentSize bytes (RTP header + payload); *segmentSize is updated with the segment
+   size actually used for the layout. Returns the number of chained buffers.
+   WARNING: the call sequence ARSTREAM2_RTP_Receiver_PacketFifoFillGroMsg -> recvmsg -> ARSTREAM2_RTP_Receiver_PacketFifoSplitGroMsg
+   -> ARSTREAM2_RTP_Receiver_PacketFifoAddFromMsgVec must not be broken (no change made to the free items list) */
+int ARSTREAM2_RTP_Receiver_PacketFifoFillGroMsg(ARSTREAM2_RTP_PacketFifo_t *fifo, struct msghdr *msg, struct iovec *iov,
+                                                unsigned int maxBufferCount, unsigned int *segmentSize);
+
+/* Split a UDP GRO receive into one msgVec entry per segment. When the received segment size
+   does not match the layout segment size the segments are moved to their buffers through
+   copyBuffer (at least recvSize bytes). The msg_hdr of each msgVec entry is set to the
+   segment buffer iovecs. Returns the number of segments. */
+int ARSTREAM2_RTP_Receiver_PacketFifoSplitGroMsg(struct iovec *iov, unsigned int bufferCount, unsigned int bufferSize,
+                                                 unsigned int layoutSegmentSize, unsigned int recvSize, unsigned int recvSegmentSize,
+                                                 uint8_t *copyBuffer, struct mmsghdr *msgVec, unsigned int msgVecCount);
+
 /* WARNING: the call sequence ARSTREAM2_RTP_Receiver_PacketFifoFillMsgVec -> recvmmsg -> ARSTREAM2_RTP_Receiver_PacketFifoAddFromMsgVec
    must not be broken (no change made to the free items list) */
 int ARSTREAM2_RTP_Receiver_PacketFifoAddFromMsgVec(ARSTREAM2_RTP_ReceiverContext_t *context,
@@ -0,0 +1,304 @@
+/**
+ * @file arstream2_rtp_cc.c
+ * @brief Parrot Streaming Library - RTP sender congestion control
+ * @date 10/16/2026
+ * @author aurelien.barre@parrot.com
+ */
+
+#include "arstream2_rtp_cc.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <libARSAL/ARSAL_Print.h>
+
+
+/**
+ * Tag for ARSAL_PRINT
+ */
+#define ARSTREAM2_RTPCC_TAG "ARSTREAM2_RtpCc"
+
+
+/**
+ * Delay-based detector: minimum trend samples, queuing delay slope threshold
+ * (10ms per second) and maximum queuing delay in microseconds
+ */
+#define ARSTREAM2_RTPCC_TREND_MIN_SAMPLES 4
+#define ARSTREAM2_RTPCC_OVERUSE_SLOPE (0.01f)
+#define ARSTREAM2_RTPCC_MAX_QUEUING_DELAY (100000)
+
+
+/**
+ * Base round-trip delay window period in microseconds
+ * (the base is the minimum over the current and the previous period)
+ */
+#define ARSTREAM2_RTPCC_BASE_RTT_PERIOD (10000000)
+
+
+/**
+ * Delay-based controller: multiplicative decrease of the sent bitrate,
+ * increase per second and maximum estimate to sent bitrate ratio
+ */
+#define ARSTREAM2_RTPCC_DECREASE_FACTOR (0.85f)
+#define ARSTREAM2_RTPCC_INCREASE_PER_SECOND (0.08f)
+#define ARSTREAM2_RTPCC_MAX_SENT_RATIO (1.5f)
+#define ARSTREAM2_RTPCC_MIN_DECREASE_INTERVAL (100000)
+
+
+/**
+ * Loss-based controller: fraction lost thresholds (in 1/256) and increase per second
+ */
+#define ARSTREAM2_RTPCC_LOSS_HIGH (26)
+#define ARSTREAM2_RTPCC_LOSS_LOW (5)
+#define ARSTREAM2_RTPCC_LOSS_INCREASE_PER_SECOND (0.05f)
+
+
+static inline uint32_t ARSTREAM2_RTPCC_Clamp(float bitrate, uint32_t minBitrate, uint32_t maxBitrate)
+{
+    if (bitrate < (float)minBitrate) return minBitrate;
+    if (bitrate > (float)maxBitrate) return maxBitrate;
+    return (uint32_t)bitrate;
+}
+
+
+int ARSTREAM2_RTPCC_Init(ARSTREAM2_RTPCC_Context_t *context, uint32_t minBitrate, uint32_t maxBitrate, uint32_t startBitrate)
+{
+    if (!context)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTPCC_TAG, "Invalid pointer");
+        return -1;
+    }
+
+    memset(context, 0, sizeof(ARSTREAM2_RTPCC_Context_t));
+
+    if (ARSTREAM2_RTPCC_SetBitrateLimits(context, minBitrate, maxBitrate) != 0)
+    {
+        return -1;
+    }
+
+    if (startBitrate == 0)
+    {
+        startBitrate = ARSTREAM2_RTPCC_DEFAULT_START_BITRATE;
+    }
+    context->delayBitrate = ARSTREAM2_RTPCC_Clamp((float)startBitrate, context->minBitrate, context->maxBitrate);
+    context->lossBitrate = context->delayBitrate;
+    context->estimatedBitrate = context->delayBitrate;
+
+    return 0;
+}
+
+
+int ARSTREAM2_RTPCC_SetBitrateLimits(ARSTREAM2_RTPCC_Context_t *context, uint32_t minBitrate, uint32_t maxBitrate)
+{
+    if (!context)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTPCC_TAG, "Invalid pointer");
+        return -1;
+    }
+
+    if (minBitrate == 0)
+    {
+        minBitrate = ARSTREAM2_RTPCC_DEFAULT_MIN_BITRATE;
+    }
+    if (maxBitrate == 0)
+    {
+        maxBitrate = ARSTREAM2_RTPCC_DEFAULT_MAX_BITRATE;
+    }
+    if (minBitrate > maxBitrate)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTPCC_TAG, "Invalid bitrate limits (min %d, max %d)", minBitrate, maxBitrate);
+        return -1;
+    }
+
+    __atomic_store_n(&context->minBitrate, minBitrate, __ATOMIC_RELAXED);
+    __atomic_store_n(&context->maxBitrate, maxBitrate, __ATOMIC_RELAXED);
+
+    return 0;
+}
+
+
+int ARSTREAM2_RTPCC_GetBitrateLimits(ARSTREAM2_RTPCC_Context_t *context, uint32_t *minBitrate, uint32_t *maxBitrate)
+{
+    if (!context)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTPCC_TAG, "Invalid pointer");
+        return -1;
+    }
+
+    if (minBitrate) *minBitrate = __atomic_load_n(&context->minBitrate, __ATOMIC_RELAXED);
+    if (maxBitrate) *maxBitrate = __atomic_load_n(&context->maxBitrate, __ATOMIC_RELAXED);
+
+    return 0;
+}
+
+
+static void ARSTREAM2_RTPCC_UpdateDelayTrend(ARSTREAM2_RTPCC_Context_t *context, uint32_t roundTripDelay, uint64_t curTime)
+{
+    uint32_t baseRtt;
+    float queuingDelay;
+    int i, idx;
+
+    /* windowed minimum round-trip delay */
+    if ((context->baseRttStartTime == 0) || (curTime >= context->baseRttStartTime + ARSTREAM2_RTPCC_BASE_RTT_PERIOD))
+    {
+        context->prevBaseRtt = (context->baseRtt) ? context->baseRtt : roundTripDelay;
+        context->baseRtt = roundTripDelay;
+        context->baseRttStartTime = curTime;
+    }
+    else if (roundTripDelay < context->baseRtt)
+    {
+        context->baseRtt = roundTripDelay;
+    }
+    baseRtt = (context->prevBaseRtt < context->baseRtt) ? context->prevBaseRtt : context->baseRtt;
+
+    context->smoothedRtt = (context->smoothedRtt == 0.) ? (float)roundTripDelay : context->smoothedRtt * 0.75f + (float)roundTripDelay * 0.25f;
+    queuingDelay = context->smoothedRtt - (float)baseRtt;
+
+    context->trendTime[context->trendIndex] = curTime;
+    context->trendDelay[context->trendIndex] = queuingDelay;
+    context->trendIndex = (context->trendIndex + 1) % ARSTREAM2_RTPCC_TREND_WINDOW_SIZE;
+    if (context->trendCount < ARSTREAM2_RTPCC_TREND_WINDOW_SIZE)
+    {
+        context->trendCount++;
+    }
+
+    /* least squares slope of the queuing delay over time */
+    context->delaySlope = 0.;
+    if (context->trendCount >= ARSTREAM2_RTPCC_TREND_MIN_SAMPLES)
+    {
+        uint64_t t0 = context->trendTime[(context->trendIndex + ARSTREAM2_RTPCC_TREND_WINDOW_SIZE - context->trendCount) % ARSTREAM2_RTPCC_TREND_WINDOW_SIZE];
+        float meanT = 0., meanD = 0., num = 0., den = 0.;
+        for (i = 0; i < context->trendCount; i++)
+        {
+            idx = (context->trendIndex + ARSTREAM2_RTPCC_TREND_WINDOW_SIZE - 1 - i) % ARSTREAM2_RTPCC_TREND_WINDOW_SIZE;
+            meanT += (float)(context->trendTime[idx] - t0);
+            meanD += context->trendDelay[idx];
+        }
+        meanT /= (float)context->trendCount;
+        meanD /= (float)context->trendCount;
+        for (i = 0; i < context->trendCount; i++)
+        {
+            idx = (context->trendIndex + ARSTREAM2_RTPCC_TREND_WINDOW_SIZE - 1 - i) % ARSTREAM2_RTPCC_TREND_WINDOW_SIZE;
+            float dt = (float)(context->trendTime[idx] - t0) - meanT;
+            num += dt * (context->trendDelay[idx] - meanD);
+            den += dt * dt;
+        }
+        if (den > 0.)
+        {
+            context->delaySlope = num / den;
+        }
+    }
+
+    if ((context->delaySlope > ARSTREAM2_RTPCC_OVERUSE_SLOPE) || (queuingDelay > (float)ARSTREAM2_RTPCC_MAX_QUEUING_DELAY))
+    {
+        context->usage = ARSTREAM2_RTPCC_USAGE_OVERUSE;
+    }
+    else if (context->delaySlope < -ARSTREAM2_RTPCC_OVERUSE_SLOPE)
+    {
+        context->usage = ARSTREAM2_RTPCC_USAGE_UNDERUSE;
+    }
+    else
+    {
+        context->usage = ARSTREAM2_RTPCC_USAGE_NORMAL;
+    }
+}
+
+
+int ARSTREAM2_RTPCC_ProcessReceiverReport(ARSTREAM2_RTPCC_Context_t *context, uint32_t roundTripDelay, uint32_t fractionLost,
+                                          uint64_t sentByteCount, uint64_t curTime)
+{
+    uint32_t minBitrate, maxBitrate, sentBitrate;
+    float lossRatio, maxIncrease, bitrate;
+    uint64_t interval;
+
+    if (!context)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTPCC_TAG, "Invalid pointer");
+        return -1;
+    }
+
+    if (roundTripDelay > 0)
+    {
+        ARSTREAM2_RTPCC_UpdateDelayTrend(context, roundTripDelay, curTime);
+    }
+
+    if ((context->prevUpdateTime == 0) || (curTime <= context->prevUpdateTime) || (sentByteCount < context->prevByteCount))
+    {
+        context->prevUpdateTime = curTime;
+        context->prevByteCount = sentByteCount;
+        return -2;
+    }
+
+    interval = curTime - context->prevUpdateTime;
+    sentBitrate = (uint32_t)((sentByteCount - context->prevByteCount) * 8 * 1000000 / interval);
+    context->sentBitrate = (context->sentBitrate == 0) ? sentBitrate : (context->sentBitrate * 3 + sentBitrate) / 4;
+    context->prevUpdateTime = curTime;
+    context->prevByteCount = sentByteCount;
+    if (interval > 1000000)
+    {
+        interval = 1000000;
+    }
+
+    ARSTREAM2_RTPCC_GetBitrateLimits(context, &minBitrate, &maxBitrate);
+    lossRatio = (float)(fractionLost & 0xFF) / 256.;
+
+    /* never increase beyond what the encoder actually uses */
+    maxIncrease = (float)context->sentBitrate * ARSTREAM2_RTPCC_MAX_SENT_RATIO;
+
+    /* delay-based AIMD controller */
+    bitrate = (float)context->delayBitrate;
+    switch (context->usage)
+    {
+        case ARSTREAM2_RTPCC_USAGE_OVERUSE:
+            /* decrease at most once per round-trip */
+            if (curTime >= context->lastDecreaseTime + ((context->smoothedRtt > ARSTREAM2_RTPCC_MIN_DECREASE_INTERVAL) ? (uint64_t)context->smoothedRtt : ARSTREAM2_RTPCC_MIN_DECREASE_INTERVAL))
+            {
+                float decreased = (float)context->sentBitrate * (1. - lossRatio) * ARSTREAM2_RTPCC_DECREASE_FACTOR;
+                if (decreased < bitrate)
+                {
+                    bitrate = decreased;
+                }
+                context->lastDecreaseTime = curTime;
+            }
+            break;
+        case ARSTREAM2_RTPCC_USAGE_UNDERUSE:
+            /* the queues are draining: hold */
+            break;
+        case ARSTREAM2_RTPCC_USAGE_NORMAL:
+        default:
+            if (bitrate < maxIncrease)
+            {
+                bitrate *= 1. + ARSTREAM2_RTPCC_INCREASE_PER_SECOND * (float)interval / 1000000.;
+                if (bitrate > maxIncrease)
+                {
+                    bitrate = maxIncrease;
+                }
+            }
+            break;
+    }
+    context->delayBitrate = ARSTREAM2_RTPCC_Clamp(bitrate, minBitrate, maxBitrate);
+
+    /* loss-based controller */
+    bitrate = (float)context->lossBitrate;
+    if (fractionLost > ARSTREAM2_RTPCC_LOSS_HIGH)
+    {
+        bitrate *= 1. - 0.5 * lossRatio;
+    }
+    else if ((fractionLost < ARSTREAM2_RTPCC_LOSS_LOW) && (bitrate < maxIncrease))
+    {
+        /* scaled by the time since the last update so that the ramp does not depend on the RR rate */
+        bitrate *= 1. + ARSTREAM2_RTPCC_LOSS_INCREASE_PER_SECOND * (float)interval / 1000000.;
+        if (bitrate > maxIncrease)
+        {
+            bitrate = maxIncrease;
+        }
+    }
+    context->lossBitrate = ARSTREAM2_RTPCC_Clamp(bitrate, minBitrate, maxBitrate);
+
+    context->estimatedBitrate = (context->delayBitrate < context->lossBitrate) ? context->delayBitrate : context->lossBitrate;
+
+    ARSAL_PRINT(ARSAL_PRINT_VERBOSE, ARSTREAM2_RTPCC_TAG, "RTT %d, slope %.4f, usage %d, loss %d/256, sent %d, delay %d, loss %d, estimate %d bit/s",
+                roundTripDelay, context->delaySlope, context->usage, fractionLost, context->sentBitrate,
+                context->delayBitrate, context->lossBitrate, context->estimatedBitrate);
+
+    return 0;
+}
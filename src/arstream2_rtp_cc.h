@@ -0,0 +1,96 @@
+/**
+ * @file arstream2_rtp_cc.h
+ * @brief Parrot Streaming Library - RTP sender congestion control
+ * @date 10/16/2026
+ * @author aurelien.barre@parrot.com
+ */
+
+#ifndef _ARSTREAM2_RTPCC_H_
+#define _ARSTREAM2_RTPCC_H_
+
+#include <inttypes.h>
+
+
+/*
+ * Macros
+ */
+
+#define ARSTREAM2_RTPCC_DEFAULT_MIN_BITRATE 150000
+#define ARSTREAM2_RTPCC_DEFAULT_MAX_BITRATE 20000000
+#define ARSTREAM2_RTPCC_DEFAULT_START_BITRATE 2000000
+
+#define ARSTREAM2_RTPCC_TREND_WINDOW_SIZE 10
+
+
+/*
+ * Types
+ */
+
+/**
+ * @brief Network usage from the delay-based detector
+ */
+typedef enum
+{
+    ARSTREAM2_RTPCC_USAGE_NORMAL = 0,
+    ARSTREAM2_RTPCC_USAGE_UNDERUSE,
+    ARSTREAM2_RTPCC_USAGE_OVERUSE,
+
+} eARSTREAM2_RTPCC_USAGE;
+
+
+/**
+ * @brief Congestion control context
+ * The available bandwidth estimate is the minimum of a delay-based AIMD controller driven by
+ * the queuing delay trend and a loss-based controller driven by the receiver report fraction lost.
+ * The queuing delay is the round-trip delay above its windowed minimum; the reverse path only
+ * carries RTCP so its variations are those of the one-way delay.
+ */
+typedef struct ARSTREAM2_RTPCC_Context_s
+{
+    /* bitrate limits (can be set from any thread) */
+    uint32_t minBitrate;
+    uint32_t maxBitrate;
+
+    uint32_t delayBitrate;
+    uint32_t lossBitrate;
+    uint32_t estimatedBitrate;
+    eARSTREAM2_RTPCC_USAGE usage;
+
+    /* round-trip delay and queuing delay trend */
+    uint32_t baseRtt;
+    uint32_t prevBaseRtt;
+    uint64_t baseRttStartTime;
+    float smoothedRtt;
+    uint64_t trendTime[ARSTREAM2_RTPCC_TREND_WINDOW_SIZE];
+    float trendDelay[ARSTREAM2_RTPCC_TREND_WINDOW_SIZE];
+    int trendCount;
+    int trendIndex;
+    float delaySlope;
+
+    /* sent bitrate over the receiver report intervals */
+    uint64_t prevByteCount;
+    uint64_t prevUpdateTime;
+    uint32_t sentBitrate;
+    uint64_t lastDecreaseTime;
+
+} ARSTREAM2_RTPCC_Context_t;
+
+
+/*
+ * Functions
+ */
+
+/* A 0 bitrate selects the default value */
+int ARSTREAM2_RTPCC_Init(ARSTREAM2_RTPCC_Context_t *context, uint32_t minBitrate, uint32_t maxBitrate, uint32_t startBitrate);
+
+/* Can be called from any thread, the limits are applied on the next receiver report; a 0 bitrate selects the default value */
+int ARSTREAM2_RTPCC_SetBitrateLimits(ARSTREAM2_RTPCC_Context_t *context, uint32_t minBitrate, uint32_t maxBitrate);
+
+int ARSTREAM2_RTPCC_GetBitrateLimits(ARSTREAM2_RTPCC_Context_t *context, uint32_t *minBitrate, uint32_t *maxBitrate);
+
+/* Update the estimate from a receiver report; sentByteCount is the cumulated RTP sent byte count.
+   Returns 0 when context->estimatedBitrate has been updated, -2 when there is not enough data yet */
+int ARSTREAM2_RTPCC_ProcessReceiverReport(ARSTREAM2_RTPCC_Context_t *context, uint32_t roundTripDelay, uint32_t fractionLost,
+                                          uint64_t sentByteCount, uint64_t curTime);
+
+#endif /* _ARSTREAM2_RTPCC_H_ */
@@ -0,0 +1,741 @@
+/**
+ * @file arstream2_rtp_fec.c
+ * @brief Parrot Streaming Library - RTP XOR forward error correction
+ * @date 10/16/2026
+ * @author aurelien.barre@parrot.com
+ */
+
+#include "arstream2_rtp_fec.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <netinet/in.h>
+#include <libARSAL/ARSAL_Print.h>
+#include <libARStream2/arstream2_stream_sender.h>
+
+
+/**
+ * Tag for ARSAL_PRINT
+ */
+#define ARSTREAM2_RTPFEC_TAG "ARSTREAM2_RtpFec"
+
+
+int ARSTREAM2_RTPFEC_Sender_Init(ARSTREAM2_RTPFEC_SenderContext_t *context, unsigned int maxPacketSize)
+{
+    if (!context)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTPFEC_TAG, "Invalid pointer");
+        return -1;
+    }
+
+    if (maxPacketSize <= sizeof(ARSTREAM2_RTPFEC_Header_t))
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTPFEC_TAG, "Invalid max packet size (%d)", maxPacketSize);
+        return -1;
+    }
+
+    memset(context, 0, sizeof(ARSTREAM2_RTPFEC_SenderContext_t));
+    context->ssrc = ARSTREAM2_RTPFEC_SSRC;
+    context->maxDataSize = maxPacketSize - sizeof(ARSTREAM2_RTPFEC_Header_t);
+
+    return 0;
+}
+
+
+int ARSTREAM2_RTPFEC_Sender_Free(ARSTREAM2_RTPFEC_SenderContext_t *context)
+{
+    unsigned int i;
+
+    if (!context)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTPFEC_TAG, "Invalid pointer");
+        return -1;
+    }
+
+    free(context->row.data);
+    context->row.data = NULL;
+    for (i = 0; i < ARSTREAM2_RTPFEC_MAX_GROUP_SIZE; i++)
+    {
+        free(context->column[i].data);
+        context->column[i].data = NULL;
+    }
+
+    return 0;
+}
+
+
+int ARSTREAM2_RTPFEC_Sender_Flush(ARSTREAM2_RTPFEC_SenderContext_t *context)
+{
+    unsigned int i;
+
+    if (!context)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTPFEC_TAG, "Invalid pointer");
+        return -1;
+    }
+
+    context->row.active = 0;
+    for (i = 0; i < ARSTREAM2_RTPFEC_MAX_GROUP_SIZE; i++)
+    {
+        context->column[i].active = 0;
+    }
+    context->matrixActive = 0;
+
+    return 0;
+}
+
+
+int ARSTREAM2_RTPFEC_Sender_SetConfig(ARSTREAM2_RTPFEC_SenderContext_t *context, int groupSize, int rowCount, int importanceLevelCount)
+{
+    if (!context)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTPFEC_TAG, "Invalid pointer");
+        return -1;
+    }
+
+    if ((groupSize < 0) || (groupSize > ARSTREAM2_RTPFEC_MAX_GROUP_SIZE)
+            || (rowCount < 0) || (rowCount > ARSTREAM2_RTPFEC_MAX_ROW_COUNT)
+            || (importanceLevelCount < 0) || (importanceLevelCount > ARSTREAM2_STREAM_SENDER_MAX_IMPORTANCE_LEVELS))
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTPFEC_TAG, "Invalid FEC config (groupSize %d, rowCount %d, importanceLevelCount %d)",
+                    groupSize, rowCount, importanceLevelCount);
+        return -1;
+    }
+
+    __atomic_store_n(&context->reqGroupSize, groupSize, __ATOMIC_RELAXED);
+    __atomic_store_n(&context->reqRowCount, rowCount, __ATOMIC_RELAXED);
+    __atomic_store_n(&context->reqImportanceLevelCount, importanceLevelCount, __ATOMIC_RELAXED);
+
+    return 0;
+}
+
+
+int ARSTREAM2_RTPFEC_Sender_GetConfig(ARSTREAM2_RTPFEC_SenderContext_t *context, int *groupSize, int *rowCount, int *importanceLevelCount)
+{
+    if (!context)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTPFEC_TAG, "Invalid pointer");
+        return -1;
+    }
+
+    if (groupSize) *groupSize = __atomic_load_n(&context->reqGroupSize, __ATOMIC_RELAXED);
+    if (rowCount) *rowCount = __atomic_load_n(&context->reqRowCount, __ATOMIC_RELAXED);
+    if (importanceLevelCount) *importanceLevelCount = __atomic_load_n(&context->reqImportanceLevelCount, __ATOMIC_RELAXED);
+
+    return 0;
+}
+
+
+static int ARSTREAM2_RTPFEC_Sender_StartGroup(ARSTREAM2_RTPFEC_SenderContext_t *context, ARSTREAM2_RTPFEC_SenderGroup_t *group,
+                                              uint16_t snBase, uint8_t offset)
+{
+    if (!group->data)
+    {
+        group->data = malloc(context->maxDataSize);
+        if (!group->data)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTPFEC_TAG, "Memory allocation failed (%d)", context->maxDataSize);
+            return -1;
+        }
+    }
+
+    group->active = 1;
+    group->snBase = snBase;
+    group->mask = 0;
+    group->offset = offset;
+    group->lengthRecovery = 0;
+    group->flagsRecovery = 0;
+    group->tsRecovery = 0;
+    group->dataSize = 0;
+    group->ntpTimestamp = 0;
+    group->inputTimestamp = 0;
+    group->timeoutTimestamp = 0;
+    group->rtpTimestamp = 0;
+    group->importance = (uint32_t)-1;
+    group->priority = (uint32_t)-1;
+
+    return 0;
+}
+
+
+static void ARSTREAM2_RTPFEC_Sender_GroupAdd(ARSTREAM2_RTPFEC_SenderGroup_t *group, const ARSTREAM2_RTP_Packet_t *packet,
+                                             unsigned int length, unsigned int index)
+{
+    unsigned int k, offset, i;
+
+    if (length > group->dataSize)
+    {
+        memset(group->data + group->dataSize, 0, length - group->dataSize);
+        group->dataSize = length;
+    }
+
+    /* XOR everything after the RTP header */
+    for (k = 1, offset = 0; k < packet->msgIovLength; k++)
+    {
+        const uint8_t *src = (const uint8_t*)packet->buffer->msgIov[k].iov_base;
+        uint8_t *dst = group->data + offset;
+        for (i = 0; i < packet->buffer->msgIov[k].iov_len; i++)
+        {
+            dst[i] ^= src[i];
+        }
+        offset += packet->buffer->msgIov[k].iov_len;
+    }
+
+    group->mask |= (1 << index);
+    group->lengthRecovery ^= (uint16_t)length;
+    group->flagsRecovery ^= ntohs(packet->header->flags);
+    group->tsRecovery ^= packet->rtpTimestamp;
+    if (packet->ntpTimestamp > group->ntpTimestamp) group->ntpTimestamp = packet->ntpTimestamp;
+    if (packet->inputTimestamp > group->inputTimestamp) group->inputTimestamp = packet->inputTimestamp;
+    if (packet->timeoutTimestamp > group->timeoutTimestamp) group->timeoutTimestamp = packet->timeoutTimestamp;
+    if ((int32_t)(packet->rtpTimestamp - group->rtpTimestamp) > 0) group->rtpTimestamp = packet->rtpTimestamp;
+    if (packet->importance < group->importance) group->importance = packet->importance;
+    if (packet->priority < group->priority) group->priority = packet->priority;
+}
+
+
+static int ARSTREAM2_RTPFEC_Sender_FlushGroup(ARSTREAM2_RTPFEC_SenderContext_t *context, ARSTREAM2_RTPFEC_SenderGroup_t *group,
+                                              ARSTREAM2_RTP_PacketFifo_t *fifo, ARSTREAM2_RTP_PacketFifoQueue_t *queue)
+{
+    ARSTREAM2_RTP_PacketFifoBuffer_t *buffer;
+    ARSTREAM2_RTP_PacketFifoItem_t *item;
+    ARSTREAM2_RTPFEC_Header_t *fecHeader;
+    int ret = 0;
+
+    if ((!group->active) || (!group->mask))
+    {
+        group->active = 0;
+        return 0;
+    }
+    group->active = 0;
+
+    buffer = ARSTREAM2_RTP_PacketFifoGetBuffer(fifo);
+    item = ARSTREAM2_RTP_PacketFifoPopFreeItem(fifo);
+    if ((!item) || (!buffer))
+    {
+        if (buffer) ARSTREAM2_RTP_PacketFifoUnrefBuffer(fifo, buffer);
+        if (item) ARSTREAM2_RTP_PacketFifoPushFreeItem(fifo, item);
+        ARSAL_PRINT(ARSAL_PRINT_WARNING, ARSTREAM2_RTPFEC_TAG, "Packet FIFO is full, repair packet dropped (snBase %d)", group->snBase);
+        return -2;
+    }
+
+    ARSTREAM2_RTP_PacketReset(&item->packet);
+    item->packet.buffer = buffer;
+    item->packet.inputTimestamp = group->inputTimestamp;
+    item->packet.timeoutTimestamp = group->timeoutTimestamp;
+    item->packet.ntpTimestamp = group->ntpTimestamp;
+    item->packet.rtpTimestamp = group->rtpTimestamp;
+    item->packet.seqNum = context->seqNum++;
+    item->packet.importance = group->importance;
+    item->packet.priority = group->priority;
+
+    fecHeader = (ARSTREAM2_RTPFEC_Header_t*)buffer->buffer;
+    fecHeader->snBase = htons(group->snBase);
+    fecHeader->mask = htons(group->mask);
+    fecHeader->offset = group->offset;
+    fecHeader->reserved1 = 0;
+    fecHeader->lengthRecovery = htons(group->lengthRecovery);
+    fecHeader->flagsRecovery = htons(group->flagsRecovery);
+    fecHeader->reserved2 = 0;
+    fecHeader->tsRecovery = htonl(group->tsRecovery);
+    memcpy(buffer->buffer + sizeof(ARSTREAM2_RTPFEC_Header_t), group->data, group->dataSize);
+    item->packet.payload = buffer->buffer;
+    item->packet.payloadSize = sizeof(ARSTREAM2_RTPFEC_Header_t) + group->dataSize;
+
+    item->packet.header = (ARSTREAM2_RTP_Header_t*)buffer->header;
+    item->packet.header->flags = htons(0x8000 | ARSTREAM2_RTPFEC_PAYLOAD_TYPE);
+    item->packet.header->seqNum = htons(item->packet.seqNum);
+    item->packet.header->timestamp = htonl(item->packet.rtpTimestamp);
+    item->packet.header->ssrc = htonl(context->ssrc);
+
+    buffer->msgIov[0].iov_base = (void*)item->packet.header;
+    buffer->msgIov[0].iov_len = (size_t)sizeof(ARSTREAM2_RTP_Header_t);
+    buffer->msgIov[1].iov_base = (void*)item->packet.payload;
+    buffer->msgIov[1].iov_len = (size_t)item->packet.payloadSize;
+    item->packet.msgIovLength = 2;
+
+    ret = ARSTREAM2_RTP_PacketFifoEnqueueItemOrderedByPriority(queue, item);
+    if (ret != 0)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTPFEC_TAG, "ARSTREAM2_RTP_PacketFifoEnqueueItemOrderedByPriority() failed (%d)", ret);
+        ARSTREAM2_RTP_PacketFifoUnrefBuffer(fifo, item->packet.buffer);
+        ARSTREAM2_RTP_PacketFifoPushFreeItem(fifo, item);
+        return -1;
+    }
+    context->repairPacketCount++;
+
+    if ((context->rtpSenderContext) && (context->rtpSenderContext->fanOutCount > 0))
+    {
+        ret = ARSTREAM2_RTP_Sender_PacketFifoFanOut(context->rtpSenderContext, fifo, item, 0);
+        if (ret < 0)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTPFEC_TAG, "ARSTREAM2_RTP_Sender_PacketFifoFanOut() failed (%d)", ret);
+        }
+    }
+
+    return 0;
+}
+
+
+static void ARSTREAM2_RTPFEC_Sender_FlushColumns(ARSTREAM2_RTPFEC_SenderContext_t *context,
+                                                 ARSTREAM2_RTP_PacketFifo_t *fifo, ARSTREAM2_RTP_PacketFifoQueue_t *queue)
+{
+    unsigned int i;
+
+    for (i = 0; i < ARSTREAM2_RTPFEC_MAX_GROUP_SIZE; i++)
+    {
+        if (context->column[i].active)
+        {
+            ARSTREAM2_RTPFEC_Sender_FlushGroup(context, &context->column[i], fifo, queue);
+        }
+    }
+    context->matrixActive = 0;
+}
+
+
+int ARSTREAM2_RTPFEC_Sender_AddPacket(ARSTREAM2_RTPFEC_SenderContext_t *context,
+                                      ARSTREAM2_RTP_PacketFifo_t *fifo,
+                                      ARSTREAM2_RTP_PacketFifoQueue_t *queue,
+                                      const ARSTREAM2_RTP_Packet_t *packet)
+{
+    unsigned int length, k, pos = 0, span = 0;
+    int protect;
+
+    if ((!context) || (!fifo) || (!queue) || (!packet) || (!packet->buffer) || (!packet->header))
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTPFEC_TAG, "Invalid pointer");
+        return -1;
+    }
+
+    /* end of the current matrix */
+    if (context->matrixActive)
+    {
+        span = context->groupSize * ((context->rowCount > 1) ? context->rowCount : 1);
+        pos = (uint16_t)(packet->seqNum - context->matrixBase);
+        if (pos >= span)
+        {
+            ARSTREAM2_RTPFEC_Sender_FlushColumns(context, fifo, queue);
+        }
+    }
+
+    /* start a new matrix with the current configuration */
+    if (!context->matrixActive)
+    {
+        unsigned int groupSize = (unsigned int)__atomic_load_n(&context->reqGroupSize, __ATOMIC_RELAXED);
+        if ((context->row.active) && (groupSize != context->groupSize))
+        {
+            ARSTREAM2_RTPFEC_Sender_FlushGroup(context, &context->row, fifo, queue);
+        }
+        context->groupSize = groupSize;
+        context->rowCount = (unsigned int)__atomic_load_n(&context->reqRowCount, __ATOMIC_RELAXED);
+        context->importanceLevelCount = (unsigned int)__atomic_load_n(&context->reqImportanceLevelCount, __ATOMIC_RELAXED);
+        if (context->groupSize == 0)
+        {
+            /* FEC is disabled */
+            return 0;
+        }
+        context->matrixBase = packet->seqNum;
+        context->matrixActive = 1;
+        pos = 0;
+    }
+    span = context->groupSize * ((context->rowCount > 1) ? context->rowCount : 1);
+
+    for (k = 1, length = 0; k < packet->msgIovLength; k++)
+    {
+        length += packet->buffer->msgIov[k].iov_len;
+    }
+    protect = (((context->importanceLevelCount == 0) || (packet->importance < context->importanceLevelCount))
+               && (length > 0) && (length <= context->maxDataSize)) ? 1 : 0;
+    if ((length > context->maxDataSize)
+            && ((context->importanceLevelCount == 0) || (packet->importance < context->importanceLevelCount)))
+    {
+        context->unprotectedPacketCount++;
+    }
+
+    /* row group: consecutive packets */
+    if ((context->row.active) && ((uint16_t)(packet->seqNum - context->row.snBase) >= context->groupSize))
+    {
+        ARSTREAM2_RTPFEC_Sender_FlushGroup(context, &context->row, fifo, queue);
+    }
+    if (protect)
+    {
+        if ((context->row.active) || (ARSTREAM2_RTPFEC_Sender_StartGroup(context, &context->row, packet->seqNum, 1) == 0))
+        {
+            unsigned int index = (uint16_t)(packet->seqNum - context->row.snBase);
+            ARSTREAM2_RTPFEC_Sender_GroupAdd(&context->row, packet, length, index);
+            if ((index == context->groupSize - 1) || (packet->markerBit))
+            {
+                /* do not hold the end of the access unit until the next one */
+                ARSTREAM2_RTPFEC_Sender_FlushGroup(context, &context->row, fifo, queue);
+            }
+        }
+    }
+
+    /* column groups: the most important packets at the same position in each row of the matrix */
+    if ((protect) && (context->rowCount > 1) && (packet->importance == 0))
+    {
+        ARSTREAM2_RTPFEC_SenderGroup_t *column = &context->column[pos % context->groupSize];
+        if ((column->active) || (ARSTREAM2_RTPFEC_Sender_StartGroup(context, column, context->matrixBase + pos % context->groupSize, context->groupSize) == 0))
+        {
+            ARSTREAM2_RTPFEC_Sender_GroupAdd(column, packet, length, pos / context->groupSize);
+        }
+    }
+
+    if (pos == span - 1)
+    {
+        ARSTREAM2_RTPFEC_Sender_FlushColumns(context, fifo, queue);
+    }
+
+    return 0;
+}
+
+
+int ARSTREAM2_RTPFEC_Receiver_Init(ARSTREAM2_RTPFEC_ReceiverContext_t *context)
+{
+    if (!context)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTPFEC_TAG, "Invalid pointer");
+        return -1;
+    }
+
+    memset(context, 0, sizeof(ARSTREAM2_RTPFEC_ReceiverContext_t));
+
+    return 0;
+}
+
+
+static void ARSTREAM2_RTPFEC_Receiver_ReleasePending(ARSTREAM2_RTPFEC_ReceiverContext_t *context, ARSTREAM2_RTP_PacketFifo_t *fifo)
+{
+    unsigned int i;
+
+    for (i = 0; i < context->releaseCount; i++)
+    {
+        int ret = ARSTREAM2_RTP_PacketFifoUnrefBuffer(fifo, context->release[i]);
+        if (ret != 0)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTPFEC_TAG, "ARSTREAM2_RTP_PacketFifoUnrefBuffer() failed (%d)", ret);
+        }
+    }
+    context->releaseCount = 0;
+}
+
+
+static void ARSTREAM2_RTPFEC_Receiver_RemoveRepair(ARSTREAM2_RTPFEC_ReceiverContext_t *context, ARSTREAM2_RTP_PacketFifo_t *fifo, unsigned int index)
+{
+    ARSTREAM2_RTP_PacketFifoItem_t *item = context->repair[index].item;
+
+    if (item->packet.buffer)
+    {
+        int ret = ARSTREAM2_RTP_PacketFifoUnrefBuffer(fifo, item->packet.buffer);
+        if (ret != 0)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTPFEC_TAG, "ARSTREAM2_RTP_PacketFifoUnrefBuffer() failed (%d)", ret);
+        }
+        item->packet.buffer = NULL;
+    }
+    ARSTREAM2_RTP_PacketFifoPushFreeItem(fifo, item);
+
+    context->repairCount--;
+    if (index != context->repairCount)
+    {
+        context->repair[index] = context->repair[context->repairCount];
+    }
+}
+
+
+int ARSTREAM2_RTPFEC_Receiver_Flush(ARSTREAM2_RTPFEC_ReceiverContext_t *context, ARSTREAM2_RTP_PacketFifo_t *fifo)
+{
+    unsigned int i;
+
+    if ((!context) || (!fifo))
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTPFEC_TAG, "Invalid pointer");
+        return -1;
+    }
+
+    ARSTREAM2_RTPFEC_Receiver_ReleasePending(context, fifo);
+    for (i = 0; i < ARSTREAM2_RTPFEC_RECEIVER_MEDIA_WINDOW_SIZE; i++)
+    {
+        if (context->media[i].buffer)
+        {
+            ARSTREAM2_RTP_PacketFifoUnrefBuffer(fifo, context->media[i].buffer);
+            context->media[i].buffer = NULL;
+        }
+    }
+    while (context->repairCount > 0)
+    {
+        ARSTREAM2_RTPFEC_Receiver_RemoveRepair(context, fifo, context->repairCount - 1);
+    }
+
+    return 0;
+}
+
+
+int ARSTREAM2_RTPFEC_Receiver_AddRepairPacket(ARSTREAM2_RTPFEC_ReceiverContext_t *context,
+                                              ARSTREAM2_RTP_PacketFifoItem_t *item, uint32_t extHighestSeqNum,
+                                              unsigned int size, uint64_t curTime)
+{
+    ARSTREAM2_RTPFEC_ReceiverRepair_t *repair;
+    ARSTREAM2_RTPFEC_Header_t *fecHeader;
+
+    if ((!context) || (!item) || (!item->packet.buffer))
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTPFEC_TAG, "Invalid pointer");
+        return -1;
+    }
+
+    if (size <= sizeof(ARSTREAM2_RTP_Header_t) + sizeof(ARSTREAM2_RTPFEC_Header_t))
+    {
+        ARSAL_PRINT(ARSAL_PRINT_WARNING, ARSTREAM2_RTPFEC_TAG, "Invalid repair packet size (%d)", size);
+        return -1;
+    }
+
+    if (context->repairCount >= ARSTREAM2_RTPFEC_RECEIVER_MAX_REPAIR_COUNT)
+    {
+        return -2;
+    }
+
+    fecHeader = (ARSTREAM2_RTPFEC_Header_t*)item->packet.buffer->buffer;
+    repair = &context->repair[context->repairCount];
+    repair->item = item;
+    repair->mask = ntohs(fecHeader->mask);
+    repair->offset = fecHeader->offset;
+    repair->lengthRecovery = ntohs(fecHeader->lengthRecovery);
+    repair->flagsRecovery = ntohs(fecHeader->flagsRecovery);
+    repair->tsRecovery = ntohl(fecHeader->tsRecovery);
+    repair->data = item->packet.buffer->buffer + sizeof(ARSTREAM2_RTPFEC_Header_t);
+    repair->dataSize = size - sizeof(ARSTREAM2_RTP_Header_t) - sizeof(ARSTREAM2_RTPFEC_Header_t);
+    repair->recvTimestamp = curTime;
+    repair->extSnBase = (extHighestSeqNum & 0xFFFF0000) | (uint32_t)ntohs(fecHeader->snBase);
+    if ((int64_t)repair->extSnBase - (int64_t)extHighestSeqNum < -32768)
+    {
+        repair->extSnBase += 65536;
+    }
+    else if ((int64_t)repair->extSnBase - (int64_t)extHighestSeqNum > 32768)
+    {
+        repair->extSnBase -= 65536;
+    }
+    if ((!repair->mask) || (!repair->offset))
+    {
+        ARSAL_PRINT(ARSAL_PRINT_WARNING, ARSTREAM2_RTPFEC_TAG, "Invalid repair packet (mask 0x%04X, offset %d)", repair->mask, repair->offset);
+        return -1;
+    }
+
+    context->repairCount++;
+    context->repairPacketCount++;
+
+    return 0;
+}
+
+
+int ARSTREAM2_RTPFEC_Receiver_AddMediaPacket(ARSTREAM2_RTPFEC_ReceiverContext_t *context,
+                                             const ARSTREAM2_RTP_Packet_t *packet)
+{
+    ARSTREAM2_RTP_Packet_t *entry;
+
+    if ((!context) || (!packet) || (!packet->buffer) || (!packet->header))
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTPFEC_TAG, "Invalid pointer");
+        return -1;
+    }
+
+    entry = &context->media[packet->extSeqNum & (ARSTREAM2_RTPFEC_RECEIVER_MEDIA_WINDOW_SIZE - 1)];
+    if (entry->buffer)
+    {
+        if (entry->extSeqNum == packet->extSeqNum)
+        {
+            return 0;
+        }
+        if (context->releaseCount >= ARSTREAM2_RTPFEC_RECEIVER_MEDIA_WINDOW_SIZE)
+        {
+            return -2;
+        }
+        /* the buffer cannot be released here (see ARSTREAM2_RTP_Receiver_PacketFifoAddFromMsgVec) */
+        context->release[context->releaseCount++] = entry->buffer;
+        entry->buffer = NULL;
+    }
+
+    ARSTREAM2_RTP_PacketCopy(entry, packet);
+    ARSTREAM2_RTP_PacketFifoBufferAddRef(entry->buffer);
+    context->mediaSsrc = ntohl(packet->header->ssrc);
+
+    return 0;
+}
+
+
+static inline ARSTREAM2_RTP_Packet_t* ARSTREAM2_RTPFEC_Receiver_GetMedia(ARSTREAM2_RTPFEC_ReceiverContext_t *context, uint32_t extSeqNum)
+{
+    ARSTREAM2_RTP_Packet_t *entry = &context->media[extSeqNum & (ARSTREAM2_RTPFEC_RECEIVER_MEDIA_WINDOW_SIZE - 1)];
+
+    return ((entry->buffer) && (entry->extSeqNum == extSeqNum)) ? entry : NULL;
+}
+
+
+static int ARSTREAM2_RTPFEC_Receiver_Recover(ARSTREAM2_RTPFEC_ReceiverContext_t *context, ARSTREAM2_RTPFEC_ReceiverRepair_t *repair,
+                                             uint32_t missingExtSeqNum, ARSTREAM2_RTP_ReceiverContext_t *rtpContext,
+                                             ARSTREAM2_RTP_PacketFifo_t *fifo, ARSTREAM2_RTP_PacketFifoQueue_t *queue,
+                                             ARSTREAM2_RTP_PacketFifoQueue_t **resendQueue, uint32_t *resendTimeout, unsigned int resendCount,
+                                             uint64_t curTime, ARSTREAM2_RTCP_ReceiverContext_t *rtcpContext)
+{
+    struct mmsghdr msg;
+    ARSTREAM2_RTP_Header_t *header;
+    ARSTREAM2_RTP_Packet_t *media;
+    uint8_t *data;
+    uint16_t length, flags;
+    uint32_t ts;
+    unsigned int b, i, mediaLength;
+    int ret;
+
+    length = repair->lengthRecovery;
+    flags = repair->flagsRecovery;
+    ts = repair->tsRecovery;
+    for (b = 0; b < 16; b++)
+    {
+        if ((repair->mask & (1 << b)) && ((media = ARSTREAM2_RTPFEC_Receiver_GetMedia(context, repair->extSnBase + b * repair->offset)) != NULL))
+        {
+            length ^= (uint16_t)(media->headerExtensionSize + media->payloadSize);
+            flags ^= ntohs(media->header->flags);
+            ts ^= media->rtpTimestamp;
+        }
+    }
+    if ((length == 0) || (length > repair->dataSize) || ((flags >> 14) != 2) || (ARSTREAM2_RTPFEC_IS_REPAIR_PACKET(flags)))
+    {
+        ARSAL_PRINT(ARSAL_PRINT_WARNING, ARSTREAM2_RTPFEC_TAG, "Inconsistent recovered packet (extSeqNum %d, length %d, flags 0x%04X)",
+                    missingExtSeqNum, length, flags);
+        return -1;
+    }
+
+    /* do not let ARSTREAM2_RTP_Receiver_PacketFifoFillMsgVec flush the FIFO */
+    ARSTREAM2_RTP_PacketFifoReclaimBuffers(fifo);
+    if (!fifo->bufferFree)
+    {
+        return -2;
+    }
+    ret = ARSTREAM2_RTP_Receiver_PacketFifoFillMsgVec(fifo, &msg, 1);
+    if (ret != 1)
+    {
+        return -2;
+    }
+    if (msg.msg_hdr.msg_iov[1].iov_len < length)
+    {
+        return -1;
+    }
+
+    /* WARNING: no buffer must be released until ARSTREAM2_RTP_Receiver_PacketFifoAddFromMsgVec is called */
+    header = (ARSTREAM2_RTP_Header_t*)msg.msg_hdr.msg_iov[0].iov_base;
+    data = (uint8_t*)msg.msg_hdr.msg_iov[1].iov_base;
+    memcpy(data, repair->data, length);
+    for (b = 0; b < 16; b++)
+    {
+        if ((repair->mask & (1 << b)) && ((media = ARSTREAM2_RTPFEC_Receiver_GetMedia(context, repair->extSnBase + b * repair->offset)) != NULL))
+        {
+            /* the header extension and payload are contiguous in receiver buffers */
+            mediaLength = media->headerExtensionSize + media->payloadSize;
+            if (mediaLength > length) mediaLength = length;
+            for (i = 0; i < mediaLength; i++)
+            {
+                data[i] ^= media->buffer->buffer[i];
+            }
+        }
+    }
+    header->flags = htons(flags);
+    header->seqNum = htons((uint16_t)(missingExtSeqNum & 0xFFFF));
+    header->timestamp = htonl(ts);
+    header->ssrc = htonl(context->mediaSsrc);
+    msg.msg_len = sizeof(ARSTREAM2_RTP_Header_t) + length;
+
+    ret = ARSTREAM2_RTP_Receiver_PacketFifoAddFromMsgVec(rtpContext, fifo, queue, resendQueue, resendTimeout, resendCount,
+                                                         &msg, 1, curTime, rtcpContext);
+    if (ret < 0)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTPFEC_TAG, "ARSTREAM2_RTP_Receiver_PacketFifoAddFromMsgVec() failed (%d)", ret);
+        return -1;
+    }
+
+    return 0;
+}
+
+
+int ARSTREAM2_RTPFEC_Receiver_Process(ARSTREAM2_RTPFEC_ReceiverContext_t *context,
+                                      ARSTREAM2_RTP_ReceiverContext_t *rtpContext,
+                                      ARSTREAM2_RTP_PacketFifo_t *fifo, ARSTREAM2_RTP_PacketFifoQueue_t *queue,
+                                      ARSTREAM2_RTP_PacketFifoQueue_t **resendQueue, uint32_t *resendTimeout, unsigned int resendCount,
+                                      uint64_t curTime, ARSTREAM2_RTCP_ReceiverContext_t *rtcpContext)
+{
+    int progress, recoveredCount = 0;
+    unsigned int i, b, missingCount;
+    uint32_t missingExtSeqNum;
+
+    if ((!context) || (!rtpContext) || (!fifo) || (!queue) || (!rtcpContext))
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTPFEC_TAG, "Invalid pointer");
+        return -1;
+    }
+
+    ARSTREAM2_RTPFEC_Receiver_ReleasePending(context, fifo);
+
+    /* a recovered packet can complete another group (row and column protection) */
+    do
+    {
+        progress = 0;
+        for (i = 0; i < context->repairCount; )
+        {
+            ARSTREAM2_RTPFEC_ReceiverRepair_t *repair = &context->repair[i];
+
+            if ((int64_t)rtpContext->extHighestSeqNum - (int64_t)repair->extSnBase >= ARSTREAM2_RTPFEC_RECEIVER_MEDIA_WINDOW_SIZE)
+            {
+                /* the protected packets are out of the media window */
+                ARSTREAM2_RTPFEC_Receiver_RemoveRepair(context, fifo, i);
+                continue;
+            }
+
+            missingCount = 0;
+            missingExtSeqNum = 0;
+            for (b = 0; b < 16; b++)
+            {
+                if ((repair->mask & (1 << b)) && (!ARSTREAM2_RTPFEC_Receiver_GetMedia(context, repair->extSnBase + b * repair->offset)))
+                {
+                    missingCount++;
+                    missingExtSeqNum = repair->extSnBase + b * repair->offset;
+                }
+            }
+
+            if (missingCount == 0)
+            {
+                ARSTREAM2_RTPFEC_Receiver_RemoveRepair(context, fifo, i);
+            }
+            else if (missingCount == 1)
+            {
+                int ret = ARSTREAM2_RTPFEC_Receiver_Recover(context, repair, missingExtSeqNum, rtpContext, fifo, queue,
+                                                            resendQueue, resendTimeout, resendCount, curTime, rtcpContext);
+                if (ret == -2)
+                {
+                    /* no free buffer, retry later */
+                    i++;
+                    continue;
+                }
+                if (ret == 0)
+                {
+                    context->recoveredPacketCount++;
+                    recoveredCount++;
+                    progress = 1;
+                }
+                ARSTREAM2_RTPFEC_Receiver_RemoveRepair(context, fifo, i);
+            }
+            else if (curTime >= repair->recvTimestamp + ARSTREAM2_RTPFEC_RECEIVER_REPAIR_TIMEOUT)
+            {
+                context->unrecoverablePacketCount += missingCount;
+                ARSTREAM2_RTPFEC_Receiver_RemoveRepair(context, fifo, i);
+            }
+            else
+            {
+                i++;
+            }
+        }
+    }
+    while (progress);
+
+    ARSTREAM2_RTPFEC_Receiver_ReleasePending(context, fifo);
+
+    return recoveredCount;
+}
@@ -0,0 +1,199 @@
+/**
+ * @file arstream2_rtp_fec.h
+ * @brief Parrot Streaming Library - RTP XOR forward error correction
+ * @date 10/16/2026
+ * @author aurelien.barre@parrot.com
+ */
+
+#ifndef _ARSTREAM2_RTPFEC_H_
+#define _ARSTREAM2_RTPFEC_H_
+
+#include "arstream2_rtp.h"
+
+
+/*
+ * Macros
+ */
+
+#define ARSTREAM2_RTPFEC_PAYLOAD_TYPE 97
+#define ARSTREAM2_RTPFEC_SSRC 0x41525346
+
+#define ARSTREAM2_RTPFEC_MAX_GROUP_SIZE 16
+#define ARSTREAM2_RTPFEC_MAX_ROW_COUNT 16
+
+#define ARSTREAM2_RTPFEC_RECEIVER_MEDIA_WINDOW_SIZE 256
+#define ARSTREAM2_RTPFEC_RECEIVER_MAX_REPAIR_COUNT 64
+#define ARSTREAM2_RTPFEC_RECEIVER_REPAIR_TIMEOUT 500000
+
+/* host order RTP header flags */
+#define ARSTREAM2_RTPFEC_IS_REPAIR_PACKET(_flags) (((_flags) & 0x7F) == ARSTREAM2_RTPFEC_PAYLOAD_TYPE)
+
+
+/*
+ * Types
+ */
+
+/**
+ * @brief FEC header, follows the RTP header of repair packets
+ * The repair payload is the XOR of everything after the RTP header (header extension
+ * and payload) of the protected media packets, zero padded to the longest one.
+ * Protected packets are snBase + i * offset for each bit i set in mask.
+ */
+typedef struct {
+    uint16_t snBase;
+    uint16_t mask;
+    uint8_t offset;
+    uint8_t reserved1;
+    uint16_t lengthRecovery;
+    uint16_t flagsRecovery;
+    uint16_t reserved2;
+    uint32_t tsRecovery;
+} __attribute__ ((packed)) ARSTREAM2_RTPFEC_Header_t;
+
+
+/**
+ * @brief FEC sender protection group
+ */
+typedef struct ARSTREAM2_RTPFEC_SenderGroup_s
+{
+    int active;
+    uint16_t snBase;
+    uint16_t mask;
+    uint8_t offset;
+    uint16_t lengthRecovery;
+    uint16_t flagsRecovery;
+    uint32_t tsRecovery;
+    uint8_t *data;
+    unsigned int dataSize;
+    uint64_t ntpTimestamp;
+    uint64_t inputTimestamp;
+    uint64_t timeoutTimestamp;
+    uint32_t rtpTimestamp;
+    uint32_t importance;
+    uint32_t priority;
+
+} ARSTREAM2_RTPFEC_SenderGroup_t;
+
+
+/**
+ * @brief FEC sender context
+ * Row groups protect groupSize consecutive packets; when rowCount > 1 column groups
+ * protect the most important packets (importance level 0) of a groupSize x rowCount matrix.
+ * Only packets with an importance level below importanceLevelCount are protected.
+ */
+typedef struct ARSTREAM2_RTPFEC_SenderContext_s
+{
+    uint32_t ssrc;
+    uint16_t seqNum;
+    unsigned int maxDataSize;
+
+    /* requested configuration (can be set from any thread), applied at the next matrix start */
+    int reqGroupSize;
+    int reqRowCount;
+    int reqImportanceLevelCount;
+
+    unsigned int groupSize;
+    unsigned int rowCount;
+    unsigned int importanceLevelCount;
+    int matrixActive;
+    uint16_t matrixBase;
+    ARSTREAM2_RTPFEC_SenderGroup_t row;
+    ARSTREAM2_RTPFEC_SenderGroup_t column[ARSTREAM2_RTPFEC_MAX_GROUP_SIZE];
+
+    uint32_t repairPacketCount;
+    uint32_t unprotectedPacketCount; /* packets to protect that exceed maxDataSize */
+
+    /* media sender context, the repair packets are also sent to its fan-out destinations (optional, can be NULL) */
+    ARSTREAM2_RTP_SenderContext_t *rtpSenderContext;
+
+} ARSTREAM2_RTPFEC_SenderContext_t;
+
+
+/**
+ * @brief FEC receiver pending repair packet
+ */
+typedef struct ARSTREAM2_RTPFEC_ReceiverRepair_s
+{
+    ARSTREAM2_RTP_PacketFifoItem_t *item;
+    uint32_t extSnBase;
+    uint16_t mask;
+    uint8_t offset;
+    uint16_t lengthRecovery;
+    uint16_t flagsRecovery;
+    uint32_t tsRecovery;
+    uint8_t *data;
+    unsigned int dataSize;
+    uint64_t recvTimestamp;
+
+} ARSTREAM2_RTPFEC_ReceiverRepair_t;
+
+
+/**
+ * @brief FEC receiver context
+ */
+typedef struct ARSTREAM2_RTPFEC_ReceiverContext_s
+{
+    /* received media packets indexed by extSeqNum, holds a reference on the buffers */
+    ARSTREAM2_RTP_Packet_t media[ARSTREAM2_RTPFEC_RECEIVER_MEDIA_WINDOW_SIZE];
+    uint32_t mediaSsrc;
+
+    /* buffers evicted from the media window during ARSTREAM2_RTP_Receiver_PacketFifoAddFromMsgVec,
+       released by the next ARSTREAM2_RTPFEC_Receiver_Process call */
+    ARSTREAM2_RTP_PacketFifoBuffer_t *release[ARSTREAM2_RTPFEC_RECEIVER_MEDIA_WINDOW_SIZE];
+    unsigned int releaseCount;
+
+    ARSTREAM2_RTPFEC_ReceiverRepair_t repair[ARSTREAM2_RTPFEC_RECEIVER_MAX_REPAIR_COUNT];
+    unsigned int repairCount;
+
+    uint32_t repairPacketCount;
+    uint32_t recoveredPacketCount;
+    uint32_t unrecoverablePacketCount;
+
+} ARSTREAM2_RTPFEC_ReceiverContext_t;
+
+
+/*
+ * Functions
+ */
+
+int ARSTREAM2_RTPFEC_Sender_Init(ARSTREAM2_RTPFEC_SenderContext_t *context, unsigned int maxPacketSize);
+
+int ARSTREAM2_RTPFEC_Sender_Free(ARSTREAM2_RTPFEC_SenderContext_t *context);
+
+/* Discard the pending protection groups */
+int ARSTREAM2_RTPFEC_Sender_Flush(ARSTREAM2_RTPFEC_SenderContext_t *context);
+
+/* Can be called from any thread, the new configuration is applied at the next matrix start */
+int ARSTREAM2_RTPFEC_Sender_SetConfig(ARSTREAM2_RTPFEC_SenderContext_t *context, int groupSize, int rowCount, int importanceLevelCount);
+
+int ARSTREAM2_RTPFEC_Sender_GetConfig(ARSTREAM2_RTPFEC_SenderContext_t *context, int *groupSize, int *rowCount, int *importanceLevelCount);
+
+/* Add a media packet that has just been enqueued; completed repair packets are enqueued in the same queue */
+int ARSTREAM2_RTPFEC_Sender_AddPacket(ARSTREAM2_RTPFEC_SenderContext_t *context,
+                                      ARSTREAM2_RTP_PacketFifo_t *fifo,
+                                      ARSTREAM2_RTP_PacketFifoQueue_t *queue,
+                                      const ARSTREAM2_RTP_Packet_t *packet);
+
+int ARSTREAM2_RTPFEC_Receiver_Init(ARSTREAM2_RTPFEC_ReceiverContext_t *context);
+
+int ARSTREAM2_RTPFEC_Receiver_Flush(ARSTREAM2_RTPFEC_ReceiverContext_t *context, ARSTREAM2_RTP_PacketFifo_t *fifo);
+
+/* Called from ARSTREAM2_RTP_Receiver_PacketFifoAddFromMsgVec: must not release any buffer.
+   The repair item is kept by the context on success (return 0). */
+int ARSTREAM2_RTPFEC_Receiver_AddRepairPacket(ARSTREAM2_RTPFEC_ReceiverContext_t *context,
+                                              ARSTREAM2_RTP_PacketFifoItem_t *item, uint32_t extHighestSeqNum,
+                                              unsigned int size, uint64_t curTime);
+
+/* Called from ARSTREAM2_RTP_Receiver_PacketFifoAddFromMsgVec: must not release any buffer */
+int ARSTREAM2_RTPFEC_Receiver_AddMediaPacket(ARSTREAM2_RTPFEC_ReceiverContext_t *context,
+                                             const ARSTREAM2_RTP_Packet_t *packet);
+
+/* Rebuild the missing packets that can be recovered and add them to the queue
+   through ARSTREAM2_RTP_Receiver_PacketFifoAddFromMsgVec; returns the recovered packet count */
+int ARSTREAM2_RTPFEC_Receiver_Process(ARSTREAM2_RTPFEC_ReceiverContext_t *context,
+                                      ARSTREAM2_RTP_ReceiverContext_t *rtpContext,
+                                      ARSTREAM2_RTP_PacketFifo_t *fifo, ARSTREAM2_RTP_PacketFifoQueue_t *queue,
+                                      ARSTREAM2_RTP_PacketFifoQueue_t **resendQueue, uint32_t *resendTimeout, unsigned int resendCount,
+                                      uint64_t curTime, ARSTREAM2_RTCP_ReceiverContext_t *rtcpContext);
+
+#endif /* _ARSTREAM2_RTPFEC_H_ */
@@ -6,6 +6,7 @@
  */
 
 #include "arstream2_rtp_h264.h"
+#include "arstream2_rtp_fec.h"
 
 #include <stdlib.h>
 #include <string.h>
@@ -31,17 +32,11 @@ static int ARSTREAM2_RTPH264_FifoDequeueNalu(ARSTREAM2_H264_NaluFifo_t *fifo, AR
         return -1;
     }
 
-    if ((!fifo->head) || (!fifo->count))
-    {
-        //ARSAL_PRINT(ARSAL_PRINT_VERBOSE, ARSTREAM2_RTPH264_TAG, "NALU FIFO is empty");
-        return -2;
-    }
-
     cur = ARSTREAM2_H264_NaluFifoDequeueItem(fifo);
     if (!cur)
     {
-        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTPH264_TAG, "Failed to dequeue FIFO item");
-        return -1;
+        //ARSAL_PRINT(ARSAL_PRINT_VERBOSE, ARSTREAM2_RTPH264_TAG, "NALU FIFO is empty");
+        return -2;
     }
 
     memcpy(nalu, &cur->nalu, sizeof(ARSTREAM2_H264_NalUnit_t));
@@ -57,12 +52,56 @@ static int ARSTREAM2_RTPH264_FifoDequeueNalu(ARSTREAM2_H264_NaluFifo_t *fifo, AR
 }
 
 
+static inline unsigned int ARSTREAM2_RTPH264_Sender_MaxPacketSize(const ARSTREAM2_RTP_SenderContext_t *context)
+{
+    /* when FEC is enabled keep room for the FEC header so that full size packets can be protected */
+    if ((context->fecCtx) && (__atomic_load_n(&context->fecCtx->reqGroupSize, __ATOMIC_RELAXED) > 0)
+            && (context->maxPacketSize > sizeof(ARSTREAM2_RTPFEC_Header_t)))
+    {
+        return context->maxPacketSize - sizeof(ARSTREAM2_RTPFEC_Header_t);
+    }
+    return context->maxPacketSize;
+}
+
+
+static inline void ARSTREAM2_RTPH264_Sender_FecAddPacket(ARSTREAM2_RTP_SenderContext_t *context,
+                                                         ARSTREAM2_RTP_PacketFifo_t *packetFifo,
+                                                         ARSTREAM2_RTP_PacketFifoQueue_t *packetFifoQueue,
+                                                         ARSTREAM2_RTP_PacketFifoItem_t *item)
+{
+    if (context->fecCtx)
+    {
+        int fecRet = ARSTREAM2_RTPFEC_Sender_AddPacket(context->fecCtx, packetFifo, packetFifoQueue, &item->packet);
+        if (fecRet < 0)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTPH264_TAG, "ARSTREAM2_RTPFEC_Sender_AddPacket() failed (%d)", fecRet);
+        }
+    }
+}
+
+
+static inline void ARSTREAM2_RTPH264_Sender_FanOut(ARSTREAM2_RTP_SenderContext_t *context,
+                                                   ARSTREAM2_RTP_PacketFifo_t *packetFifo,
+                                                   ARSTREAM2_RTP_PacketFifoItem_t *item)
+{
+    if (context->fanOutCount > 0)
+    {
+        int fanOutRet = ARSTREAM2_RTP_Sender_PacketFifoFanOut(context, packetFifo, item, 1);
+        if (fanOutRet < 0)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTPH264_TAG, "ARSTREAM2_RTP_Sender_PacketFifoFanOut() failed (%d)", fanOutRet);
+        }
+    }
+}
+
+
 static int ARSTREAM2_RTPH264_Sender_SingleNaluPacket(ARSTREAM2_RTP_SenderContext_t *context,
                                                      ARSTREAM2_H264_NalUnit_t *nalu,
                                                      ARSTREAM2_RTP_PacketFifo_t *packetFifo,
                                                      ARSTREAM2_RTP_PacketFifoQueue_t *packetFifoQueue, uint64_t curTime)
 {
     int ret = 0;
+    unsigned int maxPacketSize = ARSTREAM2_RTPH264_Sender_MaxPacketSize(context);
 
     ARSTREAM2_RTP_PacketFifoBuffer_t *buffer = ARSTREAM2_RTP_PacketFifoGetBuffer(packetFifo);
     ARSTREAM2_RTP_PacketFifoItem_t *item = ARSTREAM2_RTP_PacketFifoPopFreeItem(packetFifo);
@@ -83,7 +122,7 @@ static int ARSTREAM2_RTPH264_Sender_SingleNaluPacket(ARSTREAM2_RTP_SenderContext
             }
             else
             {
-                if (nalu->metadataSize <= context->maxPacketSize)
+                if (nalu->metadataSize <= maxPacketSize)
                 {
                     memcpy(item->packet.buffer->buffer + offsetInBuffer, nalu->metadata, nalu->metadataSize);
                     headerExtension = item->packet.buffer->buffer + offsetInBuffer;
@@ -92,11 +131,11 @@ static int ARSTREAM2_RTPH264_Sender_SingleNaluPacket(ARSTREAM2_RTP_SenderContext
                 }
                 else
                 {
-                    ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTPH264_TAG, "Header extension size exceeds max packet size (%d)", context->maxPacketSize);
+                    ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTPH264_TAG, "Header extension size exceeds max packet size (%d)", maxPacketSize);
                 }
             }
         }
-        if (offsetInBuffer + nalu->naluSize <= context->maxPacketSize)
+        if (offsetInBuffer + nalu->naluSize <= maxPacketSize)
         {
             memcpy(item->packet.buffer->buffer + offsetInBuffer, nalu->nalu, nalu->naluSize);
             payload = item->packet.buffer->buffer + offsetInBuffer;
@@ -105,7 +144,7 @@ static int ARSTREAM2_RTPH264_Sender_SingleNaluPacket(ARSTREAM2_RTP_SenderContext
         }
         else
         {
-            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTPH264_TAG, "Payload size exceeds max packet size (%d)", context->maxPacketSize);
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTPH264_TAG, "Payload size exceeds max packet size (%d)", maxPacketSize);
         }
 
         context->seqNum += nalu->seqNumForcedDiscontinuity;
@@ -127,6 +166,11 @@ static int ARSTREAM2_RTPH264_Sender_SingleNaluPacket(ARSTREAM2_RTP_SenderContext
                 ARSTREAM2_RTP_PacketFifoUnrefBuffer(packetFifo, item->packet.buffer);
                 ARSTREAM2_RTP_PacketFifoPushFreeItem(packetFifo, item);
             }
+            else
+            {
+                ARSTREAM2_RTPH264_Sender_FanOut(context, packetFifo, item);
+                ARSTREAM2_RTPH264_Sender_FecAddPacket(context, packetFifo, packetFifoQueue, item);
+            }
         }
     }
     else
@@ -149,6 +193,7 @@ static int ARSTREAM2_RTPH264_Sender_FuAPackets(ARSTREAM2_RTP_SenderContext_t *co
                                                ARSTREAM2_RTP_PacketFifoQueue_t *packetFifoQueue, uint64_t curTime)
 {
     int ret, status = 0;
+    unsigned int maxPacketSize = ARSTREAM2_RTPH264_Sender_MaxPacketSize(context);
     unsigned int i, offset;
     uint8_t fuIndicator, fuHeader;
     fuIndicator = fuHeader = *nalu->nalu;
@@ -163,13 +208,13 @@ static int ARSTREAM2_RTPH264_Sender_FuAPackets(ARSTREAM2_RTP_SenderContext_t *co
         unsigned int fragmentOffset = 0;
         do
         {
-            unsigned int packetSize = (fragmentSize - fragmentOffset > context->maxPacketSize - 2) ? context->maxPacketSize - 2 : fragmentSize - fragmentOffset;
+            unsigned int packetSize = (fragmentSize - fragmentOffset > maxPacketSize - 2) ? maxPacketSize - 2 : fragmentSize - fragmentOffset;
             if ((context->useRtpHeaderExtensions) && (offset == 1) && (nalu->metadataSize < packetSize))
             {
                 packetSize -= nalu->metadataSize;
             }
 
-            if (packetSize + 2 <= context->maxPacketSize)
+            if (packetSize + 2 <= maxPacketSize)
             {
                 ARSTREAM2_RTP_PacketFifoBuffer_t *buffer = ARSTREAM2_RTP_PacketFifoGetBuffer(packetFifo);
                 ARSTREAM2_RTP_PacketFifoItem_t *item = ARSTREAM2_RTP_PacketFifoPopFreeItem(packetFifo);
@@ -191,7 +236,7 @@ static int ARSTREAM2_RTPH264_Sender_FuAPackets(ARSTREAM2_RTP_SenderContext_t *co
                         }
                         else
                         {
-                            if (nalu->metadataSize <= context->maxPacketSize)
+                            if (nalu->metadataSize <= maxPacketSize)
                             {
                                 memcpy(item->packet.buffer->buffer + offsetInBuffer, nalu->metadata, nalu->metadataSize);
                                 headerExtension = item->packet.buffer->buffer + offsetInBuffer;
@@ -200,11 +245,11 @@ static int ARSTREAM2_RTPH264_Sender_FuAPackets(ARSTREAM2_RTP_SenderContext_t *co
                             }
                             else
                             {
-                                ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTPH264_TAG, "Header extension size exceeds max packet size (%d)", context->maxPacketSize);
+                                ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTPH264_TAG, "Header extension size exceeds max packet size (%d)", maxPacketSize);
                             }
                         }
                     }
-                    if (offsetInBuffer + packetSize + 2 <= context->maxPacketSize)
+                    if (offsetInBuffer + packetSize + 2 <= maxPacketSize)
                     {
                         memcpy(item->packet.buffer->buffer + offsetInBuffer + 2, nalu->nalu + offset, packetSize);
                         *(item->packet.buffer->buffer + offsetInBuffer) = fuIndicator;
@@ -217,7 +262,7 @@ static int ARSTREAM2_RTPH264_Sender_FuAPackets(ARSTREAM2_RTP_SenderContext_t *co
                     }
                     else
                     {
-                        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTPH264_TAG, "Payload size exceeds max packet size (%d)", context->maxPacketSize);
+                        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTPH264_TAG, "Payload size exceeds max packet size (%d)", maxPacketSize);
                     }
 
                     if (offset == 1) context->seqNum += nalu->seqNumForcedDiscontinuity;
@@ -240,6 +285,11 @@ static int ARSTREAM2_RTPH264_Sender_FuAPackets(ARSTREAM2_RTP_SenderContext_t *co
                             ARSTREAM2_RTP_PacketFifoUnrefBuffer(packetFifo, item->packet.buffer);
                             ARSTREAM2_RTP_PacketFifoPushFreeItem(packetFifo, item);
                         }
+                        else
+                        {
+                            ARSTREAM2_RTPH264_Sender_FanOut(context, packetFifo, item);
+                            ARSTREAM2_RTPH264_Sender_FecAddPacket(context, packetFifo, packetFifoQueue, item);
+                        }
                     }
                 }
                 else
@@ -272,6 +322,7 @@ static int ARSTREAM2_RTPH264_Sender_BeginStapAPacket(ARSTREAM2_RTP_SenderContext
                                                      ARSTREAM2_RTP_PacketFifo_t *packetFifo, uint64_t curTime)
 {
     int ret = 0;
+    unsigned int maxPacketSize = ARSTREAM2_RTPH264_Sender_MaxPacketSize(context);
 
     ARSTREAM2_RTP_PacketFifoBuffer_t *buffer = ARSTREAM2_RTP_PacketFifoGetBuffer(packetFifo);
     context->stapItem = ARSTREAM2_RTP_PacketFifoPopFreeItem(packetFifo);
@@ -301,7 +352,7 @@ static int ARSTREAM2_RTPH264_Sender_BeginStapAPacket(ARSTREAM2_RTP_SenderContext
             }
             else
             {
-                if (nalu->metadataSize <= context->maxPacketSize)
+                if (nalu->metadataSize <= maxPacketSize)
                 {
                     memcpy(context->stapItem->packet.buffer->buffer + context->stapOffsetInBuffer, nalu->metadata, nalu->metadataSize);
                     context->stapHeaderExtension = context->stapItem->packet.buffer->buffer + context->stapOffsetInBuffer;
@@ -310,11 +361,11 @@ static int ARSTREAM2_RTPH264_Sender_BeginStapAPacket(ARSTREAM2_RTP_SenderContext
                 }
                 else
                 {
-                    ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTPH264_TAG, "Header extension size exceeds max packet size (%d)", context->maxPacketSize);
+                    ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTPH264_TAG, "Header extension size exceeds max packet size (%d)", maxPacketSize);
                 }
             }
         }
-        if (context->stapOffsetInBuffer + 1 <= context->maxPacketSize)
+        if (context->stapOffsetInBuffer + 1 <= maxPacketSize)
         {
             context->stapPayload = context->stapItem->packet.buffer->buffer + context->stapOffsetInBuffer;
             context->stapPayloadSize = 1;
@@ -323,7 +374,7 @@ static int ARSTREAM2_RTPH264_Sender_BeginStapAPacket(ARSTREAM2_RTP_SenderContext
         }
         else
         {
-            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTPH264_TAG, "Payload size exceeds max packet size (%d)", context->maxPacketSize);
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTPH264_TAG, "Payload size exceeds max packet size (%d)", maxPacketSize);
         }
     }
     else
@@ -343,8 +394,9 @@ static int ARSTREAM2_RTPH264_Sender_AppendToStapAPacket(ARSTREAM2_RTP_SenderCont
                                                         ARSTREAM2_H264_NalUnit_t *nalu)
 {
     int ret = 0;
+    unsigned int maxPacketSize = ARSTREAM2_RTPH264_Sender_MaxPacketSize(context);
 
-    if (context->stapOffsetInBuffer + 2 + nalu->naluSize <= context->maxPacketSize)
+    if (context->stapOffsetInBuffer + 2 + nalu->naluSize <= maxPacketSize)
     {
         uint8_t nri = ((uint8_t)(*(nalu->nalu)) >> 5) & 0x3;
         if (nri > context->stapMaxNri) context->stapMaxNri = nri;
@@ -375,7 +427,7 @@ static int ARSTREAM2_RTPH264_Sender_AppendToStapAPacket(ARSTREAM2_RTP_SenderCont
     }
     else
     {
-        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTPH264_TAG, "Payload size exceeds max packet size (%d)", context->maxPacketSize);
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTPH264_TAG, "Payload size exceeds max packet size (%d)", maxPacketSize);
     }
 
     return ret;
@@ -410,6 +462,11 @@ static int ARSTREAM2_RTPH264_Sender_FinishStapAPacket(ARSTREAM2_RTP_SenderContex
             ARSTREAM2_RTP_PacketFifoUnrefBuffer(packetFifo, context->stapItem->packet.buffer);
             ARSTREAM2_RTP_PacketFifoPushFreeItem(packetFifo, context->stapItem);
         }
+        else
+        {
+            ARSTREAM2_RTPH264_Sender_FanOut(context, packetFifo, context->stapItem);
+            ARSTREAM2_RTPH264_Sender_FecAddPacket(context, packetFifo, packetFifoQueue, context->stapItem);
+        }
     }
     context->stapPayloadSize = 0;
     context->stapHeaderExtensionSize = 0;
@@ -428,6 +485,7 @@ int ARSTREAM2_RTPH264_Sender_NaluFifoToPacketFifo(ARSTREAM2_RTP_SenderContext_t
     ARSTREAM2_H264_NalUnit_t nalu;
     int ret = 0, fifoRes, naluCount = 0, err;
     int initialPacketCount = packetFifoQueue->count;
+    unsigned int maxPacketSize = ARSTREAM2_RTPH264_Sender_MaxPacketSize(context);
 
     while ((fifoRes = ARSTREAM2_RTPH264_FifoDequeueNalu(naluFifo, &nalu)) == 0) //TODO replace with FifoDequeue+FifoPushFreeItem
     {
@@ -473,7 +531,7 @@ int ARSTREAM2_RTPH264_Sender_NaluFifoToPacketFifo(ARSTREAM2_RTP_SenderContext_t
                     ? (nalu.naluSize + ((context->useRtpHeaderExtensions) ? nalu.metadataSize : 0) + context->targetPacketSize / 2) / context->targetPacketSize
                     : 0;
 
-            if ((fragmentCount > 1) || (nalu.naluSize > context->maxPacketSize))
+            if ((fragmentCount > 1) || (nalu.naluSize > maxPacketSize))
             {
                 /* Fragmentation (FU-A) */
 
@@ -496,7 +554,7 @@ int ARSTREAM2_RTPH264_Sender_NaluFifoToPacketFifo(ARSTREAM2_RTP_SenderContext_t
             else
             {
                 unsigned int newStapSize = ((!context->stapPending) ? sizeof(ARSTREAM2_RTP_Header_t) + ((context->useRtpHeaderExtensions) ? nalu.metadataSize : 0) + 1 : 0) + 2 + nalu.naluSize;
-                if ((context->stapPayloadSize + context->stapHeaderExtensionSize + newStapSize >= context->maxPacketSize)
+                if ((context->stapPayloadSize + context->stapHeaderExtensionSize + newStapSize >= maxPacketSize)
                         || (context->stapPayloadSize + context->stapHeaderExtensionSize + newStapSize > context->targetPacketSize)
                         || (nalu.seqNumForcedDiscontinuity))
                 {
@@ -511,7 +569,7 @@ int ARSTREAM2_RTPH264_Sender_NaluFifoToPacketFifo(ARSTREAM2_RTP_SenderContext_t
                     }
                 }
 
-                if ((context->stapPayloadSize + context->stapHeaderExtensionSize + newStapSize >= context->maxPacketSize)
+                if ((context->stapPayloadSize + context->stapHeaderExtensionSize + newStapSize >= maxPacketSize)
                         || (context->stapPayloadSize + context->stapHeaderExtensionSize + newStapSize > context->targetPacketSize))
                 {
                     /* Single NAL unit */
@@ -7,6 +7,37 @@
 
 
 #include "arstream2_rtp_receiver.h"
+#include "arstream2_shm_transport_internal.h"
+
+#ifdef __linux__
+#include <netinet/udp.h>
+#define ARSTREAM2_RTP_RECEIVER_HAS_GRO 1
+#ifndef SOL_UDP
+#define SOL_UDP 17
+#endif
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
+#else
+#define ARSTREAM2_RTP_RECEIVER_HAS_GRO 0
+#endif
+
+#if defined(HAS_IO_URING) && defined(__linux__) && defined(__has_include)
+/* the kernel headers may predate io_uring: fall back to recvmmsg */
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#if defined(IORING_RECV_MULTISHOT) && defined(__NR_io_uring_setup)
+#define ARSTREAM2_RTP_RECEIVER_HAS_IO_URING 1
+#endif
+#endif
+#endif
+#ifndef ARSTREAM2_RTP_RECEIVER_HAS_IO_URING
+#define ARSTREAM2_RTP_RECEIVER_HAS_IO_URING 0
+#endif
+
+#define ARSTREAM2_RTP_RECEIVER_URING_RECV_USER_DATA (1)
 
 
 #define ARSTREAM2_RTP_RECEIVER_TAG "ARSTREAM2_RtpReceiver"
@@ -234,6 +265,23 @@ static int ARSTREAM2_RtpReceiver_StreamSocketSetup(ARSTREAM2_RtpReceiver_t *rece
         }
     }
 
+    if ((ret == 0) && (receiver->net.useGro))
+    {
+        /* enable UDP GRO */
+#if ARSTREAM2_RTP_RECEIVER_HAS_GRO
+        int gro = 1;
+        err = setsockopt(receiver->net.streamSocket, SOL_UDP, UDP_GRO, (void*)&gro, sizeof(gro));
+        if (err != 0)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_WARNING, ARSTREAM2_RTP_RECEIVER_TAG, "UDP GRO is not supported, using recvmmsg: error=%d (%s)", errno, strerror(errno));
+            receiver->net.useGro = 0;
+        }
+#else
+        ARSAL_PRINT(ARSAL_PRINT_WARNING, ARSTREAM2_RTP_RECEIVER_TAG, "UDP GRO is not supported on this platform, using recvmmsg");
+        receiver->net.useGro = 0;
+#endif
+    }
+
     if (ret == 0)
     {
         /* bind the socket */
@@ -253,6 +301,7 @@ static int ARSTREAM2_RtpReceiver_StreamSocketSetup(ARSTREAM2_RtpReceiver_t *rece
         }
         receiver->net.streamSocket = -1;
     }
+    receiver->net.streamEventFd = receiver->net.streamSocket;
 
     return ret;
 }
@@ -289,10 +338,217 @@ static int ARSTREAM2_RtpReceiver_StreamSocketTeardown(ARSTREAM2_RtpReceiver_t *r
         while (((err = close(receiver->net.streamSocket)) == -1) && (errno == EINTR));
         receiver->net.streamSocket = -1;
     }
+    receiver->net.streamEventFd = -1;
 
     return 0;
 }
 
+
+#if ARSTREAM2_RTP_RECEIVER_HAS_IO_URING
+static void ARSTREAM2_RtpReceiver_UringFree(ARSTREAM2_RtpReceiver_t *receiver)
+{
+    struct ARSTREAM2_RtpReceiver_UringInfos_t *uring = &receiver->uring;
+
+    if (uring->ringFd >= 0)
+    {
+        /* closing the ring cancels the pending multishot recvmsg */
+        int err;
+        while (((err = close(uring->ringFd)) == -1) && (errno == EINTR));
+        ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARSTREAM2_RTP_RECEIVER_TAG, "io_uring multishot recvmsg armed %llu times",
+                    (long long unsigned int)uring->rearmCount);
+    }
+    if (uring->sqes)
+    {
+        munmap(uring->sqes, uring->sqesSize);
+    }
+    if ((uring->cqRing) && (uring->cqRing != uring->sqRing))
+    {
+        munmap(uring->cqRing, uring->cqRingSize);
+    }
+    if (uring->sqRing)
+    {
+        munmap(uring->sqRing, uring->sqRingSize);
+    }
+    if (uring->bufRing)
+    {
+        munmap(uring->bufRing, uring->bufRingSize);
+    }
+
+    memset(uring, 0, sizeof(struct ARSTREAM2_RtpReceiver_UringInfos_t));
+    uring->ringFd = -1;
+}
+
+
+static int ARSTREAM2_RtpReceiver_UringArm(ARSTREAM2_RtpReceiver_t *receiver)
+{
+    struct ARSTREAM2_RtpReceiver_UringInfos_t *uring = &receiver->uring;
+    unsigned int tail = *uring->sqTail;
+    unsigned int index = tail & *uring->sqMask;
+    struct io_uring_sqe *sqe = (struct io_uring_sqe*)uring->sqes + index;
+    int ret;
+
+    /* multishot recvmsg: one completion per datagram in a buffer picked from the provided buffer ring */
+    memset(sqe, 0, sizeof(struct io_uring_sqe));
+    sqe->opcode = IORING_OP_RECVMSG;
+    sqe->fd = receiver->net.streamSocket;
+    sqe->addr = (uint64_t)(uintptr_t)&uring->recvMsg;
+    sqe->len = 1;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->buf_group = 0;
+    sqe->user_data = ARSTREAM2_RTP_RECEIVER_URING_RECV_USER_DATA;
+    uring->sqArray[index] = index;
+    __atomic_store_n(uring->sqTail, tail + 1, __ATOMIC_RELEASE);
+
+    while (((ret = syscall(__NR_io_uring_enter, uring->ringFd, 1, 0, 0, NULL, 0)) == -1) && (errno == EINTR));
+    if (ret < 0)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_RECEIVER_TAG, "Stream io_uring - submit error (%d): %s", errno, strerror(errno));
+        return -1;
+    }
+
+    uring->armed = 1;
+    uring->rearmCount++;
+
+    return 0;
+}
+
+
+static int ARSTREAM2_RtpReceiver_UringInit(ARSTREAM2_RtpReceiver_t *receiver)
+{
+    struct ARSTREAM2_RtpReceiver_UringInfos_t *uring = &receiver->uring;
+    struct io_uring_params params;
+    struct io_uring_buf_reg reg;
+    struct io_uring_buf_ring *bufRing;
+    size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+    size_t ringEntriesSize;
+    unsigned int i, head, tail;
+    int ret;
+
+    memset(uring, 0, sizeof(struct ARSTREAM2_RtpReceiver_UringInfos_t));
+    uring->ringFd = -1;
+    uring->bufferCount = ARSTREAM2_RTP_RECEIVER_URING_BUFFER_COUNT;
+    uring->bufferSize = (sizeof(struct io_uring_recvmsg_out) + sizeof(ARSTREAM2_RTP_Header_t) + receiver->rtpReceiverContext.maxPacketSize
+                         + pageSize - 1) & ~(pageSize - 1);
+
+    memset(&params, 0, sizeof(struct io_uring_params));
+    params.flags = IORING_SETUP_CQSIZE;
+    params.cq_entries = 2 * uring->bufferCount;
+    ret = syscall(__NR_io_uring_setup, ARSTREAM2_RTP_RECEIVER_URING_SQ_ENTRIES, &params);
+    if (ret < 0)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_WARNING, ARSTREAM2_RTP_RECEIVER_TAG, "io_uring setup failed: error=%d (%s)", errno, strerror(errno));
+        return -1;
+    }
+    uring->ringFd = ret;
+
+    /* map the submission and completion rings */
+    uring->sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+    uring->cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        if (uring->cqRingSize > uring->sqRingSize)
+        {
+            uring->sqRingSize = uring->cqRingSize;
+        }
+        uring->cqRingSize = uring->sqRingSize;
+    }
+    uring->sqRing = mmap(NULL, uring->sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, uring->ringFd, IORING_OFF_SQ_RING);
+    if (uring->sqRing == MAP_FAILED)
+    {
+        uring->sqRing = NULL;
+        ARSAL_PRINT(ARSAL_PRINT_WARNING, ARSTREAM2_RTP_RECEIVER_TAG, "io_uring SQ ring mmap failed: error=%d (%s)", errno, strerror(errno));
+        return -1;
+    }
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        uring->cqRing = uring->sqRing;
+    }
+    else
+    {
+        uring->cqRing = mmap(NULL, uring->cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, uring->ringFd, IORING_OFF_CQ_RING);
+        if (uring->cqRing == MAP_FAILED)
+        {
+            uring->cqRing = NULL;
+            ARSAL_PRINT(ARSAL_PRINT_WARNING, ARSTREAM2_RTP_RECEIVER_TAG, "io_uring CQ ring mmap failed: error=%d (%s)", errno, strerror(errno));
+            return -1;
+        }
+    }
+    uring->sqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+    uring->sqes = mmap(NULL, uring->sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, uring->ringFd, IORING_OFF_SQES);
+    if (uring->sqes == MAP_FAILED)
+    {
+        uring->sqes = NULL;
+        ARSAL_PRINT(ARSAL_PRINT_WARNING, ARSTREAM2_RTP_RECEIVER_TAG, "io_uring SQEs mmap failed: error=%d (%s)", errno, strerror(errno));
+        return -1;
+    }
+    uring->sqTail = (unsigned int*)((uint8_t*)uring->sqRing + params.sq_off.tail);
+    uring->sqMask = (unsigned int*)((uint8_t*)uring->sqRing + params.sq_off.ring_mask);
+    uring->sqFlags = (unsigned int*)((uint8_t*)uring->sqRing + params.sq_off.flags);
+    uring->sqArray = (unsigned int*)((uint8_t*)uring->sqRing + params.sq_off.array);
+    uring->cqHead = (unsigned int*)((uint8_t*)uring->cqRing + params.cq_off.head);
+    uring->cqTail = (unsigned int*)((uint8_t*)uring->cqRing + params.cq_off.tail);
+    uring->cqMask = (unsigned int*)((uint8_t*)uring->cqRing + params.cq_off.ring_mask);
+    uring->cqes = (uint8_t*)uring->cqRing + params.cq_off.cqes;
+
+    /* provided buffer ring: the ring entries are followed by the buffers in the same mapping */
+    ringEntriesSize = (uring->bufferCount * sizeof(struct io_uring_buf) + pageSize - 1) & ~(pageSize - 1);
+    uring->bufRingSize = ringEntriesSize + (size_t)uring->bufferCount * uring->bufferSize;
+    uring->bufRing = mmap(NULL, uring->bufRingSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (uring->bufRing == MAP_FAILED)
+    {
+        uring->bufRing = NULL;
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_RECEIVER_TAG, "io_uring buffer ring mmap failed (size %zu): error=%d (%s)", uring->bufRingSize, errno, strerror(errno));
+        return -1;
+    }
+    uring->buffers = (uint8_t*)uring->bufRing + ringEntriesSize;
+
+    memset(&reg, 0, sizeof(struct io_uring_buf_reg));
+    reg.ring_addr = (uint64_t)(uintptr_t)uring->bufRing;
+    reg.ring_entries = uring->bufferCount;
+    reg.bgid = 0;
+    ret = syscall(__NR_io_uring_register, uring->ringFd, IORING_REGISTER_PBUF_RING, &reg, 1);
+    if (ret < 0)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_WARNING, ARSTREAM2_RTP_RECEIVER_TAG, "io_uring buffer ring registration failed: error=%d (%s)", errno, strerror(errno));
+        return -1;
+    }
+
+    bufRing = (struct io_uring_buf_ring*)uring->bufRing;
+    for (i = 0; i < uring->bufferCount; i++)
+    {
+        bufRing->bufs[i].addr = (uint64_t)(uintptr_t)(uring->buffers + (size_t)i * uring->bufferSize);
+        bufRing->bufs[i].len = uring->bufferSize;
+        bufRing->bufs[i].bid = (uint16_t)i;
+    }
+    uring->bufRingTail = (uint16_t)uring->bufferCount;
+    __atomic_store_n(&bufRing->tail, uring->bufRingTail, __ATOMIC_RELEASE);
+
+    memset(&uring->recvMsg, 0, sizeof(struct msghdr));
+    ret = ARSTREAM2_RtpReceiver_UringArm(receiver);
+    if (ret != 0)
+    {
+        return -1;
+    }
+
+    /* an unsupported multishot recvmsg fails immediately on submission */
+    head = *uring->cqHead;
+    tail = __atomic_load_n(uring->cqTail, __ATOMIC_ACQUIRE);
+    if (head != tail)
+    {
+        struct io_uring_cqe *cqe = (struct io_uring_cqe*)uring->cqes + (head & *uring->cqMask);
+        if ((cqe->res < 0) && (cqe->res != -ENOBUFS))
+        {
+            ARSAL_PRINT(ARSAL_PRINT_WARNING, ARSTREAM2_RTP_RECEIVER_TAG, "io_uring multishot recvmsg failed: error=%d (%s)", -cqe->res, strerror(-cqe->res));
+            return -1;
+        }
+    }
+
+    return 0;
+}
+#endif
+
+
 static int ARSTREAM2_RtpReceiver_ControlMuxSetup(ARSTREAM2_RtpReceiver_t *receiver)
 {
 #if BUILD_LIBMUX
@@ -538,22 +794,38 @@ static int ARSTREAM2_RtpReceiver_ControlSocketTeardown(ARSTREAM2_RtpReceiver_t *
 
 static void ARSTREAM2_RtpReceiver_UpdateMonitoring(ARSTREAM2_RtpReceiver_t *receiver, uint64_t recvTimestamp, uint32_t rtpTimestamp, uint64_t ntpTimestamp, uint64_t ntpTimestampLocal, uint16_t seqNum, uint16_t markerBit, uint32_t bytes)
 {
-    ARSAL_Mutex_Lock(&(receiver->monitoringMutex));
+    ARSTREAM2_RtpReceiver_MonitoringPoint_t *prev = &receiver->monitoringPoint[receiver->monitoringIndex];
+    ARSTREAM2_RtpReceiver_MonitoringPoint_t *point;
+    unsigned int seq = receiver->monitoringSeq;
+    uint32_t receptionTime = (uint32_t)(recvTimestamp - ntpTimestampLocal);
+    int hasPrev = (receiver->monitoringCount > 0);
+
+    /* odd sequence: write in progress */
+    __atomic_store_n(&receiver->monitoringSeq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    point = &receiver->monitoringPoint[(receiver->monitoringIndex + 1) % ARSTREAM2_RTP_RECEIVER_MONITORING_MAX_POINTS];
+    point->bytes = bytes;
+    point->rtpTimestamp = rtpTimestamp;
+    point->ntpTimestamp = ntpTimestamp;
+    point->ntpTimestampLocal = ntpTimestampLocal;
+    point->seqNum = seqNum;
+    point->markerBit = markerBit;
+    point->recvTimestamp = recvTimestamp;
+    /* the sums wrap around; differences between two points stay exact */
+    point->bytesSum = ((hasPrev) ? prev->bytesSum : 0) + bytes;
+    point->bytesSqSum = ((hasPrev) ? prev->bytesSqSum : 0) + (uint64_t)bytes * bytes;
+    point->receptionTimeSum = ((hasPrev) ? prev->receptionTimeSum : 0) + receptionTime;
+    point->receptionTimeSqSum = ((hasPrev) ? prev->receptionTimeSqSum : 0) + (uint64_t)receptionTime * receptionTime;
+    point->gapsInSeqNumSum = (hasPrev) ? prev->gapsInSeqNumSum + (int16_t)(seqNum - prev->seqNum) - 1 : 0;
 
+    receiver->monitoringIndex = (receiver->monitoringIndex + 1) % ARSTREAM2_RTP_RECEIVER_MONITORING_MAX_POINTS;
     if (receiver->monitoringCount < ARSTREAM2_RTP_RECEIVER_MONITORING_MAX_POINTS)
     {
         receiver->monitoringCount++;
     }
-    receiver->monitoringIndex = (receiver->monitoringIndex + 1) % ARSTREAM2_RTP_RECEIVER_MONITORING_MAX_POINTS;
-    receiver->monitoringPoint[receiver->monitoringIndex].bytes = bytes;
-    receiver->monitoringPoint[receiver->monitoringIndex].rtpTimestamp = rtpTimestamp;
-    receiver->monitoringPoint[receiver->monitoringIndex].ntpTimestamp = ntpTimestamp;
-    receiver->monitoringPoint[receiver->monitoringIndex].ntpTimestampLocal = ntpTimestampLocal;
-    receiver->monitoringPoint[receiver->monitoringIndex].seqNum = seqNum;
-    receiver->monitoringPoint[receiver->monitoringIndex].markerBit = markerBit;
-    receiver->monitoringPoint[receiver->monitoringIndex].recvTimestamp = recvTimestamp;
-
-    ARSAL_Mutex_Unlock(&(receiver->monitoringMutex));
+
+    __atomic_store_n(&receiver->monitoringSeq, seq + 2, __ATOMIC_RELEASE);
 }
 
 static int ARSTREAM2_RtpReceiver_MuxRecvMmsg(ARSTREAM2_RtpReceiver_t *receiver, struct mmsghdr *msgvec, unsigned int vlen, int blocking)
@@ -677,6 +949,11 @@ static int ARSTREAM2_RtpReceiver_NetRecvMmsg(ARSTREAM2_RtpReceiver_t *receiver,
     while (((ret = recvmmsg(receiver->net.streamSocket, msgvec, vlen, 0, NULL)) == -1) && (errno == EINTR));
     if (ret < 0)
     {
+        if (errno == EAGAIN)
+        {
+            /* Nothing left to read on the socket */
+            return 0;
+        }
         ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_RECEIVER_TAG, "Stream socket - recvmmsg error (%d): %s", errno, strerror(errno));
         return -1;
     }
@@ -686,6 +963,147 @@ static int ARSTREAM2_RtpReceiver_NetRecvMmsg(ARSTREAM2_RtpReceiver_t *receiver,
     }
 }
 
+static int ARSTREAM2_RtpReceiver_UringRecvMmsg(ARSTREAM2_RtpReceiver_t *receiver, struct mmsghdr *msgvec, unsigned int vlen, int blocking)
+{
+#if ARSTREAM2_RTP_RECEIVER_HAS_IO_URING
+    struct ARSTREAM2_RtpReceiver_UringInfos_t *uring;
+    struct io_uring_buf_ring *bufRing;
+    unsigned int head, tail, mask, bufMask, count = 0;
+
+    if ((!receiver) || (!msgvec))
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_RECEIVER_TAG, "Invalid pointer");
+        return -1;
+    }
+    uring = &receiver->uring;
+    bufRing = (struct io_uring_buf_ring*)uring->bufRing;
+    bufMask = uring->bufferCount - 1;
+
+    if (__atomic_load_n(uring->sqFlags, __ATOMIC_RELAXED) & IORING_SQ_CQ_OVERFLOW)
+    {
+        /* flush the overflowed completions to the CQ ring */
+        int ret;
+        while (((ret = syscall(__NR_io_uring_enter, uring->ringFd, 0, 0, IORING_ENTER_GETEVENTS, NULL, 0)) == -1) && (errno == EINTR));
+    }
+
+    /* reap the completions from the shared CQ ring, no system call is needed */
+    head = *uring->cqHead;
+    tail = __atomic_load_n(uring->cqTail, __ATOMIC_ACQUIRE);
+    mask = *uring->cqMask;
+    while ((head != tail) && (count < vlen))
+    {
+        struct io_uring_cqe *cqe = (struct io_uring_cqe*)uring->cqes + (head & mask);
+        head++;
+
+        if (cqe->user_data != ARSTREAM2_RTP_RECEIVER_URING_RECV_USER_DATA)
+        {
+            continue;
+        }
+        if (!(cqe->flags & IORING_CQE_F_MORE))
+        {
+            /* the multishot recvmsg has terminated (e.g. no more provided buffers) */
+            uring->armed = 0;
+        }
+
+        if (cqe->flags & IORING_CQE_F_BUFFER)
+        {
+            unsigned int bid = cqe->flags >> IORING_CQE_BUFFER_SHIFT;
+            uint8_t *buf = uring->buffers + (size_t)bid * uring->bufferSize;
+
+            if (cqe->res >= (int)sizeof(struct io_uring_recvmsg_out))
+            {
+                struct io_uring_recvmsg_out *out = (struct io_uring_recvmsg_out*)buf;
+                size_t offset = sizeof(struct io_uring_recvmsg_out) + uring->recvMsg.msg_namelen + uring->recvMsg.msg_controllen;
+                size_t k, left = ((size_t)cqe->res > offset) ? (size_t)cqe->res - offset : 0;
+                uint8_t *payload = buf + offset;
+
+                msgvec[count].msg_hdr.msg_flags = (out->payloadlen > left) ? MSG_TRUNC : 0;
+                for (k = 0, offset = 0; ((k < (size_t)msgvec[count].msg_hdr.msg_iovlen) && (left > 0)); k++)
+                {
+                    size_t sz = (msgvec[count].msg_hdr.msg_iov[k].iov_len < left) ? msgvec[count].msg_hdr.msg_iov[k].iov_len : left;
+                    memcpy(msgvec[count].msg_hdr.msg_iov[k].iov_base, payload + offset, sz);
+                    offset += sz;
+                    left -= sz;
+                }
+                if (left != 0)
+                {
+                    msgvec[count].msg_hdr.msg_flags |= MSG_TRUNC;
+                }
+                msgvec[count].msg_len = (unsigned int)offset;
+                count++;
+            }
+
+            /* give the buffer back to the kernel */
+            bufRing->bufs[uring->bufRingTail & bufMask].addr = (uint64_t)(uintptr_t)buf;
+            bufRing->bufs[uring->bufRingTail & bufMask].len = uring->bufferSize;
+            bufRing->bufs[uring->bufRingTail & bufMask].bid = (uint16_t)bid;
+            uring->bufRingTail++;
+        }
+        else if ((cqe->res < 0) && (cqe->res != -ENOBUFS))
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_RECEIVER_TAG, "Stream io_uring - recvmsg error (%d): %s", -cqe->res, strerror(-cqe->res));
+        }
+    }
+    __atomic_store_n(&bufRing->tail, uring->bufRingTail, __ATOMIC_RELEASE);
+    __atomic_store_n(uring->cqHead, head, __ATOMIC_RELEASE);
+
+    if (!uring->armed)
+    {
+        int ret = ARSTREAM2_RtpReceiver_UringArm(receiver);
+        if ((ret != 0) && (count == 0))
+        {
+            return -1;
+        }
+    }
+
+    return (int)count;
+#else
+    return -ENOSYS;
+#endif
+}
+
+
+static int ARSTREAM2_RtpReceiver_StreamUringSetup(ARSTREAM2_RtpReceiver_t *receiver)
+{
+    int ret;
+
+    ret = ARSTREAM2_RtpReceiver_StreamSocketSetup(receiver);
+    if (ret != 0)
+    {
+        return ret;
+    }
+
+#if ARSTREAM2_RTP_RECEIVER_HAS_IO_URING
+    ret = ARSTREAM2_RtpReceiver_UringInit(receiver);
+    if (ret == 0)
+    {
+        /* the ring file descriptor is readable when completions are available */
+        receiver->net.streamEventFd = receiver->uring.ringFd;
+        return 0;
+    }
+    ARSTREAM2_RtpReceiver_UringFree(receiver);
+#endif
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, ARSTREAM2_RTP_RECEIVER_TAG, "io_uring reception is not supported, using recvmmsg");
+    receiver->net.useIoUring = 0;
+    receiver->ops.streamChannelRecvMmsg = ARSTREAM2_RtpReceiver_NetRecvMmsg;
+    receiver->ops.streamChannelTeardown = ARSTREAM2_RtpReceiver_StreamSocketTeardown;
+
+    return 0;
+}
+
+static int ARSTREAM2_RtpReceiver_StreamUringTeardown(ARSTREAM2_RtpReceiver_t *receiver)
+{
+    if (receiver == NULL)
+        return -EINVAL;
+
+#if ARSTREAM2_RTP_RECEIVER_HAS_IO_URING
+    ARSTREAM2_RtpReceiver_UringFree(receiver);
+#endif
+
+    return ARSTREAM2_RtpReceiver_StreamSocketTeardown(receiver);
+}
+
 static int ARSTREAM2_RtpReceiver_MuxSendControlData(ARSTREAM2_RtpReceiver_t *receiver,
                                                     uint8_t *buffer,
                                                     int size)
@@ -799,6 +1217,72 @@ static int ARSTREAM2_RtpReceiver_NetReadControlData(ARSTREAM2_RtpReceiver_t *rec
     return (int)bytes;
 }
 
+static int ARSTREAM2_RtpReceiver_StreamShmSetup(ARSTREAM2_RtpReceiver_t *receiver)
+{
+    if ((receiver == NULL) || (receiver->net.shm == NULL))
+        return -EINVAL;
+
+    /* the RTP ring eventfd is readable when the sender has signaled new packets */
+    receiver->net.streamSocket = -1;
+    receiver->net.streamEventFd = ARSTREAM2_ShmTransport_GetEventFd(receiver->net.shm, ARSTREAM2_SHM_TRANSPORT_RING_STREAM);
+
+    return 0;
+}
+
+static int ARSTREAM2_RtpReceiver_StreamShmTeardown(ARSTREAM2_RtpReceiver_t *receiver)
+{
+    if (receiver == NULL)
+        return -EINVAL;
+
+    /* the eventfd is owned by the transport */
+    receiver->net.streamEventFd = -1;
+
+    return 0;
+}
+
+static int ARSTREAM2_RtpReceiver_ShmRecvMmsg(ARSTREAM2_RtpReceiver_t *receiver, struct mmsghdr *msgvec, unsigned int vlen, int blocking)
+{
+    if ((receiver == NULL) || (receiver->net.shm == NULL) || (msgvec == NULL))
+        return -EINVAL;
+
+    return ARSTREAM2_ShmTransport_RecvMmsg(receiver->net.shm, ARSTREAM2_SHM_TRANSPORT_RING_STREAM, msgvec, vlen);
+}
+
+static int ARSTREAM2_RtpReceiver_ControlShmSetup(ARSTREAM2_RtpReceiver_t *receiver)
+{
+    if ((receiver == NULL) || (receiver->net.shm == NULL))
+        return -EINVAL;
+
+    /* the sender RTCP ring eventfd is readable when the sender has signaled new reports */
+    receiver->net.controlSocket = ARSTREAM2_ShmTransport_GetEventFd(receiver->net.shm, ARSTREAM2_SHM_TRANSPORT_RING_SENDER_CONTROL);
+
+    return 0;
+}
+
+static int ARSTREAM2_RtpReceiver_ControlShmTeardown(ARSTREAM2_RtpReceiver_t *receiver)
+{
+    if (receiver == NULL)
+        return -EINVAL;
+
+    /* the eventfd is owned by the transport */
+    receiver->net.controlSocket = -1;
+
+    return 0;
+}
+
+static int ARSTREAM2_RtpReceiver_ShmSendControlData(ARSTREAM2_RtpReceiver_t *receiver, uint8_t *buffer, int size)
+{
+    int ret = ARSTREAM2_ShmTransport_Send(receiver->net.shm, ARSTREAM2_SHM_TRANSPORT_RING_RECEIVER_CONTROL, buffer, size);
+    if (ret < 0)
+        ret = -errno;
+    return ret;
+}
+
+static int ARSTREAM2_RtpReceiver_ShmReadControlData(ARSTREAM2_RtpReceiver_t *receiver, uint8_t *buffer, int size)
+{
+    return ARSTREAM2_ShmTransport_Recv(receiver->net.shm, ARSTREAM2_SHM_TRANSPORT_RING_SENDER_CONTROL, buffer, size);
+}
+
 
 void ARSTREAM2_RtpReceiver_Stop(ARSTREAM2_RtpReceiver_t *receiver)
 {
@@ -831,7 +1315,6 @@ ARSTREAM2_RtpReceiver_t* ARSTREAM2_RtpReceiver_New(ARSTREAM2_RtpReceiver_Config_
                                                    eARSTREAM2_ERROR *error)
 {
     ARSTREAM2_RtpReceiver_t *retReceiver = NULL;
-    int monitoringMutexWasInit = 0;
     eARSTREAM2_ERROR internalError = ARSTREAM2_OK;
 
     /* ARGS Check */
@@ -936,6 +1419,7 @@ ARSTREAM2_RtpReceiver_t* ARSTREAM2_RtpReceiver_New(ARSTREAM2_RtpReceiver_Config_
         retReceiver->packetFifo = config->packetFifo;
         retReceiver->packetFifoQueue = config->packetFifoQueue;
         retReceiver->msgVecCount = retReceiver->packetFifo->bufferPoolSize;
+        retReceiver->recvStats.msgVecCount = retReceiver->msgVecCount;
         retReceiver->rtpStatsCallback = config->rtpStatsCallback;
         retReceiver->rtpStatsCallbackUserPtr = config->rtpStatsCallbackUserPtr;
         retReceiver->rtph264ReceiverContext.auCallback = config->auCallback;
@@ -982,6 +1466,13 @@ ARSTREAM2_RtpReceiver_t* ARSTREAM2_RtpReceiver_New(ARSTREAM2_RtpReceiver_Config_
         retReceiver->rtcpReceiverContext.lossReportCtx.sendTimeInterval = config->lossReportSendTimeInterval;
         retReceiver->rtcpReceiverContext.djbReportCtx.sendTimeInterval = config->djbReportSendTimeInterval;
         retReceiver->rtcpReceiverContext.djbReportCtx.djbMetricsAvailable = 0;
+        retReceiver->rtcpReceiverContext.nackCtx.enabled = ((config->generateNack > 0) && (retReceiver->generateReceiverReports)) ? 1 : 0;
+        retReceiver->rtcpReceiverContext.nackCtx.retryInterval = ARSTREAM2_RTCP_NACK_DEFAULT_RETRY_INTERVAL;
+        if (config->useFec > 0)
+        {
+            ARSTREAM2_RTPFEC_Receiver_Init(&retReceiver->fecReceiverContext);
+            retReceiver->rtpReceiverContext.fecCtx = &retReceiver->fecReceiverContext;
+        }
 
         if (retReceiver->rtpReceiverContext.maxPacketSize < sizeof(ARSTREAM2_RTCP_ReceiverReport_t) + sizeof(ARSTREAM2_RTCP_ReceptionReportBlock_t))
         {
@@ -994,12 +1485,15 @@ ARSTREAM2_RtpReceiver_t* ARSTREAM2_RtpReceiver_New(ARSTREAM2_RtpReceiver_Config_
             ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARSTREAM2_RTP_RECEIVER_TAG, "New RTP Receiver using sockets");
             retReceiver->net.isMulticast = 0;
             retReceiver->net.streamSocket = -1;
+            retReceiver->net.streamEventFd = -1;
             retReceiver->net.controlSocket = -1;
+            retReceiver->uring.ringFd = -1;
 
             if (net_config->mcastAddr)
             {
                 retReceiver->net.isMulticast = 1;
                 retReceiver->generateReceiverReports = 0; // Force not sending RTCP receiver reports in multicast mode
+                retReceiver->rtcpReceiverContext.nackCtx.enabled = 0;
                 retReceiver->net.serverAddr = strndup(net_config->mcastAddr, 16);
             }
             if (net_config->mcastIfaceAddr)
@@ -1015,17 +1509,53 @@ ARSTREAM2_RtpReceiver_t* ARSTREAM2_RtpReceiver_New(ARSTREAM2_RtpReceiver_Config_
             retReceiver->net.clientStreamPort = (net_config->clientStreamPort > 0) ? net_config->clientStreamPort : ARSTREAM2_RTP_RECEIVER_DEFAULT_CLIENT_STREAM_PORT;
             retReceiver->net.clientControlPort = (net_config->clientControlPort > 0) ? net_config->clientControlPort : ARSTREAM2_RTP_RECEIVER_DEFAULT_CLIENT_CONTROL_PORT;
             retReceiver->net.classSelector = net_config->classSelector;
+            retReceiver->net.useGro = (net_config->useGro > 0) ? 1 : 0;
+            retReceiver->net.useIoUring = (net_config->useIoUring > 0) ? 1 : 0;
+            if ((retReceiver->net.useIoUring) && (retReceiver->net.useGro))
+            {
+                ARSAL_PRINT(ARSAL_PRINT_WARNING, ARSTREAM2_RTP_RECEIVER_TAG, "Config: UDP GRO is not used with io_uring reception");
+                retReceiver->net.useGro = 0;
+            }
 
             retReceiver->useMux = 0;
 
-            retReceiver->ops.streamChannelSetup = ARSTREAM2_RtpReceiver_StreamSocketSetup;
-            retReceiver->ops.streamChannelRecvMmsg = ARSTREAM2_RtpReceiver_NetRecvMmsg;
-            retReceiver->ops.streamChannelTeardown = ARSTREAM2_RtpReceiver_StreamSocketTeardown;
+            if ((net_config->shmTransport) && (ARSTREAM2_ShmTransport_Ref(net_config->shmTransport) == ARSTREAM2_OK))
+            {
+                ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARSTREAM2_RTP_RECEIVER_TAG, "Using the shared memory transport");
+                retReceiver->net.shm = net_config->shmTransport;
+                retReceiver->net.useGro = 0;
+                retReceiver->net.useIoUring = 0;
+
+                retReceiver->ops.streamChannelSetup = ARSTREAM2_RtpReceiver_StreamShmSetup;
+                retReceiver->ops.streamChannelRecvMmsg = ARSTREAM2_RtpReceiver_ShmRecvMmsg;
+                retReceiver->ops.streamChannelTeardown = ARSTREAM2_RtpReceiver_StreamShmTeardown;
+
+                retReceiver->ops.controlChannelSetup = ARSTREAM2_RtpReceiver_ControlShmSetup;
+                retReceiver->ops.controlChannelSend = ARSTREAM2_RtpReceiver_ShmSendControlData;
+                retReceiver->ops.controlChannelRead = ARSTREAM2_RtpReceiver_ShmReadControlData;
+                retReceiver->ops.controlChannelTeardown = ARSTREAM2_RtpReceiver_ControlShmTeardown;
+            }
+            else if (retReceiver->net.useIoUring)
+            {
+                /* falls back to the socket ops on setup when io_uring is not available */
+                retReceiver->ops.streamChannelSetup = ARSTREAM2_RtpReceiver_StreamUringSetup;
+                retReceiver->ops.streamChannelRecvMmsg = ARSTREAM2_RtpReceiver_UringRecvMmsg;
+                retReceiver->ops.streamChannelTeardown = ARSTREAM2_RtpReceiver_StreamUringTeardown;
+            }
+            else
+            {
+                retReceiver->ops.streamChannelSetup = ARSTREAM2_RtpReceiver_StreamSocketSetup;
+                retReceiver->ops.streamChannelRecvMmsg = ARSTREAM2_RtpReceiver_NetRecvMmsg;
+                retReceiver->ops.streamChannelTeardown = ARSTREAM2_RtpReceiver_StreamSocketTeardown;
+            }
 
-            retReceiver->ops.controlChannelSetup = ARSTREAM2_RtpReceiver_ControlSocketSetup;
-            retReceiver->ops.controlChannelSend = ARSTREAM2_RtpReceiver_NetSendControlData;
-            retReceiver->ops.controlChannelRead = ARSTREAM2_RtpReceiver_NetReadControlData;
-            retReceiver->ops.controlChannelTeardown = ARSTREAM2_RtpReceiver_ControlSocketTeardown;
+            if (!retReceiver->net.shm)
+            {
+                retReceiver->ops.controlChannelSetup = ARSTREAM2_RtpReceiver_ControlSocketSetup;
+                retReceiver->ops.controlChannelSend = ARSTREAM2_RtpReceiver_NetSendControlData;
+                retReceiver->ops.controlChannelRead = ARSTREAM2_RtpReceiver_NetReadControlData;
+                retReceiver->ops.controlChannelTeardown = ARSTREAM2_RtpReceiver_ControlSocketTeardown;
+            }
         }
 
 #if BUILD_LIBMUX
@@ -1049,20 +1579,6 @@ ARSTREAM2_RtpReceiver_t* ARSTREAM2_RtpReceiver_New(ARSTREAM2_RtpReceiver_Config_
 
     }
 
-    /* Setup internal mutexes/sems */
-    if (internalError == ARSTREAM2_OK)
-    {
-        int mutexInitRet = ARSAL_Mutex_Init(&(retReceiver->monitoringMutex));
-        if (mutexInitRet != 0)
-        {
-            internalError = ARSTREAM2_ERROR_ALLOC;
-        }
-        else
-        {
-            monitoringMutexWasInit = 1;
-        }
-    }
-
     /* MsgVec array */
     if (internalError == ARSTREAM2_OK)
     {
@@ -1086,6 +1602,18 @@ ARSTREAM2_RtpReceiver_t* ARSTREAM2_RtpReceiver_New(ARSTREAM2_RtpReceiver_Config_
         }
     }
 
+    /* GRO message and copy buffer */
+    if ((internalError == ARSTREAM2_OK) && (retReceiver->net.useGro))
+    {
+        retReceiver->groCopyBuffer = malloc(ARSTREAM2_RTP_RECEIVER_GRO_MAX_SIZE);
+        retReceiver->groMsg = calloc(1, sizeof(struct mmsghdr));
+        if ((!retReceiver->groCopyBuffer) || (!retReceiver->groMsg))
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_RECEIVER_TAG, "GRO buffer allocation failed (size %d)", ARSTREAM2_RTP_RECEIVER_GRO_MAX_SIZE);
+            internalError = ARSTREAM2_ERROR_ALLOC;
+        }
+    }
+
     /* Stream channel setup */
     if (internalError == ARSTREAM2_OK)
     {
@@ -1132,17 +1660,19 @@ ARSTREAM2_RtpReceiver_t* ARSTREAM2_RtpReceiver_New(ARSTREAM2_RtpReceiver_Config_
         {
             ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_RECEIVER_TAG, "Failed to teardown the control channel (error %d : %s).\n", -ret, strerror(-ret));
         }
-        if (monitoringMutexWasInit == 1)
-        {
-            ARSAL_Mutex_Destroy(&(retReceiver->monitoringMutex));
-        }
         free(retReceiver->msgVec);
+        free(retReceiver->groCopyBuffer);
+        free(retReceiver->groMsg);
         free(retReceiver->rtcpMsgBuffer);
         free(retReceiver->canonicalName);
         free(retReceiver->friendlyName);
         free(retReceiver->applicationName);
         free(retReceiver->net.serverAddr);
         free(retReceiver->net.mcastIfaceAddr);
+        if (retReceiver->net.shm)
+        {
+            ARSTREAM2_ShmTransport_Unref(retReceiver->net.shm);
+        }
 
 #if BUILD_LIBMUX
         if ((retReceiver) && (retReceiver->mux.mux))
@@ -1176,8 +1706,9 @@ eARSTREAM2_ERROR ARSTREAM2_RtpReceiver_Delete(ARSTREAM2_RtpReceiver_t **receiver
         {
             ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_RECEIVER_TAG, "Failed to teardown the control channel (error %d : %s).\n", -ret, strerror(-ret));
         }
-        ARSAL_Mutex_Destroy(&((*receiver)->monitoringMutex));
         free((*receiver)->msgVec);
+        free((*receiver)->groCopyBuffer);
+        free((*receiver)->groMsg);
         free((*receiver)->rtcpMsgBuffer);
         free((*receiver)->canonicalName);
         free((*receiver)->friendlyName);
@@ -1185,6 +1716,10 @@ eARSTREAM2_ERROR ARSTREAM2_RtpReceiver_Delete(ARSTREAM2_RtpReceiver_t **receiver
         free((*receiver)->net.serverAddr);
         free((*receiver)->net.mcastIfaceAddr);
         free((*receiver)->rtcpReceiverContext.lossReportCtx.receivedFlag);
+        if ((*receiver)->net.shm)
+        {
+            ARSTREAM2_ShmTransport_Unref((*receiver)->net.shm);
+        }
 
 #if BUILD_LIBMUX
         if ((*receiver)->mux.mux)
@@ -1215,16 +1750,16 @@ eARSTREAM2_ERROR ARSTREAM2_RtpReceiver_GetSelectParams(ARSTREAM2_RtpReceiver_t *
     if (!receiver->useMux)
     {
         _maxFd = -1;
-        if (receiver->net.streamSocket > _maxFd) _maxFd = receiver->net.streamSocket;
+        if (receiver->net.streamEventFd > _maxFd) _maxFd = receiver->net.streamEventFd;
         if (receiver->net.controlSocket > _maxFd) _maxFd = receiver->net.controlSocket;
         if (readSet)
         {
-            FD_SET(receiver->net.streamSocket, *readSet);
+            FD_SET(receiver->net.streamEventFd, *readSet);
             FD_SET(receiver->net.controlSocket, *readSet);
         }
         if (exceptSet)
         {
-            FD_SET(receiver->net.streamSocket, *exceptSet);
+            FD_SET(receiver->net.streamEventFd, *exceptSet);
             FD_SET(receiver->net.controlSocket, *exceptSet);
         }
     }
@@ -1245,12 +1780,134 @@ eARSTREAM2_ERROR ARSTREAM2_RtpReceiver_GetSelectParams(ARSTREAM2_RtpReceiver_t *
 }
 
 
+eARSTREAM2_ERROR ARSTREAM2_RtpReceiver_GetPollParams(ARSTREAM2_RtpReceiver_t *receiver, int *streamFd, int *controlFd, int *streamReadPending, uint32_t *nextTimeout)
+{
+    // Args check
+    if (receiver == NULL)
+    {
+        return ARSTREAM2_ERROR_BAD_PARAMETERS;
+    }
+
+    if (streamFd) *streamFd = (!receiver->useMux) ? receiver->net.streamEventFd : -1;
+    if (controlFd) *controlFd = (!receiver->useMux) ? receiver->net.controlSocket : -1;
+    if (streamReadPending) *streamReadPending = receiver->streamReadPending;
+    if (nextTimeout) *nextTimeout = (receiver->generateReceiverReports) ? ((receiver->nextRrDelay < ARSTREAM2_RTP_RECEIVER_TIMEOUT_US) ? receiver->nextRrDelay : ARSTREAM2_RTP_RECEIVER_TIMEOUT_US) : ARSTREAM2_RTP_RECEIVER_TIMEOUT_US;
+
+    return ARSTREAM2_OK;
+}
+
+
+static inline unsigned int ARSTREAM2_RtpReceiver_RecvStatsBucket(uint64_t value)
+{
+    unsigned int bucket = 0;
+
+    while ((value) && (bucket < ARSTREAM2_RTP_RECEIVER_RECV_STATS_HISTOGRAM_BUCKET_COUNT - 1))
+    {
+        value >>= 1;
+        bucket++;
+    }
+
+    return bucket;
+}
+
+
+static inline uint64_t ARSTREAM2_RtpReceiver_GetTimeUs(void)
+{
+    struct timespec t;
+    ARSAL_Time_GetTime(&t);
+    return (uint64_t)t.tv_sec * 1000000 + (uint64_t)t.tv_nsec / 1000;
+}
+
+
+/* WARNING: the call sequence ARSTREAM2_RtpReceiver_StreamGroFill -> ARSTREAM2_RtpReceiver_StreamGroRecv
+   -> ARSTREAM2_RTP_Receiver_PacketFifoAddFromMsgVec must not be broken (no change made to the free items list) */
+static int ARSTREAM2_RtpReceiver_StreamGroFill(ARSTREAM2_RtpReceiver_t *receiver)
+{
+    unsigned int maxBufferCount = (receiver->msgVecCount < ARSTREAM2_RTP_RECEIVER_GRO_MAX_SEGMENTS) ? receiver->msgVecCount : ARSTREAM2_RTP_RECEIVER_GRO_MAX_SEGMENTS;
+    int ret;
+
+    /* lay out the free buffers for the last seen segment size so that
+     * the kernel scatters each segment directly into its own buffer */
+    receiver->groBufferSize = (receiver->packetFifo->bufferFree) ? receiver->packetFifo->bufferFree->bufferSize : 0;
+    receiver->groLayoutSegmentSize = receiver->groSegmentSize;
+    ret = ARSTREAM2_RTP_Receiver_PacketFifoFillGroMsg(receiver->packetFifo, &receiver->groMsg->msg_hdr, receiver->groIov,
+                                                      maxBufferCount, &receiver->groLayoutSegmentSize);
+    if (ret > 0)
+    {
+        receiver->groMsg->msg_hdr.msg_control = receiver->groControl.buf;
+        receiver->groMsg->msg_hdr.msg_controllen = sizeof(receiver->groControl.buf);
+        receiver->groMsg->msg_len = 0;
+    }
+
+    return ret;
+}
+
+
+static int ARSTREAM2_RtpReceiver_StreamGroRecv(ARSTREAM2_RtpReceiver_t *receiver, unsigned int bufferCount)
+{
+    unsigned int recvSize, recvSegmentSize;
+    struct cmsghdr *cmsg;
+    int ret;
+
+    ret = receiver->ops.streamChannelRecvMmsg(receiver, receiver->groMsg, 1, 0);
+    if (ret <= 0)
+    {
+        return ret;
+    }
+
+    recvSize = receiver->groMsg->msg_len;
+    recvSegmentSize = recvSize;
+    for (cmsg = CMSG_FIRSTHDR(&receiver->groMsg->msg_hdr); cmsg; cmsg = CMSG_NXTHDR(&receiver->groMsg->msg_hdr, cmsg))
+    {
+#if ARSTREAM2_RTP_RECEIVER_HAS_GRO
+        if ((cmsg->cmsg_level == SOL_UDP) && (cmsg->cmsg_type == UDP_GRO))
+        {
+            int gsoSize;
+            memcpy(&gsoSize, CMSG_DATA(cmsg), sizeof(gsoSize));
+            if (gsoSize > 0)
+            {
+                recvSegmentSize = (unsigned int)gsoSize;
+            }
+        }
+#endif
+    }
+
+    if (receiver->groMsg->msg_hdr.msg_flags & MSG_TRUNC)
+    {
+        /* the chained buffers were too small: drop the partial last segment */
+        ARSAL_PRINT(ARSAL_PRINT_WARNING, ARSTREAM2_RTP_RECEIVER_TAG, "Truncated GRO receive (%d bytes, segment size %d)", recvSize, recvSegmentSize);
+        recvSize -= recvSize % recvSegmentSize;
+        if (recvSize == 0)
+        {
+            return 0;
+        }
+    }
+
+    ret = ARSTREAM2_RTP_Receiver_PacketFifoSplitGroMsg(receiver->groIov, bufferCount, receiver->groBufferSize,
+                                                       receiver->groLayoutSegmentSize, recvSize, recvSegmentSize,
+                                                       receiver->groCopyBuffer, receiver->msgVec, receiver->msgVecCount);
+    if (ret < 0)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_RECEIVER_TAG, "ARSTREAM2_RTP_Receiver_PacketFifoSplitGroMsg() failed (%d)", ret);
+        return 0;
+    }
+
+    if ((ret > 1) && (recvSegmentSize != receiver->groSegmentSize))
+    {
+        /* only coalesced receives tell the actual segment size */
+        receiver->groSegmentSize = recvSegmentSize;
+    }
+
+    return ret;
+}
+
+
 eARSTREAM2_ERROR ARSTREAM2_RtpReceiver_ProcessRtp(ARSTREAM2_RtpReceiver_t *receiver, int selectRet, fd_set *readSet, fd_set *writeSet, fd_set *exceptSet,
                                                   int *shouldStop, ARSTREAM2_RTP_PacketFifoQueue_t **resendQueue, uint32_t *resendTimeout, unsigned int resendCount)
 {
     eARSTREAM2_ERROR retVal = ARSTREAM2_OK;
     struct timespec t1;
-    uint64_t curTime;
+    uint64_t curTime, t3;
     int ret;
 
     // Args check
@@ -1259,7 +1916,7 @@ eARSTREAM2_ERROR ARSTREAM2_RtpReceiver_ProcessRtp(ARSTREAM2_RtpReceiver_t *recei
         return ARSTREAM2_ERROR_BAD_PARAMETERS;
     }
 
-    if ((exceptSet) && (FD_ISSET(receiver->net.streamSocket, exceptSet)))
+    if ((exceptSet) && (FD_ISSET(receiver->net.streamEventFd, exceptSet)))
     {
         ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_RECEIVER_TAG, "Exception on stream socket");
     }
@@ -1268,48 +1925,131 @@ eARSTREAM2_ERROR ARSTREAM2_RtpReceiver_ProcessRtp(ARSTREAM2_RtpReceiver_t *recei
     curTime = (uint64_t)t1.tv_sec * 1000000 + (uint64_t)t1.tv_nsec / 1000;
 
     /* RTP packets reception */
-    if ((!readSet) || ((selectRet >= 0) && (FD_ISSET(receiver->net.streamSocket, readSet))))
+    if ((!readSet) || (receiver->streamReadPending) || ((selectRet >= 0) && (FD_ISSET(receiver->net.streamEventFd, readSet))))
     {
-        ret = ARSTREAM2_RTP_Receiver_PacketFifoFillMsgVec(receiver->packetFifo, receiver->msgVec, receiver->msgVecCount);
-        if (ret < 0)
-        {
-            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_RECEIVER_TAG, "ARSTREAM2_RTP_Receiver_PacketFifoFillMsgVec() failed (%d)", ret);
-        }
-        else if (ret > 0)
-        {
-            unsigned int msgCount = (unsigned  int)ret;
+        /* With sockets, read until the socket is drained (required by edge-triggered event loops)
+         * or until there are no more free packet buffers */
+        int recvMore = 1;
+        receiver->streamReadPending = 0;
 
-            ret = receiver->ops.streamChannelRecvMmsg(receiver, receiver->msgVec, msgCount, receiver->useMux);
-            if (ret < 0)
+        while (recvMore)
+        {
+            recvMore = 0;
+            if ((!receiver->useMux) && (receiver->net.useGro))
             {
-                if (ret == -EPIPE && receiver->useMux == 1)
+                ret = ARSTREAM2_RtpReceiver_StreamGroFill(receiver);
+            }
+            else
+            {
+                ret = ARSTREAM2_RTP_Receiver_PacketFifoFillMsgVec(receiver->packetFifo, receiver->msgVec,
+                                                                  (receiver->singleRecvCount > 0) ? 1 : receiver->msgVecCount);
+                if (receiver->singleRecvCount > 0)
                 {
-                    /* EPIPE with the mux means that we should no longer use the channel */
-                    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARSTREAM2_RTP_RECEIVER_TAG, "Got an EPIPE for stream channel, stopping thread");
-                    if (shouldStop) *shouldStop = 1;
+                    receiver->singleRecvCount--;
                 }
-                if (ret != -ETIMEDOUT)
+            }
+            if (ret < 0)
+            {
+                ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_RECEIVER_TAG, "ARSTREAM2_RTP_Receiver_PacketFifoFillMsgVec() failed (%d)", ret);
+            }
+            else if (ret == 0)
+            {
+                if (!receiver->useMux)
                 {
-                    ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_RECEIVER_TAG, "Failed to read data (%d)", ret);
+                    /* No free buffers: the socket may not be drained */
+                    receiver->streamReadPending = 1;
                 }
             }
-            else if (ret > 0)
+            else
             {
-                unsigned int recvMsgCount = (unsigned int)ret;
+                unsigned int msgCount = (unsigned  int)ret;
 
-                ret = ARSTREAM2_RTP_Receiver_PacketFifoAddFromMsgVec(&receiver->rtpReceiverContext, receiver->packetFifo,
-                                                                     receiver->packetFifoQueue, resendQueue, resendTimeout, resendCount,
-                                                                     receiver->msgVec, recvMsgCount, curTime,
-                                                                     &receiver->rtcpReceiverContext);
+                if ((!receiver->useMux) && (receiver->net.useGro))
+                {
+                    ret = ARSTREAM2_RtpReceiver_StreamGroRecv(receiver, msgCount);
+                }
+                else
+                {
+                    ret = receiver->ops.streamChannelRecvMmsg(receiver, receiver->msgVec, msgCount, receiver->useMux);
+                }
                 if (ret < 0)
                 {
-                    ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_RECEIVER_TAG, "ARSTREAM2_RTP_Receiver_PacketFifoAddFromMsgVec() failed (%d)", ret);
+                    if (ret == -EPIPE && receiver->useMux == 1)
+                    {
+                        /* EPIPE with the mux means that we should no longer use the channel */
+                        ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARSTREAM2_RTP_RECEIVER_TAG, "Got an EPIPE for stream channel, stopping thread");
+                        if (shouldStop) *shouldStop = 1;
+                    }
+                    if (ret != -ETIMEDOUT)
+                    {
+                        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_RECEIVER_TAG, "Failed to read data (%d)", ret);
+                    }
+                }
+                else if (ret > 0)
+                {
+                    unsigned int recvMsgCount = (unsigned int)ret, i;
+                    uint64_t recvBytes = 0, t2, addTime;
+                    uint64_t spillCount = receiver->packetFifo->overflowCount + receiver->packetFifo->truncatedCount;
+
+                    for (i = 0; i < recvMsgCount; i++)
+                    {
+                        recvBytes += receiver->msgVec[i].msg_len;
+                    }
+
+                    t2 = ARSTREAM2_RtpReceiver_GetTimeUs();
+                    ret = ARSTREAM2_RTP_Receiver_PacketFifoAddFromMsgVec(&receiver->rtpReceiverContext, receiver->packetFifo,
+                                                                         receiver->packetFifoQueue, resendQueue, resendTimeout, resendCount,
+                                                                         receiver->msgVec, recvMsgCount, curTime,
+                                                                         &receiver->rtcpReceiverContext);
+                    if (ret < 0)
+                    {
+                        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_RECEIVER_TAG, "ARSTREAM2_RTP_Receiver_PacketFifoAddFromMsgVec() failed (%d)", ret);
+                    }
+                    addTime = ARSTREAM2_RtpReceiver_GetTimeUs() - t2;
+                    if ((receiver->packetFifo->overflowSpill) && (recvMsgCount > 1)
+                            && (receiver->packetFifo->overflowCount + receiver->packetFifo->truncatedCount != spillCount))
+                    {
+                        /* large datagrams are coming: do not let them overwrite each other in the spill area */
+                        receiver->singleRecvCount = ARSTREAM2_RTP_RECEIVER_OVERFLOW_SINGLE_RECV_COUNT;
+                    }
+
+                    __atomic_add_fetch(&receiver->recvStats.batchCount, 1, __ATOMIC_RELAXED);
+                    __atomic_add_fetch(&receiver->recvStats.datagramCount, recvMsgCount, __ATOMIC_RELAXED);
+                    __atomic_add_fetch(&receiver->recvStats.byteCount, recvBytes, __ATOMIC_RELAXED);
+                    if (recvMsgCount == receiver->msgVecCount)
+                    {
+                        __atomic_add_fetch(&receiver->recvStats.fullBatchCount, 1, __ATOMIC_RELAXED);
+                    }
+                    __atomic_add_fetch(&receiver->recvStats.packetFifoAddTime, addTime, __ATOMIC_RELAXED);
+                    __atomic_add_fetch(&receiver->recvStats.batchDatagramsHistogram[ARSTREAM2_RtpReceiver_RecvStatsBucket(recvMsgCount)], 1, __ATOMIC_RELAXED);
+                    __atomic_add_fetch(&receiver->recvStats.batchBytesHistogram[ARSTREAM2_RtpReceiver_RecvStatsBucket(recvBytes)], 1, __ATOMIC_RELAXED);
+                    __atomic_add_fetch(&receiver->recvStats.packetFifoAddTimeHistogram[ARSTREAM2_RtpReceiver_RecvStatsBucket(addTime)], 1, __ATOMIC_RELAXED);
+
+                    if ((!receiver->useMux) && ((receiver->net.useGro) || (recvMsgCount == msgCount)))
+                    {
+                        /* The batch was full (or GRO is used), there may be more packets waiting */
+                        recvMore = 1;
+                    }
                 }
             }
         }
     }
 
+    /* FEC recovery */
+    if (receiver->rtpReceiverContext.fecCtx)
+    {
+        ret = ARSTREAM2_RTPFEC_Receiver_Process(receiver->rtpReceiverContext.fecCtx, &receiver->rtpReceiverContext,
+                                                receiver->packetFifo, receiver->packetFifoQueue,
+                                                resendQueue, resendTimeout, resendCount,
+                                                curTime, &receiver->rtcpReceiverContext);
+        if (ret < 0)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_RECEIVER_TAG, "ARSTREAM2_RTPFEC_Receiver_Process() failed (%d)", ret);
+        }
+    }
+
     /* RTP packets processing */
+    t3 = ARSTREAM2_RtpReceiver_GetTimeUs();
     ret = ARSTREAM2_RTPH264_Receiver_PacketFifoToAuFifo(&receiver->rtph264ReceiverContext, receiver->packetFifo,
                                                         receiver->packetFifoQueue, receiver->auFifo,
                                                         curTime, &receiver->rtcpReceiverContext);
@@ -1317,11 +2057,48 @@ eARSTREAM2_ERROR ARSTREAM2_RtpReceiver_ProcessRtp(ARSTREAM2_RtpReceiver_t *recei
     {
         ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_RECEIVER_TAG, "ARSTREAM2_RTPH264_Receiver_PacketFifoToAuFifo() failed (%d)", ret);
     }
+    t3 = ARSTREAM2_RtpReceiver_GetTimeUs() - t3;
+    __atomic_add_fetch(&receiver->recvStats.auFifoAddTime, t3, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&receiver->recvStats.auFifoAddTimeHistogram[ARSTREAM2_RtpReceiver_RecvStatsBucket(t3)], 1, __ATOMIC_RELAXED);
 
     return retVal;
 }
 
 
+#define ARSTREAM2_RTP_RECEIVER_RECV_STATS_READ(_field) \
+    ((reset) ? __atomic_exchange_n(&(_field), 0, __ATOMIC_RELAXED) : __atomic_load_n(&(_field), __ATOMIC_RELAXED))
+
+eARSTREAM2_ERROR ARSTREAM2_RtpReceiver_GetRecvStats(ARSTREAM2_RtpReceiver_t *receiver, ARSTREAM2_RtpReceiver_RecvStats_t *recvStats, int reset)
+{
+    int i;
+
+    if ((!receiver) || (!recvStats))
+    {
+        return ARSTREAM2_ERROR_BAD_PARAMETERS;
+    }
+
+    /* each counter is read (and reset) atomically, the structure as a whole is not a snapshot */
+    recvStats->msgVecCount = receiver->recvStats.msgVecCount;
+    recvStats->batchCount = ARSTREAM2_RTP_RECEIVER_RECV_STATS_READ(receiver->recvStats.batchCount);
+    recvStats->datagramCount = ARSTREAM2_RTP_RECEIVER_RECV_STATS_READ(receiver->recvStats.datagramCount);
+    recvStats->byteCount = ARSTREAM2_RTP_RECEIVER_RECV_STATS_READ(receiver->recvStats.byteCount);
+    recvStats->fullBatchCount = ARSTREAM2_RTP_RECEIVER_RECV_STATS_READ(receiver->recvStats.fullBatchCount);
+    recvStats->packetFifoAddTime = ARSTREAM2_RTP_RECEIVER_RECV_STATS_READ(receiver->recvStats.packetFifoAddTime);
+    recvStats->auFifoAddTime = ARSTREAM2_RTP_RECEIVER_RECV_STATS_READ(receiver->recvStats.auFifoAddTime);
+    for (i = 0; i < ARSTREAM2_RTP_RECEIVER_RECV_STATS_HISTOGRAM_BUCKET_COUNT; i++)
+    {
+        recvStats->batchDatagramsHistogram[i] = ARSTREAM2_RTP_RECEIVER_RECV_STATS_READ(receiver->recvStats.batchDatagramsHistogram[i]);
+        recvStats->batchBytesHistogram[i] = ARSTREAM2_RTP_RECEIVER_RECV_STATS_READ(receiver->recvStats.batchBytesHistogram[i]);
+        recvStats->packetFifoAddTimeHistogram[i] = ARSTREAM2_RTP_RECEIVER_RECV_STATS_READ(receiver->recvStats.packetFifoAddTimeHistogram[i]);
+        recvStats->auFifoAddTimeHistogram[i] = ARSTREAM2_RTP_RECEIVER_RECV_STATS_READ(receiver->recvStats.auFifoAddTimeHistogram[i]);
+    }
+
+    return ARSTREAM2_OK;
+}
+
+#undef ARSTREAM2_RTP_RECEIVER_RECV_STATS_READ
+
+
 eARSTREAM2_ERROR ARSTREAM2_RtpReceiver_ProcessRtcp(ARSTREAM2_RtpReceiver_t *receiver, int selectRet, fd_set *readSet, fd_set *writeSet, fd_set *exceptSet, int *shouldStop)
 {
     eARSTREAM2_ERROR retVal = ARSTREAM2_OK;
@@ -1385,9 +2162,24 @@ eARSTREAM2_ERROR ARSTREAM2_RtpReceiver_ProcessRtcp(ARSTREAM2_RtpReceiver_t *rece
     /* RTCP receiver reports */
     if (receiver->generateReceiverReports)
     {
+        int generateNack = 0;
+
+        if ((receiver->rtcpReceiverContext.nackCtx.enabled)
+                && (curTime >= receiver->rtcpReceiverContext.nackCtx.lastSendTime + ARSTREAM2_RTCP_NACK_MIN_PACKET_TIME_INTERVAL))
+        {
+            /* retry after one round trip plus some margin */
+            int64_t rtDelay = receiver->rtcpReceiverContext.clockDeltaCtx.rtDelayAvg;
+            uint32_t retryInterval = (rtDelay > 0) ? (uint32_t)(rtDelay + rtDelay / 2) : ARSTREAM2_RTCP_NACK_DEFAULT_RETRY_INTERVAL;
+            if (retryInterval < ARSTREAM2_RTCP_NACK_MIN_RETRY_INTERVAL) retryInterval = ARSTREAM2_RTCP_NACK_MIN_RETRY_INTERVAL;
+            if (retryInterval > ARSTREAM2_RTCP_NACK_MAX_RETRY_INTERVAL) retryInterval = ARSTREAM2_RTCP_NACK_MAX_RETRY_INTERVAL;
+            receiver->rtcpReceiverContext.nackCtx.retryInterval = retryInterval;
+            generateNack = (ARSTREAM2_RTCP_NackIsPending(&receiver->rtcpReceiverContext.nackCtx, curTime) > 0) ? 1 : 0;
+        }
+
         rrDelay = (uint32_t)(curTime - receiver->rtcpReceiverContext.lastRtcpTimestamp);
-        if ((rrDelay >= receiver->nextRrDelay) && (receiver->rtcpReceiverContext.prevSrNtpTimestamp != 0))
+        if (((rrDelay >= receiver->nextRrDelay) || (generateNack)) && (receiver->rtcpReceiverContext.prevSrNtpTimestamp != 0))
         {
+            /* NACK feedback is sent early (see RFC4585) in a compound packet starting with a receiver report */
             unsigned int size = 0;
             int generateVideoStats = 0;
             int generateLossReport = 0;
@@ -1421,7 +2213,7 @@ eARSTREAM2_ERROR ARSTREAM2_RtpReceiver_ProcessRtcp(ARSTREAM2_RtpReceiver_t *rece
 
             ret = ARSTREAM2_RTCP_Receiver_GenerateCompoundPacket(receiver->rtcpMsgBuffer, receiver->rtpReceiverContext.maxPacketSize, curTime,
                                                                  1, 1, 1, generateVideoStats, generateLossReport, generateDjbReport,
-                                                                 &receiver->rtcpReceiverContext, &size);
+                                                                 generateNack, &receiver->rtcpReceiverContext, &size);
             if ((ret == 0) && (size > 0))
             {
                 receiver->rtcpDropStatsTotalPackets++;
@@ -1535,6 +2327,10 @@ eARSTREAM2_ERROR ARSTREAM2_RtpReceiver_ProcessEnd(ARSTREAM2_RtpReceiver_t *recei
         return ARSTREAM2_ERROR_BAD_PARAMETERS;
     }
 
+    /* release the FEC references before flushing the packet FIFO */
+    if (receiver->rtpReceiverContext.fecCtx)
+        ARSTREAM2_RTPFEC_Receiver_Flush(receiver->rtpReceiverContext.fecCtx, receiver->packetFifo);
+
     /* flush the packet FIFO */
     if (queueOnly)
         ARSTREAM2_RTP_Receiver_PacketFifoFlushQueue(receiver->packetFifo, receiver->packetFifoQueue);
@@ -1709,10 +2505,12 @@ eARSTREAM2_ERROR ARSTREAM2_RtpReceiver_GetMonitoring(ARSTREAM2_RtpReceiver_t *re
                                                      uint32_t *bytesReceived, uint32_t *meanPacketSize, uint32_t *packetSizeStdDev, uint32_t *packetsReceived, uint32_t *packetsMissed)
 {
     eARSTREAM2_ERROR ret = ARSTREAM2_OK;
-    uint64_t endTime, curTime, previousTime, auTimestamp, receptionTimeSum = 0, receptionTimeVarSum = 0, packetSizeVarSum = 0;
-    uint32_t bytes, bytesSum = 0, _meanPacketSize = 0, receptionTime = 0, meanReceptionTime = 0, _receptionTimeJitter = 0, _packetSizeStdDev = 0;
-    int currentSeqNum, previousSeqNum = -1, seqNumDelta, gapsInSeqNum = 0;
-    int points = 0, usefulPoints = 0, idx, i, firstUsefulIdx = -1;
+    ARSTREAM2_RtpReceiver_MonitoringPoint_t first, last;
+    uint64_t endTime, minTime, bytesSum = 0, bytesSqSum = 0, receptionTimeSum = 0, receptionTimeSqSum = 0;
+    uint32_t _meanPacketSize = 0, _receptionTimeJitter = 0, _packetSizeStdDev = 0;
+    int64_t gapsInSeqNum = 0;
+    int usefulPoints, count, oldestIdx, lo, hi, mid, firstPos, lastPos;
+    unsigned int seq;
 
     if ((receiver == NULL) || (timeIntervalUs == 0))
     {
@@ -1725,72 +2523,74 @@ eARSTREAM2_ERROR ARSTREAM2_RtpReceiver_GetMonitoring(ARSTREAM2_RtpReceiver_t *re
         ARSAL_Time_GetTime(&t1);
         startTime = (uint64_t)t1.tv_sec * 1000000 + (uint64_t)t1.tv_nsec / 1000;
     }
-    endTime = startTime;
+    minTime = (startTime > timeIntervalUs) ? startTime - timeIntervalUs : 0;
 
-    ARSAL_Mutex_Lock(&(receiver->monitoringMutex));
+#define ARSTREAM2_RTP_RECEIVER_MONITORING_POINT(_pos) \
+    (receiver->monitoringPoint[(oldestIdx + (_pos)) % ARSTREAM2_RTP_RECEIVER_MONITORING_MAX_POINTS])
 
-    if (receiver->monitoringCount > 0)
+    /* the window holds the points received in [startTime - timeIntervalUs, startTime]
+     * (the former full scan used the point preceding each of them instead);
+     * the points are in recvTimestamp order: binary search the window bounds
+     * and use the running sums, retry if the writer updated the ring meanwhile */
+    do
     {
-        idx = receiver->monitoringIndex;
-        previousTime = startTime;
-
-        while (points < receiver->monitoringCount)
+        seq = __atomic_load_n(&receiver->monitoringSeq, __ATOMIC_ACQUIRE);
+        endTime = startTime;
+        usefulPoints = 0;
+        count = receiver->monitoringCount;
+        if ((!(seq & 1)) && (count > 0) && (count <= ARSTREAM2_RTP_RECEIVER_MONITORING_MAX_POINTS))
         {
-            curTime = receiver->monitoringPoint[idx].recvTimestamp;
-            if (curTime > startTime)
-            {
-                points++;
-                idx = (idx - 1 >= 0) ? idx - 1 : ARSTREAM2_RTP_RECEIVER_MONITORING_MAX_POINTS - 1;
-                continue;
-            }
-            if (startTime - curTime > timeIntervalUs)
+            oldestIdx = (receiver->monitoringIndex + ARSTREAM2_RTP_RECEIVER_MONITORING_MAX_POINTS - count + 1) % ARSTREAM2_RTP_RECEIVER_MONITORING_MAX_POINTS;
+
+            /* last point received at or before startTime */
+            for (lo = 0, hi = count; lo < hi; )
             {
-                break;
+                mid = (lo + hi) / 2;
+                if (ARSTREAM2_RTP_RECEIVER_MONITORING_POINT(mid).recvTimestamp > startTime) hi = mid; else lo = mid + 1;
             }
-            if (firstUsefulIdx == -1)
+            lastPos = lo - 1;
+
+            /* first point received in the time interval */
+            for (lo = 0, hi = count; lo < hi; )
             {
-                firstUsefulIdx = idx;
+                mid = (lo + hi) / 2;
+                if (ARSTREAM2_RTP_RECEIVER_MONITORING_POINT(mid).recvTimestamp < minTime) lo = mid + 1; else hi = mid;
             }
-            idx = (idx - 1 >= 0) ? idx - 1 : ARSTREAM2_RTP_RECEIVER_MONITORING_MAX_POINTS - 1;
-            curTime = receiver->monitoringPoint[idx].recvTimestamp;
-            bytes = receiver->monitoringPoint[idx].bytes;
-            bytesSum += bytes;
-            auTimestamp = receiver->monitoringPoint[idx].ntpTimestampLocal;
-            receptionTime = curTime - auTimestamp;
-            receptionTimeSum += receptionTime;
-            currentSeqNum = receiver->monitoringPoint[idx].seqNum;
-            seqNumDelta = (previousSeqNum != -1) ? (previousSeqNum - currentSeqNum) : 1;
-            if (seqNumDelta < -32768) seqNumDelta += 65536; /* handle seqNum 16 bits loopback */
-            gapsInSeqNum += seqNumDelta - 1;
-            previousSeqNum = currentSeqNum;
-            previousTime = curTime;
-            usefulPoints++;
-            points++;
-            idx = (idx - 1 >= 0) ? idx - 1 : ARSTREAM2_RTP_RECEIVER_MONITORING_MAX_POINTS - 1;
-        }
-
-        endTime = previousTime;
-        _meanPacketSize = (usefulPoints) ? (bytesSum / usefulPoints) : 0;
-        meanReceptionTime = (usefulPoints) ? (uint32_t)(receptionTimeSum / usefulPoints) : 0;
-
-        if ((receptionTimeJitter) || (packetSizeStdDev))
-        {
-            for (i = 0, idx = firstUsefulIdx; i < usefulPoints; i++)
+            firstPos = lo;
+
+            if (lastPos >= firstPos)
             {
-                idx = (idx - 1 >= 0) ? idx - 1 : ARSTREAM2_RTP_RECEIVER_MONITORING_MAX_POINTS - 1;
-                curTime = receiver->monitoringPoint[idx].recvTimestamp;
-                bytes = receiver->monitoringPoint[idx].bytes;
-                auTimestamp = receiver->monitoringPoint[idx].ntpTimestampLocal;
-                receptionTime = curTime - auTimestamp;
-                packetSizeVarSum += ((bytes - _meanPacketSize) * (bytes - _meanPacketSize));
-                receptionTimeVarSum += ((receptionTime - meanReceptionTime) * (receptionTime - meanReceptionTime));
+                first = ARSTREAM2_RTP_RECEIVER_MONITORING_POINT(firstPos);
+                last = ARSTREAM2_RTP_RECEIVER_MONITORING_POINT(lastPos);
+                usefulPoints = lastPos - firstPos + 1;
             }
-            _receptionTimeJitter = (usefulPoints) ? (uint32_t)(sqrt((double)receptionTimeVarSum / usefulPoints)) : 0;
-            _packetSizeStdDev = (usefulPoints) ? (uint32_t)(sqrt((double)packetSizeVarSum / usefulPoints)) : 0;
         }
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
     }
+    while ((seq & 1) || (__atomic_load_n(&receiver->monitoringSeq, __ATOMIC_RELAXED) != seq));
+
+#undef ARSTREAM2_RTP_RECEIVER_MONITORING_POINT
+
+    if (usefulPoints > 0)
+    {
+        uint32_t firstReceptionTime = (uint32_t)(first.recvTimestamp - first.ntpTimestampLocal);
+        double mean, var;
+
+        endTime = first.recvTimestamp;
+        bytesSum = last.bytesSum - first.bytesSum + first.bytes;
+        bytesSqSum = last.bytesSqSum - first.bytesSqSum + (uint64_t)first.bytes * first.bytes;
+        receptionTimeSum = last.receptionTimeSum - first.receptionTimeSum + firstReceptionTime;
+        receptionTimeSqSum = last.receptionTimeSqSum - first.receptionTimeSqSum + (uint64_t)firstReceptionTime * firstReceptionTime;
+        gapsInSeqNum = last.gapsInSeqNumSum - first.gapsInSeqNumSum;
 
-    ARSAL_Mutex_Unlock(&(receiver->monitoringMutex));
+        _meanPacketSize = (uint32_t)(bytesSum / usefulPoints);
+        mean = (double)bytesSum / usefulPoints;
+        var = (double)bytesSqSum / usefulPoints - mean * mean;
+        _packetSizeStdDev = (var > 0.) ? (uint32_t)sqrt(var) : 0;
+        mean = (double)receptionTimeSum / usefulPoints;
+        var = (double)receptionTimeSqSum / usefulPoints - mean * mean;
+        _receptionTimeJitter = (var > 0.) ? (uint32_t)sqrt(var) : 0;
+    }
 
     if (realTimeIntervalUs)
     {
@@ -1802,7 +2602,7 @@ eARSTREAM2_ERROR ARSTREAM2_RtpReceiver_GetMonitoring(ARSTREAM2_RtpReceiver_t *re
     }
     if (bytesReceived)
     {
-        *bytesReceived = bytesSum;
+        *bytesReceived = (uint32_t)bytesSum;
     }
     if (meanPacketSize)
     {
@@ -1818,7 +2618,7 @@ eARSTREAM2_ERROR ARSTREAM2_RtpReceiver_GetMonitoring(ARSTREAM2_RtpReceiver_t *re
     }
     if (packetsMissed)
     {
-        *packetsMissed = gapsInSeqNum;
+        *packetsMissed = (uint32_t)gapsInSeqNum;
     }
 
     return ret;
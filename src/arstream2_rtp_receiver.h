@@ -28,6 +28,7 @@
 #include "arstream2_rtp_sender.h"
 #include "arstream2_rtp.h"
 #include "arstream2_rtp_h264.h"
+#include "arstream2_rtp_fec.h"
 #include "arstream2_rtcp.h"
 #include "arstream2_h264.h"
 
@@ -54,6 +55,20 @@
 
 #define ARSTREAM2_RTP_RECEIVER_RTCP_DROP_LOG_INTERVAL (10)
 
+#define ARSTREAM2_RTP_RECEIVER_RECV_STATS_HISTOGRAM_BUCKET_COUNT (24)
+
+#define ARSTREAM2_RTP_RECEIVER_GRO_MAX_SEGMENTS (64)
+
+/* after a datagram spilled into the packet FIFO overflow area (shared by a whole batch),
+   receive one datagram at a time for this number of calls */
+#define ARSTREAM2_RTP_RECEIVER_OVERFLOW_SINGLE_RECV_COUNT (64)
+
+/* io_uring provided buffer ring (the buffers are sized for the max packet size
+   but only the pages actually written to become resident) */
+#define ARSTREAM2_RTP_RECEIVER_URING_BUFFER_COUNT (256)
+#define ARSTREAM2_RTP_RECEIVER_URING_SQ_ENTRIES (4)
+#define ARSTREAM2_RTP_RECEIVER_GRO_MAX_SIZE (65535)
+
 
 /**
  * @brief Callback function for RTP stats
@@ -78,6 +93,9 @@ typedef struct ARSTREAM2_RtpReceiver_NetConfig_t
     int clientStreamPort;                           /**< Client stream port */
     int clientControlPort;                          /**< Client control port */
     eARSAL_SOCKET_CLASS_SELECTOR classSelector;     /**< Type of Service class selector */
+    int useGro;                                     /**< Boolean-like (0-1) flag: if active receive coalesced RTP packets with UDP generic receive offload (Linux only, falls back to recvmmsg when not supported) */
+    int useIoUring;                                 /**< Boolean-like (0-1) flag: if active receive RTP packets with an io_uring multishot recvmsg (Linux only, falls back to recvmmsg when not supported; disables useGro) */
+    ARSTREAM2_ShmTransport_t *shmTransport;         /**< Shared memory transport used instead of the sockets (optional, can be NULL) */
 } ARSTREAM2_RtpReceiver_NetConfig_t;
 
 // Forward declaration of the mux_ctx structure
@@ -111,6 +129,8 @@ typedef struct ARSTREAM2_RtpReceiver_Config_t
     uint32_t videoStatsSendTimeInterval;            /**< Time interval for sending video stats in compound RTCP packets (optional, can be null) */
     uint32_t lossReportSendTimeInterval;            /**< Time interval for sending loss reports in compound RTCP packets (optional, can be null) */
     uint32_t djbReportSendTimeInterval;             /**< Time interval for sending de-jitter buffer metrics reports in compound RTCP packets (optional, can be null) */
+    int generateNack;                               /**< Boolean-like (0-1) flag: if active send RTCP generic NACK feedback for missing packets (requires generateReceiverReports) */
+    int useFec;                                     /**< Boolean-like (0-1) flag: if active recover missing packets from the sender FEC repair packets */
 } ARSTREAM2_RtpReceiver_Config_t;
 
 
@@ -128,9 +148,34 @@ typedef struct ARSTREAM2_RtpReceiver_MonitoringPoint_s {
     uint16_t seqNum;
     uint16_t markerBit;
     uint32_t bytes;
+    /* running sums up to and including this point */
+    uint64_t bytesSum;
+    uint64_t bytesSqSum;
+    uint64_t receptionTimeSum;
+    uint64_t receptionTimeSqSum;
+    int64_t gapsInSeqNumSum;
 } ARSTREAM2_RtpReceiver_MonitoringPoint_t;
 
 
+/**
+ * @brief RtpReceiver network reception stats
+ * Histograms use power of two buckets (bucket i counts values in [2^(i-1), 2^i - 1]).
+ */
+typedef struct ARSTREAM2_RtpReceiver_RecvStats_s {
+    uint32_t msgVecCount;
+    uint64_t batchCount;
+    uint64_t datagramCount;
+    uint64_t byteCount;
+    uint64_t fullBatchCount;
+    uint64_t packetFifoAddTime;
+    uint64_t auFifoAddTime;
+    uint32_t batchDatagramsHistogram[ARSTREAM2_RTP_RECEIVER_RECV_STATS_HISTOGRAM_BUCKET_COUNT];
+    uint32_t batchBytesHistogram[ARSTREAM2_RTP_RECEIVER_RECV_STATS_HISTOGRAM_BUCKET_COUNT];
+    uint32_t packetFifoAddTimeHistogram[ARSTREAM2_RTP_RECEIVER_RECV_STATS_HISTOGRAM_BUCKET_COUNT];
+    uint32_t auFifoAddTimeHistogram[ARSTREAM2_RTP_RECEIVER_RECV_STATS_HISTOGRAM_BUCKET_COUNT];
+} ARSTREAM2_RtpReceiver_RecvStats_t;
+
+
 struct ARSTREAM2_RtpReceiver_NetInfos_t {
     char *serverAddr;
     char *mcastIfaceAddr;
@@ -139,12 +184,49 @@ struct ARSTREAM2_RtpReceiver_NetInfos_t {
     int clientStreamPort;
     int clientControlPort;
     int classSelector;
+    int useGro;
+    int useIoUring;
 
     /* Sockets */
     int isMulticast;
     int streamSocket;
+    int streamEventFd;  /* file descriptor to wait on for the stream channel (stream socket or io_uring) */
     int controlSocket;
     struct sockaddr_in controlSendSin;
+
+    /* Shared memory transport (no sockets, the event file descriptors are the ring eventfds) */
+    ARSTREAM2_ShmTransport_t *shm;
+};
+
+struct ARSTREAM2_RtpReceiver_UringInfos_t {
+    int ringFd;
+    void *sqRing;
+    size_t sqRingSize;
+    void *cqRing;
+    size_t cqRingSize;
+    void *sqes;
+    size_t sqesSize;
+    unsigned int *sqTail;
+    unsigned int *sqMask;
+    unsigned int *sqFlags;
+    unsigned int *sqArray;
+    unsigned int *cqHead;
+    unsigned int *cqTail;
+    unsigned int *cqMask;
+    void *cqes;
+
+    /* provided buffer ring (ring entries followed by the buffers) */
+    void *bufRing;
+    size_t bufRingSize;
+    uint8_t *buffers;
+    unsigned int bufferCount;
+    unsigned int bufferSize;
+    uint16_t bufRingTail;
+
+    /* multishot recvmsg (the msghdr must stay valid while armed) */
+    struct msghdr recvMsg;
+    int armed;
+    uint64_t rearmCount;
 };
 
 struct ARSTREAM2_RtpReceiver_MuxInfos_t {
@@ -179,12 +261,14 @@ struct ARSTREAM2_RtpReceiver_t {
     int useMux;
     struct ARSTREAM2_RtpReceiver_NetInfos_t net;
     struct ARSTREAM2_RtpReceiver_MuxInfos_t mux;
+    struct ARSTREAM2_RtpReceiver_UringInfos_t uring;
     struct ARSTREAM2_RtpReceiver_Ops_t ops;
 
     /* Process context */
     ARSTREAM2_RTP_ReceiverContext_t rtpReceiverContext;
     ARSTREAM2_RTPH264_ReceiverContext_t rtph264ReceiverContext;
     ARSTREAM2_RTCP_ReceiverContext_t rtcpReceiverContext;
+    ARSTREAM2_RTPFEC_ReceiverContext_t fecReceiverContext;
     ARSTREAM2_RtpReceiver_RtpStatsCallback_t rtpStatsCallback;
     void *rtpStatsCallbackUserPtr;
 
@@ -202,9 +286,23 @@ struct ARSTREAM2_RtpReceiver_t {
     ARSTREAM2_RTP_PacketFifoQueue_t *packetFifoQueue;
     struct mmsghdr *msgVec;
     unsigned int msgVecCount;
-
-    /* Monitoring */
-    ARSAL_Mutex_t monitoringMutex;
+    int streamReadPending;
+    unsigned int singleRecvCount;
+
+    /* UDP GRO */
+    struct mmsghdr *groMsg;                         /* allocated: struct mmsghdr is incomplete without _GNU_SOURCE */
+    struct iovec groIov[2 * ARSTREAM2_RTP_RECEIVER_GRO_MAX_SEGMENTS];
+    union {
+        struct cmsghdr align;
+        uint8_t buf[CMSG_SPACE(sizeof(int))];
+    } groControl;
+    unsigned int groSegmentSize;
+    unsigned int groLayoutSegmentSize;
+    unsigned int groBufferSize;
+    uint8_t *groCopyBuffer;
+
+    /* Monitoring (single writer, readers use the monitoringSeq sequence lock) */
+    unsigned int monitoringSeq;
     int monitoringCount;
     int monitoringIndex;
     ARSTREAM2_RtpReceiver_MonitoringPoint_t monitoringPoint[ARSTREAM2_RTP_RECEIVER_MONITORING_MAX_POINTS];
@@ -212,6 +310,9 @@ struct ARSTREAM2_RtpReceiver_t {
     unsigned int rtcpDropCount;
     unsigned int rtcpDropStatsTotalPackets;
     uint64_t rtcpDropLogStartTime;
+
+    /* Reception stats (written by the network thread only) */
+    ARSTREAM2_RtpReceiver_RecvStats_t recvStats;
 };
 
 
@@ -262,10 +363,45 @@ eARSTREAM2_ERROR ARSTREAM2_RtpReceiver_Delete(ARSTREAM2_RtpReceiver_t **receiver
 eARSTREAM2_ERROR ARSTREAM2_RtpReceiver_GetSelectParams(ARSTREAM2_RtpReceiver_t *receiver, fd_set **readSet, fd_set **writeSet, fd_set **exceptSet, int *maxFd, uint32_t *nextTimeout);
 
 
+/**
+ * @brief Get the event loop parameters
+ * This function is an alternative to ARSTREAM2_RtpReceiver_GetSelectParams() for event loops
+ * that register the file descriptors once (e.g. epoll) instead of rebuilding fd_sets.
+ * When the receiver does not use sockets (mux), the file descriptors are set to -1.
+ * The streamReadPending flag is set when the last reception stopped before the stream socket
+ * was drained (no free packet buffers); the stream socket must then be considered readable
+ * on the next ARSTREAM2_RtpReceiver_ProcessRtp() call even if no new event is notified.
+ *
+ * @param[in] receiver The receiver instance
+ * @param[out] streamFd Stream channel file descriptor: the stream socket, or the io_uring file descriptor with io_uring reception (optional, can be NULL)
+ * @param[out] controlFd Control socket file descriptor (optional, can be NULL)
+ * @param[out] streamReadPending Stream socket read pending flag (optional, can be NULL)
+ * @param[out] nextTimeout Next timeout in microseconds (optional, can be NULL)
+ *
+ * @return ARSTREAM2_OK if no error occured.
+ * @return ARSTREAM2_ERROR_BAD_PARAMETERS if the receiver is invalid.
+ */
+eARSTREAM2_ERROR ARSTREAM2_RtpReceiver_GetPollParams(ARSTREAM2_RtpReceiver_t *receiver, int *streamFd, int *controlFd, int *streamReadPending, uint32_t *nextTimeout);
+
+
 eARSTREAM2_ERROR ARSTREAM2_RtpReceiver_ProcessRtp(ARSTREAM2_RtpReceiver_t *receiver, int selectRet, fd_set *readSet, fd_set *writeSet, fd_set *exceptSet,
                                                   int *shouldStop, ARSTREAM2_RTP_PacketFifoQueue_t **resendQueue, uint32_t *resendTimeout, unsigned int resendCount);
 
 
+/**
+ * @brief Get the network reception stats
+ * The stats can be read from any thread while the network thread is running.
+ *
+ * @param[in] receiver The receiver instance
+ * @param[out] recvStats Pointer to the reception stats structure to fill
+ * @param[in] reset Boolean-like (0-1) flag: if active reset the stats after reading them
+ *
+ * @return ARSTREAM2_OK if no error occured.
+ * @return ARSTREAM2_ERROR_BAD_PARAMETERS if either the receiver or recvStats is invalid.
+ */
+eARSTREAM2_ERROR ARSTREAM2_RtpReceiver_GetRecvStats(ARSTREAM2_RtpReceiver_t *receiver, ARSTREAM2_RtpReceiver_RecvStats_t *recvStats, int reset);
+
+
 eARSTREAM2_ERROR ARSTREAM2_RtpReceiver_ProcessRtcp(ARSTREAM2_RtpReceiver_t *receiver, int selectRet, fd_set *readSet, fd_set *writeSet, fd_set *exceptSet, int *shouldStop);
 
 
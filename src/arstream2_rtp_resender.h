@@ -12,6 +12,8 @@
 
 #include <inttypes.h>
 
+#include <libARSAL/ARSAL_Thread.h>
+
 #include <libARStream2/arstream2_error.h>
 #include "arstream2_rtp_sender.h"
 #include "arstream2_rtp.h"
@@ -33,6 +35,23 @@ typedef struct ARSTREAM2_RtpResender_s
     int streamSocketSendBufferSize;
     uint32_t maxNetworkLatencyUs;
 
+    /* Event loop registration state (owned by the network thread) */
+    int pollRegistered;
+    int pollWritePending;
+
+    /* Worker thread mode: the network thread hands the packets over through
+     * the ring and the worker thread sends them from its own item-only FIFO
+     * (the buffers are given back to the receiver FIFO when unreferenced) */
+    int useThread;
+    ARSTREAM2_RTP_PacketRing_t ring;
+    ARSTREAM2_RTP_PacketFifo_t workerPacketFifo;
+    ARSTREAM2_RTP_PacketFifoQueue_t workerPacketFifoQueue;
+    ARSAL_Thread_t thread;
+    int threadShouldStop;
+    int signalPipe[2];
+    int signalPending;
+    uint32_t handoffDropCount;
+
     struct ARSTREAM2_RtpResender_s *prev;
     struct ARSTREAM2_RtpResender_s *next;
 
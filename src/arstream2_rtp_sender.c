@@ -19,11 +19,18 @@
 #include <netinet/ip.h>
 #include <fcntl.h>
 #include <math.h>
+#ifdef __linux__
+#include <netinet/udp.h>
+#include <time.h>
+#endif
 
 #include "arstream2_rtp_sender.h"
 #include "arstream2_rtp.h"
 #include "arstream2_rtp_h264.h"
+#include "arstream2_rtp_fec.h"
+#include "arstream2_rtp_cc.h"
 #include "arstream2_rtcp.h"
+#include "arstream2_shm_transport_internal.h"
 
 #include <libARSAL/ARSAL_Print.h>
 #include <libARSAL/ARSAL_Mutex.h>
@@ -50,7 +57,7 @@
 
 
 /**
- * Maximum number of elements for the monitoring
+ * Maximum number of elements for the monitoring (must be a power of 2)
  */
 #define ARSTREAM2_RTP_SENDER_MONITORING_MAX_POINTS (2048)
 
@@ -73,6 +80,88 @@
 #define ARSTREAM2_RTP_SENDER_DEFAULT_MIN_STREAM_SOCKET_SEND_BUFFER_SIZE (31250)
 
 
+/**
+ * UDP generic segmentation offload (Linux >= 4.18)
+ */
+#ifdef __linux__
+#define ARSTREAM2_RTP_SENDER_HAS_GSO 1
+#ifndef SOL_UDP
+#define SOL_UDP 17
+#endif
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+#else
+#define ARSTREAM2_RTP_SENDER_HAS_GSO 0
+#endif
+
+
+/**
+ * Maximum number of segments in a UDP GSO send (UDP_MAX_SEGMENTS in the kernel)
+ */
+#define ARSTREAM2_RTP_SENDER_GSO_MAX_SEGMENTS (64)
+
+
+/**
+ * Maximum total payload size of a UDP GSO send over IPv4
+ */
+#define ARSTREAM2_RTP_SENDER_GSO_MAX_SIZE (65507)
+
+
+/**
+ * Kernel timed transmission with SO_TXTIME launch times (Linux >= 4.19)
+ */
+#ifdef __linux__
+#define ARSTREAM2_RTP_SENDER_HAS_TXTIME 1
+#ifndef SO_TXTIME
+#define SO_TXTIME 61
+#endif
+#ifndef SCM_TXTIME
+#define SCM_TXTIME SO_TXTIME
+#endif
+#ifndef CLOCK_TAI
+#define CLOCK_TAI 11
+#endif
+#else
+#define ARSTREAM2_RTP_SENDER_HAS_TXTIME 0
+#endif
+
+
+/**
+ * Timed transmission: minimum launch time lead in microseconds with CLOCK_TAI launch
+ * times (the etf qdisc drops the packets whose launch time is closer than its delta)
+ */
+#define ARSTREAM2_RTP_SENDER_TXTIME_TAI_LEAD (500)
+
+
+/**
+ * Packet pacing: default and maximum access unit interval (used until the
+ * interval is estimated from the RTP timestamps) in microseconds
+ */
+#define ARSTREAM2_RTP_SENDER_PACING_DEFAULT_FRAME_INTERVAL (33333)
+#define ARSTREAM2_RTP_SENDER_PACING_MAX_FRAME_INTERVAL (200000)
+
+
+/**
+ * Packet pacing: minimum remaining pacing window in microseconds
+ * (late packets of an access unit are sent at least at this pace)
+ */
+#define ARSTREAM2_RTP_SENDER_PACING_MIN_WINDOW (1000)
+
+
+/**
+ * Packet pacing: token bucket depth in microseconds at the current rate
+ * (must cover the event loop wake-up granularity)
+ */
+#define ARSTREAM2_RTP_SENDER_PACING_BURST_TIME (2000)
+
+
+/**
+ * Minimum target bitrate change in percent for calling the bitrate callback function
+ */
+#define ARSTREAM2_RTP_SENDER_BITRATE_CALLBACK_THRESHOLD (5)
+
+
 /**
  * Maximum interval between calls to the RTPStats callback function in microseconds
  * (this is useful when the callback is needed but the receiver doesn't send RTCP packets)
@@ -109,9 +198,30 @@ typedef struct ARSTREAM2_RtpSender_MonitoringPoint_s {
     uint32_t priority;
     uint32_t bytesSent;
     uint32_t bytesDropped;
+    /* running sums up to and including this point */
+    uint64_t packetsSentSum;
+    uint64_t packetsDroppedSum;
+    uint64_t bytesSentSum;
+    uint64_t bytesSentSqSum;
+    uint64_t bytesDroppedSum;
+    uint64_t acqToNetworkTimeSum;
+    uint64_t acqToNetworkTimeSqSum;
+    uint64_t networkTimeSum;
+    uint64_t networkTimeSqSum;
 } ARSTREAM2_RtpSender_MonitoringPoint_t;
 
 
+/* min/max segment tree node over the monitoring ring slots */
+typedef struct ARSTREAM2_RtpSender_MonitoringMinMax_s {
+    uint32_t acqToNetworkTimeMin;
+    uint32_t acqToNetworkTimeMax;
+    uint32_t networkTimeMin;
+    uint32_t networkTimeMax;
+    uint32_t packetSizeMin;
+    uint32_t packetSizeMax;
+} ARSTREAM2_RtpSender_MonitoringMinMax_t;
+
+
 struct ARSTREAM2_RtpSender_t {
     /* Configuration on New */
     char *canonicalName;
@@ -131,11 +241,17 @@ struct ARSTREAM2_RtpSender_t {
     void *videoStatsCallbackUserPtr;
     ARSTREAM2_StreamSender_DisconnectionCallback_t disconnectionCallback;
     void *disconnectionCallbackUserPtr;
+    ARSTREAM2_StreamSender_BitrateCallback_t bitrateCallback;
+    void *bitrateCallbackUserPtr;
+    uint32_t lastTargetBitrate;
     int maxBitrate;
     uint8_t *rtcpMsgBuffer;
 
     ARSTREAM2_RTP_SenderContext_t rtpSenderContext;
     ARSTREAM2_RTCP_SenderContext_t rtcpSenderContext;
+    ARSTREAM2_RTPFEC_SenderContext_t fecSenderContext;
+    int useCongestionControl;
+    ARSTREAM2_RTPCC_Context_t ccContext;
 
     /* Sockets */
     int isMulticast;
@@ -144,6 +260,7 @@ struct ARSTREAM2_RtpSender_t {
     struct sockaddr_in controlSendSin;
     int streamSocket;
     int controlSocket;
+    ARSTREAM2_ShmTransport_t *shm;
     int packetsPending;
     int previouslySending;
     uint32_t nextSrDelay;
@@ -155,14 +272,50 @@ struct ARSTREAM2_RtpSender_t {
     struct mmsghdr *msgVec;
     unsigned int msgVecCount;
 
+    /* RTCP generic NACK retransmission */
+    int useRtcpNack;
+
+    /* UDP GSO */
+    int useGso;
+    struct mmsghdr *gsoMsgVec;
+    unsigned int *gsoMsgPacketCount;
+    struct iovec *gsoIov;
+    uint8_t *gsoControl;
+
+    /* Kernel timed transmission (SO_TXTIME launch times, the fq or etf qdisc does the pacing) */
+    int useTxTime;
+    int txTimeClockId;
+    uint32_t txTimeLead;
+    uint8_t *txTimeControl;
+    uint64_t *txTimeLaunch;
+    uint64_t txTimeNext;
+
+    /* Packet pacing (token bucket, byte counts in microbytes) */
+    int pacingWindowPercent;
+    int pacingActive;
+    uint32_t pacingRtpTimestamp;
+    uint64_t pacingAuStartTime;
+    uint32_t pacingFrameInterval;
+    uint64_t pacingRate;
+    int64_t pacingTokens;
+    uint64_t pacingLastTime;
+    uint32_t pacingDelay;
+    uint32_t pacedPacketCount;
+    uint64_t pacingDelayIntegral;
+    uint64_t pacingDelayIntegralSq;
+
+    /* delay until the earliest packet timeout in the queue */
+    uint32_t timeoutDelay;
+
     /* Monitoring & debug */
     ARSTREAM2_H264_VideoStats_t videoStats;
     char *dateAndTime;
     char *debugPath;
-    ARSAL_Mutex_t monitoringMutex;
+    unsigned int monitoringSeq;
     int monitoringCount;
     int monitoringIndex;
     ARSTREAM2_RtpSender_MonitoringPoint_t monitoringPoint[ARSTREAM2_RTP_SENDER_MONITORING_MAX_POINTS];
+    ARSTREAM2_RtpSender_MonitoringMinMax_t monitoringMinMax[2 * ARSTREAM2_RTP_SENDER_MONITORING_MAX_POINTS];
     FILE* fMonitorOut;
 
     unsigned int timeoutDropCount[ARSTREAM2_STREAM_SENDER_MAX_IMPORTANCE_LEVELS];
@@ -321,6 +474,46 @@ static int ARSTREAM2_RtpSender_StreamSocketSetup(ARSTREAM2_RtpSender_t *sender)
         }
     }
 
+    if ((ret == 0) && (sender->useGso))
+    {
+        /* check UDP GSO support */
+#if ARSTREAM2_RTP_SENDER_HAS_GSO
+        int segmentSize = 0;
+        socklen_t segmentSizeLen = sizeof(segmentSize);
+        err = getsockopt(sender->streamSocket, SOL_UDP, UDP_SEGMENT, (void*)&segmentSize, &segmentSizeLen);
+        if (err != 0)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_WARNING, ARSTREAM2_RTP_SENDER_TAG, "UDP GSO is not supported, using sendmmsg: error=%d (%s)", errno, strerror(errno));
+            sender->useGso = 0;
+        }
+#else
+        ARSAL_PRINT(ARSAL_PRINT_WARNING, ARSTREAM2_RTP_SENDER_TAG, "UDP GSO is not supported on this platform, using sendmmsg");
+        sender->useGso = 0;
+#endif
+    }
+
+    if ((ret == 0) && (sender->useTxTime))
+    {
+        /* enable the packet launch times */
+#if ARSTREAM2_RTP_SENDER_HAS_TXTIME
+        struct {
+            int32_t clockid;
+            uint32_t flags;
+        } txTime; /* struct sock_txtime */
+        txTime.clockid = sender->txTimeClockId;
+        txTime.flags = 0;
+        err = setsockopt(sender->streamSocket, SOL_SOCKET, SO_TXTIME, (void*)&txTime, sizeof(txTime));
+        if (err != 0)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_WARNING, ARSTREAM2_RTP_SENDER_TAG, "SO_TXTIME is not supported, using user-space pacing: error=%d (%s)", errno, strerror(errno));
+            sender->useTxTime = 0;
+        }
+#else
+        ARSAL_PRINT(ARSAL_PRINT_WARNING, ARSTREAM2_RTP_SENDER_TAG, "SO_TXTIME is not supported on this platform, using user-space pacing");
+        sender->useTxTime = 0;
+#endif
+    }
+
     if (ret != 0)
     {
         if (sender->streamSocket >= 0)
@@ -516,6 +709,373 @@ static int sendmmsg(int sockfd, struct mmsghdr *msgvec, unsigned int vlen, unsig
 }
 #endif
 
+#if ARSTREAM2_RTP_SENDER_HAS_GSO
+/* Pack consecutive packets of the same size into UDP GSO messages; a group ends
+ * with the first shorter packet, which becomes the last segment */
+static unsigned int ARSTREAM2_RtpSender_GsoFillMsgVec(ARSTREAM2_RtpSender_t *sender, unsigned int msgVecCount)
+{
+    struct msghdr *hdr = NULL;
+    struct cmsghdr *cmsg;
+    unsigned int i, k, gsoMsgCount = 0, iovCount = 0;
+    size_t len, segmentSize = 0, totalSize = 0;
+    int groupOpen = 0;
+
+    for (i = 0; i < msgVecCount; i++)
+    {
+        for (k = 0, len = 0; k < (unsigned int)sender->msgVec[i].msg_hdr.msg_iovlen; k++)
+        {
+            len += sender->msgVec[i].msg_hdr.msg_iov[k].iov_len;
+        }
+
+        if ((groupOpen) && (len <= segmentSize) && (totalSize + len <= ARSTREAM2_RTP_SENDER_GSO_MAX_SIZE)
+                && (sender->gsoMsgPacketCount[gsoMsgCount - 1] < ARSTREAM2_RTP_SENDER_GSO_MAX_SEGMENTS))
+        {
+            /* append the packet to the current GSO message */
+            sender->gsoMsgPacketCount[gsoMsgCount - 1]++;
+            totalSize += len;
+            if (len < segmentSize)
+            {
+                groupOpen = 0;
+            }
+        }
+        else
+        {
+            /* start a new GSO message */
+            hdr = &sender->gsoMsgVec[gsoMsgCount].msg_hdr;
+            hdr->msg_name = sender->msgVec[i].msg_hdr.msg_name;
+            hdr->msg_namelen = sender->msgVec[i].msg_hdr.msg_namelen;
+            hdr->msg_iov = &sender->gsoIov[iovCount];
+            hdr->msg_iovlen = 0;
+            hdr->msg_control = NULL;
+            hdr->msg_controllen = 0;
+            hdr->msg_flags = 0;
+            sender->gsoMsgVec[gsoMsgCount].msg_len = 0;
+            sender->gsoMsgPacketCount[gsoMsgCount] = 1;
+            gsoMsgCount++;
+            segmentSize = len;
+            totalSize = len;
+            groupOpen = 1;
+        }
+
+        for (k = 0; k < (unsigned int)sender->msgVec[i].msg_hdr.msg_iovlen; k++)
+        {
+            sender->gsoIov[iovCount++] = sender->msgVec[i].msg_hdr.msg_iov[k];
+        }
+        hdr->msg_iovlen += sender->msgVec[i].msg_hdr.msg_iovlen;
+
+        if (sender->gsoMsgPacketCount[gsoMsgCount - 1] == 2)
+        {
+            /* more than one segment: set the segment size */
+            hdr->msg_control = sender->gsoControl + (gsoMsgCount - 1) * CMSG_SPACE(sizeof(uint16_t));
+            hdr->msg_controllen = CMSG_SPACE(sizeof(uint16_t));
+            cmsg = CMSG_FIRSTHDR(hdr);
+            cmsg->cmsg_level = SOL_UDP;
+            cmsg->cmsg_type = UDP_SEGMENT;
+            cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+            *((uint16_t*)CMSG_DATA(cmsg)) = (uint16_t)segmentSize;
+        }
+    }
+
+    return gsoMsgCount;
+}
+
+
+/* Report the GSO messages sent sizes on the packets msgVec and return the number of packets sent */
+static int ARSTREAM2_RtpSender_GsoUpdateMsgVec(ARSTREAM2_RtpSender_t *sender, unsigned int gsoMsgCount)
+{
+    unsigned int i, j, k, p;
+    size_t len;
+    int sentCount = 0;
+
+    for (i = 0, p = 0; i < gsoMsgCount; i++)
+    {
+        for (j = 0; j < sender->gsoMsgPacketCount[i]; j++, p++)
+        {
+            if (sender->gsoMsgVec[i].msg_len > 0)
+            {
+                for (k = 0, len = 0; k < (unsigned int)sender->msgVec[p].msg_hdr.msg_iovlen; k++)
+                {
+                    len += sender->msgVec[p].msg_hdr.msg_iov[k].iov_len;
+                }
+                sender->msgVec[p].msg_len = (unsigned int)len;
+                sentCount++;
+            }
+        }
+    }
+
+    return sentCount;
+}
+#endif
+
+
+static inline unsigned int ARSTREAM2_RtpSender_PacketSize(const ARSTREAM2_RTP_Packet_t *packet)
+{
+    unsigned int k, size;
+
+    for (k = 0, size = 0; k < packet->msgIovLength; k++)
+    {
+        size += packet->buffer->msgIov[k].iov_len;
+    }
+
+    return size;
+}
+
+
+/* Start the pacing window of the access unit at the head of the queue if it is a new one
+ * (retransmitted packets of older access units do not restart the window) */
+static void ARSTREAM2_RtpSender_PacerCheckAccessUnit(ARSTREAM2_RtpSender_t *sender, const ARSTREAM2_RTP_PacketFifoItem_t *cur, uint64_t curTime)
+{
+    if ((!sender->pacingActive) || ((int32_t)(cur->packet.rtpTimestamp - sender->pacingRtpTimestamp) > 0))
+    {
+        if (sender->pacingActive)
+        {
+            uint64_t interval = (uint64_t)(cur->packet.rtpTimestamp - sender->pacingRtpTimestamp) * 1000000 / sender->rtpSenderContext.rtpClockRate;
+            if (interval <= ARSTREAM2_RTP_SENDER_PACING_MAX_FRAME_INTERVAL)
+            {
+                sender->pacingFrameInterval = (sender->pacingFrameInterval * 7 + (uint32_t)interval) / 8;
+            }
+        }
+        sender->pacingActive = 1;
+        sender->pacingRtpTimestamp = cur->packet.rtpTimestamp;
+        sender->pacingAuStartTime = curTime;
+    }
+}
+
+
+/* Refill the pacing token bucket and return the number of packets at the head of the queue
+ * that can be sent now; the rate spreads the queued bytes over what remains of the pacing
+ * window of the access unit at the head of the queue */
+static unsigned int ARSTREAM2_RtpSender_PacerGetAllowedCount(ARSTREAM2_RtpSender_t *sender, uint64_t curTime, unsigned int maxCount)
+{
+    ARSTREAM2_RTP_PacketFifoItem_t *cur = sender->packetFifoQueue->head;
+    int windowPercent = __atomic_load_n(&sender->pacingWindowPercent, __ATOMIC_RELAXED);
+    uint64_t queuedSize, window, elapsed, maxTokens;
+    int64_t tokens;
+    unsigned int count;
+
+    if ((windowPercent <= 0) || (!cur))
+    {
+        /* nothing to pace, the bucket will be full for the next access unit */
+        sender->pacingLastTime = 0;
+        return maxCount;
+    }
+
+    ARSTREAM2_RtpSender_PacerCheckAccessUnit(sender, cur, curTime);
+
+    for (queuedSize = 0; cur; cur = cur->next)
+    {
+        queuedSize += ARSTREAM2_RtpSender_PacketSize(&cur->packet);
+    }
+    window = (uint64_t)sender->pacingFrameInterval * windowPercent / 100;
+    elapsed = curTime - sender->pacingAuStartTime;
+    window = (elapsed + ARSTREAM2_RTP_SENDER_PACING_MIN_WINDOW < window) ? window - elapsed : ARSTREAM2_RTP_SENDER_PACING_MIN_WINDOW;
+    sender->pacingRate = queuedSize * 1000000 / window;
+
+    /* tokens are in microbytes: bytes per second times microseconds */
+    maxTokens = sender->pacingRate * ARSTREAM2_RTP_SENDER_PACING_BURST_TIME;
+    if (maxTokens < (uint64_t)sender->rtpSenderContext.maxPacketSize * 1000000)
+    {
+        maxTokens = (uint64_t)sender->rtpSenderContext.maxPacketSize * 1000000;
+    }
+    if (sender->pacingLastTime == 0)
+    {
+        tokens = (int64_t)maxTokens;
+    }
+    else
+    {
+        tokens = sender->pacingTokens + (int64_t)(sender->pacingRate * (curTime - sender->pacingLastTime));
+        if (tokens > (int64_t)maxTokens)
+        {
+            tokens = (int64_t)maxTokens;
+        }
+    }
+    sender->pacingTokens = tokens;
+    sender->pacingLastTime = curTime;
+
+    for (cur = sender->packetFifoQueue->head, count = 0; ((cur) && (count < maxCount)); cur = cur->next, count++)
+    {
+        int64_t size = (int64_t)ARSTREAM2_RtpSender_PacketSize(&cur->packet) * 1000000;
+        if (tokens < size)
+        {
+            break;
+        }
+        tokens -= size;
+    }
+
+    return count;
+}
+
+
+/* Consume the tokens of the packets sent from the head of the queue (must be called
+ * before the queue is cleaned) and update the pacing delay statistics */
+static void ARSTREAM2_RtpSender_PacerUpdate(ARSTREAM2_RtpSender_t *sender, uint64_t curTime, unsigned int sentCount)
+{
+    ARSTREAM2_RTP_PacketFifoItem_t *cur;
+    unsigned int i;
+
+    if (sender->pacingLastTime == 0)
+    {
+        return;
+    }
+
+    for (cur = sender->packetFifoQueue->head, i = 0; ((cur) && (i < sentCount)); cur = cur->next, i++)
+    {
+        sender->pacingTokens -= (int64_t)ARSTREAM2_RtpSender_PacketSize(&cur->packet) * 1000000;
+        if (cur->packet.rtpTimestamp == sender->pacingRtpTimestamp)
+        {
+            uint64_t delay = curTime - sender->pacingAuStartTime;
+            sender->pacedPacketCount++;
+            sender->pacingDelayIntegral += delay;
+            sender->pacingDelayIntegralSq += delay * delay;
+        }
+    }
+}
+
+
+/* Time until the packet at the head of the queue can be sent (0 if it is not held by the pacer) */
+static uint32_t ARSTREAM2_RtpSender_PacerGetDelay(ARSTREAM2_RtpSender_t *sender)
+{
+    ARSTREAM2_RTP_PacketFifoItem_t *cur = sender->packetFifoQueue->head;
+    int64_t missing;
+
+    if ((sender->pacingLastTime == 0) || (!cur) || (sender->pacingRate == 0))
+    {
+        return 0;
+    }
+
+    missing = (int64_t)ARSTREAM2_RtpSender_PacketSize(&cur->packet) * 1000000 - sender->pacingTokens;
+
+    return (missing > 0) ? (uint32_t)((uint64_t)missing / sender->pacingRate) + 1 : 0;
+}
+
+
+#if ARSTREAM2_RTP_SENDER_HAS_TXTIME
+/* Set the SO_TXTIME launch times of the packets filled in msgVec (all the queued packets are
+ * handed to the kernel at once); the queued bytes are spread over what remains of the pacing
+ * window of the access unit at the head of the queue, after the previously scheduled packets */
+static void ARSTREAM2_RtpSender_TxTimeFillMsgVec(ARSTREAM2_RtpSender_t *sender, uint64_t curTime, unsigned int msgVecCount)
+{
+    ARSTREAM2_RTP_PacketFifoItem_t *cur = sender->packetFifoQueue->head;
+    int windowPercent = __atomic_load_n(&sender->pacingWindowPercent, __ATOMIC_RELAXED);
+    uint64_t queuedSize, windowEnd, launchTime, rate, socketTime;
+    struct msghdr *hdr;
+    struct cmsghdr *cmsg;
+    struct timespec ts;
+    unsigned int i;
+
+    if ((windowPercent <= 0) || (!cur))
+    {
+        /* nothing to pace, the packets are sent right away */
+        sender->txTimeNext = 0;
+        return;
+    }
+
+    /* launch times are on the socket clock, which may differ from the ARSAL time */
+    if (clock_gettime(sender->txTimeClockId, &ts) != 0)
+    {
+        return;
+    }
+    socketTime = (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+
+    ARSTREAM2_RtpSender_PacerCheckAccessUnit(sender, cur, curTime);
+
+    for (queuedSize = 0, i = 0; ((cur) && (i < msgVecCount)); cur = cur->next, i++)
+    {
+        queuedSize += ARSTREAM2_RtpSender_PacketSize(&cur->packet);
+    }
+    launchTime = curTime + sender->txTimeLead;
+    if (sender->txTimeNext > launchTime)
+    {
+        launchTime = sender->txTimeNext;
+    }
+    windowEnd = sender->pacingAuStartTime + (uint64_t)sender->pacingFrameInterval * windowPercent / 100;
+    rate = queuedSize * 1000000 / ((launchTime + ARSTREAM2_RTP_SENDER_PACING_MIN_WINDOW < windowEnd) ? windowEnd - launchTime : ARSTREAM2_RTP_SENDER_PACING_MIN_WINDOW);
+    if (rate == 0)
+    {
+        return;
+    }
+
+    for (cur = sender->packetFifoQueue->head, i = 0; ((cur) && (i < msgVecCount)); cur = cur->next, i++)
+    {
+        sender->txTimeLaunch[i] = launchTime;
+        hdr = &sender->msgVec[i].msg_hdr;
+        hdr->msg_control = sender->txTimeControl + i * CMSG_SPACE(sizeof(uint64_t));
+        hdr->msg_controllen = CMSG_SPACE(sizeof(uint64_t));
+        cmsg = CMSG_FIRSTHDR(hdr);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_TXTIME;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(uint64_t));
+        *((uint64_t*)CMSG_DATA(cmsg)) = socketTime + (launchTime - curTime) * 1000;
+        launchTime += (uint64_t)ARSTREAM2_RtpSender_PacketSize(&cur->packet) * 1000000 / rate;
+    }
+    sender->txTimeNext = launchTime;
+}
+
+
+/* Update the pacing delay statistics from the launch times of the packets sent from the head
+ * of the queue (must be called before the queue is cleaned); the packets that were not sent
+ * are rescheduled from their launch time on the next call */
+static void ARSTREAM2_RtpSender_TxTimeUpdate(ARSTREAM2_RtpSender_t *sender, unsigned int sentCount, unsigned int msgVecCount)
+{
+    ARSTREAM2_RTP_PacketFifoItem_t *cur;
+    unsigned int i;
+
+    if ((msgVecCount == 0) || (!sender->msgVec[0].msg_hdr.msg_control))
+    {
+        return;
+    }
+
+    for (cur = sender->packetFifoQueue->head, i = 0; ((cur) && (i < sentCount)); cur = cur->next, i++)
+    {
+        if (cur->packet.rtpTimestamp == sender->pacingRtpTimestamp)
+        {
+            uint64_t delay = sender->txTimeLaunch[i] - sender->pacingAuStartTime;
+            sender->pacedPacketCount++;
+            sender->pacingDelayIntegral += delay;
+            sender->pacingDelayIntegralSq += delay * delay;
+        }
+    }
+    if (sentCount < msgVecCount)
+    {
+        sender->txTimeNext = sender->txTimeLaunch[sentCount];
+    }
+}
+#endif
+
+
+static inline void ARSTREAM2_RtpSender_MonitoringMinMaxMerge(ARSTREAM2_RtpSender_MonitoringMinMax_t *dst,
+                                                            const ARSTREAM2_RtpSender_MonitoringMinMax_t *a,
+                                                            const ARSTREAM2_RtpSender_MonitoringMinMax_t *b)
+{
+    dst->acqToNetworkTimeMin = (a->acqToNetworkTimeMin < b->acqToNetworkTimeMin) ? a->acqToNetworkTimeMin : b->acqToNetworkTimeMin;
+    dst->acqToNetworkTimeMax = (a->acqToNetworkTimeMax > b->acqToNetworkTimeMax) ? a->acqToNetworkTimeMax : b->acqToNetworkTimeMax;
+    dst->networkTimeMin = (a->networkTimeMin < b->networkTimeMin) ? a->networkTimeMin : b->networkTimeMin;
+    dst->networkTimeMax = (a->networkTimeMax > b->networkTimeMax) ? a->networkTimeMax : b->networkTimeMax;
+    dst->packetSizeMin = (a->packetSizeMin < b->packetSizeMin) ? a->packetSizeMin : b->packetSizeMin;
+    dst->packetSizeMax = (a->packetSizeMax > b->packetSizeMax) ? a->packetSizeMax : b->packetSizeMax;
+}
+
+
+/* min/max over the ring slots [first, last] (no wraparound) */
+static void ARSTREAM2_RtpSender_MonitoringMinMaxQuery(ARSTREAM2_RtpSender_t *sender, unsigned int first, unsigned int last,
+                                                      ARSTREAM2_RtpSender_MonitoringMinMax_t *result)
+{
+    unsigned int l = first + ARSTREAM2_RTP_SENDER_MONITORING_MAX_POINTS;
+    unsigned int r = last + ARSTREAM2_RTP_SENDER_MONITORING_MAX_POINTS + 1;
+
+    for (; l < r; l /= 2, r /= 2)
+    {
+        if (l & 1)
+        {
+            ARSTREAM2_RtpSender_MonitoringMinMaxMerge(result, result, &sender->monitoringMinMax[l++]);
+        }
+        if (r & 1)
+        {
+            ARSTREAM2_RtpSender_MonitoringMinMaxMerge(result, result, &sender->monitoringMinMax[--r]);
+        }
+    }
+}
+
 
 static void ARSTREAM2_RtpSender_UpdateMonitoring(uint64_t inputTimestamp, uint64_t outputTimestamp, uint64_t ntpTimestamp,
                                                  uint32_t rtpTimestamp, uint16_t seqNum, uint16_t markerBit,
@@ -523,31 +1083,72 @@ static void ARSTREAM2_RtpSender_UpdateMonitoring(uint64_t inputTimestamp, uint64
                                                  uint32_t bytesSent, uint32_t bytesDropped, void *userPtr)
 {
     ARSTREAM2_RtpSender_t *sender = (ARSTREAM2_RtpSender_t*)userPtr;
+    ARSTREAM2_RtpSender_MonitoringPoint_t zero, *prev, *point;
+    ARSTREAM2_RtpSender_MonitoringMinMax_t *node;
+    uint32_t acqToNetworkTime = 0, networkTime = 0;
+    unsigned int seq, idx, i;
 
     if (!sender)
     {
         return;
     }
 
-    ARSAL_Mutex_Lock(&(sender->monitoringMutex));
-
+    memset(&zero, 0, sizeof(zero));
+    prev = (sender->monitoringCount > 0) ? &sender->monitoringPoint[sender->monitoringIndex] : &zero;
+    idx = (sender->monitoringIndex + 1) % ARSTREAM2_RTP_SENDER_MONITORING_MAX_POINTS;
+    point = &sender->monitoringPoint[idx];
+    if (bytesSent)
+    {
+        acqToNetworkTime = (uint32_t)(outputTimestamp - ntpTimestamp);
+        networkTime = (uint32_t)(outputTimestamp - inputTimestamp);
+    }
+
+    /* odd sequence: write in progress */
+    seq = sender->monitoringSeq;
+    __atomic_store_n(&sender->monitoringSeq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    point->inputTimestamp = inputTimestamp;
+    point->outputTimestamp = outputTimestamp;
+    point->ntpTimestamp = ntpTimestamp;
+    point->rtpTimestamp = rtpTimestamp;
+    point->seqNum = seqNum;
+    point->markerBit = markerBit;
+    point->importance = importance;
+    point->priority = priority;
+    point->bytesSent = bytesSent;
+    point->bytesDropped = bytesDropped;
+    /* the sums wrap around; differences between two points stay exact */
+    point->packetsSentSum = prev->packetsSentSum + ((bytesSent) ? 1 : 0);
+    point->packetsDroppedSum = prev->packetsDroppedSum + ((bytesDropped) ? 1 : 0);
+    point->bytesSentSum = prev->bytesSentSum + bytesSent;
+    point->bytesSentSqSum = prev->bytesSentSqSum + (uint64_t)bytesSent * bytesSent;
+    point->bytesDroppedSum = prev->bytesDroppedSum + bytesDropped;
+    point->acqToNetworkTimeSum = prev->acqToNetworkTimeSum + acqToNetworkTime;
+    point->acqToNetworkTimeSqSum = prev->acqToNetworkTimeSqSum + (uint64_t)acqToNetworkTime * acqToNetworkTime;
+    point->networkTimeSum = prev->networkTimeSum + networkTime;
+    point->networkTimeSqSum = prev->networkTimeSqSum + (uint64_t)networkTime * networkTime;
+
+    /* leaf then ancestors; dropped-only points do not count in the min/max */
+    node = &sender->monitoringMinMax[ARSTREAM2_RTP_SENDER_MONITORING_MAX_POINTS + idx];
+    node->acqToNetworkTimeMin = (bytesSent) ? acqToNetworkTime : (uint32_t)(-1);
+    node->acqToNetworkTimeMax = acqToNetworkTime;
+    node->networkTimeMin = (bytesSent) ? networkTime : (uint32_t)(-1);
+    node->networkTimeMax = networkTime;
+    node->packetSizeMin = (bytesSent) ? bytesSent : (uint32_t)(-1);
+    node->packetSizeMax = bytesSent;
+    for (i = (ARSTREAM2_RTP_SENDER_MONITORING_MAX_POINTS + idx) / 2; i > 0; i /= 2)
+    {
+        ARSTREAM2_RtpSender_MonitoringMinMaxMerge(&sender->monitoringMinMax[i], &sender->monitoringMinMax[2 * i], &sender->monitoringMinMax[2 * i + 1]);
+    }
+
+    sender->monitoringIndex = idx;
     if (sender->monitoringCount < ARSTREAM2_RTP_SENDER_MONITORING_MAX_POINTS)
     {
         sender->monitoringCount++;
     }
-    sender->monitoringIndex = (sender->monitoringIndex + 1) % ARSTREAM2_RTP_SENDER_MONITORING_MAX_POINTS;
-    sender->monitoringPoint[sender->monitoringIndex].inputTimestamp = inputTimestamp;
-    sender->monitoringPoint[sender->monitoringIndex].outputTimestamp = outputTimestamp;
-    sender->monitoringPoint[sender->monitoringIndex].ntpTimestamp = ntpTimestamp;
-    sender->monitoringPoint[sender->monitoringIndex].rtpTimestamp = rtpTimestamp;
-    sender->monitoringPoint[sender->monitoringIndex].seqNum = seqNum;
-    sender->monitoringPoint[sender->monitoringIndex].markerBit = markerBit;
-    sender->monitoringPoint[sender->monitoringIndex].importance = importance;
-    sender->monitoringPoint[sender->monitoringIndex].priority = priority;
-    sender->monitoringPoint[sender->monitoringIndex].bytesSent = bytesSent;
-    sender->monitoringPoint[sender->monitoringIndex].bytesDropped = bytesDropped;
 
-    ARSAL_Mutex_Unlock(&(sender->monitoringMutex));
+    __atomic_store_n(&sender->monitoringSeq, seq + 2, __ATOMIC_RELEASE);
 
     if (sender->fMonitorOut)
     {
@@ -563,7 +1164,6 @@ static void ARSTREAM2_RtpSender_UpdateMonitoring(uint64_t inputTimestamp, uint64
 ARSTREAM2_RtpSender_t* ARSTREAM2_RtpSender_New(const ARSTREAM2_RtpSender_Config_t *config, eARSTREAM2_ERROR *error)
 {
     ARSTREAM2_RtpSender_t *retSender = NULL;
-    int monitoringMutexWasInit = 0;
     eARSTREAM2_ERROR internalError = ARSTREAM2_OK;
 
     /* ARGS Check */
@@ -655,15 +1255,56 @@ ARSTREAM2_RtpSender_t* ARSTREAM2_RtpSender_New(const ARSTREAM2_RtpSender_Config_
         retSender->videoStatsCallbackUserPtr = config->videoStatsCallbackUserPtr;
         retSender->disconnectionCallback = config->disconnectionCallback;
         retSender->disconnectionCallbackUserPtr = config->disconnectionCallbackUserPtr;
+        retSender->bitrateCallback = config->bitrateCallback;
+        retSender->bitrateCallbackUserPtr = config->bitrateCallbackUserPtr;
         retSender->naluFifo = config->naluFifo;
         retSender->packetFifo = config->packetFifo;
         retSender->packetFifoQueue = config->packetFifoQueue;
-        retSender->msgVecCount = retSender->packetFifo->bufferPoolSize;
+        /* an item-only FIFO can carry up to one packet per item */
+        retSender->msgVecCount = (retSender->packetFifo->bufferPoolSize > 0) ? retSender->packetFifo->bufferPoolSize : retSender->packetFifo->itemPoolSize;
         retSender->rtpSenderContext.maxPacketSize = config->maxPacketSize;
         retSender->rtpSenderContext.targetPacketSize = config->targetPacketSize;
         retSender->maxBitrate = config->maxBitrate;
         retSender->streamSocketSendBufferSize = config->streamSocketSendBufferSize;
         retSender->rtpSenderContext.useRtpHeaderExtensions = (config->useRtpHeaderExtensions > 0) ? 1 : 0;
+        retSender->useGso = (config->useGso > 0) ? 1 : 0;
+        retSender->useTxTime = (config->useTxTime > 0) ? 1 : 0;
+#if ARSTREAM2_RTP_SENDER_HAS_TXTIME
+        retSender->txTimeClockId = (config->useTxTime == 2) ? CLOCK_TAI : CLOCK_MONOTONIC;
+        retSender->txTimeLead = (config->useTxTime == 2) ? ARSTREAM2_RTP_SENDER_TXTIME_TAI_LEAD : 0;
+#endif
+        if ((config->shmTransport) && (ARSTREAM2_ShmTransport_Ref(config->shmTransport) == ARSTREAM2_OK))
+        {
+            retSender->shm = config->shmTransport;
+            if ((retSender->useGso) || (retSender->useTxTime))
+            {
+                /* the packets never reach a socket */
+                ARSAL_PRINT(ARSAL_PRINT_WARNING, ARSTREAM2_RTP_SENDER_TAG, "Config: UDP GSO and timed transmission are disabled with the shared memory transport");
+                retSender->useGso = 0;
+                retSender->useTxTime = 0;
+            }
+        }
+        if ((retSender->useTxTime) && (retSender->useGso))
+        {
+            /* a GSO message has a single launch time */
+            ARSAL_PRINT(ARSAL_PRINT_WARNING, ARSTREAM2_RTP_SENDER_TAG, "Config: UDP GSO is disabled with timed transmission");
+            retSender->useGso = 0;
+        }
+        retSender->useRtcpNack = (config->useRtcpNack > 0) ? 1 : 0;
+        retSender->pacingWindowPercent = (config->pacingWindowPercent > 100) ? 100 : ((config->pacingWindowPercent > 0) ? config->pacingWindowPercent : 0);
+        retSender->pacingFrameInterval = ARSTREAM2_RTP_SENDER_PACING_DEFAULT_FRAME_INTERVAL;
+        retSender->useCongestionControl = (config->useCongestionControl > 0) ? 1 : 0;
+        if (retSender->useCongestionControl)
+        {
+            /* start from the configured maximum bitrate, the estimate is then updated on each receiver report */
+            if (ARSTREAM2_RTPCC_Init(&retSender->ccContext, (config->minBitrate > 0) ? config->minBitrate : 0,
+                                     (config->maxBitrate > 0) ? config->maxBitrate : 0, (config->maxBitrate > 0) ? config->maxBitrate : 0) != 0)
+            {
+                ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_SENDER_TAG, "Config: invalid congestion control bitrate limits");
+                internalError = ARSTREAM2_ERROR_BAD_PARAMETERS;
+            }
+            retSender->maxBitrate = (int)retSender->ccContext.estimatedBitrate;
+        }
         retSender->rtpSenderContext.senderSsrc = ARSTREAM2_RTP_SENDER_SSRC;
         retSender->rtpSenderContext.rtpClockRate = 90000;
         retSender->rtpSenderContext.rtpTimestampOffset = 0;
@@ -720,20 +1361,6 @@ ARSTREAM2_RtpSender_t* ARSTREAM2_RtpSender_New(const ARSTREAM2_RtpSender_Config_
         srand(t1.tv_nsec);
     }
 
-    /* Setup internal mutexes/sems */
-    if (internalError == ARSTREAM2_OK)
-    {
-        int mutexInitRet = ARSAL_Mutex_Init(&(retSender->monitoringMutex));
-        if (mutexInitRet != 0)
-        {
-            internalError = ARSTREAM2_ERROR_ALLOC;
-        }
-        else
-        {
-            monitoringMutexWasInit = 1;
-        }
-    }
-
     /* MsgVec array */
     if (internalError == ARSTREAM2_OK)
     {
@@ -757,8 +1384,82 @@ ARSTREAM2_RtpSender_t* ARSTREAM2_RtpSender_New(const ARSTREAM2_RtpSender_Config_
         }
     }
 
-    /* Stream socket setup */
+    /* Retransmission cache */
+    if ((internalError == ARSTREAM2_OK) && (retSender->useRtcpNack))
+    {
+        int cacheRet = ARSTREAM2_RTP_Sender_RetransmitCacheInit(&retSender->rtpSenderContext, ARSTREAM2_RTP_SENDER_RETRANSMIT_CACHE_DEFAULT_SIZE,
+                                                                ARSTREAM2_RTP_SENDER_RETRANSMIT_CACHE_DEFAULT_TIMEOUT);
+        if (cacheRet != 0)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_SENDER_TAG, "Retransmission cache allocation failed (%d)", cacheRet);
+            internalError = ARSTREAM2_ERROR_ALLOC;
+        }
+    }
+
+    /* FEC stage (always set up so that it can be enabled through the dynamic config) */
     if (internalError == ARSTREAM2_OK)
+    {
+        int fecRet = ARSTREAM2_RTPFEC_Sender_Init(&retSender->fecSenderContext, retSender->rtpSenderContext.maxPacketSize);
+        if (fecRet == 0)
+        {
+            fecRet = ARSTREAM2_RTPFEC_Sender_SetConfig(&retSender->fecSenderContext, config->fecGroupSize,
+                                                       config->fecRowCount, config->fecImportanceLevelCount);
+        }
+        if (fecRet != 0)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_SENDER_TAG, "Config: invalid FEC parameters (%d)", fecRet);
+            internalError = ARSTREAM2_ERROR_BAD_PARAMETERS;
+        }
+        else
+        {
+            retSender->rtpSenderContext.fecCtx = &retSender->fecSenderContext;
+            retSender->fecSenderContext.rtpSenderContext = &retSender->rtpSenderContext;
+        }
+    }
+
+    /* GSO arrays */
+    if ((internalError == ARSTREAM2_OK) && (retSender->useGso))
+    {
+        retSender->gsoMsgVec = malloc(retSender->msgVecCount * sizeof(struct mmsghdr));
+        retSender->gsoMsgPacketCount = malloc(retSender->msgVecCount * sizeof(unsigned int));
+        retSender->gsoIov = malloc(retSender->msgVecCount * ARSTREAM2_RTP_PACKET_MAX_IOV_COUNT * sizeof(struct iovec));
+        retSender->gsoControl = malloc(retSender->msgVecCount * CMSG_SPACE(sizeof(uint16_t)));
+        if ((!retSender->gsoMsgVec) || (!retSender->gsoMsgPacketCount) || (!retSender->gsoIov) || (!retSender->gsoControl))
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_SENDER_TAG, "GSO arrays allocation failed");
+            internalError = ARSTREAM2_ERROR_ALLOC;
+        }
+        else
+        {
+            memset(retSender->gsoControl, 0, retSender->msgVecCount * CMSG_SPACE(sizeof(uint16_t)));
+        }
+    }
+
+    /* Timed transmission arrays */
+    if ((internalError == ARSTREAM2_OK) && (retSender->useTxTime))
+    {
+        retSender->txTimeControl = malloc(retSender->msgVecCount * CMSG_SPACE(sizeof(uint64_t)));
+        retSender->txTimeLaunch = malloc(retSender->msgVecCount * sizeof(uint64_t));
+        if ((!retSender->txTimeControl) || (!retSender->txTimeLaunch))
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_SENDER_TAG, "Timed transmission arrays allocation failed");
+            internalError = ARSTREAM2_ERROR_ALLOC;
+        }
+        else
+        {
+            memset(retSender->txTimeControl, 0, retSender->msgVecCount * CMSG_SPACE(sizeof(uint64_t)));
+        }
+    }
+
+    /* Shared memory transport setup: the control "socket" is the receiver RTCP ring eventfd */
+    if ((internalError == ARSTREAM2_OK) && (retSender->shm))
+    {
+        retSender->controlSocket = ARSTREAM2_ShmTransport_GetEventFd(retSender->shm, ARSTREAM2_SHM_TRANSPORT_RING_RECEIVER_CONTROL);
+        ARSAL_PRINT(ARSAL_PRINT_INFO, ARSTREAM2_RTP_SENDER_TAG, "Using the shared memory transport");
+    }
+
+    /* Stream socket setup */
+    if ((internalError == ARSTREAM2_OK) && (!retSender->shm))
     {
         int socketRet = ARSTREAM2_RtpSender_StreamSocketSetup(retSender);
         if (socketRet != 0)
@@ -769,7 +1470,7 @@ ARSTREAM2_RtpSender_t* ARSTREAM2_RtpSender_New(const ARSTREAM2_RtpSender_Config_
     }
 
     /* Control socket setup */
-    if (internalError == ARSTREAM2_OK)
+    if ((internalError == ARSTREAM2_OK) && (!retSender->shm))
     {
         int socketRet = ARSTREAM2_RtpSender_ControlSocketSetup(retSender);
         if (socketRet != 0)
@@ -837,6 +1538,13 @@ ARSTREAM2_RtpSender_t* ARSTREAM2_RtpSender_New(const ARSTREAM2_RtpSender_Config_
         (retSender != NULL))
     {
         int err;
+        if (retSender->shm)
+        {
+            /* the eventfd is owned by the transport */
+            retSender->controlSocket = -1;
+            ARSTREAM2_ShmTransport_Unref(retSender->shm);
+            retSender->shm = NULL;
+        }
         if (retSender->streamSocket != -1)
         {
             while (((err = close(retSender->streamSocket)) == -1) && (errno == EINTR));
@@ -847,8 +1555,15 @@ ARSTREAM2_RtpSender_t* ARSTREAM2_RtpSender_New(const ARSTREAM2_RtpSender_Config_
             while (((err = close(retSender->controlSocket)) == -1) && (errno == EINTR));
             retSender->controlSocket = -1;
         }
-        if (monitoringMutexWasInit == 1) ARSAL_Mutex_Destroy(&(retSender->monitoringMutex));
+        ARSTREAM2_RTP_Sender_RetransmitCacheFree(&retSender->rtpSenderContext, NULL);
+        ARSTREAM2_RTPFEC_Sender_Free(&retSender->fecSenderContext);
         free(retSender->msgVec);
+        free(retSender->gsoMsgVec);
+        free(retSender->gsoMsgPacketCount);
+        free(retSender->gsoIov);
+        free(retSender->gsoControl);
+        free(retSender->txTimeControl);
+        free(retSender->txTimeLaunch);
         free(retSender->rtcpMsgBuffer);
         free(retSender->canonicalName);
         free(retSender->friendlyName);
@@ -877,7 +1592,13 @@ eARSTREAM2_ERROR ARSTREAM2_RtpSender_Delete(ARSTREAM2_RtpSender_t **sender)
         (*sender != NULL))
     {
         int err;
-        ARSAL_Mutex_Destroy(&((*sender)->monitoringMutex));
+        if ((*sender)->shm)
+        {
+            /* the eventfd is owned by the transport */
+            (*sender)->controlSocket = -1;
+            ARSTREAM2_ShmTransport_Unref((*sender)->shm);
+            (*sender)->shm = NULL;
+        }
         if ((*sender)->streamSocket != -1)
         {
             while (((err = close((*sender)->streamSocket)) == -1) && (errno == EINTR));
@@ -888,7 +1609,16 @@ eARSTREAM2_ERROR ARSTREAM2_RtpSender_Delete(ARSTREAM2_RtpSender_t **sender)
             while (((err = close((*sender)->controlSocket)) == -1) && (errno == EINTR));
             (*sender)->controlSocket = -1;
         }
+        ARSTREAM2_RTP_Sender_RetransmitCacheFree(&(*sender)->rtpSenderContext, (*sender)->packetFifo);
+        ARSTREAM2_RTPFEC_Sender_Free(&(*sender)->fecSenderContext);
+        free((*sender)->rtpSenderContext.fanOut);
         free((*sender)->msgVec);
+        free((*sender)->gsoMsgVec);
+        free((*sender)->gsoMsgPacketCount);
+        free((*sender)->gsoIov);
+        free((*sender)->gsoControl);
+        free((*sender)->txTimeControl);
+        free((*sender)->txTimeLaunch);
         free((*sender)->rtcpMsgBuffer);
         free((*sender)->friendlyName);
         free((*sender)->applicationName);
@@ -937,6 +1667,45 @@ eARSTREAM2_ERROR ARSTREAM2_RtpSender_FlushNaluQueue(ARSTREAM2_RtpSender_t *sende
 }
 
 
+static void ARSTREAM2_RtpSender_CongestionControlUpdate(ARSTREAM2_RtpSender_t *sender, uint64_t curTime)
+{
+    uint64_t targetBitrate;
+    int ret;
+
+    ret = ARSTREAM2_RTPCC_ProcessReceiverReport(&sender->ccContext, sender->rtcpSenderContext.roundTripDelay,
+                                                sender->rtcpSenderContext.receiverFractionLost,
+                                                sender->rtpSenderContext.byteCount, curTime);
+    if (ret != 0)
+    {
+        if (ret != -2)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_SENDER_TAG, "Failed to process the congestion control receiver report (%d)", ret);
+        }
+        return;
+    }
+
+    sender->maxBitrate = (int)sender->ccContext.estimatedBitrate;
+    sender->rtcpSenderContext.rtcpByteRate = sender->maxBitrate * ARSTREAM2_RTCP_SENDER_BANDWIDTH_SHARE / 8;
+
+    /* the encoder bitrate excludes the RTCP bandwidth share and the FEC repair packets */
+    targetBitrate = (uint64_t)(sender->ccContext.estimatedBitrate * (1. - ARSTREAM2_RTCP_SENDER_BANDWIDTH_SHARE));
+    if (sender->fecSenderContext.groupSize > 0)
+    {
+        uint64_t g = sender->fecSenderContext.groupSize, r = sender->fecSenderContext.rowCount;
+        targetBitrate = (r > 1) ? targetBitrate * g * r / (g * r + g + r) : targetBitrate * g / (g + 1);
+    }
+
+    if ((sender->bitrateCallback) && ((sender->lastTargetBitrate == 0)
+            || (targetBitrate * 100 >= (uint64_t)sender->lastTargetBitrate * (100 + ARSTREAM2_RTP_SENDER_BITRATE_CALLBACK_THRESHOLD))
+            || (targetBitrate * 100 <= (uint64_t)sender->lastTargetBitrate * (100 - ARSTREAM2_RTP_SENDER_BITRATE_CALLBACK_THRESHOLD))))
+    {
+        /* Call the bitrate callback function */
+        sender->bitrateCallback((uint32_t)targetBitrate, sender->bitrateCallbackUserPtr);
+        sender->lastTargetBitrate = (uint32_t)targetBitrate;
+    }
+}
+
+
 static void ARSTREAM2_RtpSender_RtpStatsCallback(ARSTREAM2_RtpSender_t *sender, uint64_t curTime, int gotLossReport)
 {
     ARSTREAM2_RTP_RtpStats_t rtpStats;
@@ -953,6 +1722,11 @@ static void ARSTREAM2_RtpSender_RtpStatsCallback(ARSTREAM2_RtpSender_t *sender,
     rtpStats.senderStats.inputToSentTimeIntegralSq = sender->rtpSenderContext.inputToSentTimeIntegralSq;
     rtpStats.senderStats.inputToDroppedTimeIntegral = sender->rtpSenderContext.inputToDroppedTimeIntegral;
     rtpStats.senderStats.inputToDroppedTimeIntegralSq = sender->rtpSenderContext.inputToDroppedTimeIntegralSq;
+    rtpStats.senderStats.pacedPacketCount = sender->pacedPacketCount;
+    rtpStats.senderStats.pacingDelayIntegral = sender->pacingDelayIntegral;
+    rtpStats.senderStats.pacingDelayIntegralSq = sender->pacingDelayIntegralSq;
+    rtpStats.senderStats.fecRepairPacketCount = sender->fecSenderContext.repairPacketCount;
+    rtpStats.senderStats.fecUnprotectedPacketCount = sender->fecSenderContext.unprotectedPacketCount;
     if (sender->rtcpSenderContext.lastSrTimestamp != 0)
     {
         rtpStats.senderReport.timestamp = sender->rtcpSenderContext.lastSrTimestamp;
@@ -1017,22 +1791,50 @@ eARSTREAM2_ERROR ARSTREAM2_RtpSender_GetSelectParams(ARSTREAM2_RtpSender_t *send
     }
     if (writeSet)
     {
-        if (sender->packetsPending)
+        if ((sender->packetsPending) && (sender->streamSocket != -1))
             FD_SET(sender->streamSocket, *writeSet);
     }
     if (exceptSet)
     {
-        FD_SET(sender->streamSocket, *exceptSet);
+        if (sender->streamSocket != -1)
+            FD_SET(sender->streamSocket, *exceptSet);
         FD_SET(sender->controlSocket, *exceptSet);
     }
 
     if (maxFd) *maxFd = _maxFd;
-    if (nextTimeout) *nextTimeout = (sender->nextSrDelay < ARSTREAM2_RTP_SENDER_TIMEOUT_US) ? sender->nextSrDelay : ARSTREAM2_RTP_SENDER_TIMEOUT_US;
+    if (nextTimeout)
+    {
+        *nextTimeout = (sender->nextSrDelay < ARSTREAM2_RTP_SENDER_TIMEOUT_US) ? sender->nextSrDelay : ARSTREAM2_RTP_SENDER_TIMEOUT_US;
+        if ((sender->pacingDelay > 0) && (sender->pacingDelay < *nextTimeout)) *nextTimeout = sender->pacingDelay;
+        if ((sender->timeoutDelay > 0) && (sender->timeoutDelay < *nextTimeout)) *nextTimeout = sender->timeoutDelay;
+    }
 
     return retVal;
 }
 
 
+eARSTREAM2_ERROR ARSTREAM2_RtpSender_GetPollParams(ARSTREAM2_RtpSender_t *sender, int *streamFd, int *controlFd, int *streamWritePending, uint32_t *nextTimeout)
+{
+    // Args check
+    if (sender == NULL)
+    {
+        return ARSTREAM2_ERROR_BAD_PARAMETERS;
+    }
+
+    if (streamFd) *streamFd = sender->streamSocket;
+    if (controlFd) *controlFd = sender->controlSocket;
+    if (streamWritePending) *streamWritePending = sender->packetsPending;
+    if (nextTimeout)
+    {
+        *nextTimeout = (sender->nextSrDelay < ARSTREAM2_RTP_SENDER_TIMEOUT_US) ? sender->nextSrDelay : ARSTREAM2_RTP_SENDER_TIMEOUT_US;
+        if ((sender->pacingDelay > 0) && (sender->pacingDelay < *nextTimeout)) *nextTimeout = sender->pacingDelay;
+        if ((sender->timeoutDelay > 0) && (sender->timeoutDelay < *nextTimeout)) *nextTimeout = sender->timeoutDelay;
+    }
+
+    return ARSTREAM2_OK;
+}
+
+
 eARSTREAM2_ERROR ARSTREAM2_RtpSender_ProcessRtp(ARSTREAM2_RtpSender_t *sender, int selectRet, fd_set *readSet, fd_set *writeSet, fd_set *exceptSet)
 {
     eARSTREAM2_ERROR retVal = ARSTREAM2_OK;
@@ -1047,7 +1849,7 @@ eARSTREAM2_ERROR ARSTREAM2_RtpSender_ProcessRtp(ARSTREAM2_RtpSender_t *sender, i
         return ARSTREAM2_ERROR_BAD_PARAMETERS;
     }
 
-    if ((exceptSet) && (FD_ISSET(sender->streamSocket, exceptSet)))
+    if ((exceptSet) && (sender->streamSocket != -1) && (FD_ISSET(sender->streamSocket, exceptSet)))
     {
         ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_SENDER_TAG, "Exception on stream socket");
     }
@@ -1154,9 +1956,11 @@ eARSTREAM2_ERROR ARSTREAM2_RtpSender_ProcessRtp(ARSTREAM2_RtpSender_t *sender, i
 #endif
 
     /* RTP packets sending */
-    if ((!sender->packetsPending) || ((sender->packetsPending) && ((!writeSet) || ((selectRet >= 0) && (FD_ISSET(sender->streamSocket, writeSet))))))
+    if ((!sender->packetsPending) || ((sender->packetsPending) && ((!writeSet) || ((selectRet >= 0) && (sender->streamSocket != -1) && (FD_ISSET(sender->streamSocket, writeSet))))))
     {
-        ret = ARSTREAM2_RTP_Sender_PacketFifoFillMsgVec(sender->packetFifoQueue, sender->msgVec, sender->msgVecCount, (void*)&sender->streamSendSin, sizeof(sender->streamSendSin));
+        /* with timed transmission the whole queue is handed to the kernel, which does the pacing */
+        unsigned int sendCount = (sender->useTxTime) ? sender->msgVecCount : ARSTREAM2_RtpSender_PacerGetAllowedCount(sender, curTime, sender->msgVecCount);
+        ret = (sendCount > 0) ? ARSTREAM2_RTP_Sender_PacketFifoFillMsgVec(sender->packetFifoQueue, sender->msgVec, sendCount, (void*)&sender->streamSendSin, sizeof(sender->streamSendSin)) : -2;
         if (ret < 0)
         {
             if (ret != -2)
@@ -1173,8 +1977,46 @@ eARSTREAM2_ERROR ARSTREAM2_RtpSender_ProcessRtp(ARSTREAM2_RtpSender_t *sender, i
             msgVecCount = round((float)msgVecCount * ((float)rand() * (ARSTREAM2_RTP_SENDER_RANDOM_CONGESTION_MSG_MAX - ARSTREAM2_RTP_SENDER_RANDOM_CONGESTION_MSG_MIN) / RAND_MAX + ARSTREAM2_RTP_SENDER_RANDOM_CONGESTION_MSG_MIN));
 #endif
 
+#if ARSTREAM2_RTP_SENDER_HAS_TXTIME
+            if (sender->useTxTime)
+            {
+                ARSTREAM2_RtpSender_TxTimeFillMsgVec(sender, curTime, (unsigned int)msgVecCount);
+            }
+#endif
+
             sender->packetsPending = 1;
-            while (((ret = sendmmsg(sender->streamSocket, sender->msgVec, msgVecCount, 0)) == -1) && (errno == EINTR));
+#if ARSTREAM2_RTP_SENDER_HAS_GSO
+            if (sender->useGso)
+            {
+                unsigned int gsoMsgCount = ARSTREAM2_RtpSender_GsoFillMsgVec(sender, (unsigned int)msgVecCount);
+                while (((ret = sendmmsg(sender->streamSocket, sender->gsoMsgVec, gsoMsgCount, 0)) == -1) && (errno == EINTR));
+                if ((ret < 0) && ((errno == EIO) || (errno == EINVAL) || (errno == ENOPROTOOPT) || (errno == EOPNOTSUPP)))
+                {
+                    /* the kernel or the device does not support segmentation: fall back to sendmmsg */
+                    ARSAL_PRINT(ARSAL_PRINT_WARNING, ARSTREAM2_RTP_SENDER_TAG, "UDP GSO send failed, falling back to sendmmsg: error=%d (%s)", errno, strerror(errno));
+                    sender->useGso = 0;
+                }
+                else
+                {
+                    int sentCount = ARSTREAM2_RtpSender_GsoUpdateMsgVec(sender, (ret > 0) ? (unsigned int)ret : 0);
+                    if (ret >= 0)
+                    {
+                        ret = sentCount;
+                    }
+                }
+            }
+            if (!sender->useGso)
+#endif
+            {
+                if (sender->shm)
+                {
+                    ret = ARSTREAM2_ShmTransport_SendMmsg(sender->shm, ARSTREAM2_SHM_TRANSPORT_RING_STREAM, sender->msgVec, msgVecCount);
+                }
+                else
+                {
+                    while (((ret = sendmmsg(sender->streamSocket, sender->msgVec, msgVecCount, 0)) == -1) && (errno == EINTR));
+                }
+            }
             if (ret < 0)
             {
                 if (errno == EAGAIN)
@@ -1206,6 +2048,14 @@ eARSTREAM2_ERROR ARSTREAM2_RtpSender_ProcessRtp(ARSTREAM2_RtpSender_t *sender, i
                 //if (sender->packetsPending) ARSAL_PRINT(ARSAL_PRINT_WARNING, ARSTREAM2_RTP_SENDER_TAG, "Sent %d packets out of %d", msgVecSentCount, msgVecCount); //TODO: debug
             }
 
+            ARSTREAM2_RtpSender_PacerUpdate(sender, curTime, (unsigned int)msgVecSentCount);
+#if ARSTREAM2_RTP_SENDER_HAS_TXTIME
+            if (sender->useTxTime)
+            {
+                ARSTREAM2_RtpSender_TxTimeUpdate(sender, (unsigned int)msgVecSentCount, (unsigned int)msgVecCount);
+            }
+#endif
+
             ret = ARSTREAM2_RTP_Sender_PacketFifoCleanFromMsgVec(&sender->rtpSenderContext, sender->packetFifo,
                                                                  sender->packetFifoQueue, sender->msgVec,
                                                                  msgVecSentCount, curTime);
@@ -1217,6 +2067,24 @@ eARSTREAM2_ERROR ARSTREAM2_RtpSender_ProcessRtp(ARSTREAM2_RtpSender_t *sender, i
                 }
             }
         }
+
+        /* wake up the event loop when the pacer releases the next packet */
+        sender->pacingDelay = (sender->packetsPending) ? 0 : ARSTREAM2_RtpSender_PacerGetDelay(sender);
+    }
+
+    /* wake up the event loop when the next packet times out, so that it is dropped on time */
+    uint64_t nextTimeoutTime = ARSTREAM2_RTP_PacketFifoQueueGetNextTimeout(sender->packetFifoQueue);
+    if (nextTimeoutTime == 0)
+    {
+        sender->timeoutDelay = 0;
+    }
+    else if (nextTimeoutTime > curTime)
+    {
+        sender->timeoutDelay = (nextTimeoutTime - curTime < ARSTREAM2_RTP_SENDER_TIMEOUT_US) ? (uint32_t)(nextTimeoutTime - curTime) : ARSTREAM2_RTP_SENDER_TIMEOUT_US;
+    }
+    else
+    {
+        sender->timeoutDelay = 1;
     }
 
     if ((sender->rtpStatsCallback != NULL) && (curTime >= sender->lastRtpStatsCallbackTime + ARSTREAM2_RTP_SENDER_RTPSTATS_CALLBACK_MAX_INTERVAL))
@@ -1228,6 +2096,20 @@ eARSTREAM2_ERROR ARSTREAM2_RtpSender_ProcessRtp(ARSTREAM2_RtpSender_t *sender, i
 }
 
 
+static ssize_t ARSTREAM2_RtpSender_ReadControlData(ARSTREAM2_RtpSender_t *sender)
+{
+    ssize_t bytes;
+
+    if (sender->shm)
+    {
+        return ARSTREAM2_ShmTransport_Recv(sender->shm, ARSTREAM2_SHM_TRANSPORT_RING_RECEIVER_CONTROL, sender->rtcpMsgBuffer, sender->rtpSenderContext.maxPacketSize);
+    }
+
+    while (((bytes = recv(sender->controlSocket, sender->rtcpMsgBuffer, sender->rtpSenderContext.maxPacketSize, 0)) == -1) && (errno == EINTR));
+    return bytes;
+}
+
+
 eARSTREAM2_ERROR ARSTREAM2_RtpSender_ProcessRtcp(ARSTREAM2_RtpSender_t *sender, int selectRet, fd_set *readSet, fd_set *writeSet, fd_set *exceptSet)
 {
     eARSTREAM2_ERROR retVal = ARSTREAM2_OK;
@@ -1255,7 +2137,7 @@ eARSTREAM2_ERROR ARSTREAM2_RtpSender_ProcessRtcp(ARSTREAM2_RtpSender_t *sender,
         /* The control socket is ready for reading */
         //TODO: recvmmsg?
         ssize_t bytes;
-        while (((bytes = recv(sender->controlSocket, sender->rtcpMsgBuffer, sender->rtpSenderContext.maxPacketSize, 0)) == -1) && (errno == EINTR));
+        bytes = ARSTREAM2_RtpSender_ReadControlData(sender);
         if ((bytes < 0) && (errno != EAGAIN))
         {
             ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_SENDER_TAG, "Control socket - read error (%d): %s", errno, strerror(errno));
@@ -1266,16 +2148,41 @@ eARSTREAM2_ERROR ARSTREAM2_RtpSender_ProcessRtcp(ARSTREAM2_RtpSender_t *sender,
             int gotVideoStats = 0;
             int gotLossReport = 0;
             int gotDjbReport = 0;
+            int gotNack = 0;
 
+            sender->rtcpSenderContext.nackRequestCtx.count = 0;
             ret = ARSTREAM2_RTCP_Sender_ProcessCompoundPacket(sender->rtcpMsgBuffer, (unsigned int)bytes,
                                                               curTime, &sender->rtcpSenderContext,
                                                               &gotReceptionReport, &gotVideoStats,
-                                                              &gotLossReport, &gotDjbReport);
+                                                              &gotLossReport, &gotDjbReport, &gotNack);
             if ((ret != 0) && (bytes != 24)) /* workaround to avoid logging when it's an old clockSync packet with old FF or SC versions */
             {
                 ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_SENDER_TAG, "Failed to process compound RTCP packet (%d)", ret);
             }
 
+            if ((gotNack) && (sender->useRtcpNack))
+            {
+                /* the retransmitted packets are sent by the next ARSTREAM2_RtpSender_ProcessRtp() call */
+                int i;
+                for (i = 0; i < sender->rtcpSenderContext.nackRequestCtx.count; i++)
+                {
+                    ret = ARSTREAM2_RTP_Sender_PacketFifoRetransmit(&sender->rtpSenderContext, sender->packetFifo, sender->packetFifoQueue,
+                                                                    sender->rtcpSenderContext.nackRequestCtx.seqNum[i], curTime);
+                    if (ret == -1)
+                    {
+                        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_SENDER_TAG, "Failed to retransmit packet (seqNum %d)",
+                                    sender->rtcpSenderContext.nackRequestCtx.seqNum[i]);
+                        break;
+                    }
+                }
+                sender->rtcpSenderContext.nackRequestCtx.count = 0;
+            }
+
+            if ((gotReceptionReport) && (sender->useCongestionControl))
+            {
+                ARSTREAM2_RtpSender_CongestionControlUpdate(sender, curTime);
+            }
+
             if ((gotVideoStats) && (sender->videoStatsCallback != NULL))
             {
                 /* Call the receiver report callback function */
@@ -1287,7 +2194,7 @@ eARSTREAM2_ERROR ARSTREAM2_RtpSender_ProcessRtcp(ARSTREAM2_RtpSender_t *sender,
                 ARSTREAM2_RtpSender_RtpStatsCallback(sender, curTime, gotLossReport);
             }
 
-            while (((bytes = recv(sender->controlSocket, sender->rtcpMsgBuffer, sender->rtpSenderContext.maxPacketSize, 0)) == -1) && (errno == EINTR));
+            bytes = ARSTREAM2_RtpSender_ReadControlData(sender);
             if ((bytes < 0) && (errno != EAGAIN))
             {
                 ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_SENDER_TAG, "Control socket - read error (%d): %s", errno, strerror(errno));
@@ -1301,6 +2208,7 @@ eARSTREAM2_ERROR ARSTREAM2_RtpSender_ProcessRtcp(ARSTREAM2_RtpSender_t *sender,
     {
         unsigned int size = 0;
 
+        /* packetCount and byteCount are updated on packetization only: the NACK retransmissions are not counted again */
         ret = ARSTREAM2_RTCP_Sender_GenerateCompoundPacket(sender->rtcpMsgBuffer, sender->rtpSenderContext.maxPacketSize, curTime, 1, 1, 1,
                                                            sender->rtpSenderContext.packetCount, sender->rtpSenderContext.byteCount,
                                                            &sender->rtcpSenderContext, &size);
@@ -1309,7 +2217,14 @@ eARSTREAM2_ERROR ARSTREAM2_RtpSender_ProcessRtcp(ARSTREAM2_RtpSender_t *sender,
         {
             sender->rtcpDropStatsTotalPackets++;
             ssize_t bytes;
-            while (((bytes = sendto(sender->controlSocket, sender->rtcpMsgBuffer, size, 0, (struct sockaddr*)&sender->controlSendSin, sizeof(sender->controlSendSin))) == -1) && (errno == EINTR));
+            if (sender->shm)
+            {
+                bytes = ARSTREAM2_ShmTransport_Send(sender->shm, ARSTREAM2_SHM_TRANSPORT_RING_SENDER_CONTROL, sender->rtcpMsgBuffer, size);
+            }
+            else
+            {
+                while (((bytes = sendto(sender->controlSocket, sender->rtcpMsgBuffer, size, 0, (struct sockaddr*)&sender->controlSendSin, sizeof(sender->controlSendSin))) == -1) && (errno == EINTR));
+            }
             if (bytes < 0)
             {
                 if (errno == EAGAIN)
@@ -1370,11 +2285,92 @@ eARSTREAM2_ERROR ARSTREAM2_RtpSender_ProcessEnd(ARSTREAM2_RtpSender_t *sender, i
         ARSTREAM2_RTP_Sender_PacketFifoFlushQueue(&sender->rtpSenderContext, sender->packetFifo, sender->packetFifoQueue, curTime);
     else
         ARSTREAM2_RTP_Sender_PacketFifoFlush(&sender->rtpSenderContext, sender->packetFifo, curTime);
+    ARSTREAM2_RTP_Sender_RetransmitCacheFlush(&sender->rtpSenderContext, sender->packetFifo);
+    ARSTREAM2_RTPFEC_Sender_Flush(&sender->fecSenderContext);
 
     return retVal;
 }
 
 
+eARSTREAM2_ERROR ARSTREAM2_RtpSender_AddFanOutDestination(ARSTREAM2_RtpSender_t *sender, ARSTREAM2_RtpSender_t *destination,
+                                                          uint32_t maxLatencyUs, const uint32_t *maxNetworkLatencyUs)
+{
+    ARSTREAM2_RTP_SenderFanOut_t *fanOut;
+    unsigned int i;
+
+    if ((sender == NULL) || (destination == NULL) || (destination == sender))
+    {
+        return ARSTREAM2_ERROR_BAD_PARAMETERS;
+    }
+    if ((destination->packetFifo != sender->packetFifo) || (destination->naluFifo != NULL))
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_SENDER_TAG, "Fan-out destination must share the packet FIFO and have no NALU FIFO");
+        return ARSTREAM2_ERROR_BAD_PARAMETERS;
+    }
+    for (i = 0; i < sender->rtpSenderContext.fanOutCount; i++)
+    {
+        if (sender->rtpSenderContext.fanOut[i].queue == destination->packetFifoQueue)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_SENDER_TAG, "Fan-out destination is already registered");
+            return ARSTREAM2_ERROR_BAD_PARAMETERS;
+        }
+    }
+
+    fanOut = realloc(sender->rtpSenderContext.fanOut, (sender->rtpSenderContext.fanOutCount + 1) * sizeof(ARSTREAM2_RTP_SenderFanOut_t));
+    if (fanOut == NULL)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_RTP_SENDER_TAG, "Allocation failed (size %zu)", (sender->rtpSenderContext.fanOutCount + 1) * sizeof(ARSTREAM2_RTP_SenderFanOut_t));
+        return ARSTREAM2_ERROR_ALLOC;
+    }
+    sender->rtpSenderContext.fanOut = fanOut;
+
+    fanOut = &sender->rtpSenderContext.fanOut[sender->rtpSenderContext.fanOutCount];
+    memset(fanOut, 0, sizeof(*fanOut));
+    fanOut->context = &destination->rtpSenderContext;
+    fanOut->queue = destination->packetFifoQueue;
+    fanOut->maxLatencyUs = maxLatencyUs;
+    if (maxNetworkLatencyUs)
+    {
+        for (i = 0; i < ARSTREAM2_STREAM_SENDER_MAX_IMPORTANCE_LEVELS; i++)
+        {
+            fanOut->maxNetworkLatencyUs[i] = maxNetworkLatencyUs[i];
+        }
+    }
+    sender->rtpSenderContext.fanOutCount++;
+
+    return ARSTREAM2_OK;
+}
+
+
+eARSTREAM2_ERROR ARSTREAM2_RtpSender_RemoveFanOutDestination(ARSTREAM2_RtpSender_t *sender, ARSTREAM2_RtpSender_t *destination)
+{
+    unsigned int i;
+
+    if ((sender == NULL) || (destination == NULL))
+    {
+        return ARSTREAM2_ERROR_BAD_PARAMETERS;
+    }
+
+    for (i = 0; i < sender->rtpSenderContext.fanOutCount; i++)
+    {
+        if (sender->rtpSenderContext.fanOut[i].queue == destination->packetFifoQueue)
+        {
+            break;
+        }
+    }
+    if (i == sender->rtpSenderContext.fanOutCount)
+    {
+        return ARSTREAM2_ERROR_NOT_FOUND;
+    }
+
+    memmove(&sender->rtpSenderContext.fanOut[i], &sender->rtpSenderContext.fanOut[i + 1],
+            (sender->rtpSenderContext.fanOutCount - i - 1) * sizeof(ARSTREAM2_RTP_SenderFanOut_t));
+    sender->rtpSenderContext.fanOutCount--;
+
+    return ARSTREAM2_OK;
+}
+
+
 eARSTREAM2_ERROR ARSTREAM2_RtpSender_GetDynamicConfig(ARSTREAM2_RtpSender_t *sender, ARSTREAM2_RtpSender_DynamicConfig_t *config)
 {
     eARSTREAM2_ERROR ret = ARSTREAM2_OK;
@@ -1386,7 +2382,19 @@ eARSTREAM2_ERROR ARSTREAM2_RtpSender_GetDynamicConfig(ARSTREAM2_RtpSender_t *sen
 
     config->targetPacketSize = sender->rtpSenderContext.targetPacketSize;
     config->streamSocketSendBufferSize = sender->streamSocketSendBufferSize;
-    config->maxBitrate = sender->maxBitrate;
+    if (sender->useCongestionControl)
+    {
+        /* the configured maximum, sender->maxBitrate is the current estimate */
+        uint32_t maxBitrate = 0;
+        ARSTREAM2_RTPCC_GetBitrateLimits(&sender->ccContext, NULL, &maxBitrate);
+        config->maxBitrate = (int)maxBitrate;
+    }
+    else
+    {
+        config->maxBitrate = sender->maxBitrate;
+    }
+    ARSTREAM2_RTPFEC_Sender_GetConfig(&sender->fecSenderContext, &config->fecGroupSize, &config->fecRowCount, &config->fecImportanceLevelCount);
+    config->pacingWindowPercent = __atomic_load_n(&sender->pacingWindowPercent, __ATOMIC_RELAXED);
 
     return ret;
 }
@@ -1402,9 +2410,27 @@ eARSTREAM2_ERROR ARSTREAM2_RtpSender_SetDynamicConfig(ARSTREAM2_RtpSender_t *sen
     }
 
     sender->rtpSenderContext.targetPacketSize = config->targetPacketSize;
-    sender->maxBitrate = config->maxBitrate;
-    sender->rtcpSenderContext.rtcpByteRate = (sender->maxBitrate > 0) ? sender->maxBitrate * ARSTREAM2_RTCP_SENDER_BANDWIDTH_SHARE / 8 : ARSTREAM2_RTCP_SENDER_DEFAULT_BITRATE / 8;
+    if (sender->useCongestionControl)
+    {
+        /* the new maximum is applied on the next receiver report */
+        uint32_t minBitrate = 0;
+        ARSTREAM2_RTPCC_GetBitrateLimits(&sender->ccContext, &minBitrate, NULL);
+        if (ARSTREAM2_RTPCC_SetBitrateLimits(&sender->ccContext, minBitrate, (config->maxBitrate > 0) ? config->maxBitrate : 0) != 0)
+        {
+            ret = ARSTREAM2_ERROR_BAD_PARAMETERS;
+        }
+    }
+    else
+    {
+        sender->maxBitrate = config->maxBitrate;
+        sender->rtcpSenderContext.rtcpByteRate = (sender->maxBitrate > 0) ? sender->maxBitrate * ARSTREAM2_RTCP_SENDER_BANDWIDTH_SHARE / 8 : ARSTREAM2_RTCP_SENDER_DEFAULT_BITRATE / 8;
+    }
     sender->streamSocketSendBufferSize = config->streamSocketSendBufferSize;
+    if (ARSTREAM2_RTPFEC_Sender_SetConfig(&sender->fecSenderContext, config->fecGroupSize, config->fecRowCount, config->fecImportanceLevelCount) != 0)
+    {
+        ret = ARSTREAM2_ERROR_BAD_PARAMETERS;
+    }
+    __atomic_store_n(&sender->pacingWindowPercent, (config->pacingWindowPercent > 100) ? 100 : ((config->pacingWindowPercent > 0) ? config->pacingWindowPercent : 0), __ATOMIC_RELAXED);
 
     if ((sender->streamSocket != -1) && (sender->streamSocketSendBufferSize))
     {
@@ -1567,12 +2593,12 @@ eARSTREAM2_ERROR ARSTREAM2_RtpSender_GetMonitoring(ARSTREAM2_RtpSender_t *sender
                                                    ARSTREAM2_StreamSender_MonitoringData_t *monitoringData)
 {
     eARSTREAM2_ERROR ret = ARSTREAM2_OK;
-    uint64_t endTime, curTime, previousTime, acqToNetworkSum = 0, networkSum = 0, acqToNetworkVarSum = 0, networkVarSum = 0, packetSizeVarSum = 0;
-    uint32_t bytesSent, bytesDropped, bytesSentSum = 0, bytesDroppedSum = 0, meanPacketSize = 0, acqToNetworkTime = 0, networkTime = 0;
-    uint32_t acqToNetworkJitter = 0, networkJitter = 0, meanAcqToNetworkTime = 0, meanNetworkTime = 0, packetSizeStdDev = 0;
-    uint32_t minAcqToNetworkTime = (uint32_t)(-1), minNetworkTime = (uint32_t)(-1), minPacketSize = (uint32_t)(-1);
-    uint32_t maxAcqToNetworkTime = 0, maxNetworkTime = 0, maxPacketSize = 0;
-    int points = 0, usefulPoints = 0, packetsSent = 0, packetsDropped = 0, idx, i, firstUsefulIdx = -1;
+    ARSTREAM2_RtpSender_MonitoringPoint_t first, last;
+    ARSTREAM2_RtpSender_MonitoringMinMax_t minMax;
+    uint64_t endTime, minTime, bytesSentSum = 0, bytesDroppedSum = 0;
+    uint32_t acqToNetworkJitter = 0, networkJitter = 0, meanAcqToNetworkTime = 0, meanNetworkTime = 0, meanPacketSize = 0, packetSizeStdDev = 0;
+    int usefulPoints, packetsSent = 0, packetsDropped = 0, count, oldestIdx, lo, hi, mid, firstPos, lastPos;
+    unsigned int seq, firstIdx, lastIdx;
 
     if ((sender == NULL) || (timeIntervalUs == 0) || (monitoringData == NULL))
     {
@@ -1585,103 +2611,119 @@ eARSTREAM2_ERROR ARSTREAM2_RtpSender_GetMonitoring(ARSTREAM2_RtpSender_t *sender
         ARSAL_Time_GetTime(&t1);
         startTime = (uint64_t)t1.tv_sec * 1000000 + (uint64_t)t1.tv_nsec / 1000;
     }
-    endTime = startTime;
+    minTime = (startTime > timeIntervalUs) ? startTime - timeIntervalUs : 0;
 
-    ARSAL_Mutex_Lock(&(sender->monitoringMutex));
+#define ARSTREAM2_RTP_SENDER_MONITORING_POINT(_pos) \
+    (sender->monitoringPoint[(oldestIdx + (_pos)) % ARSTREAM2_RTP_SENDER_MONITORING_MAX_POINTS])
 
-    if (sender->monitoringCount > 0)
+    /* the window holds the points output in [startTime - timeIntervalUs, startTime]
+     * (the former full scan computed the deviations on the point preceding each of them instead);
+     * the points are in outputTimestamp order: binary search the window bounds,
+     * use the running sums and the min/max tree, retry if the writer updated the ring meanwhile */
+    do
     {
-        idx = sender->monitoringIndex;
-        previousTime = startTime;
-
-        while (points < sender->monitoringCount)
+        seq = __atomic_load_n(&sender->monitoringSeq, __ATOMIC_ACQUIRE);
+        endTime = startTime;
+        usefulPoints = 0;
+        minMax.acqToNetworkTimeMin = minMax.networkTimeMin = minMax.packetSizeMin = (uint32_t)(-1);
+        minMax.acqToNetworkTimeMax = minMax.networkTimeMax = minMax.packetSizeMax = 0;
+        count = sender->monitoringCount;
+        if ((!(seq & 1)) && (count > 0) && (count <= ARSTREAM2_RTP_SENDER_MONITORING_MAX_POINTS))
         {
-            curTime = sender->monitoringPoint[idx].outputTimestamp;
-            if (curTime > startTime)
-            {
-                points++;
-                idx = (idx - 1 >= 0) ? idx - 1 : ARSTREAM2_RTP_SENDER_MONITORING_MAX_POINTS - 1;
-                continue;
-            }
-            if (startTime - curTime > timeIntervalUs)
-            {
-                break;
-            }
-            if (firstUsefulIdx == -1)
+            oldestIdx = (sender->monitoringIndex + ARSTREAM2_RTP_SENDER_MONITORING_MAX_POINTS - count + 1) % ARSTREAM2_RTP_SENDER_MONITORING_MAX_POINTS;
+
+            /* last point sent at or before startTime */
+            for (lo = 0, hi = count; lo < hi; )
             {
-                firstUsefulIdx = idx;
+                mid = (lo + hi) / 2;
+                if (ARSTREAM2_RTP_SENDER_MONITORING_POINT(mid).outputTimestamp > startTime) hi = mid; else lo = mid + 1;
             }
-            bytesSent = sender->monitoringPoint[idx].bytesSent;
-            bytesSentSum += bytesSent;
-            if (bytesSent)
+            lastPos = lo - 1;
+
+            /* first point sent in the time interval */
+            for (lo = 0, hi = count; lo < hi; )
             {
-                packetsSent++;
-                acqToNetworkTime = curTime - sender->monitoringPoint[idx].ntpTimestamp;
-                acqToNetworkSum += acqToNetworkTime;
-                networkTime = curTime - sender->monitoringPoint[idx].inputTimestamp;
-                networkSum += networkTime;
-                if (acqToNetworkTime < minAcqToNetworkTime) minAcqToNetworkTime = acqToNetworkTime;
-                if (acqToNetworkTime > maxAcqToNetworkTime) maxAcqToNetworkTime = acqToNetworkTime;
-                if (networkTime < minNetworkTime) minNetworkTime = networkTime;
-                if (networkTime > maxNetworkTime) maxNetworkTime = networkTime;
-                if (bytesSent < minPacketSize) minPacketSize = bytesSent;
-                if (bytesSent > maxPacketSize) maxPacketSize = bytesSent;
+                mid = (lo + hi) / 2;
+                if (ARSTREAM2_RTP_SENDER_MONITORING_POINT(mid).outputTimestamp < minTime) lo = mid + 1; else hi = mid;
             }
-            bytesDropped = sender->monitoringPoint[idx].bytesDropped;
-            bytesDroppedSum += bytesDropped;
-            if (bytesDropped)
+            firstPos = lo;
+
+            if (lastPos >= firstPos)
             {
-                packetsDropped++;
+                first = ARSTREAM2_RTP_SENDER_MONITORING_POINT(firstPos);
+                last = ARSTREAM2_RTP_SENDER_MONITORING_POINT(lastPos);
+                usefulPoints = lastPos - firstPos + 1;
+                firstIdx = (oldestIdx + firstPos) % ARSTREAM2_RTP_SENDER_MONITORING_MAX_POINTS;
+                lastIdx = (oldestIdx + lastPos) % ARSTREAM2_RTP_SENDER_MONITORING_MAX_POINTS;
+                if (firstIdx <= lastIdx)
+                {
+                    ARSTREAM2_RtpSender_MonitoringMinMaxQuery(sender, firstIdx, lastIdx, &minMax);
+                }
+                else
+                {
+                    ARSTREAM2_RtpSender_MonitoringMinMaxQuery(sender, firstIdx, ARSTREAM2_RTP_SENDER_MONITORING_MAX_POINTS - 1, &minMax);
+                    ARSTREAM2_RtpSender_MonitoringMinMaxQuery(sender, 0, lastIdx, &minMax);
+                }
             }
-            previousTime = curTime;
-            usefulPoints++;
-            points++;
-            idx = (idx - 1 >= 0) ? idx - 1 : ARSTREAM2_RTP_SENDER_MONITORING_MAX_POINTS - 1;
         }
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    }
+    while ((seq & 1) || (__atomic_load_n(&sender->monitoringSeq, __ATOMIC_RELAXED) != seq));
+
+#undef ARSTREAM2_RTP_SENDER_MONITORING_POINT
+
+    if (usefulPoints > 0)
+    {
+        uint32_t firstAcqToNetworkTime = (first.bytesSent) ? (uint32_t)(first.outputTimestamp - first.ntpTimestamp) : 0;
+        uint32_t firstNetworkTime = (first.bytesSent) ? (uint32_t)(first.outputTimestamp - first.inputTimestamp) : 0;
+        uint64_t bytesSentSqSum, acqToNetworkSum, acqToNetworkSqSum, networkSum, networkSqSum;
+        double mean, var;
 
-        endTime = previousTime;
-        meanPacketSize = (packetsSent > 0) ? (bytesSentSum / packetsSent) : 0;
-        meanAcqToNetworkTime = (packetsSent > 0) ? (uint32_t)(acqToNetworkSum / packetsSent) : 0;
-        meanNetworkTime = (packetsSent > 0) ? (uint32_t)(networkSum / packetsSent) : 0;
+        endTime = first.outputTimestamp;
+        packetsSent = (int)(last.packetsSentSum - first.packetsSentSum) + ((first.bytesSent) ? 1 : 0);
+        packetsDropped = (int)(last.packetsDroppedSum - first.packetsDroppedSum) + ((first.bytesDropped) ? 1 : 0);
+        bytesSentSum = last.bytesSentSum - first.bytesSentSum + first.bytesSent;
+        bytesSentSqSum = last.bytesSentSqSum - first.bytesSentSqSum + (uint64_t)first.bytesSent * first.bytesSent;
+        bytesDroppedSum = last.bytesDroppedSum - first.bytesDroppedSum + first.bytesDropped;
+        acqToNetworkSum = last.acqToNetworkTimeSum - first.acqToNetworkTimeSum + firstAcqToNetworkTime;
+        acqToNetworkSqSum = last.acqToNetworkTimeSqSum - first.acqToNetworkTimeSqSum + (uint64_t)firstAcqToNetworkTime * firstAcqToNetworkTime;
+        networkSum = last.networkTimeSum - first.networkTimeSum + firstNetworkTime;
+        networkSqSum = last.networkTimeSqSum - first.networkTimeSqSum + (uint64_t)firstNetworkTime * firstNetworkTime;
 
-        for (i = 0, idx = firstUsefulIdx; i < usefulPoints; i++)
+        if (packetsSent > 0)
         {
-            idx = (idx - 1 >= 0) ? idx - 1 : ARSTREAM2_RTP_SENDER_MONITORING_MAX_POINTS - 1;
-            curTime = sender->monitoringPoint[idx].outputTimestamp;
-            bytesSent = sender->monitoringPoint[idx].bytesSent;
-            if (bytesSent)
-            {
-                acqToNetworkTime = curTime - sender->monitoringPoint[idx].ntpTimestamp;
-                networkTime = curTime - sender->monitoringPoint[idx].inputTimestamp;
-                packetSizeVarSum += ((bytesSent - meanPacketSize) * (bytesSent - meanPacketSize));
-                acqToNetworkVarSum += ((acqToNetworkTime - meanAcqToNetworkTime) * (acqToNetworkTime - meanAcqToNetworkTime));
-                networkVarSum += ((networkTime - meanNetworkTime) * (networkTime - meanNetworkTime));
-            }
+            meanPacketSize = (uint32_t)(bytesSentSum / packetsSent);
+            meanAcqToNetworkTime = (uint32_t)(acqToNetworkSum / packetsSent);
+            meanNetworkTime = (uint32_t)(networkSum / packetsSent);
+            mean = (double)bytesSentSum / packetsSent;
+            var = (double)bytesSentSqSum / packetsSent - mean * mean;
+            packetSizeStdDev = (var > 0.) ? (uint32_t)sqrt(var) : 0;
+            mean = (double)acqToNetworkSum / packetsSent;
+            var = (double)acqToNetworkSqSum / packetsSent - mean * mean;
+            acqToNetworkJitter = (var > 0.) ? (uint32_t)sqrt(var) : 0;
+            mean = (double)networkSum / packetsSent;
+            var = (double)networkSqSum / packetsSent - mean * mean;
+            networkJitter = (var > 0.) ? (uint32_t)sqrt(var) : 0;
         }
-        acqToNetworkJitter = (packetsSent > 0) ? (uint32_t)(sqrt((double)acqToNetworkVarSum / packetsSent)) : 0;
-        networkJitter = (packetsSent > 0) ? (uint32_t)(sqrt((double)networkVarSum / packetsSent)) : 0;
-        packetSizeStdDev = (packetsSent > 0) ? (uint32_t)(sqrt((double)packetSizeVarSum / packetsSent)) : 0;
     }
 
-    ARSAL_Mutex_Unlock(&(sender->monitoringMutex));
-
     monitoringData->startTimestamp = endTime;
     monitoringData->timeInterval = (startTime - endTime);
-    monitoringData->acqToNetworkTimeMin = minAcqToNetworkTime;
-    monitoringData->acqToNetworkTimeMax = maxAcqToNetworkTime;
+    monitoringData->acqToNetworkTimeMin = minMax.acqToNetworkTimeMin;
+    monitoringData->acqToNetworkTimeMax = minMax.acqToNetworkTimeMax;
     monitoringData->acqToNetworkTimeMean = meanAcqToNetworkTime;
     monitoringData->acqToNetworkTimeJitter = acqToNetworkJitter;
-    monitoringData->networkTimeMin = minNetworkTime;
-    monitoringData->networkTimeMax = maxNetworkTime;
+    monitoringData->networkTimeMin = minMax.networkTimeMin;
+    monitoringData->networkTimeMax = minMax.networkTimeMax;
     monitoringData->networkTimeMean = meanNetworkTime;
     monitoringData->networkTimeJitter = networkJitter;
-    monitoringData->bytesSent = bytesSentSum;
-    monitoringData->packetSizeMin = minPacketSize;
-    monitoringData->packetSizeMax = maxPacketSize;
+    monitoringData->bytesSent = (uint32_t)bytesSentSum;
+    monitoringData->packetSizeMin = minMax.packetSizeMin;
+    monitoringData->packetSizeMax = minMax.packetSizeMax;
     monitoringData->packetSizeMean = meanPacketSize;
     monitoringData->packetSizeStdDev = packetSizeStdDev;
     monitoringData->packetsSent = packetsSent;
-    monitoringData->bytesDropped = bytesDroppedSum;
+    monitoringData->bytesDropped = (uint32_t)bytesDroppedSum;
     monitoringData->packetsDropped = packetsDropped;
 
     return ret;
@@ -79,13 +79,25 @@ typedef struct ARSTREAM2_RtpSender_Config_t
     void *videoStatsCallbackUserPtr;                /**< Video stats callback function user pointer (optional, can be NULL) */
     ARSTREAM2_StreamSender_DisconnectionCallback_t disconnectionCallback;     /**< Disconnection callback function (optional, can be NULL) */
     void *disconnectionCallbackUserPtr;             /**< Disconnection callback function user pointer (optional, can be NULL) */
+    ARSTREAM2_StreamSender_BitrateCallback_t bitrateCallback;   /**< Congestion control target bitrate callback function (optional, can be NULL) */
+    void *bitrateCallbackUserPtr;                   /**< Congestion control target bitrate callback function user pointer (optional, can be NULL) */
     ARSTREAM2_H264_NaluFifo_t *naluFifo;            /**< Optional user-provided NALU FIFO */
     ARSTREAM2_RTP_PacketFifo_t *packetFifo;         /**< User-provided packet FIFO */
     ARSTREAM2_RTP_PacketFifoQueue_t *packetFifoQueue;  /**< User-provided packet FIFO queue */
     int maxPacketSize;                              /**< Maximum network packet size in bytes (example: the interface MTU) */
     int targetPacketSize;                           /**< Target network packet size in bytes */
     int maxBitrate;                                 /**< Maximum streaming bitrate in bit/s (optional, can be 0) */
+    int minBitrate;                                 /**< Minimum congestion control bitrate in bit/s (optional, can be 0) */
+    int useCongestionControl;                       /**< Boolean-like (0-1) flag: if active estimate the available bandwidth from the RTCP feedback and adjust maxBitrate */
     int useRtpHeaderExtensions;                     /**< Boolean-like (0-1) flag: if active insert access unit metadata as RTP header extensions */
+    int useGso;                                     /**< Boolean-like (0-1) flag: if active pack same-size consecutive packets in UDP GSO sends (falls back to sendmmsg if unsupported) */
+    int useTxTime;                                  /**< Kernel pacing with SO_TXTIME launch times: 0 disabled, 1 CLOCK_MONOTONIC (fq qdisc), 2 CLOCK_TAI (etf qdisc); falls back to user-space pacing if unsupported */
+    int useRtcpNack;                                /**< Boolean-like (0-1) flag: if active keep sent packets in a retransmission cache and resend them on RTCP generic NACK feedback */
+    int fecGroupSize;                               /**< FEC row group size in packets (0 disables FEC, max ARSTREAM2_RTPFEC_MAX_GROUP_SIZE) */
+    int fecRowCount;                                /**< FEC matrix row count for column groups protecting importance level 0 packets (0 or 1 for row groups only, max ARSTREAM2_RTPFEC_MAX_ROW_COUNT) */
+    int fecImportanceLevelCount;                    /**< Only NAL units with an importance level below this value are FEC protected (0 for all levels) */
+    int pacingWindowPercent;                        /**< Percentage of the access unit interval over which the packets of an access unit are spread (0 disables pacing, max 100) */
+    ARSTREAM2_ShmTransport_t *shmTransport;         /**< Shared memory transport used instead of the sockets (optional, can be NULL) */
     const char *dateAndTime;
     const char *debugPath;
 
@@ -100,6 +112,10 @@ typedef struct ARSTREAM2_RtpSender_DynamicConfig_t
     int targetPacketSize;                           /**< Target network packet size in bytes */
     int streamSocketSendBufferSize;                 /**< Send buffer size for the stream socket (optional, can be 0) */
     int maxBitrate;                                 /**< Maximum streaming bitrate in bit/s (optional, can be 0) */
+    int fecGroupSize;                               /**< FEC row group size in packets (0 disables FEC) */
+    int fecRowCount;                                /**< FEC matrix row count for column groups (0 or 1 for row groups only) */
+    int fecImportanceLevelCount;                    /**< Only NAL units with an importance level below this value are FEC protected (0 for all levels) */
+    int pacingWindowPercent;                        /**< Percentage of the access unit interval over which the packets of an access unit are spread (0 disables pacing, max 100) */
 
 } ARSTREAM2_RtpSender_DynamicConfig_t;
 
@@ -152,6 +168,24 @@ eARSTREAM2_ERROR ARSTREAM2_RtpSender_FlushNaluQueue(ARSTREAM2_RtpSender_t *sende
 eARSTREAM2_ERROR ARSTREAM2_RtpSender_GetSelectParams(ARSTREAM2_RtpSender_t *sender, fd_set **readSet, fd_set **writeSet, fd_set **exceptSet, int *maxFd, uint32_t *nextTimeout);
 
 
+/**
+ * @brief Get the event loop parameters
+ * This function is an alternative to ARSTREAM2_RtpSender_GetSelectParams() for event loops
+ * that register the file descriptors once (e.g. epoll) instead of rebuilding fd_sets.
+ * The stream socket only needs to be watched for writing while streamWritePending is set.
+ *
+ * @param[in] sender The sender instance
+ * @param[out] streamFd Stream socket file descriptor (optional, can be NULL)
+ * @param[out] controlFd Control socket file descriptor (optional, can be NULL)
+ * @param[out] streamWritePending Stream socket write pending flag (optional, can be NULL)
+ * @param[out] nextTimeout Next timeout in microseconds (optional, can be NULL)
+ *
+ * @return ARSTREAM2_OK if no error occured.
+ * @return ARSTREAM2_ERROR_BAD_PARAMETERS if the sender is invalid.
+ */
+eARSTREAM2_ERROR ARSTREAM2_RtpSender_GetPollParams(ARSTREAM2_RtpSender_t *sender, int *streamFd, int *controlFd, int *streamWritePending, uint32_t *nextTimeout);
+
+
 eARSTREAM2_ERROR ARSTREAM2_RtpSender_ProcessRtp(ARSTREAM2_RtpSender_t *sender, int selectRet, fd_set *readSet, fd_set *writeSet, fd_set *exceptSet);
 
 
@@ -161,6 +195,41 @@ eARSTREAM2_ERROR ARSTREAM2_RtpSender_ProcessRtcp(ARSTREAM2_RtpSender_t *sender,
 eARSTREAM2_ERROR ARSTREAM2_RtpSender_ProcessEnd(ARSTREAM2_RtpSender_t *sender, int queueOnly);
 
 
+/**
+ * @brief Add a fan-out destination
+ * Every packet generated by the sender is also enqueued (sharing the packet buffer) in the destination
+ * queue, so that the NAL units are packetized once for all destinations. The destination sender must
+ * use the same packet FIFO and no NAL unit FIFO; it keeps its own RTCP context and timeout drops.
+ * @warning This function must not be called concurrently with ARSTREAM2_RtpSender_ProcessRtp() on the sender
+ *
+ * @param[in] sender The sender instance
+ * @param[in] destination The destination sender instance
+ * @param[in] maxLatencyUs Maximum total latency for the destination in microseconds (0 for no limit)
+ * @param[in] maxNetworkLatencyUs Maximum network latency for the destination in microseconds for each
+ * importance level (optional, can be NULL; 0 for no limit)
+ *
+ * @return ARSTREAM2_OK if no error occured.
+ * @return ARSTREAM2_ERROR_BAD_PARAMETERS if the sender or destination is invalid.
+ * @return ARSTREAM2_ERROR_ALLOC if the allocation failed.
+ */
+eARSTREAM2_ERROR ARSTREAM2_RtpSender_AddFanOutDestination(ARSTREAM2_RtpSender_t *sender, ARSTREAM2_RtpSender_t *destination,
+                                                          uint32_t maxLatencyUs, const uint32_t *maxNetworkLatencyUs);
+
+
+/**
+ * @brief Remove a fan-out destination
+ * @warning This function must not be called concurrently with ARSTREAM2_RtpSender_ProcessRtp() on the sender
+ *
+ * @param[in] sender The sender instance
+ * @param[in] destination The destination sender instance
+ *
+ * @return ARSTREAM2_OK if no error occured.
+ * @return ARSTREAM2_ERROR_BAD_PARAMETERS if the sender or destination is invalid.
+ * @return ARSTREAM2_ERROR_NOT_FOUND if the destination is not a fan-out destination of the sender.
+ */
+eARSTREAM2_ERROR ARSTREAM2_RtpSender_RemoveFanOutDestination(ARSTREAM2_RtpSender_t *sender, ARSTREAM2_RtpSender_t *destination);
+
+
 /**
  * @brief Get the current dynamic configuration parameters
  *
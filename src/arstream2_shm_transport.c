@@ -0,0 +1,625 @@
+/**
+ * @file arstream2_shm_transport.c
+ * @brief Parrot Streaming Library - Shared memory transport
+ * @date 10/16/2026
+ * @author aurelien.barre@parrot.com
+ */
+
+#include "arstream2_shm_transport_internal.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+
+#include <libARSAL/ARSAL_Print.h>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+#define ARSTREAM2_SHM_TRANSPORT_SUPPORTED 1
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC 0x0001U
+#endif
+#else
+#define ARSTREAM2_SHM_TRANSPORT_SUPPORTED 0
+#endif
+
+
+#define ARSTREAM2_SHM_TRANSPORT_TAG "ARSTREAM2_ShmTransport"
+
+#define ARSTREAM2_SHM_TRANSPORT_MAGIC (0x41525332)  /* 'ARS2' */
+#define ARSTREAM2_SHM_TRANSPORT_VERSION (1)
+
+
+/* Shared memory segment header, the rings follow at the given offsets */
+typedef struct ARSTREAM2_ShmTransport_Header_s
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slotSize;
+    uint32_t ringOffset[ARSTREAM2_SHM_TRANSPORT_RING_COUNT];
+
+} ARSTREAM2_ShmTransport_Header_t;
+
+
+#if ARSTREAM2_SHM_TRANSPORT_SUPPORTED
+
+/* The ring geometry is read from the validated local copies only, never from the shared segment */
+static inline uint8_t* ARSTREAM2_ShmTransport_RingSlot(ARSTREAM2_ShmTransport_t *transport, int ring, uint32_t index)
+{
+    return (uint8_t*)transport->ring[ring] + sizeof(ARSTREAM2_ShmTransport_Ring_t)
+            + (size_t)(index & (transport->slotCount[ring] - 1)) * transport->slotStride[ring];
+}
+
+
+static inline size_t ARSTREAM2_ShmTransport_RingSize(uint32_t slotCount, uint32_t slotStride)
+{
+    return sizeof(ARSTREAM2_ShmTransport_Ring_t) + (size_t)slotCount * slotStride;
+}
+
+
+static void ARSTREAM2_ShmTransport_Destroy(ARSTREAM2_ShmTransport_t *transport)
+{
+    int i, err;
+
+    if (transport->base)
+    {
+        munmap(transport->base, transport->size);
+    }
+    if (transport->shmFd >= 0)
+    {
+        while (((err = close(transport->shmFd)) == -1) && (errno == EINTR));
+    }
+    for (i = 0; i < ARSTREAM2_SHM_TRANSPORT_RING_COUNT; i++)
+    {
+        if (transport->eventFd[i] >= 0)
+        {
+            while (((err = close(transport->eventFd[i])) == -1) && (errno == EINTR));
+        }
+    }
+    free(transport);
+}
+
+
+static ARSTREAM2_ShmTransport_t* ARSTREAM2_ShmTransport_Alloc(void)
+{
+    ARSTREAM2_ShmTransport_t *transport;
+    int i;
+
+    transport = malloc(sizeof(ARSTREAM2_ShmTransport_t));
+    if (!transport)
+    {
+        return NULL;
+    }
+    memset(transport, 0, sizeof(ARSTREAM2_ShmTransport_t));
+    transport->refCount = 1;
+    transport->shmFd = -1;
+    for (i = 0; i < ARSTREAM2_SHM_TRANSPORT_RING_COUNT; i++)
+    {
+        transport->eventFd[i] = -1;
+    }
+
+    return transport;
+}
+
+
+static int ARSTREAM2_ShmTransport_Map(ARSTREAM2_ShmTransport_t *transport)
+{
+    transport->base = mmap(NULL, transport->size, PROT_READ | PROT_WRITE, MAP_SHARED, transport->shmFd, 0);
+    if (transport->base == MAP_FAILED)
+    {
+        transport->base = NULL;
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_SHM_TRANSPORT_TAG, "Shared memory mmap failed (size %zu): error=%d (%s)", transport->size, errno, strerror(errno));
+        return -1;
+    }
+
+    return 0;
+}
+
+
+/* Wake the consumer up if it has found the ring empty */
+static void ARSTREAM2_ShmTransport_Signal(ARSTREAM2_ShmTransport_t *transport, int ring)
+{
+    ARSTREAM2_ShmTransport_Ring_t *r = transport->ring[ring];
+
+    /* order the head update before the consumerIdle check (pairs with the fence in ARSTREAM2_ShmTransport_RingIdle) */
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if ((__atomic_load_n(&r->consumerIdle, __ATOMIC_RELAXED)) && (__atomic_exchange_n(&r->consumerIdle, 0, __ATOMIC_ACQ_REL)))
+    {
+        uint64_t one = 1;
+        ssize_t ret;
+        while (((ret = write(transport->eventFd[ring], &one, sizeof(one))) == -1) && (errno == EINTR));
+        if (ret < 0)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_SHM_TRANSPORT_TAG, "Ring %d - eventfd write error (%d): %s", ring, errno, strerror(errno));
+        }
+    }
+}
+
+
+/* Called by the consumer when the ring is empty: returns 1 if the ring is still empty
+   and the producer will signal the eventfd on the next packet, 0 if packets have arrived meanwhile */
+static int ARSTREAM2_ShmTransport_RingIdle(ARSTREAM2_ShmTransport_t *transport, int ring)
+{
+    ARSTREAM2_ShmTransport_Ring_t *r = transport->ring[ring];
+    uint64_t value;
+    ssize_t ret;
+
+    /* clear the eventfd (non-blocking, EAGAIN if it was not signaled) */
+    while (((ret = read(transport->eventFd[ring], &value, sizeof(value))) == -1) && (errno == EINTR));
+
+    __atomic_store_n(&r->consumerIdle, 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&r->head, __ATOMIC_ACQUIRE) != r->tail)
+    {
+        __atomic_store_n(&r->consumerIdle, 0, __ATOMIC_RELAXED);
+        return 0;
+    }
+
+    return 1;
+}
+
+
+static int ARSTREAM2_ShmTransport_RingPush(ARSTREAM2_ShmTransport_t *transport, int ring, const struct iovec *iov, size_t iovlen)
+{
+    ARSTREAM2_ShmTransport_Ring_t *r = transport->ring[ring];
+    uint32_t head = r->head;
+    uint32_t tail = __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE);
+    uint32_t size;
+    uint8_t *slot;
+    size_t k;
+
+    for (k = 0, size = 0; k < iovlen; k++)
+    {
+        size += iov[k].iov_len;
+    }
+    if ((head - tail >= transport->slotCount[ring]) || (size > transport->slotSize))
+    {
+        __atomic_store_n(&r->dropCount, r->dropCount + 1, __ATOMIC_RELAXED);
+        return -2;
+    }
+
+    slot = ARSTREAM2_ShmTransport_RingSlot(transport, ring, head);
+    memcpy(slot, &size, sizeof(uint32_t));
+    slot += sizeof(uint32_t);
+    for (k = 0; k < iovlen; k++)
+    {
+        memcpy(slot, iov[k].iov_base, iov[k].iov_len);
+        slot += iov[k].iov_len;
+    }
+    __atomic_store_n(&r->head, head + 1, __ATOMIC_RELEASE);
+
+    return (int)size;
+}
+
+
+static int ARSTREAM2_ShmTransport_RingPop(ARSTREAM2_ShmTransport_t *transport, int ring, struct iovec *iov, size_t iovlen, int *flags)
+{
+    ARSTREAM2_ShmTransport_Ring_t *r = transport->ring[ring];
+    uint32_t tail = r->tail;
+    uint32_t size, offset, left;
+    uint8_t *slot;
+    size_t k;
+
+    if (__atomic_load_n(&r->head, __ATOMIC_ACQUIRE) == tail)
+    {
+        return -2;
+    }
+
+    slot = ARSTREAM2_ShmTransport_RingSlot(transport, ring, tail);
+    memcpy(&size, slot, sizeof(uint32_t));
+    slot += sizeof(uint32_t);
+    if (size > transport->slotSize)
+    {
+        size = transport->slotSize;
+    }
+    for (k = 0, offset = 0, left = size; ((k < iovlen) && (left > 0)); k++)
+    {
+        uint32_t sz = (iov[k].iov_len < left) ? (uint32_t)iov[k].iov_len : left;
+        memcpy(iov[k].iov_base, slot + offset, sz);
+        offset += sz;
+        left -= sz;
+    }
+    *flags = (left != 0) ? MSG_TRUNC : 0;
+    __atomic_store_n(&r->tail, tail + 1, __ATOMIC_RELEASE);
+
+    return (int)offset;
+}
+
+#endif
+
+
+eARSTREAM2_ERROR ARSTREAM2_ShmTransport_Create(ARSTREAM2_ShmTransport_t **transport, int slotCount, int slotSize)
+{
+#if ARSTREAM2_SHM_TRANSPORT_SUPPORTED
+    ARSTREAM2_ShmTransport_t *t;
+    ARSTREAM2_ShmTransport_Header_t *header;
+    uint32_t ringSlotCount[ARSTREAM2_SHM_TRANSPORT_RING_COUNT];
+    uint32_t slotStride, count, offset;
+    eARSTREAM2_ERROR ret = ARSTREAM2_OK;
+    int i;
+
+    if (!transport)
+    {
+        return ARSTREAM2_ERROR_BAD_PARAMETERS;
+    }
+
+    if (slotCount <= 0) slotCount = ARSTREAM2_SHM_TRANSPORT_DEFAULT_SLOT_COUNT;
+    if (slotSize <= 0) slotSize = ARSTREAM2_SHM_TRANSPORT_DEFAULT_SLOT_SIZE;
+    for (count = 1; count < (uint32_t)slotCount; count <<= 1);
+    ringSlotCount[ARSTREAM2_SHM_TRANSPORT_RING_STREAM] = count;
+    ringSlotCount[ARSTREAM2_SHM_TRANSPORT_RING_SENDER_CONTROL] = ARSTREAM2_SHM_TRANSPORT_CONTROL_SLOT_COUNT;
+    ringSlotCount[ARSTREAM2_SHM_TRANSPORT_RING_RECEIVER_CONTROL] = ARSTREAM2_SHM_TRANSPORT_CONTROL_SLOT_COUNT;
+    slotStride = (sizeof(uint32_t) + (uint32_t)slotSize + ARSTREAM2_SHM_TRANSPORT_CACHE_LINE_SIZE - 1) & ~(ARSTREAM2_SHM_TRANSPORT_CACHE_LINE_SIZE - 1);
+
+    t = ARSTREAM2_ShmTransport_Alloc();
+    if (!t)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_SHM_TRANSPORT_TAG, "Allocation failed");
+        return ARSTREAM2_ERROR_ALLOC;
+    }
+    t->slotSize = (uint32_t)slotSize;
+    offset = ARSTREAM2_SHM_TRANSPORT_CACHE_LINE_SIZE;
+    for (i = 0; i < ARSTREAM2_SHM_TRANSPORT_RING_COUNT; i++)
+    {
+        offset += ARSTREAM2_ShmTransport_RingSize(ringSlotCount[i], slotStride);
+    }
+    t->size = offset;
+
+    t->shmFd = syscall(__NR_memfd_create, "arstream2_shm_transport", MFD_CLOEXEC);
+    if (t->shmFd < 0)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_SHM_TRANSPORT_TAG, "memfd_create failed: error=%d (%s)", errno, strerror(errno));
+        ret = (errno == ENOSYS) ? ARSTREAM2_ERROR_UNSUPPORTED : ARSTREAM2_ERROR_ALLOC;
+    }
+    else if (ftruncate(t->shmFd, (off_t)t->size) != 0)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_SHM_TRANSPORT_TAG, "ftruncate failed (size %zu): error=%d (%s)", t->size, errno, strerror(errno));
+        ret = ARSTREAM2_ERROR_ALLOC;
+    }
+
+    for (i = 0; (ret == ARSTREAM2_OK) && (i < ARSTREAM2_SHM_TRANSPORT_RING_COUNT); i++)
+    {
+        t->eventFd[i] = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (t->eventFd[i] < 0)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_SHM_TRANSPORT_TAG, "eventfd failed: error=%d (%s)", errno, strerror(errno));
+            ret = ARSTREAM2_ERROR_ALLOC;
+        }
+    }
+
+    if (ret == ARSTREAM2_OK)
+    {
+        /* the new segment is zero-filled: only the sizes, the offsets and the consumer state need to be set */
+        header = mmap(NULL, t->size, PROT_READ | PROT_WRITE, MAP_SHARED, t->shmFd, 0);
+        if (header == MAP_FAILED)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_SHM_TRANSPORT_TAG, "Shared memory mmap failed (size %zu): error=%d (%s)", t->size, errno, strerror(errno));
+            ret = ARSTREAM2_ERROR_ALLOC;
+        }
+        else
+        {
+            t->base = header;
+            header->magic = ARSTREAM2_SHM_TRANSPORT_MAGIC;
+            header->version = ARSTREAM2_SHM_TRANSPORT_VERSION;
+            header->slotSize = t->slotSize;
+            offset = ARSTREAM2_SHM_TRANSPORT_CACHE_LINE_SIZE;
+            for (i = 0; i < ARSTREAM2_SHM_TRANSPORT_RING_COUNT; i++)
+            {
+                header->ringOffset[i] = offset;
+                t->ring[i] = (ARSTREAM2_ShmTransport_Ring_t*)((uint8_t*)t->base + offset);
+                t->ring[i]->slotCount = ringSlotCount[i];
+                t->ring[i]->slotStride = slotStride;
+                /* the consumer has not read anything yet: the first packet must ring the eventfd */
+                t->ring[i]->consumerIdle = 1;
+                t->slotCount[i] = ringSlotCount[i];
+                t->slotStride[i] = slotStride;
+                offset += ARSTREAM2_ShmTransport_RingSize(ringSlotCount[i], slotStride);
+            }
+        }
+    }
+
+    if (ret != ARSTREAM2_OK)
+    {
+        ARSTREAM2_ShmTransport_Destroy(t);
+        return ret;
+    }
+
+    ARSAL_PRINT(ARSAL_PRINT_INFO, ARSTREAM2_SHM_TRANSPORT_TAG, "Shared memory transport created: %d slots of %d bytes (%zu bytes)",
+                ringSlotCount[ARSTREAM2_SHM_TRANSPORT_RING_STREAM], slotSize, t->size);
+    *transport = t;
+    return ARSTREAM2_OK;
+#else
+    return ARSTREAM2_ERROR_UNSUPPORTED;
+#endif
+}
+
+
+eARSTREAM2_ERROR ARSTREAM2_ShmTransport_Attach(ARSTREAM2_ShmTransport_t **transport, int shmFd, int streamFd, int senderControlFd, int receiverControlFd)
+{
+#if ARSTREAM2_SHM_TRANSPORT_SUPPORTED
+    ARSTREAM2_ShmTransport_t *t;
+    ARSTREAM2_ShmTransport_Header_t *header;
+    int fds[ARSTREAM2_SHM_TRANSPORT_RING_COUNT];
+    uint32_t magic, version, slotSize;
+    off_t size;
+    int i;
+
+    if ((!transport) || (shmFd < 0) || (streamFd < 0) || (senderControlFd < 0) || (receiverControlFd < 0))
+    {
+        return ARSTREAM2_ERROR_BAD_PARAMETERS;
+    }
+    fds[ARSTREAM2_SHM_TRANSPORT_RING_STREAM] = streamFd;
+    fds[ARSTREAM2_SHM_TRANSPORT_RING_SENDER_CONTROL] = senderControlFd;
+    fds[ARSTREAM2_SHM_TRANSPORT_RING_RECEIVER_CONTROL] = receiverControlFd;
+
+    size = lseek(shmFd, 0, SEEK_END);
+    if (size < (off_t)ARSTREAM2_SHM_TRANSPORT_CACHE_LINE_SIZE)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_SHM_TRANSPORT_TAG, "Invalid shared memory segment size (%lld)", (long long)size);
+        return ARSTREAM2_ERROR_BAD_PARAMETERS;
+    }
+
+    t = ARSTREAM2_ShmTransport_Alloc();
+    if (!t)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_SHM_TRANSPORT_TAG, "Allocation failed");
+        return ARSTREAM2_ERROR_ALLOC;
+    }
+    t->size = (size_t)size;
+    t->shmFd = fcntl(shmFd, F_DUPFD_CLOEXEC, 0);
+    for (i = 0; i < ARSTREAM2_SHM_TRANSPORT_RING_COUNT; i++)
+    {
+        t->eventFd[i] = fcntl(fds[i], F_DUPFD_CLOEXEC, 0);
+        if (t->eventFd[i] < 0)
+        {
+            break;
+        }
+    }
+    if ((t->shmFd < 0) || (i < ARSTREAM2_SHM_TRANSPORT_RING_COUNT))
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_SHM_TRANSPORT_TAG, "Failed to duplicate the file descriptors: error=%d (%s)", errno, strerror(errno));
+        ARSTREAM2_ShmTransport_Destroy(t);
+        return ARSTREAM2_ERROR_BAD_PARAMETERS;
+    }
+
+    if (ARSTREAM2_ShmTransport_Map(t) != 0)
+    {
+        ARSTREAM2_ShmTransport_Destroy(t);
+        return ARSTREAM2_ERROR_ALLOC;
+    }
+
+    /* the header fields are read once and only the validated local copies are used afterwards */
+    header = (ARSTREAM2_ShmTransport_Header_t*)t->base;
+    magic = __atomic_load_n(&header->magic, __ATOMIC_RELAXED);
+    version = __atomic_load_n(&header->version, __ATOMIC_RELAXED);
+    slotSize = __atomic_load_n(&header->slotSize, __ATOMIC_RELAXED);
+    if ((magic != ARSTREAM2_SHM_TRANSPORT_MAGIC) || (version != ARSTREAM2_SHM_TRANSPORT_VERSION) || (slotSize == 0))
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_SHM_TRANSPORT_TAG, "Invalid shared memory segment (magic 0x%08X, version %d)", magic, version);
+        ARSTREAM2_ShmTransport_Destroy(t);
+        return ARSTREAM2_ERROR_BAD_PARAMETERS;
+    }
+    for (i = 0; i < ARSTREAM2_SHM_TRANSPORT_RING_COUNT; i++)
+    {
+        ARSTREAM2_ShmTransport_Ring_t *r = NULL;
+        uint32_t ringOffset = __atomic_load_n(&header->ringOffset[i], __ATOMIC_RELAXED);
+        uint32_t slotCount = 0, slotStride = 0;
+        if ((size_t)ringOffset + sizeof(ARSTREAM2_ShmTransport_Ring_t) <= t->size)
+        {
+            r = (ARSTREAM2_ShmTransport_Ring_t*)((uint8_t*)t->base + ringOffset);
+            slotCount = __atomic_load_n(&r->slotCount, __ATOMIC_RELAXED);
+            slotStride = __atomic_load_n(&r->slotStride, __ATOMIC_RELAXED);
+        }
+        if ((slotCount == 0) || (slotCount & (slotCount - 1))
+                || ((uint64_t)slotStride < sizeof(uint32_t) + (uint64_t)slotSize)
+                || ((uint64_t)ringOffset + sizeof(ARSTREAM2_ShmTransport_Ring_t) + (uint64_t)slotCount * slotStride > t->size))
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_SHM_TRANSPORT_TAG, "Invalid shared memory segment ring %d", i);
+            ARSTREAM2_ShmTransport_Destroy(t);
+            return ARSTREAM2_ERROR_BAD_PARAMETERS;
+        }
+        t->ring[i] = r;
+        t->slotCount[i] = slotCount;
+        t->slotStride[i] = slotStride;
+    }
+    t->slotSize = slotSize;
+
+    *transport = t;
+    return ARSTREAM2_OK;
+#else
+    return ARSTREAM2_ERROR_UNSUPPORTED;
+#endif
+}
+
+
+eARSTREAM2_ERROR ARSTREAM2_ShmTransport_GetFds(ARSTREAM2_ShmTransport_t *transport, int *shmFd, int *streamFd, int *senderControlFd, int *receiverControlFd)
+{
+    if (!transport)
+    {
+        return ARSTREAM2_ERROR_BAD_PARAMETERS;
+    }
+
+    if (shmFd) *shmFd = transport->shmFd;
+    if (streamFd) *streamFd = transport->eventFd[ARSTREAM2_SHM_TRANSPORT_RING_STREAM];
+    if (senderControlFd) *senderControlFd = transport->eventFd[ARSTREAM2_SHM_TRANSPORT_RING_SENDER_CONTROL];
+    if (receiverControlFd) *receiverControlFd = transport->eventFd[ARSTREAM2_SHM_TRANSPORT_RING_RECEIVER_CONTROL];
+
+    return ARSTREAM2_OK;
+}
+
+
+eARSTREAM2_ERROR ARSTREAM2_ShmTransport_Ref(ARSTREAM2_ShmTransport_t *transport)
+{
+    if (!transport)
+    {
+        return ARSTREAM2_ERROR_BAD_PARAMETERS;
+    }
+
+    __atomic_add_fetch(&transport->refCount, 1, __ATOMIC_RELAXED);
+
+    return ARSTREAM2_OK;
+}
+
+
+eARSTREAM2_ERROR ARSTREAM2_ShmTransport_Unref(ARSTREAM2_ShmTransport_t *transport)
+{
+    if (!transport)
+    {
+        return ARSTREAM2_ERROR_BAD_PARAMETERS;
+    }
+
+    if (__atomic_sub_fetch(&transport->refCount, 1, __ATOMIC_ACQ_REL) == 0)
+    {
+#if ARSTREAM2_SHM_TRANSPORT_SUPPORTED
+        ARSTREAM2_ShmTransport_Ring_t *r = transport->ring[ARSTREAM2_SHM_TRANSPORT_RING_STREAM];
+        if (r)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARSTREAM2_SHM_TRANSPORT_TAG, "Shared memory transport destroyed (%d RTP packets dropped on full ring)",
+                        __atomic_load_n(&r->dropCount, __ATOMIC_RELAXED));
+        }
+        ARSTREAM2_ShmTransport_Destroy(transport);
+#endif
+    }
+
+    return ARSTREAM2_OK;
+}
+
+
+int ARSTREAM2_ShmTransport_GetEventFd(ARSTREAM2_ShmTransport_t *transport, int ring)
+{
+    if ((!transport) || (ring < 0) || (ring >= ARSTREAM2_SHM_TRANSPORT_RING_COUNT))
+    {
+        return -1;
+    }
+
+    return transport->eventFd[ring];
+}
+
+
+int ARSTREAM2_ShmTransport_SendMmsg(ARSTREAM2_ShmTransport_t *transport, int ring, struct mmsghdr *msgVec, unsigned int msgVecCount)
+{
+#if ARSTREAM2_SHM_TRANSPORT_SUPPORTED
+    unsigned int i;
+
+    if ((!transport) || (!msgVec) || (ring < 0) || (ring >= ARSTREAM2_SHM_TRANSPORT_RING_COUNT))
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_SHM_TRANSPORT_TAG, "Invalid pointer");
+        return -1;
+    }
+
+    for (i = 0; i < msgVecCount; i++)
+    {
+        int ret = ARSTREAM2_ShmTransport_RingPush(transport, ring, msgVec[i].msg_hdr.msg_iov, msgVec[i].msg_hdr.msg_iovlen);
+        msgVec[i].msg_len = (ret > 0) ? (unsigned int)ret : 0;
+    }
+    if (msgVecCount > 0)
+    {
+        ARSTREAM2_ShmTransport_Signal(transport, ring);
+    }
+
+    return (int)msgVecCount;
+#else
+    return -1;
+#endif
+}
+
+
+int ARSTREAM2_ShmTransport_RecvMmsg(ARSTREAM2_ShmTransport_t *transport, int ring, struct mmsghdr *msgVec, unsigned int msgVecCount)
+{
+#if ARSTREAM2_SHM_TRANSPORT_SUPPORTED
+    unsigned int count = 0;
+
+    if ((!transport) || (!msgVec) || (ring < 0) || (ring >= ARSTREAM2_SHM_TRANSPORT_RING_COUNT))
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_SHM_TRANSPORT_TAG, "Invalid pointer");
+        return -1;
+    }
+
+    while (count < msgVecCount)
+    {
+        int flags = 0;
+        int ret = ARSTREAM2_ShmTransport_RingPop(transport, ring, msgVec[count].msg_hdr.msg_iov, msgVec[count].msg_hdr.msg_iovlen, &flags);
+        if (ret >= 0)
+        {
+            msgVec[count].msg_hdr.msg_flags = flags;
+            msgVec[count].msg_len = (unsigned int)ret;
+            count++;
+        }
+        else if (ARSTREAM2_ShmTransport_RingIdle(transport, ring))
+        {
+            break;
+        }
+    }
+
+    return (int)count;
+#else
+    return -1;
+#endif
+}
+
+
+int ARSTREAM2_ShmTransport_Send(ARSTREAM2_ShmTransport_t *transport, int ring, const uint8_t *buffer, int size)
+{
+#if ARSTREAM2_SHM_TRANSPORT_SUPPORTED
+    struct iovec iov;
+    int ret;
+
+    if ((!transport) || (!buffer) || (ring < 0) || (ring >= ARSTREAM2_SHM_TRANSPORT_RING_COUNT))
+    {
+        errno = EINVAL;
+        return -1;
+    }
+
+    iov.iov_base = (void*)buffer;
+    iov.iov_len = (size_t)size;
+    ret = ARSTREAM2_ShmTransport_RingPush(transport, ring, &iov, 1);
+    if (ret < 0)
+    {
+        errno = EAGAIN;
+        return -1;
+    }
+    ARSTREAM2_ShmTransport_Signal(transport, ring);
+
+    return ret;
+#else
+    errno = ENOSYS;
+    return -1;
+#endif
+}
+
+
+int ARSTREAM2_ShmTransport_Recv(ARSTREAM2_ShmTransport_t *transport, int ring, uint8_t *buffer, int size)
+{
+#if ARSTREAM2_SHM_TRANSPORT_SUPPORTED
+    struct iovec iov;
+    int ret, flags;
+
+    if ((!transport) || (!buffer) || (ring < 0) || (ring >= ARSTREAM2_SHM_TRANSPORT_RING_COUNT))
+    {
+        errno = EINVAL;
+        return -1;
+    }
+
+    iov.iov_base = buffer;
+    iov.iov_len = (size_t)size;
+    do
+    {
+        ret = ARSTREAM2_ShmTransport_RingPop(transport, ring, &iov, 1, &flags);
+    }
+    while ((ret < 0) && (!ARSTREAM2_ShmTransport_RingIdle(transport, ring)));
+    if (ret < 0)
+    {
+        errno = EAGAIN;
+        return -1;
+    }
+
+    return ret;
+#else
+    errno = ENOSYS;
+    return -1;
+#endif
+}
@@ -0,0 +1,77 @@
+/**
+ * @file arstream2_shm_transport_internal.h
+ * @brief Parrot Streaming Library - Shared memory transport
+ * @date 10/16/2026
+ * @author aurelien.barre@parrot.com
+ */
+
+#ifndef _ARSTREAM2_SHM_TRANSPORT_INTERNAL_H_
+#define _ARSTREAM2_SHM_TRANSPORT_INTERNAL_H_
+
+#include <config.h>
+
+#include <inttypes.h>
+#define __USE_GNU
+#include <sys/socket.h>
+#undef __USE_GNU
+
+#include <libARStream2/arstream2_shm_transport.h>
+
+
+#define ARSTREAM2_SHM_TRANSPORT_RING_STREAM (0)             /* RTP, sender to receiver */
+#define ARSTREAM2_SHM_TRANSPORT_RING_SENDER_CONTROL (1)     /* RTCP, sender to receiver */
+#define ARSTREAM2_SHM_TRANSPORT_RING_RECEIVER_CONTROL (2)   /* RTCP, receiver to sender */
+#define ARSTREAM2_SHM_TRANSPORT_RING_COUNT (3)
+
+#define ARSTREAM2_SHM_TRANSPORT_CONTROL_SLOT_COUNT (64)
+#define ARSTREAM2_SHM_TRANSPORT_CACHE_LINE_SIZE (64)
+
+
+/* Ring header in the shared memory segment; the producer and consumer
+   indexes are on separate cache lines, the slots follow the header */
+typedef struct ARSTREAM2_ShmTransport_Ring_s
+{
+    uint32_t slotCount;
+    uint32_t slotStride;
+    uint8_t pad0[ARSTREAM2_SHM_TRANSPORT_CACHE_LINE_SIZE - 2 * sizeof(uint32_t)];
+    uint32_t head;              /* written by the producer */
+    uint32_t dropCount;         /* written by the producer */
+    uint8_t pad1[ARSTREAM2_SHM_TRANSPORT_CACHE_LINE_SIZE - 2 * sizeof(uint32_t)];
+    uint32_t tail;              /* written by the consumer */
+    uint32_t consumerIdle;      /* set by the consumer before waiting on the eventfd, cleared by the producer */
+    uint8_t pad2[ARSTREAM2_SHM_TRANSPORT_CACHE_LINE_SIZE - 2 * sizeof(uint32_t)];
+
+} ARSTREAM2_ShmTransport_Ring_t;
+
+
+struct ARSTREAM2_ShmTransport_s
+{
+    int refCount;
+    int shmFd;
+    void *base;
+    size_t size;
+    uint32_t slotSize;
+    ARSTREAM2_ShmTransport_Ring_t *ring[ARSTREAM2_SHM_TRANSPORT_RING_COUNT];
+    uint32_t slotCount[ARSTREAM2_SHM_TRANSPORT_RING_COUNT];     /* local copies: the segment is writable by the peer process */
+    uint32_t slotStride[ARSTREAM2_SHM_TRANSPORT_RING_COUNT];
+    int eventFd[ARSTREAM2_SHM_TRANSPORT_RING_COUNT];
+};
+
+
+/* Get the eventfd to wait on for a ring (readable when the producer has signaled new packets) */
+int ARSTREAM2_ShmTransport_GetEventFd(ARSTREAM2_ShmTransport_t *transport, int ring);
+
+/* Push the msgVec datagrams to a ring (the iovecs are gathered in the slots); a datagram that does
+   not fit is dropped like on a full socket buffer. Returns msgVecCount, -1 on error */
+int ARSTREAM2_ShmTransport_SendMmsg(ARSTREAM2_ShmTransport_t *transport, int ring, struct mmsghdr *msgVec, unsigned int msgVecCount);
+
+/* Pop up to msgVecCount datagrams from a ring (scattered to the iovecs, MSG_TRUNC is set in msg_flags
+   if a datagram does not fit). Returns the datagram count, 0 when the ring is empty, -1 on error */
+int ARSTREAM2_ShmTransport_RecvMmsg(ARSTREAM2_ShmTransport_t *transport, int ring, struct mmsghdr *msgVec, unsigned int msgVecCount);
+
+/* Single datagram versions; return the byte count or -1 with errno set to EAGAIN if the ring is full (send) or empty (receive) */
+int ARSTREAM2_ShmTransport_Send(ARSTREAM2_ShmTransport_t *transport, int ring, const uint8_t *buffer, int size);
+
+int ARSTREAM2_ShmTransport_Recv(ARSTREAM2_ShmTransport_t *transport, int ring, uint8_t *buffer, int size);
+
+#endif /* _ARSTREAM2_SHM_TRANSPORT_INTERNAL_H_ */
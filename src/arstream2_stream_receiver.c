@@ -7,6 +7,10 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#ifdef HAS_EPOLL
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#endif
 
 #include <libARSAL/ARSAL_Print.h>
 #include <libARSAL/ARSAL_Mutex.h>
@@ -27,6 +31,11 @@
 #define ARSTREAM2_STREAM_RECEIVER_DEFAULT_PACKET_FIFO_BUFFER_TO_ITEM_FACTOR (4)
 #define ARSTREAM2_STREAM_RECEIVER_DEFAULT_MIN_PACKET_FIFO_ITEM_COUNT (ARSTREAM2_STREAM_RECEIVER_DEFAULT_MIN_PACKET_FIFO_BUFFER_COUNT * ARSTREAM2_STREAM_RECEIVER_DEFAULT_PACKET_FIFO_BUFFER_TO_ITEM_FACTOR)
 
+/* When the server does not provide the maximum packet size the packet FIFO buffers are sized for an
+   Ethernet MTU and larger datagrams go to a few maximum UDP size overflow buffers */
+#define ARSTREAM2_STREAM_RECEIVER_DEFAULT_PACKET_BUFFER_SIZE (1500 - ARSTREAM2_RTP_TOTAL_HEADERS_SIZE)
+#define ARSTREAM2_STREAM_RECEIVER_DEFAULT_PACKET_FIFO_OVERFLOW_BUFFER_COUNT (16)
+
 #define ARSTREAM2_STREAM_RECEIVER_DEFAULT_AU_FIFO_ITEM_COUNT (200)
 #define ARSTREAM2_STREAM_RECEIVER_DEFAULT_AU_FIFO_ITEM_NALU_COUNT (128)
 #define ARSTREAM2_STREAM_RECEIVER_DEFAULT_AU_FIFO_BUFFER_COUNT (60)
@@ -44,6 +53,9 @@
 #define ARSTREAM2_STREAM_RECEIVER_DJB_REPORT_RTCP_SEND_INTERVAL (1000000)
 #define ARSTREAM2_STREAM_RECEIVER_UNTIMED_METADATA_DEFAULT_SEND_INTERVAL (5000000)
 
+#define ARSTREAM2_STREAM_RECEIVER_EPOLL_MAX_EVENTS (16)
+#define ARSTREAM2_STREAM_RECEIVER_EPOLL_MIN_TIMEOUT_US (1000)
+
 
 typedef struct ARSTREAM2_StreamReceiver_s
 {
@@ -102,6 +114,9 @@ typedef struct ARSTREAM2_StreamReceiver_s
         void *getAuBufferCallbackUserPtr;
         ARSTREAM2_StreamReceiver_AuReadyCallback_t auReadyCallback;
         void *auReadyCallbackUserPtr;
+        ARSTREAM2_StreamReceiver_AuViewReadyCallback_t auViewReadyCallback;
+        void *auViewReadyCallbackUserPtr;
+        int zeroCopy;
         int mbWidth;
         int mbHeight;
         ARSTREAM2_StreamStats_VideoStats_t videoStats;
@@ -145,6 +160,7 @@ static int ARSTREAM2_StreamReceiver_StreamRecorderInit(ARSTREAM2_StreamReceiver_
 static int ARSTREAM2_StreamReceiver_StreamRecorderStop(ARSTREAM2_StreamReceiver_t *streamReceiver);
 static int ARSTREAM2_StreamReceiver_StreamRecorderFree(ARSTREAM2_StreamReceiver_t *streamReceiver);
 static void ARSTREAM2_StreamReceiver_AutoStartRecorder(ARSTREAM2_StreamReceiver_t *streamReceiver);
+static eARSTREAM2_ERROR ARSTREAM2_StreamReceiver_ResenderDelete(ARSTREAM2_StreamReceiver_t *streamReceiver, ARSTREAM2_RtpResender_t *resender);
 
 
 eARSTREAM2_ERROR ARSTREAM2_StreamReceiver_Init(ARSTREAM2_StreamReceiver_Handle *streamReceiverHandle,
@@ -368,9 +384,38 @@ eARSTREAM2_ERROR ARSTREAM2_StreamReceiver_Init(ARSTREAM2_StreamReceiver_Handle *
     /* Setup the packet FIFO */
     if (ret == ARSTREAM2_OK)
     {
-        int packetFifoRet = ARSTREAM2_RTP_PacketFifoInit(&streamReceiver->packetFifo, ARSTREAM2_STREAM_RECEIVER_DEFAULT_MIN_PACKET_FIFO_ITEM_COUNT,
-                                                         ARSTREAM2_STREAM_RECEIVER_DEFAULT_MIN_PACKET_FIFO_BUFFER_COUNT,
-                                                         streamReceiver->maxPacketSize);
+        int packetFifoItemCount = ARSTREAM2_STREAM_RECEIVER_DEFAULT_MIN_PACKET_FIFO_ITEM_COUNT;
+        int packetFifoBufferCount = ARSTREAM2_STREAM_RECEIVER_DEFAULT_MIN_PACKET_FIFO_BUFFER_COUNT;
+        if (config->useFec)
+        {
+            /* the FEC stage holds a reference on the recent media packets and on the pending repair packets */
+            packetFifoBufferCount += ARSTREAM2_RTPFEC_RECEIVER_MEDIA_WINDOW_SIZE + ARSTREAM2_RTPFEC_RECEIVER_MAX_REPAIR_COUNT;
+            packetFifoItemCount += ARSTREAM2_RTPFEC_RECEIVER_MAX_REPAIR_COUNT;
+        }
+        int packetBufferSize = ((streamReceiver->maxPacketSize > (int)ARSTREAM2_STREAM_RECEIVER_DEFAULT_PACKET_BUFFER_SIZE) && (config->maxPacketSize <= 0))
+                ? (int)ARSTREAM2_STREAM_RECEIVER_DEFAULT_PACKET_BUFFER_SIZE : streamReceiver->maxPacketSize;
+        int packetFifoRet;
+        if (config->usePacketFifoArena)
+        {
+            int arenaFlags = ((config->packetFifoArenaHugePages) ? ARSTREAM2_RTP_PACKET_FIFO_ARENA_HUGE_PAGES : 0)
+                    | ((config->packetFifoArenaLock) ? ARSTREAM2_RTP_PACKET_FIFO_ARENA_LOCK : 0);
+            packetFifoRet = ARSTREAM2_RTP_PacketFifoInitArena(&streamReceiver->packetFifo, packetFifoItemCount, packetFifoBufferCount,
+                                                              packetBufferSize, arenaFlags);
+        }
+        else
+        {
+            packetFifoRet = ARSTREAM2_RTP_PacketFifoInit(&streamReceiver->packetFifo, packetFifoItemCount, packetFifoBufferCount,
+                                                         packetBufferSize);
+        }
+        if ((packetFifoRet == 0) && (packetBufferSize < streamReceiver->maxPacketSize))
+        {
+            packetFifoRet = ARSTREAM2_RTP_PacketFifoInitOverflow(&streamReceiver->packetFifo, ARSTREAM2_STREAM_RECEIVER_DEFAULT_PACKET_FIFO_OVERFLOW_BUFFER_COUNT,
+                                                                 streamReceiver->maxPacketSize);
+            if (packetFifoRet != 0)
+            {
+                ARSTREAM2_RTP_PacketFifoFree(&streamReceiver->packetFifo);
+            }
+        }
         if (packetFifoRet != 0)
         {
             ret = ARSTREAM2_ERROR_ALLOC;
@@ -383,6 +428,17 @@ eARSTREAM2_ERROR ARSTREAM2_StreamReceiver_Init(ARSTREAM2_StreamReceiver_Handle *
                 ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "ARSTREAM2_RTP_PacketFifoAddQueue() failed (%d)", packetFifoRet);
                 ret = ARSTREAM2_ERROR_ALLOC;
             }
+            else
+            {
+                /* the receive queue holds at most one packet per buffer, leave room for gaps */
+                packetFifoRet = ARSTREAM2_RTP_PacketFifoQueueEnableSeqNumIndex(&streamReceiver->packetFifoQueue,
+                                                                              2 * ARSTREAM2_STREAM_RECEIVER_DEFAULT_MIN_PACKET_FIFO_BUFFER_COUNT);
+                if (packetFifoRet != 0)
+                {
+                    ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "ARSTREAM2_RTP_PacketFifoQueueEnableSeqNumIndex() failed (%d)", packetFifoRet);
+                    ret = ARSTREAM2_ERROR_ALLOC;
+                }
+            }
             packetFifoWasCreated = 1;
         }
     }
@@ -432,6 +488,8 @@ eARSTREAM2_ERROR ARSTREAM2_StreamReceiver_Init(ARSTREAM2_StreamReceiver_Handle *
         receiverConfig.maxPacketSize = config->maxPacketSize;
         receiverConfig.insertStartCodes = 1;
         receiverConfig.generateReceiverReports = config->generateReceiverReports;
+        receiverConfig.generateNack = config->generateNack;
+        receiverConfig.useFec = config->useFec;
         receiverConfig.videoStatsSendTimeInterval = ARSTREAM2_STREAM_RECEIVER_VIDEO_STATS_RTCP_SEND_INTERVAL;
         receiverConfig.lossReportSendTimeInterval = ARSTREAM2_STREAM_RECEIVER_LOSS_REPORT_RTCP_SEND_INTERVAL;
         receiverConfig.djbReportSendTimeInterval = ARSTREAM2_STREAM_RECEIVER_DJB_REPORT_RTCP_SEND_INTERVAL;
@@ -448,6 +506,9 @@ eARSTREAM2_ERROR ARSTREAM2_StreamReceiver_Init(ARSTREAM2_StreamReceiver_Handle *
             receiver_net_config.clientStreamPort = net_config->clientStreamPort;
             receiver_net_config.clientControlPort = net_config->clientControlPort;
             receiver_net_config.classSelector = net_config->classSelector;
+            receiver_net_config.useGro = net_config->useGro;
+            receiver_net_config.useIoUring = net_config->useIoUring;
+            receiver_net_config.shmTransport = net_config->shmTransport;
             streamReceiver->receiver = ARSTREAM2_RtpReceiver_New(&receiverConfig, &receiver_net_config, NULL, &ret);
         }
 
@@ -560,10 +621,10 @@ eARSTREAM2_ERROR ARSTREAM2_StreamReceiver_Free(ARSTREAM2_StreamReceiver_Handle *
     ARSTREAM2_RtpResender_t *resender, *next;
     for (resender = streamReceiver->resender; resender; resender = next)
     {
-        ret = ARSTREAM2_RtpSender_Delete(&resender->sender);
+        ret = ARSTREAM2_StreamReceiver_ResenderDelete(streamReceiver, resender);
         if (ret != ARSTREAM2_OK)
         {
-            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "Unable to delete sender: %s", ARSTREAM2_Error_ToString(ret));
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "Unable to delete resender: %s", ARSTREAM2_Error_ToString(ret));
         }
         next = resender->next;
         free(resender);
@@ -583,6 +644,22 @@ eARSTREAM2_ERROR ARSTREAM2_StreamReceiver_Free(ARSTREAM2_StreamReceiver_Handle *
         ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "Unable to delete H264Filter: %s", ARSTREAM2_Error_ToString(ret));
     }
 
+    ARSTREAM2_H264_AuBufferStats_t auBufferStats;
+    if (ARSTREAM2_H264_AuFifoGetBufferStats(&(streamReceiver->auFifo), &auBufferStats) == 0)
+    {
+        int c;
+        for (c = 0; c < auBufferStats.classCount; c++)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_INFO, ARSTREAM2_STREAM_RECEIVER_TAG, "AU buffer class %d (%u bytes): blocks=%u AUs=%u overflows=%u exhausted=%u",
+                        c, auBufferStats.blockSize[c], auBufferStats.blockCount[c], auBufferStats.auCount[c],
+                        auBufferStats.overflowCount[c], auBufferStats.exhaustedCount[c]);
+        }
+        if (auBufferStats.heapCount > 0)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_INFO, ARSTREAM2_STREAM_RECEIVER_TAG, "AU buffer heap fallbacks: %u", auBufferStats.heapCount);
+        }
+    }
+
     ARSTREAM2_RTP_PacketFifoFree(&(streamReceiver->packetFifo));
     ARSTREAM2_H264_AuFifoFree(&(streamReceiver->auFifo));
     ARSAL_Mutex_Destroy(&(streamReceiver->threadMutex));
@@ -1319,10 +1396,216 @@ static int ARSTREAM2_StreamReceiver_StreamRecorderFree(ARSTREAM2_StreamReceiver_
 }
 
 
+static void ARSTREAM2_StreamReceiver_AppOutputAuInfo(ARSTREAM2_StreamReceiver_t *streamReceiver, ARSTREAM2_H264_AccessUnit_t *au, uint64_t curTime,
+                                                     eARSTREAM2_STREAM_RECEIVER_AU_SYNC_TYPE *auSyncType,
+                                                     ARSTREAM2_StreamReceiver_AuReadyCallbackTimestamps_t *auTimestamps,
+                                                     ARSTREAM2_StreamReceiver_AuReadyCallbackMetadata_t *auMetadata)
+{
+    /* map the access unit sync type */
+    switch (au->syncType)
+    {
+        default:
+        case ARSTREAM2_H264_AU_SYNC_TYPE_NONE:
+            *auSyncType = ARSTREAM2_STREAM_RECEIVER_AU_SYNC_TYPE_NONE;
+            break;
+        case ARSTREAM2_H264_AU_SYNC_TYPE_IDR:
+            *auSyncType = ARSTREAM2_STREAM_RECEIVER_AU_SYNC_TYPE_IDR;
+            break;
+        case ARSTREAM2_H264_AU_SYNC_TYPE_IFRAME:
+            *auSyncType = ARSTREAM2_STREAM_RECEIVER_AU_SYNC_TYPE_IFRAME;
+            break;
+        case ARSTREAM2_H264_AU_SYNC_TYPE_PIR_START:
+            *auSyncType = ARSTREAM2_STREAM_RECEIVER_AU_SYNC_TYPE_PIR_START;
+            break;
+    }
+
+    if (au->videoStatsAvailable)
+    {
+        ARSTREAM2_H264_VideoStats_t *vs = (ARSTREAM2_H264_VideoStats_t*)au->buffer->videoStatsBuffer;
+        uint32_t outputTimestampDelta = (streamReceiver->lastAuOutputTimestamp)
+                ? (uint32_t)(curTime - streamReceiver->lastAuOutputTimestamp) : 0;
+        uint32_t estimatedLatency = ((au->ntpTimestampLocal) && (curTime > au->ntpTimestampLocal))
+                ? (uint32_t)(curTime - au->ntpTimestampLocal) : 0;
+        int32_t timingError = ((vs->timestampDelta) && (streamReceiver->lastAuOutputTimestamp))
+                ? ((int32_t)vs->timestampDelta - (int32_t)outputTimestampDelta) : 0;
+        vs->timingError = timingError;
+        streamReceiver->timingErrorIntegral += (timingError < 0) ? (uint32_t)(-timingError) : (uint32_t)timingError;
+        vs->timingErrorIntegral = streamReceiver->timingErrorIntegral;
+        streamReceiver->timingErrorIntegralSq += (int64_t)timingError * (int64_t)timingError;
+        vs->timingErrorIntegralSq = streamReceiver->timingErrorIntegralSq;
+        vs->estimatedLatency = estimatedLatency;
+        streamReceiver->estimatedLatencyIntegral += estimatedLatency;
+        vs->estimatedLatencyIntegral = streamReceiver->estimatedLatencyIntegral;
+        streamReceiver->estimatedLatencyIntegralSq += (uint64_t)estimatedLatency * (uint64_t)estimatedLatency;
+        vs->estimatedLatencyIntegralSq = streamReceiver->estimatedLatencyIntegralSq;
+        vs->timestamp = au->ntpTimestampRaw;
+
+        /* get the RSSI from the streaming metadata */
+        //TODO: remove this hack once we have a better way of getting the RSSI
+        if ((au->metadataSize >= 27) && (ntohs(*((uint16_t*)au->buffer->metadataBuffer)) == 0x5031))
+        {
+            vs->rssi = (int8_t)au->buffer->metadataBuffer[26];
+        }
+        if ((au->metadataSize >= 55) && (ntohs(*((uint16_t*)au->buffer->metadataBuffer)) == 0x5032))
+        {
+            vs->rssi = (int8_t)au->buffer->metadataBuffer[54];
+        }
+        streamReceiver->lastKnownRssi = vs->rssi;
+
+        eARSTREAM2_ERROR recvErr = ARSTREAM2_RtpReceiver_UpdateVideoStats(streamReceiver->receiver, vs);
+        if (recvErr != ARSTREAM2_OK)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "ARSTREAM2_RtpReceiver_UpdateVideoStats() failed (%d)", recvErr);
+        }
+        ARSTREAM2_StreamStats_VideoStatsFileWrite(&streamReceiver->videoStatsCtx, vs);
+    }
+
+    /* timestamps and metadata */
+    memset(auTimestamps, 0, sizeof(*auTimestamps));
+    memset(auMetadata, 0, sizeof(*auMetadata));
+    auTimestamps->auNtpTimestamp = au->ntpTimestamp;
+    auTimestamps->auNtpTimestampRaw = au->ntpTimestampRaw;
+    auTimestamps->auNtpTimestampLocal = au->ntpTimestampLocal;
+    auMetadata->isComplete = au->isComplete;
+    auMetadata->hasErrors = au->hasErrors;
+    auMetadata->isRef = au->isRef;
+    auMetadata->auMetadata = (au->metadataSize > 0) ? au->buffer->metadataBuffer : NULL;
+    auMetadata->auMetadataSize = au->metadataSize;
+    auMetadata->auUserData = (au->userDataSize > 0) ? au->buffer->userDataBuffer : NULL;
+    auMetadata->auUserDataSize = au->userDataSize;
+    auMetadata->mbWidth = streamReceiver->appOutput.mbWidth;
+    auMetadata->mbHeight = streamReceiver->appOutput.mbHeight;
+    auMetadata->mbStatus = (au->mbStatusAvailable) ? au->buffer->mbStatusBuffer : NULL;
+    if (au->videoStatsAvailable)
+    {
+        /* Map the video stats */
+        ARSTREAM2_H264_VideoStats_t *vs = (ARSTREAM2_H264_VideoStats_t*)au->buffer->videoStatsBuffer;
+        ARSTREAM2_StreamStats_VideoStats_t *vsOut = &streamReceiver->appOutput.videoStats;
+        uint32_t i, j;
+        vsOut->timestamp = vs->timestamp;
+        vsOut->rssi = vs->rssi;
+        vsOut->totalFrameCount = vs->totalFrameCount;
+        vsOut->outputFrameCount = vs->outputFrameCount;
+        vsOut->erroredOutputFrameCount = vs->erroredOutputFrameCount;
+        vsOut->missedFrameCount = vs->missedFrameCount;
+        vsOut->discardedFrameCount = vs->discardedFrameCount;
+        vsOut->timestampDeltaIntegral = vs->timestampDeltaIntegral;
+        vsOut->timestampDeltaIntegralSq = vs->timestampDeltaIntegralSq;
+        vsOut->timingErrorIntegral = vs->timingErrorIntegral;
+        vsOut->timingErrorIntegralSq = vs->timingErrorIntegralSq;
+        vsOut->estimatedLatencyIntegral = vs->estimatedLatencyIntegral;
+        vsOut->estimatedLatencyIntegralSq = vs->estimatedLatencyIntegralSq;
+        vsOut->erroredSecondCount = vs->erroredSecondCount;
+        vsOut->mbStatusZoneCount = vs->mbStatusZoneCount;
+        vsOut->mbStatusClassCount = vs->mbStatusClassCount;
+        if (vs->mbStatusZoneCount == ARSTREAM2_H264_MB_STATUS_ZONE_COUNT)
+        {
+            if (vsOut->erroredSecondCountByZone)
+            {
+                for (i = 0; i < vs->mbStatusZoneCount; i++)
+                {
+                    vsOut->erroredSecondCountByZone[i] = vs->erroredSecondCountByZone[i];
+                }
+            }
+            if (vs->mbStatusClassCount == ARSTREAM2_H264_MB_STATUS_CLASS_COUNT)
+            {
+                if (vsOut->macroblockStatus)
+                {
+                    for (j = 0; j < vs->mbStatusClassCount; j++)
+                    {
+                        for (i = 0; i < vs->mbStatusZoneCount; i++)
+                        {
+                            vsOut->macroblockStatus[j * vs->mbStatusZoneCount + i] = vs->macroblockStatus[j][i];
+                        }
+                    }
+                }
+            }
+        }
+        auMetadata->videoStats = vsOut;
+    }
+    else
+    {
+        auMetadata->videoStats = NULL;
+    }
+    auMetadata->debugString = NULL; //TODO
+}
+
+
+static int ARSTREAM2_StreamReceiver_AppOutputAuView(ARSTREAM2_StreamReceiver_t *streamReceiver, ARSTREAM2_H264_AuFifoItem_t *auItem)
+{
+    ARSTREAM2_H264_AccessUnit_t *au = &auItem->au;
+    ARSTREAM2_H264_NaluFifoItem_t *naluItem;
+    eARSTREAM2_ERROR cbRet = ARSTREAM2_ERROR_INVALID_STATE;
+    eARSTREAM2_STREAM_RECEIVER_AU_SYNC_TYPE auSyncType;
+    ARSTREAM2_StreamReceiver_AuReadyCallbackTimestamps_t auTimestamps;
+    ARSTREAM2_StreamReceiver_AuReadyCallbackMetadata_t auMetadata;
+    unsigned int auSize = 0;
+    int naluCount = 0;
+    struct timespec t1;
+    uint64_t curTime;
+
+    /* reference the NAL units in place; the buffer is shared with the recorder so the start codes are left untouched */
+    for (naluItem = au->naluHead; (naluItem) && (naluCount < (int)au->naluPoolSize); naluItem = naluItem->next)
+    {
+        /* filter out unwanted NAL units */
+        if ((streamReceiver->appOutput.filterOutSpsPps) && ((naluItem->nalu.naluType == ARSTREAM2_H264_NALU_TYPE_SPS) || (naluItem->nalu.naluType == ARSTREAM2_H264_NALU_TYPE_PPS)))
+        {
+            continue;
+        }
+        if ((streamReceiver->appOutput.filterOutSei) && (naluItem->nalu.naluType == ARSTREAM2_H264_NALU_TYPE_SEI))
+        {
+            continue;
+        }
+
+        au->naluIov[naluCount].iov_base = naluItem->nalu.nalu;
+        au->naluIov[naluCount].iov_len = naluItem->nalu.naluSize;
+        auSize += naluItem->nalu.naluSize;
+        naluCount++;
+    }
+
+    ARSAL_Mutex_Lock(&(streamReceiver->appOutput.callbackMutex));
+    streamReceiver->appOutput.callbackInProgress = 1;
+    ARSAL_Time_GetTime(&t1);
+    curTime = (uint64_t)t1.tv_sec * 1000000 + (uint64_t)t1.tv_nsec / 1000;
+    ARSTREAM2_StreamReceiver_AppOutputAuInfo(streamReceiver, au, curTime, &auSyncType, &auTimestamps, &auMetadata);
+
+    if (streamReceiver->appOutput.auViewReadyCallback)
+    {
+        /* call the auViewReadyCallback */
+        ARSAL_Mutex_Unlock(&(streamReceiver->appOutput.callbackMutex));
+
+        cbRet = streamReceiver->appOutput.auViewReadyCallback((ARSTREAM2_StreamReceiver_AuView_Handle)auItem, au->naluIov, naluCount, (int)auSize,
+                                                              &auTimestamps, auSyncType, &auMetadata,
+                                                              streamReceiver->appOutput.auViewReadyCallbackUserPtr);
+
+        ARSAL_Mutex_Lock(&(streamReceiver->appOutput.callbackMutex));
+    }
+    streamReceiver->appOutput.callbackInProgress = 0;
+    ARSAL_Mutex_Unlock(&(streamReceiver->appOutput.callbackMutex));
+    ARSAL_Cond_Signal(&(streamReceiver->appOutput.callbackCond));
+
+    streamReceiver->lastAuOutputTimestamp = curTime;
+
+    if (cbRet != ARSTREAM2_OK)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_WARNING, ARSTREAM2_STREAM_RECEIVER_TAG, "auViewReadyCallback failed: %s", ARSTREAM2_Error_ToString(cbRet));
+        if (cbRet == ARSTREAM2_ERROR_RESYNC_REQUIRED)
+        {
+            /* schedule gray IDR frame */
+            streamReceiver->appOutput.grayIFramePending = streamReceiver->appOutput.generateGrayIFrame;
+        }
+        return -1;
+    }
+
+    /* the application now holds the access unit */
+    return 0;
+}
+
+
 void* ARSTREAM2_StreamReceiver_RunAppOutputThread(void *streamReceiverHandle)
 {
     ARSTREAM2_StreamReceiver_t* streamReceiver = (ARSTREAM2_StreamReceiver_t*)streamReceiverHandle;
-    int shouldStop, running, ret;
+    int shouldStop, running, zeroCopy, ret;
     struct timespec t1;
     uint64_t curTime;
 
@@ -1338,6 +1621,7 @@ void* ARSTREAM2_StreamReceiver_RunAppOutputThread(void *streamReceiverHandle)
     ARSAL_Mutex_Lock(&(streamReceiver->appOutput.threadMutex));
     shouldStop = streamReceiver->appOutput.threadShouldStop;
     running = streamReceiver->appOutput.running;
+    zeroCopy = streamReceiver->appOutput.zeroCopy;
     ARSAL_Mutex_Unlock(&(streamReceiver->appOutput.threadMutex));
 
     while (shouldStop == 0)
@@ -1358,6 +1642,7 @@ void* ARSTREAM2_StreamReceiver_RunAppOutputThread(void *streamReceiverHandle)
             ARSTREAM2_H264_AccessUnit_t *au = &auItem->au;
             ARSTREAM2_H264_NaluFifoItem_t *naluItem;
             unsigned int auSize = 0;
+            int auHeld = 0;
 
             if ((streamReceiver->appOutput.mbWidth == 0) || (streamReceiver->appOutput.mbHeight == 0))
             {
@@ -1387,12 +1672,17 @@ void* ARSTREAM2_StreamReceiver_RunAppOutputThread(void *streamReceiverHandle)
                 auSize += naluItem->nalu.naluSize;
             }
 
-            if ((running) && (auSize > 0))
+            if ((running) && (auSize > 0) && (zeroCopy))
+            {
+                auHeld = (ARSTREAM2_StreamReceiver_AppOutputAuView(streamReceiver, auItem) == 0) ? 1 : 0;
+            }
+            else if ((running) && (auSize > 0))
             {
                 eARSTREAM2_ERROR cbRet = ARSTREAM2_OK;
                 uint8_t *auBuffer = NULL;
                 int auBufferSize = 0;
                 void *auBufferUserPtr = NULL;
+                eARSTREAM2_STREAM_RECEIVER_AU_SYNC_TYPE auSyncType;
                 ARSTREAM2_StreamReceiver_AuReadyCallbackTimestamps_t auTimestamps;
                 ARSTREAM2_StreamReceiver_AuReadyCallbackMetadata_t auMetadata;
 
@@ -1454,136 +1744,9 @@ void* ARSTREAM2_StreamReceiver_RunAppOutputThread(void *streamReceiverHandle)
                         }
                     }
 
-                    /* map the access unit sync type */
-                    eARSTREAM2_STREAM_RECEIVER_AU_SYNC_TYPE auSyncType;
-                    switch (au->syncType)
-                    {
-                        default:
-                        case ARSTREAM2_H264_AU_SYNC_TYPE_NONE:
-                            auSyncType = ARSTREAM2_STREAM_RECEIVER_AU_SYNC_TYPE_NONE;
-                            break;
-                        case ARSTREAM2_H264_AU_SYNC_TYPE_IDR:
-                            auSyncType = ARSTREAM2_STREAM_RECEIVER_AU_SYNC_TYPE_IDR;
-                            break;
-                        case ARSTREAM2_H264_AU_SYNC_TYPE_IFRAME:
-                            auSyncType = ARSTREAM2_STREAM_RECEIVER_AU_SYNC_TYPE_IFRAME;
-                            break;
-                        case ARSTREAM2_H264_AU_SYNC_TYPE_PIR_START:
-                            auSyncType = ARSTREAM2_STREAM_RECEIVER_AU_SYNC_TYPE_PIR_START;
-                            break;
-                    }
-
                     ARSAL_Time_GetTime(&t1);
                     curTime = (uint64_t)t1.tv_sec * 1000000 + (uint64_t)t1.tv_nsec / 1000;
-                    if (au->videoStatsAvailable)
-                    {
-                        ARSTREAM2_H264_VideoStats_t *vs = (ARSTREAM2_H264_VideoStats_t*)au->buffer->videoStatsBuffer;
-                        uint32_t outputTimestampDelta = (streamReceiver->lastAuOutputTimestamp)
-                                ? (uint32_t)(curTime - streamReceiver->lastAuOutputTimestamp) : 0;
-                        uint32_t estimatedLatency = ((au->ntpTimestampLocal) && (curTime > au->ntpTimestampLocal))
-                                ? (uint32_t)(curTime - au->ntpTimestampLocal) : 0;
-                        int32_t timingError = ((vs->timestampDelta) && (streamReceiver->lastAuOutputTimestamp))
-                                ? ((int32_t)vs->timestampDelta - (int32_t)outputTimestampDelta) : 0;
-                        vs->timingError = timingError;
-                        streamReceiver->timingErrorIntegral += (timingError < 0) ? (uint32_t)(-timingError) : (uint32_t)timingError;
-                        vs->timingErrorIntegral = streamReceiver->timingErrorIntegral;
-                        streamReceiver->timingErrorIntegralSq += (int64_t)timingError * (int64_t)timingError;
-                        vs->timingErrorIntegralSq = streamReceiver->timingErrorIntegralSq;
-                        vs->estimatedLatency = estimatedLatency;
-                        streamReceiver->estimatedLatencyIntegral += estimatedLatency;
-                        vs->estimatedLatencyIntegral = streamReceiver->estimatedLatencyIntegral;
-                        streamReceiver->estimatedLatencyIntegralSq += (uint64_t)estimatedLatency * (uint64_t)estimatedLatency;
-                        vs->estimatedLatencyIntegralSq = streamReceiver->estimatedLatencyIntegralSq;
-                        vs->timestamp = au->ntpTimestampRaw;
-
-                        /* get the RSSI from the streaming metadata */
-                        //TODO: remove this hack once we have a better way of getting the RSSI
-                        if ((au->metadataSize >= 27) && (ntohs(*((uint16_t*)au->buffer->metadataBuffer)) == 0x5031))
-                        {
-                            vs->rssi = (int8_t)au->buffer->metadataBuffer[26];
-                        }
-                        if ((au->metadataSize >= 55) && (ntohs(*((uint16_t*)au->buffer->metadataBuffer)) == 0x5032))
-                        {
-                            vs->rssi = (int8_t)au->buffer->metadataBuffer[54];
-                        }
-                        streamReceiver->lastKnownRssi = vs->rssi;
-
-                        eARSTREAM2_ERROR recvErr = ARSTREAM2_RtpReceiver_UpdateVideoStats(streamReceiver->receiver, vs);
-                        if (recvErr != ARSTREAM2_OK)
-                        {
-                            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "ARSTREAM2_RtpReceiver_UpdateVideoStats() failed (%d)", recvErr);
-                        }
-                        ARSTREAM2_StreamStats_VideoStatsFileWrite(&streamReceiver->videoStatsCtx, vs);
-                    }
-
-                    /* timestamps and metadata */
-                    memset(&auTimestamps, 0, sizeof(auTimestamps));
-                    memset(&auMetadata, 0, sizeof(auMetadata));
-                    auTimestamps.auNtpTimestamp = au->ntpTimestamp;
-                    auTimestamps.auNtpTimestampRaw = au->ntpTimestampRaw;
-                    auTimestamps.auNtpTimestampLocal = au->ntpTimestampLocal;
-                    auMetadata.isComplete = au->isComplete;
-                    auMetadata.hasErrors = au->hasErrors;
-                    auMetadata.isRef = au->isRef;
-                    auMetadata.auMetadata = (au->metadataSize > 0) ? au->buffer->metadataBuffer : NULL;
-                    auMetadata.auMetadataSize = au->metadataSize;
-                    auMetadata.auUserData = (au->userDataSize > 0) ? au->buffer->userDataBuffer : NULL;
-                    auMetadata.auUserDataSize = au->userDataSize;
-                    auMetadata.mbWidth = streamReceiver->appOutput.mbWidth;
-                    auMetadata.mbHeight = streamReceiver->appOutput.mbHeight;
-                    auMetadata.mbStatus = (au->mbStatusAvailable) ? au->buffer->mbStatusBuffer : NULL;
-                    if (au->videoStatsAvailable)
-                    {
-                        /* Map the video stats */
-                        ARSTREAM2_H264_VideoStats_t *vs = (ARSTREAM2_H264_VideoStats_t*)au->buffer->videoStatsBuffer;
-                        ARSTREAM2_StreamStats_VideoStats_t *vsOut = &streamReceiver->appOutput.videoStats;
-                        uint32_t i, j;
-                        vsOut->timestamp = vs->timestamp;
-                        vsOut->rssi = vs->rssi;
-                        vsOut->totalFrameCount = vs->totalFrameCount;
-                        vsOut->outputFrameCount = vs->outputFrameCount;
-                        vsOut->erroredOutputFrameCount = vs->erroredOutputFrameCount;
-                        vsOut->missedFrameCount = vs->missedFrameCount;
-                        vsOut->discardedFrameCount = vs->discardedFrameCount;
-                        vsOut->timestampDeltaIntegral = vs->timestampDeltaIntegral;
-                        vsOut->timestampDeltaIntegralSq = vs->timestampDeltaIntegralSq;
-                        vsOut->timingErrorIntegral = vs->timingErrorIntegral;
-                        vsOut->timingErrorIntegralSq = vs->timingErrorIntegralSq;
-                        vsOut->estimatedLatencyIntegral = vs->estimatedLatencyIntegral;
-                        vsOut->estimatedLatencyIntegralSq = vs->estimatedLatencyIntegralSq;
-                        vsOut->erroredSecondCount = vs->erroredSecondCount;
-                        vsOut->mbStatusZoneCount = vs->mbStatusZoneCount;
-                        vsOut->mbStatusClassCount = vs->mbStatusClassCount;
-                        if (vs->mbStatusZoneCount == ARSTREAM2_H264_MB_STATUS_ZONE_COUNT)
-                        {
-                            if (vsOut->erroredSecondCountByZone)
-                            {
-                                for (i = 0; i < vs->mbStatusZoneCount; i++)
-                                {
-                                    vsOut->erroredSecondCountByZone[i] = vs->erroredSecondCountByZone[i];
-                                }
-                            }
-                            if (vs->mbStatusClassCount == ARSTREAM2_H264_MB_STATUS_CLASS_COUNT)
-                            {
-                                if (vsOut->macroblockStatus)
-                                {
-                                    for (j = 0; j < vs->mbStatusClassCount; j++)
-                                    {
-                                        for (i = 0; i < vs->mbStatusZoneCount; i++)
-                                        {
-                                            vsOut->macroblockStatus[j * vs->mbStatusZoneCount + i] = vs->macroblockStatus[j][i];
-                                        }
-                                    }
-                                }
-                            }
-                        }
-                        auMetadata.videoStats = vsOut;
-                    }
-                    else
-                    {
-                        auMetadata.videoStats = NULL;
-                    }
-                    auMetadata.debugString = NULL; //TODO
+                    ARSTREAM2_StreamReceiver_AppOutputAuInfo(streamReceiver, au, curTime, &auSyncType, &auTimestamps, &auMetadata);
 
                     if (streamReceiver->appOutput.auReadyCallback)
                     {
@@ -1612,16 +1775,19 @@ void* ARSTREAM2_StreamReceiver_RunAppOutputThread(void *streamReceiverHandle)
                 }
             }
 
-            /* free the access unit */
-            ret = ARSTREAM2_H264_AuFifoUnrefBuffer(&streamReceiver->auFifo, auItem->au.buffer);
-            if (ret != 0)
-            {
-                ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "Failed to unref buffer (%d)", ret);
-            }
-            ret = ARSTREAM2_H264_AuFifoPushFreeItem(&streamReceiver->auFifo, auItem);
-            if (ret != 0)
+            if (!auHeld)
             {
-                ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "Failed to push free item in the AU FIFO (%d)", ret);
+                /* free the access unit */
+                ret = ARSTREAM2_H264_AuFifoUnrefBuffer(&streamReceiver->auFifo, auItem->au.buffer);
+                if (ret != 0)
+                {
+                    ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "Failed to unref buffer (%d)", ret);
+                }
+                ret = ARSTREAM2_H264_AuFifoPushFreeItem(&streamReceiver->auFifo, auItem);
+                if (ret != 0)
+                {
+                    ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "Failed to push free item in the AU FIFO (%d)", ret);
+                }
             }
 
             /* dequeue the next access unit */
@@ -1631,6 +1797,7 @@ void* ARSTREAM2_StreamReceiver_RunAppOutputThread(void *streamReceiverHandle)
         ARSAL_Mutex_Lock(&(streamReceiver->appOutput.threadMutex));
         shouldStop = streamReceiver->appOutput.threadShouldStop;
         running = streamReceiver->appOutput.running;
+        zeroCopy = streamReceiver->appOutput.zeroCopy;
         if (!shouldStop)
         {
             ARSAL_Cond_Wait(&(streamReceiver->appOutput.threadCond), &(streamReceiver->appOutput.threadMutex));
@@ -1645,69 +1812,115 @@ void* ARSTREAM2_StreamReceiver_RunAppOutputThread(void *streamReceiverHandle)
 }
 
 
-void* ARSTREAM2_StreamReceiver_RunNetworkThread(void *streamReceiverHandle)
+static void ARSTREAM2_StreamReceiver_ResenderSignal(ARSTREAM2_RtpResender_t *resender)
 {
-    ARSTREAM2_StreamReceiver_t *streamReceiver = (ARSTREAM2_StreamReceiver_t*)streamReceiverHandle;
-    ARSTREAM2_RtpResender_t *resender;
-    int shouldStop, selectRet = 0;
-    fd_set readSet, writeSet, exceptSet;
-    fd_set *pReadSet, *pWriteSet, *pExceptSet;
-    int maxFd = 0, _maxFd = 0;
-    struct timeval tv;
-    uint32_t nextTimeout = 0, _timeout = 0;
-    eARSTREAM2_ERROR err;
+    ssize_t err;
 
-    if (!streamReceiverHandle)
+    /* Wakeups are merged: nothing to do if a signal is already pending */
+    if (__atomic_exchange_n(&resender->signalPending, 1, __ATOMIC_SEQ_CST) != 0)
     {
-        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "Invalid handle");
-        return NULL;
+        return;
     }
 
-    ARSAL_PRINT(ARSAL_PRINT_INFO, ARSTREAM2_STREAM_RECEIVER_TAG, "Receiver thread running");
-    ARSAL_Mutex_Lock(&(streamReceiver->threadMutex));
-    streamReceiver->threadStarted = 1;
-    shouldStop = streamReceiver->threadShouldStop;
-    ARSAL_Mutex_Unlock(&(streamReceiver->threadMutex));
+    if (resender->signalPipe[1] != -1)
+    {
+        char * buff = "x";
+        while (((err = write(resender->signalPipe[1], buff, 1)) == -1) && (errno == EINTR));
+    }
+}
 
-    FD_ZERO(&readSet);
-    FD_ZERO(&writeSet);
-    FD_ZERO(&exceptSet);
-    pReadSet = &readSet;
-    pWriteSet = &writeSet;
-    pExceptSet = &exceptSet;
 
-    err = ARSTREAM2_RtpReceiver_GetSelectParams(streamReceiver->receiver, &pReadSet, &pWriteSet, &pExceptSet, &maxFd, &nextTimeout);
-    if (err != ARSTREAM2_OK)
+/* WARNING: must be called with the resendMutex held */
+static void ARSTREAM2_StreamReceiver_ResenderHandoff(ARSTREAM2_StreamReceiver_t *streamReceiver, ARSTREAM2_RtpResender_t *resender)
+{
+    ARSTREAM2_RTP_PacketFifoItem_t *item;
+    int count = 0;
+
+    while ((item = ARSTREAM2_RTP_PacketFifoDequeueItem(&resender->packetFifoQueue)) != NULL)
     {
-        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "ARSTREAM2_RtpReceiver_GetSelectParams() failed (%d)", err);
-        return (void *)0;
+        /* The buffer reference held by the item is transferred to the resender thread */
+        if (ARSTREAM2_RTP_PacketRingPush(&resender->ring, &item->packet) == 0)
+        {
+            count++;
+        }
+        else
+        {
+            resender->handoffDropCount++;
+            ARSTREAM2_RTP_PacketFifoUnrefBuffer(&streamReceiver->packetFifo, item->packet.buffer);
+        }
+        ARSTREAM2_RTP_PacketFifoPushFreeItem(&streamReceiver->packetFifo, item);
     }
 
-    ARSAL_Mutex_Lock(&(streamReceiver->resendMutex));
-    for (resender = streamReceiver->resender; resender; resender = resender->next)
+    if (count > 0)
     {
-        err = ARSTREAM2_RtpSender_GetSelectParams(resender->sender, &pReadSet, &pWriteSet, &pExceptSet, &_maxFd, &_timeout);
-        if (err != ARSTREAM2_OK)
+        ARSTREAM2_StreamReceiver_ResenderSignal(resender);
+    }
+}
+
+
+/* Resender thread side: move the packets handed over by the network thread to the sender queue */
+static void ARSTREAM2_StreamReceiver_ResenderDrainRing(ARSTREAM2_RtpResender_t *resender)
+{
+    ARSTREAM2_RTP_Packet_t packet;
+    ARSTREAM2_RTP_PacketFifoItem_t *item;
+
+    while (ARSTREAM2_RTP_PacketRingPop(&resender->ring, &packet) == 0)
+    {
+        item = ARSTREAM2_RTP_PacketFifoPopFreeItem(&resender->workerPacketFifo);
+        if (!item)
         {
-            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "ARSTREAM2_RtpReceiver_GetSelectParams() failed (%d)", err);
-            return (void *)0;
+            /* The buffer is given back to the receiver FIFO */
+            ARSTREAM2_RTP_PacketFifoUnrefBuffer(&resender->workerPacketFifo, packet.buffer);
+            continue;
+        }
+        ARSTREAM2_RTP_PacketCopy(&item->packet, &packet);
+        if (ARSTREAM2_RTP_PacketFifoEnqueueItem(&resender->workerPacketFifoQueue, item) != 0)
+        {
+            ARSTREAM2_RTP_PacketFifoUnrefBuffer(&resender->workerPacketFifo, packet.buffer);
+            ARSTREAM2_RTP_PacketFifoPushFreeItem(&resender->workerPacketFifo, item);
         }
-        if (_timeout < nextTimeout) nextTimeout = _timeout;
-        if (_maxFd > maxFd) maxFd = _maxFd;
     }
-    ARSAL_Mutex_Unlock(&(streamReceiver->resendMutex));
+}
 
-    if (pReadSet)
-        FD_SET(streamReceiver->signalPipe[0], pReadSet);
-    if (pExceptSet)
-        FD_SET(streamReceiver->signalPipe[0], pExceptSet);
-    if (streamReceiver->signalPipe[0] > maxFd) maxFd = streamReceiver->signalPipe[0];
-    maxFd++;
-    tv.tv_sec = 0;
-    tv.tv_usec = nextTimeout;
 
-    while (shouldStop == 0)
+static void* ARSTREAM2_StreamReceiver_RunResenderThread(void *resenderPtr)
+{
+    ARSTREAM2_RtpResender_t *resender = (ARSTREAM2_RtpResender_t*)resenderPtr;
+    int selectRet, maxFd;
+    fd_set readSet, writeSet, exceptSet;
+    fd_set *pReadSet, *pWriteSet, *pExceptSet;
+    struct timeval tv;
+    uint32_t nextTimeout;
+    eARSTREAM2_ERROR err;
+
+    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARSTREAM2_STREAM_RECEIVER_TAG, "Resender thread running");
+
+    while (!__atomic_load_n(&resender->threadShouldStop, __ATOMIC_ACQUIRE))
     {
+        FD_ZERO(&readSet);
+        FD_ZERO(&writeSet);
+        FD_ZERO(&exceptSet);
+        pReadSet = &readSet;
+        pWriteSet = &writeSet;
+        pExceptSet = &exceptSet;
+        maxFd = 0;
+        nextTimeout = 0;
+        selectRet = 0;
+
+        err = ARSTREAM2_RtpSender_GetSelectParams(resender->sender, &pReadSet, &pWriteSet, &pExceptSet, &maxFd, &nextTimeout);
+        if (err != ARSTREAM2_OK)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "ARSTREAM2_RtpSender_GetSelectParams() failed (%d)", err);
+            break;
+        }
+
+        if (pReadSet)
+            FD_SET(resender->signalPipe[0], pReadSet);
+        if (resender->signalPipe[0] > maxFd) maxFd = resender->signalPipe[0];
+        maxFd++;
+        tv.tv_sec = 0;
+        tv.tv_usec = nextTimeout;
+
         if ((pReadSet) && (pWriteSet) && (pExceptSet))
         {
             while (((selectRet = select(maxFd, pReadSet, pWriteSet, pExceptSet, &tv)) == -1) && (errno == EINTR));
@@ -1718,56 +1931,232 @@ void* ARSTREAM2_StreamReceiver_RunNetworkThread(void *streamReceiverHandle)
             }
         }
 
-        ARSAL_Mutex_Lock(&(streamReceiver->resendMutex));
+        if ((pReadSet) && (selectRet > 0) && (FD_ISSET(resender->signalPipe[0], pReadSet)))
+        {
+            /* Dump bytes (so it won't be ready next time) */
+            char dump[10];
+            int readRet;
+            while (((readRet = read(resender->signalPipe[0], &dump, 10)) == -1) && (errno == EINTR));
+        }
+
+        /* Clear the pending signal before draining so that no handoff is missed */
+        __atomic_exchange_n(&resender->signalPending, 0, __ATOMIC_SEQ_CST);
+        ARSTREAM2_StreamReceiver_ResenderDrainRing(resender);
 
-        err = ARSTREAM2_RtpReceiver_ProcessRtcp(streamReceiver->receiver, selectRet, pReadSet, pWriteSet, pExceptSet, &shouldStop);
+        err = ARSTREAM2_RtpSender_ProcessRtcp(resender->sender, selectRet, pReadSet, pWriteSet, pExceptSet);
         if (err != ARSTREAM2_OK)
         {
-            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "ARSTREAM2_RtpReceiver_ProcessRtcp() failed (%d)", err);
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "ARSTREAM2_RtpSender_ProcessRtcp() failed (%d)", err);
         }
-        err = ARSTREAM2_RtpReceiver_ProcessRtp(streamReceiver->receiver, selectRet, pReadSet, pWriteSet, pExceptSet, &shouldStop,
-                                               streamReceiver->resendQueue, streamReceiver->resendTimeout, streamReceiver->resendCount);
+        err = ARSTREAM2_RtpSender_ProcessRtp(resender->sender, selectRet, pReadSet, pWriteSet, pExceptSet);
         if (err != ARSTREAM2_OK)
         {
-            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "ARSTREAM2_RtpReceiver_ProcessRtp() failed (%d)", err);
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "ARSTREAM2_RtpSender_ProcessRtp() failed (%d)", err);
         }
+    }
 
-        for (resender = streamReceiver->resender; resender; resender = resender->next)
-        {
-            err = ARSTREAM2_RtpSender_ProcessRtcp(resender->sender, selectRet, pReadSet, pWriteSet, pExceptSet);
-            if (err != ARSTREAM2_OK)
-            {
-                ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "ARSTREAM2_RtpSender_ProcessRtcp() failed (%d)", err);
-            }
-            err = ARSTREAM2_RtpSender_ProcessRtp(resender->sender, selectRet, pReadSet, pWriteSet, pExceptSet);
-            if (err != ARSTREAM2_OK)
-            {
-                ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "ARSTREAM2_RtpSender_ProcessRtp() failed (%d)", err);
-            }
-        }
+    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARSTREAM2_STREAM_RECEIVER_TAG, "Resender thread ended");
 
-        ARSAL_Mutex_Unlock(&(streamReceiver->resendMutex));
+    return (void*)0;
+}
 
-        if ((pReadSet) && ((selectRet >= 0) && (FD_ISSET(streamReceiver->signalPipe[0], pReadSet))))
+
+/* Stop the resender thread if any and free the resender resources; the resender must not be in the list anymore
+   WARNING: must be called with the resendMutex held, or from ARSTREAM2_StreamReceiver_Free() */
+static eARSTREAM2_ERROR ARSTREAM2_StreamReceiver_ResenderDelete(ARSTREAM2_StreamReceiver_t *streamReceiver, ARSTREAM2_RtpResender_t *resender)
+{
+    eARSTREAM2_ERROR ret = ARSTREAM2_OK;
+    ARSTREAM2_RTP_Packet_t packet;
+    int err;
+
+    if ((resender->useThread) && (resender->thread))
+    {
+        __atomic_store_n(&resender->threadShouldStop, 1, __ATOMIC_RELEASE);
+        ARSTREAM2_StreamReceiver_ResenderSignal(resender);
+        err = ARSAL_Thread_Join(resender->thread, NULL);
+        if (err != 0)
         {
-            /* Dump bytes (so it won't be ready next time) */
-            char dump[10];
-            int readRet;
-            while (((readRet = read(streamReceiver->signalPipe[0], &dump, 10)) == -1) && (errno == EINTR));
-            if (readRet < 0)
-            {
-                ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "Failed to read from pipe (%d): %s", errno, strerror(errno));
-            }
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "ARSAL_Thread_Join() failed (%d)", err);
         }
-
-        if (!shouldStop)
+        err = ARSAL_Thread_Destroy(&resender->thread);
+        if (err != 0)
         {
-            ARSAL_Mutex_Lock(&(streamReceiver->threadMutex));
-            shouldStop = streamReceiver->threadShouldStop;
-            ARSAL_Mutex_Unlock(&(streamReceiver->threadMutex));
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "ARSAL_Thread_Destroy() failed (%d)", err);
         }
-
-        if (!shouldStop)
+        resender->thread = NULL;
+        if (resender->handoffDropCount > 0)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_INFO, ARSTREAM2_STREAM_RECEIVER_TAG, "Resender handoff dropped packets: %u", resender->handoffDropCount);
+        }
+    }
+
+    if (resender->sender)
+    {
+        ret = ARSTREAM2_RtpSender_ProcessEnd(resender->sender, 1);
+        if (ret != ARSTREAM2_OK)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "ARSTREAM2_RtpSender_ProcessEnd() failed (%d)", ret);
+        }
+        ret = ARSTREAM2_RtpSender_Delete(&resender->sender);
+        if (ret != ARSTREAM2_OK)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "Unable to delete sender: %s", ARSTREAM2_Error_ToString(ret));
+        }
+    }
+
+    if (resender->useThread)
+    {
+        /* Give the buffers still in flight back to the receiver FIFO */
+        if (resender->ring.packet)
+        {
+            while (ARSTREAM2_RTP_PacketRingPop(&resender->ring, &packet) == 0)
+            {
+                ARSTREAM2_RTP_PacketFifoUnrefBuffer(&resender->workerPacketFifo, packet.buffer);
+            }
+            ARSTREAM2_RTP_PacketRingFree(&resender->ring);
+        }
+        if (resender->workerPacketFifo.itemPool)
+        {
+            ARSTREAM2_RTP_PacketFifoRemoveQueue(&resender->workerPacketFifo, &resender->workerPacketFifoQueue);
+            ARSTREAM2_RTP_PacketFifoFree(&resender->workerPacketFifo);
+        }
+        ARSTREAM2_RTP_Receiver_PacketFifoFlushQueue(&streamReceiver->packetFifo, &resender->packetFifoQueue);
+        if (resender->signalPipe[0] != -1)
+        {
+            while (((err = close(resender->signalPipe[0])) == -1) && (errno == EINTR));
+            resender->signalPipe[0] = -1;
+        }
+        if (resender->signalPipe[1] != -1)
+        {
+            while (((err = close(resender->signalPipe[1])) == -1) && (errno == EINTR));
+            resender->signalPipe[1] = -1;
+        }
+    }
+
+    return ret;
+}
+
+
+static void ARSTREAM2_StreamReceiver_RunNetworkLoopSelect(ARSTREAM2_StreamReceiver_t *streamReceiver, int *shouldStop)
+{
+    ARSTREAM2_RtpResender_t *resender;
+    int selectRet = 0;
+    fd_set readSet, writeSet, exceptSet;
+    fd_set *pReadSet, *pWriteSet, *pExceptSet;
+    int maxFd = 0, _maxFd = 0;
+    struct timeval tv;
+    uint32_t nextTimeout = 0, _timeout = 0;
+    eARSTREAM2_ERROR err;
+
+    FD_ZERO(&readSet);
+    FD_ZERO(&writeSet);
+    FD_ZERO(&exceptSet);
+    pReadSet = &readSet;
+    pWriteSet = &writeSet;
+    pExceptSet = &exceptSet;
+
+    err = ARSTREAM2_RtpReceiver_GetSelectParams(streamReceiver->receiver, &pReadSet, &pWriteSet, &pExceptSet, &maxFd, &nextTimeout);
+    if (err != ARSTREAM2_OK)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "ARSTREAM2_RtpReceiver_GetSelectParams() failed (%d)", err);
+        return;
+    }
+
+    ARSAL_Mutex_Lock(&(streamReceiver->resendMutex));
+    for (resender = streamReceiver->resender; resender; resender = resender->next)
+    {
+        if (resender->useThread)
+        {
+            continue;
+        }
+        err = ARSTREAM2_RtpSender_GetSelectParams(resender->sender, &pReadSet, &pWriteSet, &pExceptSet, &_maxFd, &_timeout);
+        if (err != ARSTREAM2_OK)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "ARSTREAM2_RtpReceiver_GetSelectParams() failed (%d)", err);
+            ARSAL_Mutex_Unlock(&(streamReceiver->resendMutex));
+            return;
+        }
+        if (_timeout < nextTimeout) nextTimeout = _timeout;
+        if (_maxFd > maxFd) maxFd = _maxFd;
+    }
+    ARSAL_Mutex_Unlock(&(streamReceiver->resendMutex));
+
+    if (pReadSet)
+        FD_SET(streamReceiver->signalPipe[0], pReadSet);
+    if (pExceptSet)
+        FD_SET(streamReceiver->signalPipe[0], pExceptSet);
+    if (streamReceiver->signalPipe[0] > maxFd) maxFd = streamReceiver->signalPipe[0];
+    maxFd++;
+    tv.tv_sec = 0;
+    tv.tv_usec = nextTimeout;
+
+    while (*shouldStop == 0)
+    {
+        if ((pReadSet) && (pWriteSet) && (pExceptSet))
+        {
+            while (((selectRet = select(maxFd, pReadSet, pWriteSet, pExceptSet, &tv)) == -1) && (errno == EINTR));
+
+            if (selectRet < 0)
+            {
+                ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "Select error (%d): %s", errno, strerror(errno));
+            }
+        }
+
+        ARSAL_Mutex_Lock(&(streamReceiver->resendMutex));
+
+        err = ARSTREAM2_RtpReceiver_ProcessRtcp(streamReceiver->receiver, selectRet, pReadSet, pWriteSet, pExceptSet, shouldStop);
+        if (err != ARSTREAM2_OK)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "ARSTREAM2_RtpReceiver_ProcessRtcp() failed (%d)", err);
+        }
+        err = ARSTREAM2_RtpReceiver_ProcessRtp(streamReceiver->receiver, selectRet, pReadSet, pWriteSet, pExceptSet, shouldStop,
+                                               streamReceiver->resendQueue, streamReceiver->resendTimeout, streamReceiver->resendCount);
+        if (err != ARSTREAM2_OK)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "ARSTREAM2_RtpReceiver_ProcessRtp() failed (%d)", err);
+        }
+
+        for (resender = streamReceiver->resender; resender; resender = resender->next)
+        {
+            if (resender->useThread)
+            {
+                ARSTREAM2_StreamReceiver_ResenderHandoff(streamReceiver, resender);
+                continue;
+            }
+            err = ARSTREAM2_RtpSender_ProcessRtcp(resender->sender, selectRet, pReadSet, pWriteSet, pExceptSet);
+            if (err != ARSTREAM2_OK)
+            {
+                ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "ARSTREAM2_RtpSender_ProcessRtcp() failed (%d)", err);
+            }
+            err = ARSTREAM2_RtpSender_ProcessRtp(resender->sender, selectRet, pReadSet, pWriteSet, pExceptSet);
+            if (err != ARSTREAM2_OK)
+            {
+                ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "ARSTREAM2_RtpSender_ProcessRtp() failed (%d)", err);
+            }
+        }
+
+        ARSAL_Mutex_Unlock(&(streamReceiver->resendMutex));
+
+        if ((pReadSet) && ((selectRet >= 0) && (FD_ISSET(streamReceiver->signalPipe[0], pReadSet))))
+        {
+            /* Dump bytes (so it won't be ready next time) */
+            char dump[10];
+            int readRet;
+            while (((readRet = read(streamReceiver->signalPipe[0], &dump, 10)) == -1) && (errno == EINTR));
+            if (readRet < 0)
+            {
+                ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "Failed to read from pipe (%d): %s", errno, strerror(errno));
+            }
+        }
+
+        if (!*shouldStop)
+        {
+            ARSAL_Mutex_Lock(&(streamReceiver->threadMutex));
+            *shouldStop = streamReceiver->threadShouldStop;
+            ARSAL_Mutex_Unlock(&(streamReceiver->threadMutex));
+        }
+
+        if (!*shouldStop)
         {
             /* Prepare the next select */
             FD_ZERO(&readSet);
@@ -1787,6 +2176,10 @@ void* ARSTREAM2_StreamReceiver_RunNetworkThread(void *streamReceiverHandle)
             ARSAL_Mutex_Lock(&(streamReceiver->resendMutex));
             for (resender = streamReceiver->resender; resender; resender = resender->next)
             {
+                if (resender->useThread)
+                {
+                    continue;
+                }
                 err = ARSTREAM2_RtpSender_GetSelectParams(resender->sender, &pReadSet, &pWriteSet, &pExceptSet, &_maxFd, &_timeout);
                 if (err != ARSTREAM2_OK)
                 {
@@ -1808,47 +2201,323 @@ void* ARSTREAM2_StreamReceiver_RunNetworkThread(void *streamReceiverHandle)
             tv.tv_usec = nextTimeout;
         }
     }
+}
 
-    ARSAL_Mutex_Lock(&(streamReceiver->threadMutex));
-    streamReceiver->threadStarted = 0;
-    ARSAL_Mutex_Unlock(&(streamReceiver->threadMutex));
 
-    err = ARSTREAM2_RtpReceiver_ProcessEnd(streamReceiver->receiver, 0);
-    if (err != ARSTREAM2_OK)
+#ifdef HAS_EPOLL
+
+static int ARSTREAM2_StreamReceiver_EpollSetTimer(int timerFd, uint32_t timeout)
+{
+    struct itimerspec its;
+
+    /* Periodic timer: it only needs to be re-armed when the timeout value changes */
+    if (timeout < ARSTREAM2_STREAM_RECEIVER_EPOLL_MIN_TIMEOUT_US) timeout = ARSTREAM2_STREAM_RECEIVER_EPOLL_MIN_TIMEOUT_US;
+    its.it_value.tv_sec = timeout / 1000000;
+    its.it_value.tv_nsec = (timeout % 1000000) * 1000;
+    its.it_interval = its.it_value;
+
+    return timerfd_settime(timerFd, 0, &its, NULL);
+}
+
+
+/* WARNING: must be called with the resendMutex held */
+static void ARSTREAM2_StreamReceiver_EpollUpdateResenders(ARSTREAM2_StreamReceiver_t *streamReceiver, int epollFd, uint32_t *nextTimeout)
+{
+    ARSTREAM2_RtpResender_t *resender;
+    struct epoll_event ev;
+    int streamFd = -1, controlFd = -1, writePending = 0;
+    uint32_t _timeout = 0;
+    eARSTREAM2_ERROR err;
+
+    for (resender = streamReceiver->resender; resender; resender = resender->next)
     {
-        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "ARSTREAM2_RtpReceiver_ProcessEnd() failed (%d)", err);
+        if (resender->useThread)
+        {
+            continue;
+        }
+        err = ARSTREAM2_RtpSender_GetPollParams(resender->sender, &streamFd, &controlFd, &writePending, &_timeout);
+        if (err != ARSTREAM2_OK)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "ARSTREAM2_RtpSender_GetPollParams() failed (%d)", err);
+            continue;
+        }
+        if (_timeout < *nextTimeout) *nextTimeout = _timeout;
+
+        if (!resender->pollRegistered)
+        {
+            /* New resender: register its sockets once (they are automatically
+             * removed from the epoll set when closed on resender stop) */
+            memset(&ev, 0, sizeof(ev));
+            ev.events = EPOLLIN | EPOLLET;
+            ev.data.fd = controlFd;
+            if (epoll_ctl(epollFd, EPOLL_CTL_ADD, controlFd, &ev) != 0)
+            {
+                ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "Failed to add resender control socket to epoll (%d): %s", errno, strerror(errno));
+            }
+            ev.events = ((writePending) ? EPOLLOUT : 0) | EPOLLET;
+            ev.data.fd = streamFd;
+            if (epoll_ctl(epollFd, EPOLL_CTL_ADD, streamFd, &ev) != 0)
+            {
+                ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "Failed to add resender stream socket to epoll (%d): %s", errno, strerror(errno));
+            }
+            resender->pollRegistered = 1;
+            resender->pollWritePending = writePending;
+        }
+        else if (writePending != resender->pollWritePending)
+        {
+            /* Only watch for writability while packets are pending */
+            memset(&ev, 0, sizeof(ev));
+            ev.events = ((writePending) ? EPOLLOUT : 0) | EPOLLET;
+            ev.data.fd = streamFd;
+            if (epoll_ctl(epollFd, EPOLL_CTL_MOD, streamFd, &ev) != 0)
+            {
+                ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "Failed to modify resender stream socket in epoll (%d): %s", errno, strerror(errno));
+            }
+            resender->pollWritePending = writePending;
+        }
     }
+}
 
-    ARSAL_PRINT(ARSAL_PRINT_INFO, ARSTREAM2_STREAM_RECEIVER_TAG, "Receiver thread has ended");
 
-    return (void*)0;
+static int ARSTREAM2_StreamReceiver_RunNetworkLoopEpoll(ARSTREAM2_StreamReceiver_t *streamReceiver, int *shouldStop)
+{
+    ARSTREAM2_RtpResender_t *resender;
+    struct epoll_event ev, events[ARSTREAM2_STREAM_RECEIVER_EPOLL_MAX_EVENTS];
+    int epollFd = -1, timerFd = -1, streamFd = -1, controlFd = -1;
+    int streamReadPending = 0, eventCount, selectRet, i, ret = 0;
+    fd_set readSet, writeSet, exceptSet;
+    uint32_t nextTimeout = 0, armedTimeout = 0;
+    eARSTREAM2_ERROR err;
+
+    err = ARSTREAM2_RtpReceiver_GetPollParams(streamReceiver->receiver, &streamFd, &controlFd, NULL, NULL);
+    if ((err != ARSTREAM2_OK) || (streamFd < 0) || (controlFd < 0))
+    {
+        /* No sockets (mux): use the select loop */
+        return -1;
+    }
+
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd < 0)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "epoll_create1() failed (%d): %s", errno, strerror(errno));
+        ret = -1;
+    }
+
+    if (ret == 0)
+    {
+        timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        if (timerFd < 0)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "timerfd_create() failed (%d): %s", errno, strerror(errno));
+            ret = -1;
+        }
+    }
+
+    if (ret == 0)
+    {
+        /* Sockets are registered once, edge-triggered; the sockets are always drained
+         * by ARSTREAM2_RtpReceiver_ProcessRtp() and ARSTREAM2_RtpReceiver_ProcessRtcp() */
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN | EPOLLET;
+        ev.data.fd = streamFd;
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, streamFd, &ev) != 0) ret = -1;
+        ev.data.fd = controlFd;
+        if ((ret == 0) && (epoll_ctl(epollFd, EPOLL_CTL_ADD, controlFd, &ev) != 0)) ret = -1;
+        ev.data.fd = timerFd;
+        if ((ret == 0) && (epoll_ctl(epollFd, EPOLL_CTL_ADD, timerFd, &ev) != 0)) ret = -1;
+        ev.events = EPOLLIN;
+        ev.data.fd = streamReceiver->signalPipe[0];
+        if ((ret == 0) && (epoll_ctl(epollFd, EPOLL_CTL_ADD, streamReceiver->signalPipe[0], &ev) != 0)) ret = -1;
+        if (ret != 0)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "epoll_ctl() failed (%d): %s", errno, strerror(errno));
+        }
+    }
+
+    if (ret != 0)
+    {
+        if (timerFd >= 0) close(timerFd);
+        if (epollFd >= 0) close(epollFd);
+        return ret;
+    }
+
+    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARSTREAM2_STREAM_RECEIVER_TAG, "Using epoll network loop");
+
+    while (*shouldStop == 0)
+    {
+        /* Update the timer and the resenders registration */
+        err = ARSTREAM2_RtpReceiver_GetPollParams(streamReceiver->receiver, NULL, NULL, &streamReadPending, &nextTimeout);
+        if (err != ARSTREAM2_OK)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "ARSTREAM2_RtpReceiver_GetPollParams() failed (%d)", err);
+            break;
+        }
+        ARSAL_Mutex_Lock(&(streamReceiver->resendMutex));
+        ARSTREAM2_StreamReceiver_EpollUpdateResenders(streamReceiver, epollFd, &nextTimeout);
+        ARSAL_Mutex_Unlock(&(streamReceiver->resendMutex));
+        if (nextTimeout != armedTimeout)
+        {
+            if (ARSTREAM2_StreamReceiver_EpollSetTimer(timerFd, nextTimeout) != 0)
+            {
+                ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "timerfd_settime() failed (%d): %s", errno, strerror(errno));
+            }
+            armedTimeout = nextTimeout;
+        }
+
+        while (((eventCount = epoll_wait(epollFd, events, ARSTREAM2_STREAM_RECEIVER_EPOLL_MAX_EVENTS, (streamReadPending) ? 0 : -1)) == -1) && (errno == EINTR));
+        if (eventCount < 0)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "epoll_wait error (%d): %s", errno, strerror(errno));
+            break;
+        }
+
+        /* Translate the events to fd_sets for the Process functions */
+        FD_ZERO(&readSet);
+        FD_ZERO(&writeSet);
+        FD_ZERO(&exceptSet);
+        for (i = 0; i < eventCount; i++)
+        {
+            int fd = events[i].data.fd;
+            if (fd == timerFd)
+            {
+                uint64_t expirations;
+                int readRet;
+                while (((readRet = read(timerFd, &expirations, sizeof(expirations))) == -1) && (errno == EINTR));
+            }
+            else if (fd == streamReceiver->signalPipe[0])
+            {
+                /* Dump bytes (so it won't be ready next time) */
+                char dump[10];
+                int readRet;
+                while (((readRet = read(streamReceiver->signalPipe[0], &dump, 10)) == -1) && (errno == EINTR));
+                if (readRet < 0)
+                {
+                    ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "Failed to read from pipe (%d): %s", errno, strerror(errno));
+                }
+            }
+            else
+            {
+                /* Socket errors are read like with select() */
+                if (events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP)) FD_SET(fd, &readSet);
+                if (events[i].events & EPOLLOUT) FD_SET(fd, &writeSet);
+                if (events[i].events & EPOLLPRI) FD_SET(fd, &exceptSet);
+            }
+        }
+        selectRet = eventCount;
+
+        ARSAL_Mutex_Lock(&(streamReceiver->resendMutex));
+
+        err = ARSTREAM2_RtpReceiver_ProcessRtcp(streamReceiver->receiver, selectRet, &readSet, &writeSet, &exceptSet, shouldStop);
+        if (err != ARSTREAM2_OK)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "ARSTREAM2_RtpReceiver_ProcessRtcp() failed (%d)", err);
+        }
+        err = ARSTREAM2_RtpReceiver_ProcessRtp(streamReceiver->receiver, selectRet, &readSet, &writeSet, &exceptSet, shouldStop,
+                                               streamReceiver->resendQueue, streamReceiver->resendTimeout, streamReceiver->resendCount);
+        if (err != ARSTREAM2_OK)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "ARSTREAM2_RtpReceiver_ProcessRtp() failed (%d)", err);
+        }
+
+        for (resender = streamReceiver->resender; resender; resender = resender->next)
+        {
+            if (resender->useThread)
+            {
+                ARSTREAM2_StreamReceiver_ResenderHandoff(streamReceiver, resender);
+                continue;
+            }
+            err = ARSTREAM2_RtpSender_ProcessRtcp(resender->sender, selectRet, &readSet, &writeSet, &exceptSet);
+            if (err != ARSTREAM2_OK)
+            {
+                ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "ARSTREAM2_RtpSender_ProcessRtcp() failed (%d)", err);
+            }
+            err = ARSTREAM2_RtpSender_ProcessRtp(resender->sender, selectRet, &readSet, &writeSet, &exceptSet);
+            if (err != ARSTREAM2_OK)
+            {
+                ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "ARSTREAM2_RtpSender_ProcessRtp() failed (%d)", err);
+            }
+        }
+
+        ARSAL_Mutex_Unlock(&(streamReceiver->resendMutex));
+
+        if (!*shouldStop)
+        {
+            ARSAL_Mutex_Lock(&(streamReceiver->threadMutex));
+            *shouldStop = streamReceiver->threadShouldStop;
+            ARSAL_Mutex_Unlock(&(streamReceiver->threadMutex));
+        }
+    }
+
+    /* Resenders started after this point will register again in a new loop */
+    ARSAL_Mutex_Lock(&(streamReceiver->resendMutex));
+    for (resender = streamReceiver->resender; resender; resender = resender->next)
+    {
+        resender->pollRegistered = 0;
+        resender->pollWritePending = 0;
+    }
+    ARSAL_Mutex_Unlock(&(streamReceiver->resendMutex));
+
+    close(timerFd);
+    close(epollFd);
+
+    return 0;
 }
 
+#endif /* #ifdef HAS_EPOLL */
 
-eARSTREAM2_ERROR ARSTREAM2_StreamReceiver_StartAppOutput(ARSTREAM2_StreamReceiver_Handle streamReceiverHandle,
-                                                         ARSTREAM2_StreamReceiver_SpsPpsCallback_t spsPpsCallback, void* spsPpsCallbackUserPtr,
-                                                         ARSTREAM2_StreamReceiver_GetAuBufferCallback_t getAuBufferCallback, void* getAuBufferCallbackUserPtr,
-                                                         ARSTREAM2_StreamReceiver_AuReadyCallback_t auReadyCallback, void* auReadyCallbackUserPtr)
+
+void* ARSTREAM2_StreamReceiver_RunNetworkThread(void *streamReceiverHandle)
 {
-    ARSTREAM2_StreamReceiver_t* streamReceiver = (ARSTREAM2_StreamReceiver_t*)streamReceiverHandle;
-    eARSTREAM2_ERROR ret = ARSTREAM2_OK;
+    ARSTREAM2_StreamReceiver_t *streamReceiver = (ARSTREAM2_StreamReceiver_t*)streamReceiverHandle;
+    int shouldStop;
+    eARSTREAM2_ERROR err;
 
     if (!streamReceiverHandle)
     {
         ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "Invalid handle");
-        return ARSTREAM2_ERROR_BAD_PARAMETERS;
+        return NULL;
     }
-    if (!getAuBufferCallback)
+
+    ARSAL_PRINT(ARSAL_PRINT_INFO, ARSTREAM2_STREAM_RECEIVER_TAG, "Receiver thread running");
+    ARSAL_Mutex_Lock(&(streamReceiver->threadMutex));
+    streamReceiver->threadStarted = 1;
+    shouldStop = streamReceiver->threadShouldStop;
+    ARSAL_Mutex_Unlock(&(streamReceiver->threadMutex));
+
+#ifdef HAS_EPOLL
+    if (ARSTREAM2_StreamReceiver_RunNetworkLoopEpoll(streamReceiver, &shouldStop) != 0)
     {
-        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "Invalid getAuBufferCallback function pointer");
-        return ARSTREAM2_ERROR_BAD_PARAMETERS;
+        /* epoll is not available or not applicable: fallback to select */
+        ARSTREAM2_StreamReceiver_RunNetworkLoopSelect(streamReceiver, &shouldStop);
     }
-    if (!auReadyCallback)
+#else
+    ARSTREAM2_StreamReceiver_RunNetworkLoopSelect(streamReceiver, &shouldStop);
+#endif
+
+    ARSAL_Mutex_Lock(&(streamReceiver->threadMutex));
+    streamReceiver->threadStarted = 0;
+    ARSAL_Mutex_Unlock(&(streamReceiver->threadMutex));
+
+    err = ARSTREAM2_RtpReceiver_ProcessEnd(streamReceiver->receiver, 0);
+    if (err != ARSTREAM2_OK)
     {
-        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "Invalid auReadyCallback function pointer");
-        return ARSTREAM2_ERROR_BAD_PARAMETERS;
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "ARSTREAM2_RtpReceiver_ProcessEnd() failed (%d)", err);
     }
 
+    ARSAL_PRINT(ARSAL_PRINT_INFO, ARSTREAM2_STREAM_RECEIVER_TAG, "Receiver thread has ended");
+
+    return (void*)0;
+}
+
+
+static eARSTREAM2_ERROR ARSTREAM2_StreamReceiver_AppOutputStart(ARSTREAM2_StreamReceiver_t *streamReceiver,
+                                                                ARSTREAM2_StreamReceiver_SpsPpsCallback_t spsPpsCallback, void* spsPpsCallbackUserPtr,
+                                                                ARSTREAM2_StreamReceiver_GetAuBufferCallback_t getAuBufferCallback, void* getAuBufferCallbackUserPtr,
+                                                                ARSTREAM2_StreamReceiver_AuReadyCallback_t auReadyCallback, void* auReadyCallbackUserPtr,
+                                                                ARSTREAM2_StreamReceiver_AuViewReadyCallback_t auViewReadyCallback, void* auViewReadyCallbackUserPtr)
+{
+    eARSTREAM2_ERROR ret = ARSTREAM2_OK;
+
     ARSAL_Mutex_Lock(&(streamReceiver->appOutput.threadMutex));
     int running = streamReceiver->appOutput.running;
     ARSAL_Mutex_Unlock(&(streamReceiver->appOutput.threadMutex));
@@ -1876,6 +2545,8 @@ eARSTREAM2_ERROR ARSTREAM2_StreamReceiver_StartAppOutput(ARSTREAM2_StreamReceive
     streamReceiver->appOutput.getAuBufferCallbackUserPtr = getAuBufferCallbackUserPtr;
     streamReceiver->appOutput.auReadyCallback = auReadyCallback;
     streamReceiver->appOutput.auReadyCallbackUserPtr = auReadyCallbackUserPtr;
+    streamReceiver->appOutput.auViewReadyCallback = auViewReadyCallback;
+    streamReceiver->appOutput.auViewReadyCallbackUserPtr = auViewReadyCallbackUserPtr;
     ARSAL_Mutex_Unlock(&(streamReceiver->appOutput.callbackMutex));
 
     if (streamReceiver->sync)
@@ -1905,6 +2576,7 @@ eARSTREAM2_ERROR ARSTREAM2_StreamReceiver_StartAppOutput(ARSTREAM2_StreamReceive
 
     ARSAL_Mutex_Lock(&(streamReceiver->appOutput.threadMutex));
     streamReceiver->appOutput.grayIFramePending = streamReceiver->appOutput.generateGrayIFrame;
+    streamReceiver->appOutput.zeroCopy = (auViewReadyCallback) ? 1 : 0;
     streamReceiver->appOutput.running = 1;
     ARSAL_Mutex_Unlock(&(streamReceiver->appOutput.threadMutex));
 
@@ -1914,6 +2586,58 @@ eARSTREAM2_ERROR ARSTREAM2_StreamReceiver_StartAppOutput(ARSTREAM2_StreamReceive
 }
 
 
+eARSTREAM2_ERROR ARSTREAM2_StreamReceiver_StartAppOutput(ARSTREAM2_StreamReceiver_Handle streamReceiverHandle,
+                                                         ARSTREAM2_StreamReceiver_SpsPpsCallback_t spsPpsCallback, void* spsPpsCallbackUserPtr,
+                                                         ARSTREAM2_StreamReceiver_GetAuBufferCallback_t getAuBufferCallback, void* getAuBufferCallbackUserPtr,
+                                                         ARSTREAM2_StreamReceiver_AuReadyCallback_t auReadyCallback, void* auReadyCallbackUserPtr)
+{
+    ARSTREAM2_StreamReceiver_t* streamReceiver = (ARSTREAM2_StreamReceiver_t*)streamReceiverHandle;
+
+    if (!streamReceiverHandle)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "Invalid handle");
+        return ARSTREAM2_ERROR_BAD_PARAMETERS;
+    }
+    if (!getAuBufferCallback)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "Invalid getAuBufferCallback function pointer");
+        return ARSTREAM2_ERROR_BAD_PARAMETERS;
+    }
+    if (!auReadyCallback)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "Invalid auReadyCallback function pointer");
+        return ARSTREAM2_ERROR_BAD_PARAMETERS;
+    }
+
+    return ARSTREAM2_StreamReceiver_AppOutputStart(streamReceiver, spsPpsCallback, spsPpsCallbackUserPtr,
+                                                   getAuBufferCallback, getAuBufferCallbackUserPtr,
+                                                   auReadyCallback, auReadyCallbackUserPtr, NULL, NULL);
+}
+
+
+eARSTREAM2_ERROR ARSTREAM2_StreamReceiver_StartAppOutputZeroCopy(ARSTREAM2_StreamReceiver_Handle streamReceiverHandle,
+                                                                 ARSTREAM2_StreamReceiver_SpsPpsCallback_t spsPpsCallback, void* spsPpsCallbackUserPtr,
+                                                                 ARSTREAM2_StreamReceiver_AuViewReadyCallback_t auViewReadyCallback, void* auViewReadyCallbackUserPtr)
+{
+    ARSTREAM2_StreamReceiver_t* streamReceiver = (ARSTREAM2_StreamReceiver_t*)streamReceiverHandle;
+
+    if (!streamReceiverHandle)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "Invalid handle");
+        return ARSTREAM2_ERROR_BAD_PARAMETERS;
+    }
+    if (!auViewReadyCallback)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "Invalid auViewReadyCallback function pointer");
+        return ARSTREAM2_ERROR_BAD_PARAMETERS;
+    }
+
+    return ARSTREAM2_StreamReceiver_AppOutputStart(streamReceiver, spsPpsCallback, spsPpsCallbackUserPtr,
+                                                   NULL, NULL, NULL, NULL,
+                                                   auViewReadyCallback, auViewReadyCallbackUserPtr);
+}
+
+
 eARSTREAM2_ERROR ARSTREAM2_StreamReceiver_StopAppOutput(ARSTREAM2_StreamReceiver_Handle streamReceiverHandle)
 {
     ARSTREAM2_StreamReceiver_t* streamReceiver = (ARSTREAM2_StreamReceiver_t*)streamReceiverHandle;
@@ -1940,6 +2664,8 @@ eARSTREAM2_ERROR ARSTREAM2_StreamReceiver_StopAppOutput(ARSTREAM2_StreamReceiver
     streamReceiver->appOutput.getAuBufferCallbackUserPtr = NULL;
     streamReceiver->appOutput.auReadyCallback = NULL;
     streamReceiver->appOutput.auReadyCallbackUserPtr = NULL;
+    streamReceiver->appOutput.auViewReadyCallback = NULL;
+    streamReceiver->appOutput.auViewReadyCallbackUserPtr = NULL;
     ARSAL_Mutex_Unlock(&(streamReceiver->appOutput.callbackMutex));
 
     int auFifoRet = ARSTREAM2_H264_AuFifoRemoveQueue(&streamReceiver->auFifo, &streamReceiver->appOutput.auFifoQueue);
@@ -1955,6 +2681,42 @@ eARSTREAM2_ERROR ARSTREAM2_StreamReceiver_StopAppOutput(ARSTREAM2_StreamReceiver
 }
 
 
+eARSTREAM2_ERROR ARSTREAM2_StreamReceiver_ReleaseAuView(ARSTREAM2_StreamReceiver_Handle streamReceiverHandle,
+                                                        ARSTREAM2_StreamReceiver_AuView_Handle auView)
+{
+    ARSTREAM2_StreamReceiver_t* streamReceiver = (ARSTREAM2_StreamReceiver_t*)streamReceiverHandle;
+    ARSTREAM2_H264_AuFifoItem_t *auItem = (ARSTREAM2_H264_AuFifoItem_t*)auView;
+    eARSTREAM2_ERROR ret = ARSTREAM2_OK;
+    int fifoRet;
+
+    if (!streamReceiverHandle)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "Invalid handle");
+        return ARSTREAM2_ERROR_BAD_PARAMETERS;
+    }
+    if (!auView)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "Invalid AU view handle");
+        return ARSTREAM2_ERROR_BAD_PARAMETERS;
+    }
+
+    fifoRet = ARSTREAM2_H264_AuFifoUnrefBuffer(&streamReceiver->auFifo, auItem->au.buffer);
+    if (fifoRet != 0)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "Failed to unref buffer (%d)", fifoRet);
+        ret = ARSTREAM2_ERROR_INVALID_STATE;
+    }
+    fifoRet = ARSTREAM2_H264_AuFifoPushFreeItem(&streamReceiver->auFifo, auItem);
+    if (fifoRet != 0)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "Failed to push free item in the AU FIFO (%d)", fifoRet);
+        ret = ARSTREAM2_ERROR_INVALID_STATE;
+    }
+
+    return ret;
+}
+
+
 eARSTREAM2_ERROR ARSTREAM2_StreamReceiver_Stop(ARSTREAM2_StreamReceiver_Handle streamReceiverHandle)
 {
     ARSTREAM2_StreamReceiver_t* streamReceiver = (ARSTREAM2_StreamReceiver_t*)streamReceiverHandle;
@@ -2713,6 +3475,66 @@ eARSTREAM2_ERROR ARSTREAM2_StreamReceiver_GetPeerUntimedMetadata(ARSTREAM2_Strea
 }
 
 
+eARSTREAM2_ERROR ARSTREAM2_StreamReceiver_GetRecvStats(ARSTREAM2_StreamReceiver_Handle streamReceiverHandle,
+                                                       ARSTREAM2_StreamReceiver_RecvStats_t *stats, int reset)
+{
+    ARSTREAM2_StreamReceiver_t* streamReceiver = (ARSTREAM2_StreamReceiver_t*)streamReceiverHandle;
+    ARSTREAM2_RtpReceiver_RecvStats_t recvStats;
+    ARSTREAM2_RTP_PacketFifoUsage_t packetFifoUsage;
+    eARSTREAM2_ERROR ret;
+    int i;
+
+    if (!streamReceiverHandle)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "Invalid handle");
+        return ARSTREAM2_ERROR_BAD_PARAMETERS;
+    }
+    if (!stats)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "Invalid stats");
+        return ARSTREAM2_ERROR_BAD_PARAMETERS;
+    }
+
+    ret = ARSTREAM2_RtpReceiver_GetRecvStats(streamReceiver->receiver, &recvStats, reset);
+    if (ret != ARSTREAM2_OK)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "ARSTREAM2_RtpReceiver_GetRecvStats() failed: %d (%s)",
+                    ret, ARSTREAM2_Error_ToString(ret));
+        return ret;
+    }
+
+    memset(stats, 0, sizeof(ARSTREAM2_StreamReceiver_RecvStats_t));
+    stats->msgVecCount = recvStats.msgVecCount;
+    stats->batchCount = recvStats.batchCount;
+    stats->datagramCount = recvStats.datagramCount;
+    stats->byteCount = recvStats.byteCount;
+    stats->fullBatchCount = recvStats.fullBatchCount;
+    stats->packetFifoAddTime = recvStats.packetFifoAddTime;
+    stats->auFifoAddTime = recvStats.auFifoAddTime;
+    for (i = 0; (i < ARSTREAM2_STREAM_RECEIVER_RECV_STATS_HISTOGRAM_BUCKET_COUNT) && (i < ARSTREAM2_RTP_RECEIVER_RECV_STATS_HISTOGRAM_BUCKET_COUNT); i++)
+    {
+        stats->batchDatagramsHistogram[i] = recvStats.batchDatagramsHistogram[i];
+        stats->batchBytesHistogram[i] = recvStats.batchBytesHistogram[i];
+        stats->packetFifoAddTimeHistogram[i] = recvStats.packetFifoAddTimeHistogram[i];
+        stats->auFifoAddTimeHistogram[i] = recvStats.auFifoAddTimeHistogram[i];
+    }
+
+    if (ARSTREAM2_RTP_PacketFifoGetUsage(&streamReceiver->packetFifo, &packetFifoUsage, reset) == 0)
+    {
+        stats->packetFifoFootprint = packetFifoUsage.footprint;
+        stats->packetFifoItemCount = packetFifoUsage.itemPoolSize;
+        stats->packetFifoItemHighWatermark = packetFifoUsage.itemHighWatermark;
+        stats->packetFifoBufferCount = packetFifoUsage.bufferPoolSize;
+        stats->packetFifoBufferHighWatermark = packetFifoUsage.bufferHighWatermark;
+        stats->packetFifoOverflowBufferCount = packetFifoUsage.overflowPoolSize;
+        stats->packetFifoOverflowCount = packetFifoUsage.overflowCount;
+        stats->packetFifoTruncatedCount = packetFifoUsage.truncatedCount;
+    }
+
+    return ARSTREAM2_OK;
+}
+
+
 eARSTREAM2_ERROR ARSTREAM2_StreamReceiver_StartResender(ARSTREAM2_StreamReceiver_Handle streamReceiverHandle,
                                                         ARSTREAM2_StreamReceiver_ResenderHandle *streamResenderHandle,
                                                         const ARSTREAM2_StreamReceiver_ResenderConfig_t *config)
@@ -2748,6 +3570,9 @@ eARSTREAM2_ERROR ARSTREAM2_StreamReceiver_StartResender(ARSTREAM2_StreamReceiver
     if (ret == ARSTREAM2_OK)
     {
         memset(resender, 0, sizeof(*resender));
+        resender->signalPipe[0] = -1;
+        resender->signalPipe[1] = -1;
+        resender->useThread = (config->useThread > 0) ? 1 : 0;
         resender->streamSocketSendBufferSize = (config->streamSocketBufferSize > 0) ? config->streamSocketBufferSize : ARSTREAM2_RTP_RESENDER_DEFAULT_STREAM_SOCKET_SEND_BUFFER_SIZE;
         resender->maxNetworkLatencyUs = (config->maxNetworkLatencyMs > 0) ? config->maxNetworkLatencyMs * 1000 : 0;
     }
@@ -2768,6 +3593,31 @@ eARSTREAM2_ERROR ARSTREAM2_StreamReceiver_StartResender(ARSTREAM2_StreamReceiver
         }
     }
 
+    if ((ret == ARSTREAM2_OK) && (resender->useThread))
+    {
+        /* The handoff ring and the worker FIFO can hold all the receiver packet buffers */
+        int workerItemCount = streamReceiver->packetFifo.bufferPoolSize;
+        if (ARSTREAM2_RTP_PacketRingInit(&resender->ring, workerItemCount) != 0)
+        {
+            ret = ARSTREAM2_ERROR_ALLOC;
+        }
+        else if (ARSTREAM2_RTP_PacketFifoInit(&resender->workerPacketFifo, workerItemCount, 0, 0) != 0)
+        {
+            ret = ARSTREAM2_ERROR_ALLOC;
+        }
+        else if (ARSTREAM2_RTP_PacketFifoAddQueue(&resender->workerPacketFifo, &resender->workerPacketFifoQueue) != 0)
+        {
+            ret = ARSTREAM2_ERROR_ALLOC;
+        }
+        else if (pipe(resender->signalPipe) != 0)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "Failed to create pipe (%d): %s", errno, strerror(errno));
+            resender->signalPipe[0] = -1;
+            resender->signalPipe[1] = -1;
+            ret = ARSTREAM2_ERROR_RESOURCE_UNAVAILABLE;
+        }
+    }
+
     if (ret == ARSTREAM2_OK)
     {
         ARSTREAM2_RtpSender_Config_t senderConfig;
@@ -2786,8 +3636,8 @@ eARSTREAM2_ERROR ARSTREAM2_StreamReceiver_StartResender(ARSTREAM2_StreamReceiver
         senderConfig.streamSocketSendBufferSize = resender->streamSocketSendBufferSize;
         senderConfig.maxPacketSize = streamReceiver->maxPacketSize;
         senderConfig.naluFifo = NULL;
-        senderConfig.packetFifo = &streamReceiver->packetFifo;
-        senderConfig.packetFifoQueue = &resender->packetFifoQueue;
+        senderConfig.packetFifo = (resender->useThread) ? &resender->workerPacketFifo : &streamReceiver->packetFifo;
+        senderConfig.packetFifoQueue = (resender->useThread) ? &resender->workerPacketFifoQueue : &resender->packetFifoQueue;
         senderConfig.debugPath = streamReceiver->debugPath;
         senderConfig.dateAndTime = streamReceiver->dateAndTime;
 
@@ -2798,6 +3648,16 @@ eARSTREAM2_ERROR ARSTREAM2_StreamReceiver_StartResender(ARSTREAM2_StreamReceiver
         }
     }
 
+    if ((ret == ARSTREAM2_OK) && (resender->useThread))
+    {
+        int thErr = ARSAL_Thread_Create(&resender->thread, ARSTREAM2_StreamReceiver_RunResenderThread, (void*)resender);
+        if (thErr != 0)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "Resender thread creation failed (%d)", thErr);
+            ret = ARSTREAM2_ERROR_RESOURCE_UNAVAILABLE;
+        }
+    }
+
     if (ret == ARSTREAM2_OK)
     {
         resender->prev = NULL;
@@ -2812,7 +3672,7 @@ eARSTREAM2_ERROR ARSTREAM2_StreamReceiver_StartResender(ARSTREAM2_StreamReceiver
     if (ret == ARSTREAM2_OK)
     {
         ARSTREAM2_RtpResender_t* r;
-        for (r = streamReceiver->resender, streamReceiver->resendCount = 0; r; r = resender->next)
+        for (r = streamReceiver->resender, streamReceiver->resendCount = 0; r; r = r->next)
         {
             streamReceiver->resendCount++;
         }
@@ -2827,7 +3687,7 @@ eARSTREAM2_ERROR ARSTREAM2_StreamReceiver_StartResender(ARSTREAM2_StreamReceiver
             else
             {
                 int k;
-                for (r = streamReceiver->resender, k = 0; r; r = resender->next, k++)
+                for (r = streamReceiver->resender, k = 0; r; r = r->next, k++)
                     streamReceiver->resendQueue[k] = &r->packetFifoQueue;
             }
             streamReceiver->resendTimeout = realloc(streamReceiver->resendTimeout, streamReceiver->resendCount * sizeof(uint32_t));
@@ -2839,7 +3699,7 @@ eARSTREAM2_ERROR ARSTREAM2_StreamReceiver_StartResender(ARSTREAM2_StreamReceiver
             else
             {
                 int k;
-                for (r = streamReceiver->resender, k = 0; r; r = resender->next, k++)
+                for (r = streamReceiver->resender, k = 0; r; r = r->next, k++)
                     streamReceiver->resendTimeout[k] = r->maxNetworkLatencyUs;
             }
         }
@@ -2866,7 +3726,7 @@ eARSTREAM2_ERROR ARSTREAM2_StreamReceiver_StartResender(ARSTREAM2_StreamReceiver
     {
         if (resender)
         {
-            if (resender->sender) ARSTREAM2_RtpSender_Delete(&(resender->sender));
+            ARSTREAM2_StreamReceiver_ResenderDelete(streamReceiver, resender);
             if (packetFifoQueueCreated) ARSTREAM2_RTP_PacketFifoRemoveQueue(&streamReceiver->packetFifo, &resender->packetFifoQueue);
             free(resender);
         }
@@ -2901,19 +3761,13 @@ eARSTREAM2_ERROR ARSTREAM2_StreamReceiver_StopResender(ARSTREAM2_StreamReceiver_
 
     ARSAL_Mutex_Lock(&(streamReceiver->resendMutex));
 
-    ret = ARSTREAM2_RtpSender_ProcessEnd(resender->sender, 1);
+    ret = ARSTREAM2_StreamReceiver_ResenderDelete(streamReceiver, resender);
     if (ret != ARSTREAM2_OK)
     {
-        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "ARSTREAM2_RtpSender_ProcessEnd() failed (%d)", ret);
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "Unable to delete resender: %s", ARSTREAM2_Error_ToString(ret));
     }
     ARSTREAM2_RTP_PacketFifoRemoveQueue(&streamReceiver->packetFifo, &resender->packetFifoQueue);
 
-    ret = ARSTREAM2_RtpSender_Delete(&resender->sender);
-    if (ret != ARSTREAM2_OK)
-    {
-        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_RECEIVER_TAG, "Unable to delete sender: %s", ARSTREAM2_Error_ToString(ret));
-    }
-
     if (resender->prev)
     {
         resender->prev->next = resender->next;
@@ -2928,7 +3782,7 @@ eARSTREAM2_ERROR ARSTREAM2_StreamReceiver_StopResender(ARSTREAM2_StreamReceiver_
     }
 
     ARSTREAM2_RtpResender_t* r;
-    for (r = streamReceiver->resender, streamReceiver->resendCount = 0; r; r = resender->next)
+    for (r = streamReceiver->resender, streamReceiver->resendCount = 0; r; r = r->next)
     {
         streamReceiver->resendCount++;
     }
@@ -2943,7 +3797,7 @@ eARSTREAM2_ERROR ARSTREAM2_StreamReceiver_StopResender(ARSTREAM2_StreamReceiver_
         else
         {
             int k;
-            for (r = streamReceiver->resender, k = 0; r; r = resender->next, k++)
+            for (r = streamReceiver->resender, k = 0; r; r = r->next, k++)
                 streamReceiver->resendQueue[k] = &r->packetFifoQueue;
         }
         streamReceiver->resendTimeout = realloc(streamReceiver->resendTimeout, streamReceiver->resendCount * sizeof(uint32_t));
@@ -2955,7 +3809,7 @@ eARSTREAM2_ERROR ARSTREAM2_StreamReceiver_StopResender(ARSTREAM2_StreamReceiver_
         else
         {
             int k;
-            for (r = streamReceiver->resender, k = 0; r; r = resender->next, k++)
+            for (r = streamReceiver->resender, k = 0; r; r = r->next, k++)
                 streamReceiver->resendTimeout[k] = r->maxNetworkLatencyUs;
         }
     }
@@ -8,11 +8,16 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <errno.h>
+#ifdef HAS_EPOLL
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#endif
 
 #include <libARSAL/ARSAL_Print.h>
 
 #include <libARStream2/arstream2_stream_sender.h>
 #include "arstream2_rtp_sender.h"
+#include "arstream2_rtp_fec.h"
 #include "arstream2_stream_stats_internal.h"
 
 
@@ -40,6 +45,24 @@
  */
 #define ARSTREAM2_STREAM_SENDER_DEFAULT_STREAM_SOCKET_SEND_BUFFER_SIZE (10000000 * 100 / 1000 / 8)
 
+/**
+ * Maximum number of events returned by epoll_wait()
+ */
+#define ARSTREAM2_STREAM_SENDER_EPOLL_MAX_EVENTS (4)
+
+
+typedef struct ARSTREAM2_StreamSender_Destination_s
+{
+    ARSTREAM2_RtpSender_t *sender;
+    ARSTREAM2_RTP_PacketFifoQueue_t packetFifoQueue;
+    int pollRegistered;
+    int pollWritePending;
+
+    struct ARSTREAM2_StreamSender_Destination_s *prev;
+    struct ARSTREAM2_StreamSender_Destination_s *next;
+
+} ARSTREAM2_StreamSender_Destination_t;
+
 
 typedef struct ARSTREAM2_StreamSender_s
 {
@@ -58,15 +81,29 @@ typedef struct ARSTREAM2_StreamSender_s
 
     /* NALU and packet FIFO */
     int naluFifoSize;
+    int naluFifoLockFree;
+    int naluFifoFlushPending;
     ARSTREAM2_H264_NaluFifo_t naluFifo;
     ARSTREAM2_RTP_PacketFifo_t packetFifo;
     ARSTREAM2_RTP_PacketFifoQueue_t packetFifoQueue;
 
+    /* Additional destinations */
+    ARSTREAM2_StreamSender_Destination_t *destination;
+    int destinationCount;
+    int maxDestinationCount;
+    ARSAL_Mutex_t destinationMutex;
+    char *canonicalName;
+    char *applicationName;
+
     /* Thread status */
     ARSAL_Mutex_t threadMutex;
     int threadStarted;
     int threadShouldStop;
     int signalPipe[2];
+#ifdef HAS_EPOLL
+    int signalEventFd;
+#endif
+    int signalPending;
 
     /* Debug files */
     char *friendlyName;
@@ -85,11 +122,71 @@ static void ARSTREAM2_StreamSender_RtpStatsCallback(const ARSTREAM2_RTP_RtpStats
 static void ARSTREAM2_StreamSender_VideoStatsCallback(const ARSTREAM2_H264_VideoStats_t *videoStats, void *userPtr);
 
 
+static int ARSTREAM2_StreamSender_GetSignalFd(ARSTREAM2_StreamSender_t *streamSender)
+{
+#ifdef HAS_EPOLL
+    return streamSender->signalEventFd;
+#else
+    return streamSender->signalPipe[0];
+#endif
+}
+
+
+static void ARSTREAM2_StreamSender_Signal(ARSTREAM2_StreamSender_t *streamSender)
+{
+    ssize_t err;
+
+    /* Wakeups are merged: nothing to do if a signal is already pending */
+    if (__atomic_exchange_n(&streamSender->signalPending, 1, __ATOMIC_SEQ_CST) != 0)
+    {
+        return;
+    }
+
+#ifdef HAS_EPOLL
+    if (streamSender->signalEventFd != -1)
+    {
+        uint64_t val = 1;
+        while (((err = write(streamSender->signalEventFd, &val, sizeof(val))) == -1) && (errno == EINTR));
+    }
+#else
+    if (streamSender->signalPipe[1] != -1)
+    {
+        char * buff = "x";
+        while (((err = write(streamSender->signalPipe[1], buff, 1)) == -1) && (errno == EINTR));
+    }
+#endif
+}
+
+
+static void ARSTREAM2_StreamSender_SignalClear(ARSTREAM2_StreamSender_t *streamSender)
+{
+    int readRet;
+
+#ifdef HAS_EPOLL
+    uint64_t val;
+    while (((readRet = read(streamSender->signalEventFd, &val, sizeof(val))) == -1) && (errno == EINTR));
+#else
+    /* Dump bytes (so it won't be ready next time) */
+    char dump[10];
+    while (((readRet = read(streamSender->signalPipe[0], &dump, 10)) == -1) && (errno == EINTR));
+#endif
+    if ((readRet < 0) && (errno != EAGAIN))
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_SENDER_TAG, "Failed to read from signal fd (%d): %s", errno, strerror(errno));
+    }
+
+    /* The pending flag is cleared after the read and before the NALU FIFO
+     * is processed so that a NALU enqueued in between is never missed
+     * (full barrier: the FIFO reads must not be performed before the clear) */
+    __atomic_exchange_n(&streamSender->signalPending, 0, __ATOMIC_SEQ_CST);
+}
+
+
 eARSTREAM2_ERROR ARSTREAM2_StreamSender_Init(ARSTREAM2_StreamSender_Handle *streamSenderHandle,
                                              const ARSTREAM2_StreamSender_Config_t *config)
 {
     eARSTREAM2_ERROR ret = ARSTREAM2_OK;
-    int threadMutexWasInit = 0, packetFifoWasCreated = 0, naluFifoWasCreated = 0;
+    int threadMutexWasInit = 0, destinationMutexWasInit = 0, packetFifoWasCreated = 0, naluFifoWasCreated = 0;
     ARSTREAM2_StreamSender_t *streamSender = NULL;
 
     if (!streamSenderHandle)
@@ -115,16 +212,21 @@ eARSTREAM2_ERROR ARSTREAM2_StreamSender_Init(ARSTREAM2_StreamSender_Handle *stre
         memset(streamSender, 0, sizeof(*streamSender));
         streamSender->signalPipe[0] = -1;
         streamSender->signalPipe[1] = -1;
+#ifdef HAS_EPOLL
+        streamSender->signalEventFd = -1;
+#endif
         streamSender->rtpStatsCallback = config->rtpStatsCallback;
         streamSender->rtpStatsCallbackUserPtr = config->rtpStatsCallbackUserPtr;
         streamSender->videoStatsCallback = config->videoStatsCallback;
         streamSender->videoStatsCallbackUserPtr = config->videoStatsCallbackUserPtr;
         streamSender->naluFifoSize = (config->naluFifoSize > 0) ? config->naluFifoSize : ARSTREAM2_STREAM_SENDER_DEFAULT_NALU_FIFO_SIZE;
+        streamSender->naluFifoLockFree = (config->naluFifoLockFree > 0) ? 1 : 0;
         streamSender->maxPacketSize = (config->maxPacketSize > (int)ARSTREAM2_RTP_TOTAL_HEADERS_SIZE) ? (uint32_t)config->maxPacketSize - ARSTREAM2_RTP_TOTAL_HEADERS_SIZE : ARSTREAM2_RTP_MAX_PAYLOAD_SIZE;
         streamSender->targetPacketSize = (config->targetPacketSize > (int)ARSTREAM2_RTP_TOTAL_HEADERS_SIZE)
                 ? (uint32_t)config->targetPacketSize - ARSTREAM2_RTP_TOTAL_HEADERS_SIZE
                 : ((config->targetPacketSize) ? streamSender->maxPacketSize : 0);
         streamSender->maxBitrate = (config->maxBitrate > 0) ? config->maxBitrate : 0;
+        streamSender->maxDestinationCount = (config->maxDestinationCount > 0) ? config->maxDestinationCount : 0;
 
         if (config->streamSocketBufferSize > 0)
         {
@@ -164,6 +266,18 @@ eARSTREAM2_ERROR ARSTREAM2_StreamSender_Init(ARSTREAM2_StreamSender_Handle *stre
         {
             streamSender->friendlyName = strndup(config->canonicalName, 40);
         }
+        if (streamSender->maxDestinationCount > 0)
+        {
+            /* the additional destinations share the SDES items */
+            if (config->canonicalName)
+            {
+                streamSender->canonicalName = strdup(config->canonicalName);
+            }
+            if (config->applicationName)
+            {
+                streamSender->applicationName = strdup(config->applicationName);
+            }
+        }
         char szDate[200];
         time_t rawtime;
         struct tm timeinfo;
@@ -182,7 +296,7 @@ eARSTREAM2_ERROR ARSTREAM2_StreamSender_Init(ARSTREAM2_StreamSender_Handle *stre
     /* Setup the NAL unit FIFO */
     if (ret == ARSTREAM2_OK)
     {
-        int naluFifoRet = ARSTREAM2_H264_NaluFifoInit(&streamSender->naluFifo, streamSender->naluFifoSize);
+        int naluFifoRet = ARSTREAM2_H264_NaluFifoInit(&streamSender->naluFifo, streamSender->naluFifoSize, streamSender->naluFifoLockFree);
         if (naluFifoRet != 0)
         {
             ret = ARSTREAM2_ERROR_ALLOC;
@@ -203,12 +317,39 @@ eARSTREAM2_ERROR ARSTREAM2_StreamSender_Init(ARSTREAM2_StreamSender_Handle *stre
         {
             packetFifoBufferCount = ARSTREAM2_STREAM_SENDER_DEFAULT_MIN_PACKET_FIFO_BUFFER_COUNT;
         }
+        if (config->useRtcpNack)
+        {
+            /* the retransmission cache holds a reference on the sent packet buffers */
+            packetFifoBufferCount += ARSTREAM2_RTP_SENDER_RETRANSMIT_CACHE_DEFAULT_SIZE;
+        }
+        if (config->fecGroupSize > 0)
+        {
+            /* room for the FEC repair packets (up to one per two media packets plus the column groups) */
+            packetFifoBufferCount += packetFifoBufferCount / 2 + ARSTREAM2_RTPFEC_MAX_GROUP_SIZE;
+        }
         int packetFifoItemCount = packetFifoBufferCount * ARSTREAM2_STREAM_SENDER_DEFAULT_PACKET_FIFO_BUFFER_TO_ITEM_FACTOR;
         if (packetFifoItemCount < ARSTREAM2_STREAM_SENDER_DEFAULT_MIN_PACKET_FIFO_ITEM_COUNT)
         {
             packetFifoItemCount = ARSTREAM2_STREAM_SENDER_DEFAULT_MIN_PACKET_FIFO_ITEM_COUNT;
         }
-        int packetFifoRet = ARSTREAM2_RTP_PacketFifoInit(&streamSender->packetFifo, packetFifoItemCount, packetFifoBufferCount, streamSender->maxPacketSize);
+        if (streamSender->maxDestinationCount > 0)
+        {
+            /* the packet buffers are shared by all destinations but each destination queue
+             * needs its own items, and its retransmission cache holds buffer references */
+            packetFifoItemCount *= 1 + streamSender->maxDestinationCount;
+            packetFifoBufferCount += streamSender->maxDestinationCount * ARSTREAM2_RTP_SENDER_RETRANSMIT_CACHE_DEFAULT_SIZE;
+        }
+        int packetFifoRet;
+        if (config->usePacketFifoArena)
+        {
+            int arenaFlags = ((config->packetFifoArenaHugePages) ? ARSTREAM2_RTP_PACKET_FIFO_ARENA_HUGE_PAGES : 0)
+                    | ((config->packetFifoArenaLock) ? ARSTREAM2_RTP_PACKET_FIFO_ARENA_LOCK : 0);
+            packetFifoRet = ARSTREAM2_RTP_PacketFifoInitArena(&streamSender->packetFifo, packetFifoItemCount, packetFifoBufferCount, streamSender->maxPacketSize, arenaFlags);
+        }
+        else
+        {
+            packetFifoRet = ARSTREAM2_RTP_PacketFifoInit(&streamSender->packetFifo, packetFifoItemCount, packetFifoBufferCount, streamSender->maxPacketSize);
+        }
         if (packetFifoRet != 0)
         {
             ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_SENDER_TAG, "ARSTREAM2_RTP_PacketFifoAddQueue() failed (%d)", packetFifoRet);
@@ -222,6 +363,16 @@ eARSTREAM2_ERROR ARSTREAM2_StreamSender_Init(ARSTREAM2_StreamSender_Handle *stre
                 ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_SENDER_TAG, "ARSTREAM2_RTP_PacketFifoAddQueue() failed (%d)", packetFifoRet);
                 ret = ARSTREAM2_ERROR_ALLOC;
             }
+            else
+            {
+                /* the send queue holds at most one packet per FIFO item */
+                packetFifoRet = ARSTREAM2_RTP_PacketFifoQueueEnableTimeoutHeap(&streamSender->packetFifoQueue, packetFifoItemCount);
+                if (packetFifoRet != 0)
+                {
+                    ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_SENDER_TAG, "ARSTREAM2_RTP_PacketFifoQueueEnableTimeoutHeap() failed (%d)", packetFifoRet);
+                    ret = ARSTREAM2_ERROR_ALLOC;
+                }
+            }
             packetFifoWasCreated = 1;
         }
     }
@@ -251,6 +402,8 @@ eARSTREAM2_ERROR ARSTREAM2_StreamSender_Init(ARSTREAM2_StreamSender_Handle *stre
         senderConfig.videoStatsCallbackUserPtr = streamSender;
         senderConfig.disconnectionCallback = config->disconnectionCallback;
         senderConfig.disconnectionCallbackUserPtr = config->disconnectionCallbackUserPtr;
+        senderConfig.bitrateCallback = config->bitrateCallback;
+        senderConfig.bitrateCallbackUserPtr = config->bitrateCallbackUserPtr;
         senderConfig.naluFifo = &streamSender->naluFifo;
         senderConfig.packetFifo = &streamSender->packetFifo;
         senderConfig.packetFifoQueue = &streamSender->packetFifoQueue;
@@ -258,7 +411,17 @@ eARSTREAM2_ERROR ARSTREAM2_StreamSender_Init(ARSTREAM2_StreamSender_Handle *stre
         senderConfig.targetPacketSize = streamSender->targetPacketSize;
         senderConfig.streamSocketSendBufferSize = streamSender->streamSocketSendBufferSize;
         senderConfig.maxBitrate = streamSender->maxBitrate;
+        senderConfig.minBitrate = config->minBitrate;
+        senderConfig.useCongestionControl = config->useCongestionControl;
         senderConfig.useRtpHeaderExtensions = config->useRtpHeaderExtensions;
+        senderConfig.useGso = config->useGso;
+        senderConfig.useRtcpNack = config->useRtcpNack;
+        senderConfig.fecGroupSize = config->fecGroupSize;
+        senderConfig.fecRowCount = config->fecRowCount;
+        senderConfig.fecImportanceLevelCount = config->fecImportanceLevelCount;
+        senderConfig.pacingWindowPercent = config->pacingWindowPercent;
+        senderConfig.useTxTime = config->useTxTime;
+        senderConfig.shmTransport = config->shmTransport;
         senderConfig.debugPath = streamSender->debugPath;
         senderConfig.dateAndTime = streamSender->dateAndTime;
 
@@ -271,10 +434,18 @@ eARSTREAM2_ERROR ARSTREAM2_StreamSender_Init(ARSTREAM2_StreamSender_Handle *stre
 
     if (ret == ARSTREAM2_OK)
     {
+#ifdef HAS_EPOLL
+        streamSender->signalEventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (streamSender->signalEventFd < 0)
+        {
+            ret = ARSTREAM2_ERROR_RESOURCE_UNAVAILABLE;
+        }
+#else
         if (pipe(streamSender->signalPipe) != 0)
         {
             ret = ARSTREAM2_ERROR_RESOURCE_UNAVAILABLE;
         }
+#endif
     }
 
     if (ret == ARSTREAM2_OK)
@@ -290,6 +461,19 @@ eARSTREAM2_ERROR ARSTREAM2_StreamSender_Init(ARSTREAM2_StreamSender_Handle *stre
         }
     }
 
+    if (ret == ARSTREAM2_OK)
+    {
+        int mutexInitRet = ARSAL_Mutex_Init(&(streamSender->destinationMutex));
+        if (mutexInitRet != 0)
+        {
+            ret = ARSTREAM2_ERROR_ALLOC;
+        }
+        else
+        {
+            destinationMutexWasInit = 1;
+        }
+    }
+
     if (ret == ARSTREAM2_OK)
     {
         *streamSenderHandle = streamSender;
@@ -309,7 +493,15 @@ eARSTREAM2_ERROR ARSTREAM2_StreamSender_Init(ARSTREAM2_StreamSender_Handle *stre
                 while (((err = close(streamSender->signalPipe[1])) == -1) && (errno == EINTR));
                 streamSender->signalPipe[1] = -1;
             }
+#ifdef HAS_EPOLL
+            if (streamSender->signalEventFd != -1)
+            {
+                while (((err = close(streamSender->signalEventFd)) == -1) && (errno == EINTR));
+                streamSender->signalEventFd = -1;
+            }
+#endif
             if (threadMutexWasInit == 1) ARSAL_Mutex_Destroy(&(streamSender->threadMutex));
+            if (destinationMutexWasInit == 1) ARSAL_Mutex_Destroy(&(streamSender->destinationMutex));
             if (streamSender->sender) ARSTREAM2_RtpSender_Delete(&(streamSender->sender));
             if (naluFifoWasCreated == 1) ARSTREAM2_H264_NaluFifoFree(&(streamSender->naluFifo));
             if (packetFifoWasCreated == 1) ARSTREAM2_RTP_PacketFifoFree(&(streamSender->packetFifo));
@@ -317,6 +509,8 @@ eARSTREAM2_ERROR ARSTREAM2_StreamSender_Init(ARSTREAM2_StreamSender_Handle *stre
             ARSTREAM2_StreamStats_RtpLossFileClose(&streamSender->rtpLossCtx);
             free(streamSender->debugPath);
             free(streamSender->friendlyName);
+            free(streamSender->canonicalName);
+            free(streamSender->applicationName);
             free(streamSender->dateAndTime);
             free(streamSender);
         }
@@ -343,12 +537,7 @@ eARSTREAM2_ERROR ARSTREAM2_StreamSender_Stop(ARSTREAM2_StreamSender_Handle strea
     ARSAL_Mutex_Unlock(&(streamSender->threadMutex));
 
     /* signal the thread to avoid a deadlock */
-    if (streamSender->signalPipe[1] != -1)
-    {
-        char * buff = "x";
-        ssize_t err;
-        while (((err = write(streamSender->signalPipe[1], buff, 1)) == -1) && (errno == EINTR));
-    }
+    ARSTREAM2_StreamSender_Signal(streamSender);
 
     return ret;
 }
@@ -377,6 +566,19 @@ eARSTREAM2_ERROR ARSTREAM2_StreamSender_Free(ARSTREAM2_StreamSender_Handle *stre
 
     if (canDelete == 1)
     {
+        ARSTREAM2_StreamSender_Destination_t *destination, *next;
+        for (destination = streamSender->destination; destination; destination = next)
+        {
+            ret = ARSTREAM2_RtpSender_Delete(&destination->sender);
+            if (ret != ARSTREAM2_OK)
+            {
+                ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_SENDER_TAG, "Unable to delete destination sender: %s", ARSTREAM2_Error_ToString(ret));
+            }
+            next = destination->next;
+            free(destination);
+        }
+        streamSender->destination = NULL;
+
         ret = ARSTREAM2_RtpSender_Delete(&streamSender->sender);
         if (ret != ARSTREAM2_OK)
         {
@@ -393,7 +595,15 @@ eARSTREAM2_ERROR ARSTREAM2_StreamSender_Free(ARSTREAM2_StreamSender_Handle *stre
             close(streamSender->signalPipe[1]);
             streamSender->signalPipe[1] = -1;
         }
+#ifdef HAS_EPOLL
+        if (streamSender->signalEventFd != -1)
+        {
+            close(streamSender->signalEventFd);
+            streamSender->signalEventFd = -1;
+        }
+#endif
         ARSAL_Mutex_Destroy(&(streamSender->threadMutex));
+        ARSAL_Mutex_Destroy(&(streamSender->destinationMutex));
         ARSTREAM2_H264_NaluFifoFree(&(streamSender->naluFifo));
         ARSTREAM2_RTP_PacketFifoFree(&(streamSender->packetFifo));
         ARSTREAM2_StreamStats_VideoStatsFileClose(&streamSender->videoStatsCtx);
@@ -401,6 +611,8 @@ eARSTREAM2_ERROR ARSTREAM2_StreamSender_Free(ARSTREAM2_StreamSender_Handle *stre
         ARSTREAM2_StreamStats_RtpLossFileClose(&streamSender->rtpLossCtx);
         free(streamSender->debugPath);
         free(streamSender->friendlyName);
+        free(streamSender->canonicalName);
+        free(streamSender->applicationName);
         free(streamSender->dateAndTime);
         free(streamSender->videoStatsForCb.erroredSecondCountByZone);
         free(streamSender->videoStatsForCb.macroblockStatus);
@@ -504,7 +716,7 @@ eARSTREAM2_ERROR ARSTREAM2_StreamSender_SendNNewNalu(ARSTREAM2_StreamSender_Hand
                 res = ARSTREAM2_H264_NaluFifoEnqueueItem(&streamSender->naluFifo, item);
                 if (res != 0)
                 {
-                    res = ARSTREAM2_H264_NaluFifoPushFreeItem(&streamSender->naluFifo, item);
+                    res = ARSTREAM2_H264_NaluFifoUnpopFreeItem(&streamSender->naluFifo, item);
                     retVal = ARSTREAM2_ERROR_INVALID_STATE;
                     break;
                 }
@@ -516,12 +728,7 @@ eARSTREAM2_ERROR ARSTREAM2_StreamSender_SendNNewNalu(ARSTREAM2_StreamSender_Hand
             }
         }
 
-        if (streamSender->signalPipe[1] != -1)
-        {
-            char * buff = "x";
-            ssize_t err;
-            while (((err = write(streamSender->signalPipe[1], buff, 1)) == -1) && (errno == EINTR));
-        }
+        ARSTREAM2_StreamSender_Signal(streamSender);
     }
 
     return retVal;
@@ -538,32 +745,44 @@ eARSTREAM2_ERROR ARSTREAM2_StreamSender_FlushNaluQueue(ARSTREAM2_StreamSender_Ha
         return ARSTREAM2_ERROR_BAD_PARAMETERS;
     }
 
+    if (streamSender->naluFifoLockFree)
+    {
+        /* Only the sender thread can consume the lock-free FIFO: let it flush */
+        __atomic_store_n(&streamSender->naluFifoFlushPending, 1, __ATOMIC_RELEASE);
+        ARSTREAM2_StreamSender_Signal(streamSender);
+        return ARSTREAM2_OK;
+    }
+
     return ARSTREAM2_RtpSender_FlushNaluQueue(streamSender->sender);
 }
 
 
-void* ARSTREAM2_StreamSender_RunThread(void *streamSenderHandle)
+static void ARSTREAM2_StreamSender_ProcessNaluFifoFlush(ARSTREAM2_StreamSender_t *streamSender)
 {
-    ARSTREAM2_StreamSender_t *streamSender = (ARSTREAM2_StreamSender_t*)streamSenderHandle;
-    int shouldStop, selectRet = 0;
-    fd_set readSet, writeSet, exceptSet;
-    fd_set *pReadSet, *pWriteSet, *pExceptSet;
-    int maxFd = 0;
-    struct timeval tv;
-    uint32_t nextTimeout = 0;
     eARSTREAM2_ERROR err;
 
-    if (!streamSenderHandle)
+    if (__atomic_exchange_n(&streamSender->naluFifoFlushPending, 0, __ATOMIC_ACQ_REL))
     {
-        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_SENDER_TAG, "Invalid handle");
-        return (void*)NULL;
+        err = ARSTREAM2_RtpSender_FlushNaluQueue(streamSender->sender);
+        if (err != ARSTREAM2_OK)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_SENDER_TAG, "ARSTREAM2_RtpSender_FlushNaluQueue() failed (%d)", err);
+        }
     }
+}
 
-    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARSTREAM2_STREAM_SENDER_TAG, "Sender thread running");
-    ARSAL_Mutex_Lock(&(streamSender->threadMutex));
-    streamSender->threadStarted = 1;
-    shouldStop = streamSender->threadShouldStop;
-    ARSAL_Mutex_Unlock(&(streamSender->threadMutex));
+
+static void ARSTREAM2_StreamSender_RunLoopSelect(ARSTREAM2_StreamSender_t *streamSender, int *shouldStop)
+{
+    int selectRet = 0;
+    fd_set readSet, writeSet, exceptSet;
+    fd_set *pReadSet, *pWriteSet, *pExceptSet;
+    int maxFd = 0, _maxFd;
+    int signalFd = ARSTREAM2_StreamSender_GetSignalFd(streamSender);
+    struct timeval tv;
+    uint32_t nextTimeout = 0, _timeout;
+    ARSTREAM2_StreamSender_Destination_t *destination;
+    eARSTREAM2_ERROR err;
 
     FD_ZERO(&readSet);
     FD_ZERO(&writeSet);
@@ -576,19 +795,34 @@ void* ARSTREAM2_StreamSender_RunThread(void *streamSenderHandle)
     if (err != ARSTREAM2_OK)
     {
         ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_SENDER_TAG, "ARSTREAM2_RtpSender_GetSelectParams() failed (%d)", err);
-        return (void *)0;
+        return;
+    }
+
+    ARSAL_Mutex_Lock(&(streamSender->destinationMutex));
+    for (destination = streamSender->destination; destination; destination = destination->next)
+    {
+        err = ARSTREAM2_RtpSender_GetSelectParams(destination->sender, &pReadSet, &pWriteSet, &pExceptSet, &_maxFd, &_timeout);
+        if (err != ARSTREAM2_OK)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_SENDER_TAG, "ARSTREAM2_RtpSender_GetSelectParams() failed (%d)", err);
+            ARSAL_Mutex_Unlock(&(streamSender->destinationMutex));
+            return;
+        }
+        if (_timeout < nextTimeout) nextTimeout = _timeout;
+        if (_maxFd > maxFd) maxFd = _maxFd;
     }
+    ARSAL_Mutex_Unlock(&(streamSender->destinationMutex));
 
     if (pReadSet)
-        FD_SET(streamSender->signalPipe[0], pReadSet);
+        FD_SET(signalFd, pReadSet);
     if (pExceptSet)
-        FD_SET(streamSender->signalPipe[0], pExceptSet);
-    if (streamSender->signalPipe[0] > maxFd) maxFd = streamSender->signalPipe[0];
+        FD_SET(signalFd, pExceptSet);
+    if (signalFd > maxFd) maxFd = signalFd;
     maxFd++;
     tv.tv_sec = 0;
     tv.tv_usec = nextTimeout;
 
-    while (shouldStop == 0)
+    while (*shouldStop == 0)
     {
         if ((pReadSet) && (pWriteSet) && (pExceptSet))
         {
@@ -600,6 +834,15 @@ void* ARSTREAM2_StreamSender_RunThread(void *streamSenderHandle)
             }
         }
 
+        if ((pReadSet) && (selectRet >= 0) && (FD_ISSET(signalFd, pReadSet)))
+        {
+            ARSTREAM2_StreamSender_SignalClear(streamSender);
+        }
+
+        ARSTREAM2_StreamSender_ProcessNaluFifoFlush(streamSender);
+
+        ARSAL_Mutex_Lock(&(streamSender->destinationMutex));
+
         err = ARSTREAM2_RtpSender_ProcessRtcp(streamSender->sender, selectRet, pReadSet, pWriteSet, pExceptSet);
         if (err != ARSTREAM2_OK)
         {
@@ -611,22 +854,29 @@ void* ARSTREAM2_StreamSender_RunThread(void *streamSenderHandle)
             ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_SENDER_TAG, "ARSTREAM2_RtpSender_ProcessRtp() failed (%d)", err);
         }
 
-        if ((pReadSet) && (selectRet >= 0) && (FD_ISSET(streamSender->signalPipe[0], pReadSet)))
+        /* The destinations are processed after the main sender so that the packets fanned out
+         * by ARSTREAM2_RtpSender_ProcessRtp() are sent in the same iteration */
+        for (destination = streamSender->destination; destination; destination = destination->next)
         {
-            /* Dump bytes (so it won't be ready next time) */
-            char dump[10];
-            int readRet = read(streamSender->signalPipe[0], &dump, 10);
-            if (readRet < 0)
+            err = ARSTREAM2_RtpSender_ProcessRtcp(destination->sender, selectRet, pReadSet, pWriteSet, pExceptSet);
+            if (err != ARSTREAM2_OK)
+            {
+                ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_SENDER_TAG, "ARSTREAM2_RtpSender_ProcessRtcp() failed (%d)", err);
+            }
+            err = ARSTREAM2_RtpSender_ProcessRtp(destination->sender, selectRet, pReadSet, pWriteSet, pExceptSet);
+            if (err != ARSTREAM2_OK)
             {
-                ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_SENDER_TAG, "Failed to read from pipe (%d): %s", errno, strerror(errno));
+                ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_SENDER_TAG, "ARSTREAM2_RtpSender_ProcessRtp() failed (%d)", err);
             }
         }
 
+        ARSAL_Mutex_Unlock(&(streamSender->destinationMutex));
+
         ARSAL_Mutex_Lock(&(streamSender->threadMutex));
-        shouldStop = streamSender->threadShouldStop;
+        *shouldStop = streamSender->threadShouldStop;
         ARSAL_Mutex_Unlock(&(streamSender->threadMutex));
 
-        if (!shouldStop)
+        if (!*shouldStop)
         {
             /* Prepare the next select */
             FD_ZERO(&readSet);
@@ -643,16 +893,270 @@ void* ARSTREAM2_StreamSender_RunThread(void *streamSenderHandle)
                 break;
             }
 
+            ARSAL_Mutex_Lock(&(streamSender->destinationMutex));
+            for (destination = streamSender->destination; destination; destination = destination->next)
+            {
+                err = ARSTREAM2_RtpSender_GetSelectParams(destination->sender, &pReadSet, &pWriteSet, &pExceptSet, &_maxFd, &_timeout);
+                if (err != ARSTREAM2_OK)
+                {
+                    ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_SENDER_TAG, "ARSTREAM2_RtpSender_GetSelectParams() failed (%d)", err);
+                    continue;
+                }
+                if (_timeout < nextTimeout) nextTimeout = _timeout;
+                if (_maxFd > maxFd) maxFd = _maxFd;
+            }
+            ARSAL_Mutex_Unlock(&(streamSender->destinationMutex));
+
             if (pReadSet)
-                FD_SET(streamSender->signalPipe[0], pReadSet);
+                FD_SET(signalFd, pReadSet);
             if (pExceptSet)
-                FD_SET(streamSender->signalPipe[0], pExceptSet);
-            if (streamSender->signalPipe[0] > maxFd) maxFd = streamSender->signalPipe[0];
+                FD_SET(signalFd, pExceptSet);
+            if (signalFd > maxFd) maxFd = signalFd;
             maxFd++;
             tv.tv_sec = 0;
             tv.tv_usec = nextTimeout;
         }
     }
+}
+
+
+#ifdef HAS_EPOLL
+
+/* WARNING: must be called with the destinationMutex held */
+static void ARSTREAM2_StreamSender_EpollUpdateDestinations(ARSTREAM2_StreamSender_t *streamSender, int epollFd, uint32_t *nextTimeout)
+{
+    ARSTREAM2_StreamSender_Destination_t *destination;
+    struct epoll_event ev;
+    int streamFd = -1, controlFd = -1, writePending = 0;
+    uint32_t _timeout = 0;
+    eARSTREAM2_ERROR err;
+
+    for (destination = streamSender->destination; destination; destination = destination->next)
+    {
+        err = ARSTREAM2_RtpSender_GetPollParams(destination->sender, &streamFd, &controlFd, &writePending, &_timeout);
+        if (err != ARSTREAM2_OK)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_SENDER_TAG, "ARSTREAM2_RtpSender_GetPollParams() failed (%d)", err);
+            continue;
+        }
+        if (_timeout < *nextTimeout) *nextTimeout = _timeout;
+
+        if (!destination->pollRegistered)
+        {
+            /* New destination: register its sockets once (they are automatically
+             * removed from the epoll set when closed on destination stop) */
+            memset(&ev, 0, sizeof(ev));
+            ev.events = EPOLLIN | EPOLLET;
+            ev.data.fd = controlFd;
+            if (epoll_ctl(epollFd, EPOLL_CTL_ADD, controlFd, &ev) != 0)
+            {
+                ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_SENDER_TAG, "Failed to add destination control socket to epoll (%d): %s", errno, strerror(errno));
+            }
+            ev.events = ((writePending) ? EPOLLOUT : 0) | EPOLLET;
+            ev.data.fd = streamFd;
+            if (epoll_ctl(epollFd, EPOLL_CTL_ADD, streamFd, &ev) != 0)
+            {
+                ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_SENDER_TAG, "Failed to add destination stream socket to epoll (%d): %s", errno, strerror(errno));
+            }
+            destination->pollRegistered = 1;
+            destination->pollWritePending = writePending;
+        }
+        else if (writePending != destination->pollWritePending)
+        {
+            /* Only watch for writability while packets are pending */
+            memset(&ev, 0, sizeof(ev));
+            ev.events = ((writePending) ? EPOLLOUT : 0) | EPOLLET;
+            ev.data.fd = streamFd;
+            if (epoll_ctl(epollFd, EPOLL_CTL_MOD, streamFd, &ev) != 0)
+            {
+                ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_SENDER_TAG, "Failed to modify destination stream socket in epoll (%d): %s", errno, strerror(errno));
+            }
+            destination->pollWritePending = writePending;
+        }
+    }
+}
+
+
+static int ARSTREAM2_StreamSender_RunLoopEpoll(ARSTREAM2_StreamSender_t *streamSender, int *shouldStop)
+{
+    struct epoll_event ev, events[ARSTREAM2_STREAM_SENDER_EPOLL_MAX_EVENTS];
+    int epollFd = -1, streamFd = -1, controlFd = -1;
+    int writePending = 0, pollWritePending = 0, eventCount, timeoutMs, i, ret = 0;
+    fd_set readSet, writeSet, exceptSet;
+    uint32_t nextTimeout = 0;
+    ARSTREAM2_StreamSender_Destination_t *destination;
+    eARSTREAM2_ERROR err;
+
+    err = ARSTREAM2_RtpSender_GetPollParams(streamSender->sender, &streamFd, &controlFd, &pollWritePending, NULL);
+    if ((err != ARSTREAM2_OK) || (controlFd < 0) || (streamSender->signalEventFd < 0))
+    {
+        return -1;
+    }
+
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd < 0)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_SENDER_TAG, "epoll_create1() failed (%d): %s", errno, strerror(errno));
+        return -1;
+    }
+
+    /* Sockets are registered once, edge-triggered; the control socket is always
+     * drained by ARSTREAM2_RtpSender_ProcessRtcp() and the stream socket is only
+     * watched for writability while packets are pending (there is no stream
+     * socket with the shared memory transport, which never blocks) */
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN | EPOLLET;
+    ev.data.fd = controlFd;
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, controlFd, &ev) != 0) ret = -1;
+    ev.events = ((pollWritePending) ? EPOLLOUT : 0) | EPOLLET;
+    ev.data.fd = streamFd;
+    if ((ret == 0) && (streamFd >= 0) && (epoll_ctl(epollFd, EPOLL_CTL_ADD, streamFd, &ev) != 0)) ret = -1;
+    ev.events = EPOLLIN | EPOLLET;
+    ev.data.fd = streamSender->signalEventFd;
+    if ((ret == 0) && (epoll_ctl(epollFd, EPOLL_CTL_ADD, streamSender->signalEventFd, &ev) != 0)) ret = -1;
+    if (ret != 0)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_SENDER_TAG, "epoll_ctl() failed (%d): %s", errno, strerror(errno));
+        close(epollFd);
+        return ret;
+    }
+
+    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARSTREAM2_STREAM_SENDER_TAG, "Using epoll sender loop");
+
+    while (*shouldStop == 0)
+    {
+        err = ARSTREAM2_RtpSender_GetPollParams(streamSender->sender, NULL, NULL, &writePending, &nextTimeout);
+        if (err != ARSTREAM2_OK)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_SENDER_TAG, "ARSTREAM2_RtpSender_GetPollParams() failed (%d)", err);
+            break;
+        }
+        if ((writePending != pollWritePending) && (streamFd >= 0))
+        {
+            memset(&ev, 0, sizeof(ev));
+            ev.events = ((writePending) ? EPOLLOUT : 0) | EPOLLET;
+            ev.data.fd = streamFd;
+            if (epoll_ctl(epollFd, EPOLL_CTL_MOD, streamFd, &ev) != 0)
+            {
+                ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_SENDER_TAG, "Failed to modify stream socket in epoll (%d): %s", errno, strerror(errno));
+            }
+            pollWritePending = writePending;
+        }
+
+        /* Update the timer and the destinations registration */
+        ARSAL_Mutex_Lock(&(streamSender->destinationMutex));
+        ARSTREAM2_StreamSender_EpollUpdateDestinations(streamSender, epollFd, &nextTimeout);
+        ARSAL_Mutex_Unlock(&(streamSender->destinationMutex));
+
+        /* Round up to the next millisecond so that the deadline is not missed */
+        timeoutMs = (int)((nextTimeout + 999) / 1000);
+        while (((eventCount = epoll_wait(epollFd, events, ARSTREAM2_STREAM_SENDER_EPOLL_MAX_EVENTS, timeoutMs)) == -1) && (errno == EINTR));
+        if (eventCount < 0)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_SENDER_TAG, "epoll_wait error (%d): %s", errno, strerror(errno));
+            break;
+        }
+
+        /* Translate the events to fd_sets for the Process functions */
+        FD_ZERO(&readSet);
+        FD_ZERO(&writeSet);
+        FD_ZERO(&exceptSet);
+        for (i = 0; i < eventCount; i++)
+        {
+            int fd = events[i].data.fd;
+            if (fd == streamSender->signalEventFd)
+            {
+                ARSTREAM2_StreamSender_SignalClear(streamSender);
+            }
+            else
+            {
+                /* Socket errors are read like with select() */
+                if (events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP)) FD_SET(fd, &readSet);
+                if (events[i].events & EPOLLOUT) FD_SET(fd, &writeSet);
+                if (events[i].events & EPOLLPRI) FD_SET(fd, &exceptSet);
+            }
+        }
+
+        ARSTREAM2_StreamSender_ProcessNaluFifoFlush(streamSender);
+
+        ARSAL_Mutex_Lock(&(streamSender->destinationMutex));
+
+        err = ARSTREAM2_RtpSender_ProcessRtcp(streamSender->sender, eventCount, &readSet, &writeSet, &exceptSet);
+        if (err != ARSTREAM2_OK)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_SENDER_TAG, "ARSTREAM2_RtpSender_ProcessRtcp() failed (%d)", err);
+        }
+        err = ARSTREAM2_RtpSender_ProcessRtp(streamSender->sender, eventCount, &readSet, &writeSet, &exceptSet);
+        if (err != ARSTREAM2_OK)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_SENDER_TAG, "ARSTREAM2_RtpSender_ProcessRtp() failed (%d)", err);
+        }
+
+        for (destination = streamSender->destination; destination; destination = destination->next)
+        {
+            err = ARSTREAM2_RtpSender_ProcessRtcp(destination->sender, eventCount, &readSet, &writeSet, &exceptSet);
+            if (err != ARSTREAM2_OK)
+            {
+                ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_SENDER_TAG, "ARSTREAM2_RtpSender_ProcessRtcp() failed (%d)", err);
+            }
+            err = ARSTREAM2_RtpSender_ProcessRtp(destination->sender, eventCount, &readSet, &writeSet, &exceptSet);
+            if (err != ARSTREAM2_OK)
+            {
+                ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_SENDER_TAG, "ARSTREAM2_RtpSender_ProcessRtp() failed (%d)", err);
+            }
+        }
+
+        ARSAL_Mutex_Unlock(&(streamSender->destinationMutex));
+
+        ARSAL_Mutex_Lock(&(streamSender->threadMutex));
+        *shouldStop = streamSender->threadShouldStop;
+        ARSAL_Mutex_Unlock(&(streamSender->threadMutex));
+    }
+
+    close(epollFd);
+
+    /* Destinations started after this point will register again in a new loop */
+    ARSAL_Mutex_Lock(&(streamSender->destinationMutex));
+    for (destination = streamSender->destination; destination; destination = destination->next)
+    {
+        destination->pollRegistered = 0;
+        destination->pollWritePending = 0;
+    }
+    ARSAL_Mutex_Unlock(&(streamSender->destinationMutex));
+
+    return 0;
+}
+
+#endif /* #ifdef HAS_EPOLL */
+
+
+void* ARSTREAM2_StreamSender_RunThread(void *streamSenderHandle)
+{
+    ARSTREAM2_StreamSender_t *streamSender = (ARSTREAM2_StreamSender_t*)streamSenderHandle;
+    int shouldStop;
+    eARSTREAM2_ERROR err;
+
+    if (!streamSenderHandle)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_SENDER_TAG, "Invalid handle");
+        return (void*)NULL;
+    }
+
+    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARSTREAM2_STREAM_SENDER_TAG, "Sender thread running");
+    ARSAL_Mutex_Lock(&(streamSender->threadMutex));
+    streamSender->threadStarted = 1;
+    shouldStop = streamSender->threadShouldStop;
+    ARSAL_Mutex_Unlock(&(streamSender->threadMutex));
+
+#ifdef HAS_EPOLL
+    if (ARSTREAM2_StreamSender_RunLoopEpoll(streamSender, &shouldStop) != 0)
+    {
+        /* epoll is not available: fallback to select */
+        ARSTREAM2_StreamSender_RunLoopSelect(streamSender, &shouldStop);
+    }
+#else
+    ARSTREAM2_StreamSender_RunLoopSelect(streamSender, &shouldStop);
+#endif
 
     ARSAL_Mutex_Lock(&(streamSender->threadMutex));
     streamSender->threadStarted = 0;
@@ -711,6 +1215,14 @@ eARSTREAM2_ERROR ARSTREAM2_StreamSender_GetDynamicConfig(ARSTREAM2_StreamSender_
         }
     }
 
+    ARSTREAM2_RtpSender_DynamicConfig_t senderConfig;
+    memset(&senderConfig, 0, sizeof(senderConfig));
+    ret = ARSTREAM2_RtpSender_GetDynamicConfig(streamSender->sender, &senderConfig);
+    config->fecGroupSize = senderConfig.fecGroupSize;
+    config->fecRowCount = senderConfig.fecRowCount;
+    config->fecImportanceLevelCount = senderConfig.fecImportanceLevelCount;
+    config->pacingWindowPercent = senderConfig.pacingWindowPercent;
+
     return ret;
 }
 
@@ -765,6 +1277,10 @@ eARSTREAM2_ERROR ARSTREAM2_StreamSender_SetDynamicConfig(ARSTREAM2_StreamSender_
     senderConfig.targetPacketSize = streamSender->targetPacketSize;
     senderConfig.streamSocketSendBufferSize = streamSender->streamSocketSendBufferSize;
     senderConfig.maxBitrate = streamSender->maxBitrate;
+    senderConfig.fecGroupSize = config->fecGroupSize;
+    senderConfig.fecRowCount = config->fecRowCount;
+    senderConfig.fecImportanceLevelCount = config->fecImportanceLevelCount;
+    senderConfig.pacingWindowPercent = config->pacingWindowPercent;
 
     return ARSTREAM2_RtpSender_SetDynamicConfig(streamSender->sender, &senderConfig);
 }
@@ -1458,6 +1974,220 @@ eARSTREAM2_ERROR ARSTREAM2_StreamSender_GetMonitoring(ARSTREAM2_StreamSender_Han
 }
 
 
+eARSTREAM2_ERROR ARSTREAM2_StreamSender_StartDestination(ARSTREAM2_StreamSender_Handle streamSenderHandle,
+                                                         ARSTREAM2_StreamSender_DestinationHandle *destinationHandle,
+                                                         const ARSTREAM2_StreamSender_DestinationConfig_t *config)
+{
+    ARSTREAM2_StreamSender_t *streamSender = (ARSTREAM2_StreamSender_t*)streamSenderHandle;
+    ARSTREAM2_StreamSender_Destination_t *destination = NULL;
+    int packetFifoQueueCreated = 0;
+    eARSTREAM2_ERROR ret = ARSTREAM2_OK;
+
+    if (!streamSenderHandle)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_SENDER_TAG, "Invalid handle");
+        return ARSTREAM2_ERROR_BAD_PARAMETERS;
+    }
+    if (!destinationHandle)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_SENDER_TAG, "Invalid pointer for destination");
+        return ARSTREAM2_ERROR_BAD_PARAMETERS;
+    }
+    if (!config)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_SENDER_TAG, "Invalid pointer for config");
+        return ARSTREAM2_ERROR_BAD_PARAMETERS;
+    }
+
+    destination = (ARSTREAM2_StreamSender_Destination_t*)malloc(sizeof(*destination));
+    if (!destination)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_SENDER_TAG, "Allocation failed (size %zu)", sizeof(*destination));
+        ret = ARSTREAM2_ERROR_ALLOC;
+    }
+
+    if (ret == ARSTREAM2_OK)
+    {
+        memset(destination, 0, sizeof(*destination));
+    }
+
+    ARSAL_Mutex_Lock(&(streamSender->destinationMutex));
+
+    if ((ret == ARSTREAM2_OK) && (streamSender->destinationCount >= streamSender->maxDestinationCount))
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_SENDER_TAG, "Maximum destination count reached (%d)", streamSender->maxDestinationCount);
+        ret = ARSTREAM2_ERROR_RESOURCE_UNAVAILABLE;
+    }
+
+    if (ret == ARSTREAM2_OK)
+    {
+        int packetFifoRet = ARSTREAM2_RTP_PacketFifoAddQueue(&streamSender->packetFifo, &destination->packetFifoQueue);
+        if (packetFifoRet != 0)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_SENDER_TAG, "ARSTREAM2_RTP_PacketFifoAddQueue() failed (%d)", packetFifoRet);
+            ret = ARSTREAM2_ERROR_ALLOC;
+        }
+        else
+        {
+            packetFifoQueueCreated = 1;
+            packetFifoRet = ARSTREAM2_RTP_PacketFifoQueueEnableTimeoutHeap(&destination->packetFifoQueue, streamSender->packetFifo.itemPoolSize);
+            if (packetFifoRet != 0)
+            {
+                ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_SENDER_TAG, "ARSTREAM2_RTP_PacketFifoQueueEnableTimeoutHeap() failed (%d)", packetFifoRet);
+                ret = ARSTREAM2_ERROR_ALLOC;
+            }
+        }
+    }
+
+    if (ret == ARSTREAM2_OK)
+    {
+        ARSTREAM2_RtpSender_Config_t senderConfig;
+        memset(&senderConfig, 0, sizeof(senderConfig));
+        senderConfig.canonicalName = streamSender->canonicalName;
+        senderConfig.friendlyName = streamSender->friendlyName;
+        senderConfig.applicationName = streamSender->applicationName;
+        senderConfig.clientAddr = config->clientAddr;
+        senderConfig.mcastAddr = config->mcastAddr;
+        senderConfig.mcastIfaceAddr = config->mcastIfaceAddr;
+        senderConfig.serverStreamPort = config->serverStreamPort;
+        senderConfig.serverControlPort = config->serverControlPort;
+        senderConfig.clientStreamPort = config->clientStreamPort;
+        senderConfig.clientControlPort = config->clientControlPort;
+        senderConfig.classSelector = config->classSelector;
+        senderConfig.streamSocketSendBufferSize = (config->streamSocketBufferSize > 0) ? config->streamSocketBufferSize : streamSender->streamSocketSendBufferSize;
+        senderConfig.maxPacketSize = streamSender->maxPacketSize;
+        senderConfig.naluFifo = NULL;
+        senderConfig.packetFifo = &streamSender->packetFifo;
+        senderConfig.packetFifoQueue = &destination->packetFifoQueue;
+        senderConfig.useRtcpNack = config->useRtcpNack;
+        senderConfig.debugPath = streamSender->debugPath;
+        senderConfig.dateAndTime = streamSender->dateAndTime;
+
+        destination->sender = ARSTREAM2_RtpSender_New(&senderConfig, &ret);
+        if (ret != ARSTREAM2_OK)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_SENDER_TAG, "Error while creating sender : %s", ARSTREAM2_Error_ToString(ret));
+        }
+    }
+
+    if (ret == ARSTREAM2_OK)
+    {
+        uint32_t maxNetworkLatencyUs[ARSTREAM2_STREAM_SENDER_MAX_IMPORTANCE_LEVELS];
+        int i;
+        for (i = 0; i < ARSTREAM2_STREAM_SENDER_MAX_IMPORTANCE_LEVELS; i++)
+        {
+            maxNetworkLatencyUs[i] = (config->maxNetworkLatencyMs[i] > 0) ? (uint32_t)config->maxNetworkLatencyMs[i] * 1000 : 0;
+        }
+        ret = ARSTREAM2_RtpSender_AddFanOutDestination(streamSender->sender, destination->sender,
+                                                       (config->maxLatencyMs > 0) ? (uint32_t)config->maxLatencyMs * 1000 : 0,
+                                                       maxNetworkLatencyUs);
+        if (ret != ARSTREAM2_OK)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_SENDER_TAG, "ARSTREAM2_RtpSender_AddFanOutDestination() failed (%d)", ret);
+        }
+    }
+
+    if (ret == ARSTREAM2_OK)
+    {
+        destination->prev = NULL;
+        destination->next = streamSender->destination;
+        if (destination->next)
+        {
+            destination->next->prev = destination;
+        }
+        streamSender->destination = destination;
+        streamSender->destinationCount++;
+        *destinationHandle = destination;
+    }
+    else
+    {
+        if (destination)
+        {
+            if (destination->sender) ARSTREAM2_RtpSender_Delete(&(destination->sender));
+            if (packetFifoQueueCreated) ARSTREAM2_RTP_PacketFifoRemoveQueue(&streamSender->packetFifo, &destination->packetFifoQueue);
+            free(destination);
+        }
+        *destinationHandle = NULL;
+    }
+
+    ARSAL_Mutex_Unlock(&(streamSender->destinationMutex));
+
+    if (ret == ARSTREAM2_OK)
+    {
+        /* wake up the thread to register the destination sockets */
+        ARSTREAM2_StreamSender_Signal(streamSender);
+    }
+
+    return ret;
+}
+
+
+eARSTREAM2_ERROR ARSTREAM2_StreamSender_StopDestination(ARSTREAM2_StreamSender_Handle streamSenderHandle,
+                                                        ARSTREAM2_StreamSender_DestinationHandle *destinationHandle)
+{
+    ARSTREAM2_StreamSender_t *streamSender = (ARSTREAM2_StreamSender_t*)streamSenderHandle;
+    ARSTREAM2_StreamSender_Destination_t *destination;
+    eARSTREAM2_ERROR ret = ARSTREAM2_OK;
+
+    if (!streamSenderHandle)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_SENDER_TAG, "Invalid handle");
+        return ARSTREAM2_ERROR_BAD_PARAMETERS;
+    }
+    if ((!destinationHandle) || (!*destinationHandle))
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_SENDER_TAG, "Invalid pointer for destination");
+        return ARSTREAM2_ERROR_BAD_PARAMETERS;
+    }
+
+    destination = (ARSTREAM2_StreamSender_Destination_t*)*destinationHandle;
+
+    ARSAL_Mutex_Lock(&(streamSender->destinationMutex));
+
+    ret = ARSTREAM2_RtpSender_RemoveFanOutDestination(streamSender->sender, destination->sender);
+    if (ret != ARSTREAM2_OK)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_SENDER_TAG, "ARSTREAM2_RtpSender_RemoveFanOutDestination() failed (%d)", ret);
+        ARSAL_Mutex_Unlock(&(streamSender->destinationMutex));
+        return ret;
+    }
+
+    ret = ARSTREAM2_RtpSender_ProcessEnd(destination->sender, 1);
+    if (ret != ARSTREAM2_OK)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_SENDER_TAG, "ARSTREAM2_RtpSender_ProcessEnd() failed (%d)", ret);
+    }
+    ARSTREAM2_RTP_PacketFifoRemoveQueue(&streamSender->packetFifo, &destination->packetFifoQueue);
+
+    ret = ARSTREAM2_RtpSender_Delete(&destination->sender);
+    if (ret != ARSTREAM2_OK)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSTREAM2_STREAM_SENDER_TAG, "Unable to delete destination sender: %s", ARSTREAM2_Error_ToString(ret));
+    }
+
+    if (destination->prev)
+    {
+        destination->prev->next = destination->next;
+    }
+    if (destination->next)
+    {
+        destination->next->prev = destination->prev;
+    }
+    if (destination == streamSender->destination)
+    {
+        streamSender->destination = destination->next;
+    }
+    streamSender->destinationCount--;
+
+    ARSAL_Mutex_Unlock(&(streamSender->destinationMutex));
+
+    free(destination);
+    *destinationHandle = NULL;
+
+    return ret;
+}
+
+
 static void ARSTREAM2_StreamSender_RtpStatsCallback(const ARSTREAM2_RTP_RtpStats_t *rtpStats, void *userPtr)
 {
     ARSTREAM2_StreamSender_t *streamSender = (ARSTREAM2_StreamSender_t*)userPtr;
@@ -1499,6 +2229,11 @@ static void ARSTREAM2_StreamSender_RtpStatsCallback(const ARSTREAM2_RTP_RtpStats
             rtpsOut.senderStats.inputToSentTimeIntegralSq = rtpStats->senderStats.inputToSentTimeIntegralSq;
             rtpsOut.senderStats.inputToDroppedTimeIntegral = rtpStats->senderStats.inputToDroppedTimeIntegral;
             rtpsOut.senderStats.inputToDroppedTimeIntegralSq = rtpStats->senderStats.inputToDroppedTimeIntegralSq;
+            rtpsOut.senderStats.pacedPacketCount = rtpStats->senderStats.pacedPacketCount;
+            rtpsOut.senderStats.pacingDelayIntegral = rtpStats->senderStats.pacingDelayIntegral;
+            rtpsOut.senderStats.pacingDelayIntegralSq = rtpStats->senderStats.pacingDelayIntegralSq;
+            rtpsOut.senderStats.fecRepairPacketCount = rtpStats->senderStats.fecRepairPacketCount;
+            rtpsOut.senderStats.fecUnprotectedPacketCount = rtpStats->senderStats.fecUnprotectedPacketCount;
             rtpsOut.senderReport.timestamp = rtpStats->senderReport.timestamp;
             rtpsOut.senderReport.lastInterval = rtpStats->senderReport.lastInterval;
             rtpsOut.senderReport.intervalPacketCount = rtpStats->senderReport.intervalPacketCount;
@@ -0,0 +1,287 @@
+/**
+ * @file arstream2_clock_skew_bench.c
+ * @brief Parrot Streaming Library - Receiver clock skew estimation benchmark
+ * @date 10/16/2026
+ * @author aurelien.barre@parrot.com
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <getopt.h>
+
+#include <libARSAL/ARSAL_Print.h>
+#include <libARSAL/ARSAL_Time.h>
+
+#include "arstream2_rtp.h"
+
+
+#define TAG "ARSTREAM2_ClockSkew_Bench"
+
+#define CLOCK_SKEW_BENCH_DEFAULT_SAMPLE_COUNT (2000000)
+#define CLOCK_SKEW_BENCH_DEFAULT_SAMPLE_RATE (30)
+#define CLOCK_SKEW_BENCH_DEFAULT_DRIFT_PPM (50)
+#define CLOCK_SKEW_BENCH_DEFAULT_JITTER_US (20000)
+#define CLOCK_SKEW_BENCH_RTP_CLOCK_RATE (90000)
+#define CLOCK_SKEW_BENCH_WARMUP_US (120000000)
+
+/* Previous estimator: tumbling window of up to 400 samples, rescanned for its minimum when full
+   or when half full and older than 5 seconds */
+#define CLOCK_SKEW_BENCH_TUMBLING_WINDOW_SIZE (400)
+#define CLOCK_SKEW_BENCH_TUMBLING_WINDOW_TIMEOUT (5000000)
+#define CLOCK_SKEW_BENCH_TUMBLING_AVG_ALPHA (64)
+
+
+typedef struct
+{
+    int64_t window[CLOCK_SKEW_BENCH_TUMBLING_WINDOW_SIZE];
+    int windowSize;
+    uint64_t windowStartTimestamp;
+    int init;
+    int64_t offset;
+    int64_t minAvg;
+    int64_t clockSkew;
+
+} ClockSkewBench_Tumbling_t;
+
+
+typedef struct
+{
+    uint64_t *timestamp;
+    int64_t *sample;
+    int64_t *expected;
+    int sampleCount;
+
+} ClockSkewBench_Input_t;
+
+
+static uint64_t ClockSkewBench_GetTime(void)
+{
+    struct timespec t;
+    ARSAL_Time_GetTime(&t);
+    return (uint64_t)t.tv_sec * 1000000 + (uint64_t)t.tv_nsec / 1000;
+}
+
+
+static void ClockSkewBench_TumblingAddSample(ClockSkewBench_Tumbling_t *ctx, int64_t clockSkew, uint64_t curTime)
+{
+    int64_t clockSkewMin;
+    int i;
+
+    if (ctx->windowSize == 0)
+    {
+        ctx->windowStartTimestamp = curTime;
+    }
+    ctx->window[ctx->windowSize++] = clockSkew;
+
+    if ((ctx->windowSize < CLOCK_SKEW_BENCH_TUMBLING_WINDOW_SIZE)
+            && ((ctx->windowSize < CLOCK_SKEW_BENCH_TUMBLING_WINDOW_SIZE / 2) || (curTime < ctx->windowStartTimestamp + CLOCK_SKEW_BENCH_TUMBLING_WINDOW_TIMEOUT)))
+    {
+        return;
+    }
+
+    clockSkewMin = ctx->window[0];
+    for (i = 0; i < ctx->windowSize; i++)
+    {
+        if (ctx->window[i] < clockSkewMin)
+        {
+            clockSkewMin = ctx->window[i];
+        }
+    }
+
+    if (!ctx->init)
+    {
+        ctx->offset = clockSkewMin;
+        ctx->minAvg = 0;
+        ctx->init = 1;
+    }
+    else
+    {
+        ctx->minAvg = ctx->minAvg + (clockSkewMin - ctx->offset - ctx->minAvg + CLOCK_SKEW_BENCH_TUMBLING_AVG_ALPHA / 2) / CLOCK_SKEW_BENCH_TUMBLING_AVG_ALPHA;
+    }
+    ctx->clockSkew = (ctx->minAvg * 1000000 + CLOCK_SKEW_BENCH_RTP_CLOCK_RATE / 2) / CLOCK_SKEW_BENCH_RTP_CLOCK_RATE;
+    ctx->windowSize = 0;
+}
+
+
+/* Synthetic receive timestamps: constant clock drift plus a one-sided network jitter */
+static int ClockSkewBench_GenerateInput(ClockSkewBench_Input_t *input, int sampleCount, int sampleRate, int driftPpm, int jitterUs)
+{
+    uint64_t curTime = 1000000;
+    int i;
+
+    input->timestamp = malloc(sampleCount * sizeof(uint64_t));
+    input->sample = malloc(sampleCount * sizeof(int64_t));
+    input->expected = malloc(sampleCount * sizeof(int64_t));
+    if ((!input->timestamp) || (!input->sample) || (!input->expected))
+    {
+        return -1;
+    }
+    input->sampleCount = sampleCount;
+
+    srand(1);
+    for (i = 0; i < sampleCount; i++)
+    {
+        int64_t elapsed = (int64_t)curTime - 1000000;
+        int64_t jitter = (jitterUs > 0) ? (int64_t)(rand() % jitterUs) : 0;
+        input->expected[i] = elapsed * driftPpm / 1000000;
+        input->timestamp[i] = curTime;
+        input->sample[i] = (input->expected[i] + jitter) * CLOCK_SKEW_BENCH_RTP_CLOCK_RATE / 1000000;
+        curTime += 1000000 / sampleRate;
+    }
+
+    return 0;
+}
+
+
+static void ClockSkewBench_TumblingReset(void *estimator)
+{
+    memset(estimator, 0, sizeof(ClockSkewBench_Tumbling_t));
+}
+
+
+static void ClockSkewBench_TumblingAdd(void *estimator, int64_t clockSkew, uint64_t curTime)
+{
+    ClockSkewBench_TumblingAddSample((ClockSkewBench_Tumbling_t*)estimator, clockSkew, curTime);
+}
+
+
+static int64_t ClockSkewBench_TumblingGet(void *estimator)
+{
+    return ((ClockSkewBench_Tumbling_t*)estimator)->clockSkew;
+}
+
+
+static void ClockSkewBench_SlidingReset(void *estimator)
+{
+    memset(estimator, 0, sizeof(ARSTREAM2_RTP_ReceiverContext_t));
+    ((ARSTREAM2_RTP_ReceiverContext_t*)estimator)->rtpClockRate = CLOCK_SKEW_BENCH_RTP_CLOCK_RATE;
+}
+
+
+static void ClockSkewBench_SlidingAdd(void *estimator, int64_t clockSkew, uint64_t curTime)
+{
+    ARSTREAM2_RTP_Receiver_ClockSkewAddSample((ARSTREAM2_RTP_ReceiverContext_t*)estimator, clockSkew, curTime);
+}
+
+
+static int64_t ClockSkewBench_SlidingGet(void *estimator)
+{
+    return ((ARSTREAM2_RTP_ReceiverContext_t*)estimator)->clockSkew;
+}
+
+
+static void ClockSkewBench_Run(const char *name, const ClockSkewBench_Input_t *input, void *estimator,
+                               void (*reset)(void*), void (*add)(void*, int64_t, uint64_t), int64_t (*get)(void*))
+{
+    uint64_t startTime, endTime;
+    int64_t error, maxError = 0;
+    double errorSum = 0.;
+    int i, errorCount = 0;
+
+    /* Per-sample cost */
+    reset(estimator);
+    startTime = ClockSkewBench_GetTime();
+    for (i = 0; i < input->sampleCount; i++)
+    {
+        add(estimator, input->sample[i], input->timestamp[i]);
+    }
+    endTime = ClockSkewBench_GetTime();
+
+    /* Accuracy: distance between the estimated and the actual clock skew after warm-up */
+    reset(estimator);
+    for (i = 0; i < input->sampleCount; i++)
+    {
+        add(estimator, input->sample[i], input->timestamp[i]);
+        if (input->timestamp[i] >= input->timestamp[0] + CLOCK_SKEW_BENCH_WARMUP_US)
+        {
+            error = llabs(get(estimator) - input->expected[i]);
+            if (error > maxError) maxError = error;
+            errorSum += error;
+            errorCount++;
+        }
+    }
+
+    printf("%-10s %d samples in %llu us: %.1f ns/sample, error after warm-up: mean %.1f us, max %lld us\n",
+           name, input->sampleCount, (unsigned long long)(endTime - startTime),
+           (double)(endTime - startTime) * 1000. / input->sampleCount,
+           (errorCount > 0) ? errorSum / errorCount : 0., (long long)maxError);
+}
+
+
+static void usage(const char *progName)
+{
+    printf("Usage: %s [-n <sample count>] [-r <samples per second>] [-d <clock drift in ppm>] [-j <max jitter in us>]\n", progName);
+}
+
+
+int main(int argc, char *argv[])
+{
+    ClockSkewBench_Input_t input;
+    int sampleCount = CLOCK_SKEW_BENCH_DEFAULT_SAMPLE_COUNT;
+    int sampleRate = CLOCK_SKEW_BENCH_DEFAULT_SAMPLE_RATE;
+    int driftPpm = CLOCK_SKEW_BENCH_DEFAULT_DRIFT_PPM;
+    int jitterUs = CLOCK_SKEW_BENCH_DEFAULT_JITTER_US;
+    int c, ret;
+
+    while ((c = getopt(argc, argv, "hn:r:d:j:")) != -1)
+    {
+        switch (c)
+        {
+            case 'n':
+                sampleCount = atoi(optarg);
+                break;
+            case 'r':
+                sampleRate = atoi(optarg);
+                break;
+            case 'd':
+                driftPpm = atoi(optarg);
+                break;
+            case 'j':
+                jitterUs = atoi(optarg);
+                break;
+            case 'h':
+            default:
+                usage(argv[0]);
+                return (c == 'h') ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    if ((sampleCount <= 0) || (sampleRate <= 0) || (sampleRate > 1000000) || (jitterUs < 0))
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    memset(&input, 0, sizeof(input));
+    if (ClockSkewBench_GenerateInput(&input, sampleCount, sampleRate, driftPpm, jitterUs) != 0)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, TAG, "Memory allocation failed");
+        ret = -1;
+    }
+    else
+    {
+        ClockSkewBench_Tumbling_t *tumbling = malloc(sizeof(ClockSkewBench_Tumbling_t));
+        ARSTREAM2_RTP_ReceiverContext_t *sliding = malloc(sizeof(ARSTREAM2_RTP_ReceiverContext_t));
+        if ((!tumbling) || (!sliding))
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, TAG, "Memory allocation failed");
+            ret = -1;
+        }
+        else
+        {
+            ClockSkewBench_Run("tumbling", &input, tumbling, ClockSkewBench_TumblingReset, ClockSkewBench_TumblingAdd, ClockSkewBench_TumblingGet);
+            ClockSkewBench_Run("sliding", &input, sliding, ClockSkewBench_SlidingReset, ClockSkewBench_SlidingAdd, ClockSkewBench_SlidingGet);
+            printf("%-10s %u samples dropped (deque full)\n", "sliding", sliding->clockSkewWindowDropCount);
+            ret = 0;
+        }
+        free(tumbling);
+        free(sliding);
+    }
+
+    free(input.timestamp);
+    free(input.sample);
+    free(input.expected);
+
+    return (ret == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,202 @@
+/**
+ * @file arstream2_nalu_fifo_bench.c
+ * @brief Parrot Streaming Library - NAL unit FIFO contention benchmark
+ * @date 10/16/2026
+ * @author aurelien.barre@parrot.com
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <getopt.h>
+#include <sched.h>
+#include <unistd.h>
+
+#include <libARSAL/ARSAL_Print.h>
+#include <libARSAL/ARSAL_Thread.h>
+#include <libARSAL/ARSAL_Time.h>
+
+#include "arstream2_h264.h"
+
+
+/* The benchmark runs the encoder thread (producer) and the sender thread (consumer) sides of the
+   sender NAL unit FIFO concurrently, first with the mutex FIFO then with the lock-free SPSC FIFO,
+   and reports the wall clock time per NAL unit together with the number of times each side found
+   the FIFO full or empty. It measures the cost of the FIFO synchronization under contention: the
+   two threads must run on separate cores for the results to be meaningful. */
+
+#define TAG "ARSTREAM2_NaluFifo_Bench"
+
+#define NALU_FIFO_BENCH_DEFAULT_NALU_COUNT (2000000)
+#define NALU_FIFO_BENCH_DEFAULT_FIFO_SIZE (1024)
+
+
+typedef struct
+{
+    ARSTREAM2_H264_NaluFifo_t fifo;
+    int naluCount;
+    int fifoSize;
+    int consumedCount;
+    uint64_t producerFullCount;
+    uint64_t consumerEmptyCount;
+    uint64_t checksum;
+
+} NaluFifoBench_Context_t;
+
+
+static uint64_t NaluFifoBench_GetTime(void)
+{
+    struct timespec t;
+    ARSAL_Time_GetTime(&t);
+    return (uint64_t)t.tv_sec * 1000000 + (uint64_t)t.tv_nsec / 1000;
+}
+
+
+/* Encoder thread side: ARSTREAM2_StreamSender_SendNNewNalu() */
+static void* NaluFifoBench_Producer(void *userPtr)
+{
+    NaluFifoBench_Context_t *ctx = (NaluFifoBench_Context_t*)userPtr;
+    ARSTREAM2_H264_NaluFifoItem_t *item;
+    int i;
+
+    for (i = 0; i < ctx->naluCount; )
+    {
+        /* Do not overflow the FIFO (the FIFO logs an error when full) */
+        if (i - __atomic_load_n(&ctx->consumedCount, __ATOMIC_RELAXED) >= ctx->fifoSize)
+        {
+            ctx->producerFullCount++;
+            sched_yield();
+            continue;
+        }
+        item = ARSTREAM2_H264_NaluFifoPopFreeItem(&ctx->fifo);
+        if (!item)
+        {
+            ctx->producerFullCount++;
+            continue;
+        }
+        item->nalu.ntpTimestamp = (uint64_t)i + 1;
+        item->nalu.naluSize = 1000;
+        if (ARSTREAM2_H264_NaluFifoEnqueueItem(&ctx->fifo, item) != 0)
+        {
+            ARSTREAM2_H264_NaluFifoUnpopFreeItem(&ctx->fifo, item);
+            ctx->producerFullCount++;
+            continue;
+        }
+        i++;
+    }
+
+    return NULL;
+}
+
+
+/* Sender thread side: ARSTREAM2_RTPH264_Sender_NaluFifoToPacketFifo() */
+static void* NaluFifoBench_Consumer(void *userPtr)
+{
+    NaluFifoBench_Context_t *ctx = (NaluFifoBench_Context_t*)userPtr;
+    ARSTREAM2_H264_NaluFifoItem_t *item;
+    int count = 0;
+
+    while (count < ctx->naluCount)
+    {
+        item = ARSTREAM2_H264_NaluFifoDequeueItem(&ctx->fifo);
+        if (!item)
+        {
+            ctx->consumerEmptyCount++;
+            sched_yield();
+            continue;
+        }
+        ctx->checksum += item->nalu.ntpTimestamp;
+        ARSTREAM2_H264_NaluFifoPushFreeItem(&ctx->fifo, item);
+        count++;
+        __atomic_store_n(&ctx->consumedCount, count, __ATOMIC_RELAXED);
+    }
+
+    return NULL;
+}
+
+
+static int NaluFifoBench_Run(int lockFree, int naluCount, int fifoSize)
+{
+    NaluFifoBench_Context_t ctx;
+    ARSAL_Thread_t producerThread = NULL, consumerThread = NULL;
+    uint64_t startTime, endTime, expectedChecksum;
+
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.naluCount = naluCount;
+    ctx.fifoSize = fifoSize;
+
+    if (ARSTREAM2_H264_NaluFifoInit(&ctx.fifo, fifoSize, lockFree) != 0)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, TAG, "ARSTREAM2_H264_NaluFifoInit() failed");
+        return -1;
+    }
+
+    startTime = NaluFifoBench_GetTime();
+    ARSAL_Thread_Create(&consumerThread, NaluFifoBench_Consumer, &ctx);
+    ARSAL_Thread_Create(&producerThread, NaluFifoBench_Producer, &ctx);
+    ARSAL_Thread_Join(producerThread, NULL);
+    ARSAL_Thread_Join(consumerThread, NULL);
+    endTime = NaluFifoBench_GetTime();
+    ARSAL_Thread_Destroy(&producerThread);
+    ARSAL_Thread_Destroy(&consumerThread);
+
+    expectedChecksum = (uint64_t)naluCount * ((uint64_t)naluCount + 1) / 2;
+
+    printf("%-10s %d NALUs in %llu us: %.1f ns/NALU, %.2f MNALU/s (full: %llu, empty: %llu)%s\n",
+           (lockFree) ? "lock-free" : "mutex", naluCount, (unsigned long long)(endTime - startTime),
+           (double)(endTime - startTime) * 1000. / naluCount,
+           (double)naluCount / (double)(endTime - startTime),
+           (unsigned long long)ctx.producerFullCount, (unsigned long long)ctx.consumerEmptyCount,
+           (ctx.checksum == expectedChecksum) ? "" : " CHECKSUM ERROR");
+
+    ARSTREAM2_H264_NaluFifoFree(&ctx.fifo);
+
+    return (ctx.checksum == expectedChecksum) ? 0 : -1;
+}
+
+
+static void usage(const char *progName)
+{
+    printf("Usage: %s [-n <NALU count>] [-s <FIFO size>]\n", progName);
+}
+
+
+int main(int argc, char *argv[])
+{
+    int naluCount = NALU_FIFO_BENCH_DEFAULT_NALU_COUNT;
+    int fifoSize = NALU_FIFO_BENCH_DEFAULT_FIFO_SIZE;
+    int c, ret = 0;
+
+    while ((c = getopt(argc, argv, "hn:s:")) != -1)
+    {
+        switch (c)
+        {
+            case 'n':
+                naluCount = atoi(optarg);
+                break;
+            case 's':
+                fifoSize = atoi(optarg);
+                break;
+            case 'h':
+            default:
+                usage(argv[0]);
+                return (c == 'h') ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    if ((naluCount <= 0) || (fifoSize <= 0))
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (sysconf(_SC_NPROCESSORS_ONLN) < 2)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "Single CPU online: the producer and consumer threads do not run concurrently, the results do not reflect contention");
+    }
+
+    if (NaluFifoBench_Run(0, naluCount, fifoSize) != 0) ret = -1;
+    if (NaluFifoBench_Run(1, naluCount, fifoSize) != 0) ret = -1;
+
+    return (ret == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
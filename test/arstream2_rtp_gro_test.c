@@ -0,0 +1,137 @@
+/**
+ * @file arstream2_rtp_gro_test.c
+ * @brief Parrot Streaming Library - RTP receiver UDP GRO split test
+ * @date 10/17/2026
+ * @author aurelien.barre@parrot.com
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <libARSAL/ARSAL_Print.h>
+
+#include "arstream2_rtp.h"
+#include "arstream2_rtcp.h"
+
+#include <netinet/in.h>
+
+
+#define TAG "ARSTREAM2_RtpGro_Test"
+
+#define RTP_GRO_TEST_BUFFER_COUNT (16)
+#define RTP_GRO_TEST_BUFFER_SIZE (100)
+#define RTP_GRO_TEST_OVERFLOW_BUFFER_COUNT (2)
+#define RTP_GRO_TEST_OVERFLOW_BUFFER_SIZE (400)
+#define RTP_GRO_TEST_MAX_SEGMENTS (4)
+#define RTP_GRO_TEST_CLOCK_RATE (90000)
+
+#define RTP_GRO_TEST_CHECK(_cond) do { \
+        if (!(_cond)) { \
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, TAG, "Check failed line %d: %s", __LINE__, #_cond); \
+            ret = -1; \
+            goto out; \
+        } \
+    } while (0)
+
+
+/* Receive segmentCount RTP packets of segmentSize bytes coalesced in a single GRO datagram.
+ * The msgVec array is filled with garbage as when freshly allocated: the split must not rely
+ * on anything but the segments, the overflow class must not be used and no packet dropped. */
+static int RtpGroTest_Receive(unsigned int segmentSize, unsigned int segmentCount)
+{
+    ARSTREAM2_RTP_PacketFifo_t fifo;
+    ARSTREAM2_RTP_PacketFifoQueue_t queue;
+    ARSTREAM2_RTP_ReceiverContext_t context;
+    ARSTREAM2_RTCP_ReceiverContext_t rtcpContext;
+    ARSTREAM2_RTP_PacketFifoItem_t *item;
+    struct iovec iov[2 * RTP_GRO_TEST_MAX_SEGMENTS];
+    struct msghdr msg;
+    struct mmsghdr *msgVec = NULL;
+    uint8_t datagram[RTP_GRO_TEST_MAX_SEGMENTS * (sizeof(ARSTREAM2_RTP_Header_t) + RTP_GRO_TEST_BUFFER_SIZE)];
+    uint8_t copyBuffer[sizeof(datagram)];
+    unsigned int i, k, offset, size, layoutSegmentSize = 0, recvSize = segmentSize * segmentCount;
+    int bufferCount, ret = 0;
+
+    memset(&fifo, 0, sizeof(fifo));
+    memset(&queue, 0, sizeof(queue));
+    memset(&context, 0, sizeof(context));
+    memset(&rtcpContext, 0, sizeof(rtcpContext));
+    context.rtpClockRate = RTP_GRO_TEST_CLOCK_RATE;
+    context.maxPacketSize = RTP_GRO_TEST_BUFFER_SIZE;
+    context.previousExtSeqNum = -1;
+
+    RTP_GRO_TEST_CHECK(ARSTREAM2_RTP_PacketFifoInit(&fifo, RTP_GRO_TEST_BUFFER_COUNT, RTP_GRO_TEST_BUFFER_COUNT, RTP_GRO_TEST_BUFFER_SIZE) == 0);
+    RTP_GRO_TEST_CHECK(ARSTREAM2_RTP_PacketFifoInitOverflow(&fifo, RTP_GRO_TEST_OVERFLOW_BUFFER_COUNT, RTP_GRO_TEST_OVERFLOW_BUFFER_SIZE) == 0);
+    RTP_GRO_TEST_CHECK(ARSTREAM2_RTP_PacketFifoAddQueue(&fifo, &queue) == 0);
+    msgVec = malloc(RTP_GRO_TEST_MAX_SEGMENTS * sizeof(struct mmsghdr));
+    RTP_GRO_TEST_CHECK(msgVec != NULL);
+    memset(msgVec, 0xA5, RTP_GRO_TEST_MAX_SEGMENTS * sizeof(struct mmsghdr));
+
+    /* RTP packets with consecutive sequence numbers */
+    for (i = 0; i < segmentCount; i++)
+    {
+        ARSTREAM2_RTP_Header_t *header = (ARSTREAM2_RTP_Header_t*)(datagram + i * segmentSize);
+        memset(header, 0, segmentSize);
+        header->flags = htons((2 << 14) | 96);
+        header->seqNum = htons(1000 + i);
+        header->timestamp = htonl(3000);
+        header->ssrc = htonl(0x12345678);
+        memset(datagram + i * segmentSize + sizeof(ARSTREAM2_RTP_Header_t), i + 1, segmentSize - sizeof(ARSTREAM2_RTP_Header_t));
+    }
+
+    bufferCount = ARSTREAM2_RTP_Receiver_PacketFifoFillGroMsg(&fifo, &msg, iov, RTP_GRO_TEST_MAX_SEGMENTS, &layoutSegmentSize);
+    RTP_GRO_TEST_CHECK(bufferCount == RTP_GRO_TEST_MAX_SEGMENTS);
+
+    /* scatter the datagram over the iovecs as recvmsg does */
+    for (k = 0, offset = 0; (k < msg.msg_iovlen) && (offset < recvSize); k++)
+    {
+        size = (msg.msg_iov[k].iov_len < recvSize - offset) ? msg.msg_iov[k].iov_len : recvSize - offset;
+        memcpy(msg.msg_iov[k].iov_base, datagram + offset, size);
+        offset += size;
+    }
+    RTP_GRO_TEST_CHECK(offset == recvSize);
+
+    RTP_GRO_TEST_CHECK(ARSTREAM2_RTP_Receiver_PacketFifoSplitGroMsg(iov, bufferCount, RTP_GRO_TEST_BUFFER_SIZE, layoutSegmentSize,
+                                                                    recvSize, segmentSize, copyBuffer, msgVec, RTP_GRO_TEST_MAX_SEGMENTS) == (int)segmentCount);
+    RTP_GRO_TEST_CHECK(ARSTREAM2_RTP_Receiver_PacketFifoAddFromMsgVec(&context, &fifo, &queue, NULL, NULL, 0,
+                                                                      msgVec, segmentCount, 1000000, &rtcpContext) >= 0);
+
+    RTP_GRO_TEST_CHECK(fifo.overflowCount == 0);
+    RTP_GRO_TEST_CHECK(fifo.truncatedCount == 0);
+    RTP_GRO_TEST_CHECK(queue.count == (int)segmentCount);
+    for (i = 0; i < segmentCount; i++)
+    {
+        item = ARSTREAM2_RTP_PacketFifoDequeueItem(&queue);
+        RTP_GRO_TEST_CHECK(item != NULL);
+        RTP_GRO_TEST_CHECK(item->packet.seqNum == 1000 + i);
+        RTP_GRO_TEST_CHECK(item->packet.payloadSize == segmentSize - sizeof(ARSTREAM2_RTP_Header_t));
+        RTP_GRO_TEST_CHECK((item->packet.payload[0] == i + 1) && (item->packet.payload[item->packet.payloadSize - 1] == i + 1));
+        RTP_GRO_TEST_CHECK(ARSTREAM2_RTP_PacketFifoUnrefBuffer(&fifo, item->packet.buffer) == 0);
+        RTP_GRO_TEST_CHECK(ARSTREAM2_RTP_PacketFifoPushFreeItem(&fifo, item) == 0);
+    }
+
+out:
+    free(msgVec);
+    ARSTREAM2_RTP_PacketFifoRemoveQueue(&fifo, &queue);
+    ARSTREAM2_RTP_PacketFifoFree(&fifo);
+
+    return ret;
+}
+
+
+int main(int argc, char *argv[])
+{
+    int ret = 0;
+
+    /* segments laid out directly in their buffers */
+    if (RtpGroTest_Receive(sizeof(ARSTREAM2_RTP_Header_t) + RTP_GRO_TEST_BUFFER_SIZE, 3) != 0) ret = -1;
+    /* segments smaller than the layout: gathered then scattered through the copy buffer */
+    if (RtpGroTest_Receive(sizeof(ARSTREAM2_RTP_Header_t) + 60, 4) != 0) ret = -1;
+    /* single datagram */
+    if (RtpGroTest_Receive(sizeof(ARSTREAM2_RTP_Header_t) + 40, 1) != 0) ret = -1;
+
+    printf("%s\n", (ret == 0) ? "PASSED" : "FAILED");
+
+    return (ret == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,174 @@
+/**
+ * @file arstream2_shm_transport_test.c
+ * @brief Parrot Streaming Library - Shared memory transport test
+ * @date 10/16/2026
+ * @author aurelien.barre@parrot.com
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+
+#include <libARSAL/ARSAL_Print.h>
+
+#include "arstream2_shm_transport_internal.h"
+
+
+#define TAG "ARSTREAM2_ShmTransport_Test"
+
+#define SHM_TRANSPORT_TEST_SLOT_COUNT (8)
+#define SHM_TRANSPORT_TEST_SLOT_SIZE (100)
+
+#define SHM_TRANSPORT_TEST_CHECK(_cond) do { \
+        if (!(_cond)) { \
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, TAG, "Check failed line %d: %s", __LINE__, #_cond); \
+            return -1; \
+        } \
+    } while (0)
+
+
+static int ShmTransportTest_IsReadable(int fd)
+{
+    struct pollfd p;
+    int ret;
+
+    p.fd = fd;
+    p.events = POLLIN;
+    p.revents = 0;
+    while (((ret = poll(&p, 1, 0)) == -1) && (errno == EINTR));
+
+    return ((ret == 1) && (p.revents & POLLIN)) ? 1 : 0;
+}
+
+
+/* The consumer waits on the eventfd before its first read: the first packet must wake it up */
+static int ShmTransportTest_FirstPacketSignals(ARSTREAM2_ShmTransport_t *producer, ARSTREAM2_ShmTransport_t *consumer)
+{
+    uint8_t header[2] = { 0x80, 0x60 }, payload[7] = { 1, 2, 3, 4, 5, 6, 7 }, buffer[SHM_TRANSPORT_TEST_SLOT_SIZE];
+    struct iovec sendIov[2], recvIov;
+    struct mmsghdr sendMsg, recvMsg;
+    int streamFd, controlFd;
+
+    streamFd = ARSTREAM2_ShmTransport_GetEventFd(consumer, ARSTREAM2_SHM_TRANSPORT_RING_STREAM);
+    controlFd = ARSTREAM2_ShmTransport_GetEventFd(consumer, ARSTREAM2_SHM_TRANSPORT_RING_SENDER_CONTROL);
+    SHM_TRANSPORT_TEST_CHECK((streamFd >= 0) && (controlFd >= 0));
+    SHM_TRANSPORT_TEST_CHECK(!ShmTransportTest_IsReadable(streamFd));
+    SHM_TRANSPORT_TEST_CHECK(!ShmTransportTest_IsReadable(controlFd));
+
+    memset(&sendMsg, 0, sizeof(sendMsg));
+    sendIov[0].iov_base = header;
+    sendIov[0].iov_len = sizeof(header);
+    sendIov[1].iov_base = payload;
+    sendIov[1].iov_len = sizeof(payload);
+    sendMsg.msg_hdr.msg_iov = sendIov;
+    sendMsg.msg_hdr.msg_iovlen = 2;
+    memset(&recvMsg, 0, sizeof(recvMsg));
+    recvIov.iov_base = buffer;
+    recvIov.iov_len = sizeof(buffer);
+    recvMsg.msg_hdr.msg_iov = &recvIov;
+    recvMsg.msg_hdr.msg_iovlen = 1;
+
+    /* RTP ring */
+    SHM_TRANSPORT_TEST_CHECK(ARSTREAM2_ShmTransport_SendMmsg(producer, ARSTREAM2_SHM_TRANSPORT_RING_STREAM, &sendMsg, 1) == 1);
+    SHM_TRANSPORT_TEST_CHECK(ShmTransportTest_IsReadable(streamFd));
+    SHM_TRANSPORT_TEST_CHECK(ARSTREAM2_ShmTransport_RecvMmsg(consumer, ARSTREAM2_SHM_TRANSPORT_RING_STREAM, &recvMsg, 1) == 1);
+    SHM_TRANSPORT_TEST_CHECK((recvMsg.msg_len == sizeof(header) + sizeof(payload)) && (recvMsg.msg_hdr.msg_flags == 0));
+    SHM_TRANSPORT_TEST_CHECK((!memcmp(buffer, header, sizeof(header))) && (!memcmp(buffer + sizeof(header), payload, sizeof(payload))));
+
+    /* the empty ring read clears the eventfd and the next packet signals it again */
+    SHM_TRANSPORT_TEST_CHECK(ARSTREAM2_ShmTransport_RecvMmsg(consumer, ARSTREAM2_SHM_TRANSPORT_RING_STREAM, &recvMsg, 1) == 0);
+    SHM_TRANSPORT_TEST_CHECK(!ShmTransportTest_IsReadable(streamFd));
+    SHM_TRANSPORT_TEST_CHECK(ARSTREAM2_ShmTransport_SendMmsg(producer, ARSTREAM2_SHM_TRANSPORT_RING_STREAM, &sendMsg, 1) == 1);
+    SHM_TRANSPORT_TEST_CHECK(ShmTransportTest_IsReadable(streamFd));
+    SHM_TRANSPORT_TEST_CHECK(ARSTREAM2_ShmTransport_RecvMmsg(consumer, ARSTREAM2_SHM_TRANSPORT_RING_STREAM, &recvMsg, 1) == 1);
+
+    /* RTCP ring */
+    SHM_TRANSPORT_TEST_CHECK(ARSTREAM2_ShmTransport_Send(producer, ARSTREAM2_SHM_TRANSPORT_RING_SENDER_CONTROL, payload, sizeof(payload)) == sizeof(payload));
+    SHM_TRANSPORT_TEST_CHECK(ShmTransportTest_IsReadable(controlFd));
+    SHM_TRANSPORT_TEST_CHECK(ARSTREAM2_ShmTransport_Recv(consumer, ARSTREAM2_SHM_TRANSPORT_RING_SENDER_CONTROL, buffer, sizeof(buffer)) == sizeof(payload));
+    SHM_TRANSPORT_TEST_CHECK(!memcmp(buffer, payload, sizeof(payload)));
+    errno = 0;
+    SHM_TRANSPORT_TEST_CHECK((ARSTREAM2_ShmTransport_Recv(consumer, ARSTREAM2_SHM_TRANSPORT_RING_SENDER_CONTROL, buffer, sizeof(buffer)) == -1) && (errno == EAGAIN));
+
+    return 0;
+}
+
+
+/* A full ring drops the packets like a full socket buffer */
+static int ShmTransportTest_FullRingDrops(ARSTREAM2_ShmTransport_t *producer, ARSTREAM2_ShmTransport_t *consumer)
+{
+    uint8_t payload[SHM_TRANSPORT_TEST_SLOT_SIZE], buffer[SHM_TRANSPORT_TEST_SLOT_SIZE];
+    struct iovec sendIov, recvIov;
+    struct mmsghdr sendMsg, recvMsg;
+    int i, count = 0, ret;
+
+    memset(payload, 0x55, sizeof(payload));
+    memset(&sendMsg, 0, sizeof(sendMsg));
+    sendIov.iov_base = payload;
+    sendIov.iov_len = sizeof(payload);
+    sendMsg.msg_hdr.msg_iov = &sendIov;
+    sendMsg.msg_hdr.msg_iovlen = 1;
+    memset(&recvMsg, 0, sizeof(recvMsg));
+    recvIov.iov_base = buffer;
+    recvIov.iov_len = sizeof(buffer);
+    recvMsg.msg_hdr.msg_iov = &recvIov;
+    recvMsg.msg_hdr.msg_iovlen = 1;
+
+    for (i = 0; i < 2 * SHM_TRANSPORT_TEST_SLOT_COUNT; i++)
+    {
+        SHM_TRANSPORT_TEST_CHECK(ARSTREAM2_ShmTransport_SendMmsg(producer, ARSTREAM2_SHM_TRANSPORT_RING_STREAM, &sendMsg, 1) == 1);
+    }
+    while ((ret = ARSTREAM2_ShmTransport_RecvMmsg(consumer, ARSTREAM2_SHM_TRANSPORT_RING_STREAM, &recvMsg, 1)) > 0)
+    {
+        SHM_TRANSPORT_TEST_CHECK(recvMsg.msg_len == sizeof(payload));
+        count++;
+    }
+    SHM_TRANSPORT_TEST_CHECK((ret == 0) && (count == SHM_TRANSPORT_TEST_SLOT_COUNT));
+
+    return 0;
+}
+
+
+int main(int argc, char *argv[])
+{
+    ARSTREAM2_ShmTransport_t *transport = NULL, *attached = NULL;
+    int shmFd, streamFd, senderControlFd, receiverControlFd;
+    int ret = 0;
+
+    if (ARSTREAM2_ShmTransport_Create(&transport, SHM_TRANSPORT_TEST_SLOT_COUNT, SHM_TRANSPORT_TEST_SLOT_SIZE) != ARSTREAM2_OK)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, TAG, "ARSTREAM2_ShmTransport_Create() failed");
+        return EXIT_FAILURE;
+    }
+
+    /* in-process: the same transport on both sides */
+    if (ShmTransportTest_FirstPacketSignals(transport, transport) != 0) ret = -1;
+
+    /* the attached side shares the segment and the eventfds */
+    if ((ARSTREAM2_ShmTransport_GetFds(transport, &shmFd, &streamFd, &senderControlFd, &receiverControlFd) != ARSTREAM2_OK)
+            || (ARSTREAM2_ShmTransport_Attach(&attached, shmFd, streamFd, senderControlFd, receiverControlFd) != ARSTREAM2_OK))
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, TAG, "ARSTREAM2_ShmTransport_Attach() failed");
+        ret = -1;
+    }
+    else
+    {
+        uint8_t buffer[SHM_TRANSPORT_TEST_SLOT_SIZE];
+
+        /* the consumer goes idle again (and clears the eventfds) when it finds the rings empty */
+        while (ARSTREAM2_ShmTransport_Recv(attached, ARSTREAM2_SHM_TRANSPORT_RING_STREAM, buffer, sizeof(buffer)) > 0);
+        while (ARSTREAM2_ShmTransport_Recv(attached, ARSTREAM2_SHM_TRANSPORT_RING_SENDER_CONTROL, buffer, sizeof(buffer)) > 0);
+
+        if (ShmTransportTest_FirstPacketSignals(transport, attached) != 0) ret = -1;
+        if (ShmTransportTest_FullRingDrops(transport, attached) != 0) ret = -1;
+        ARSTREAM2_ShmTransport_Unref(attached);
+    }
+
+    ARSTREAM2_ShmTransport_Unref(transport);
+
+    printf("%s\n", (ret == 0) ? "PASSED" : "FAILED");
+
+    return (ret == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
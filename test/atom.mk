@@ -14,4 +14,60 @@ LOCAL_SRC_FILES := arstream2_stream_receiver_test.c
 
 include $(BUILD_EXECUTABLE)
 
+include $(CLEAR_VARS)
+
+LOCAL_CATEGORY_PATH := test
+LOCAL_MODULE := ARStream2NaluFifoBench
+LOCAL_DESCRIPTION := Parrot Streaming Library - NAL unit FIFO contention benchmark
+
+LOCAL_LIBRARIES := libARSAL libARStream2
+
+LOCAL_C_INCLUDES := $(LOCAL_PATH)/../src
+
+LOCAL_SRC_FILES := arstream2_nalu_fifo_bench.c
+
+include $(BUILD_EXECUTABLE)
+
+include $(CLEAR_VARS)
+
+LOCAL_CATEGORY_PATH := test
+LOCAL_MODULE := ARStream2ClockSkewBench
+LOCAL_DESCRIPTION := Parrot Streaming Library - Receiver clock skew estimation benchmark
+
+LOCAL_LIBRARIES := libARSAL libARStream2
+
+LOCAL_C_INCLUDES := $(LOCAL_PATH)/../src
+
+LOCAL_SRC_FILES := arstream2_clock_skew_bench.c
+
+include $(BUILD_EXECUTABLE)
+
+include $(CLEAR_VARS)
+
+LOCAL_CATEGORY_PATH := test
+LOCAL_MODULE := ARStream2ShmTransportTest
+LOCAL_DESCRIPTION := Parrot Streaming Library - Shared memory transport test program
+
+LOCAL_LIBRARIES := libARSAL libARStream2
+
+LOCAL_C_INCLUDES := $(LOCAL_PATH)/../src
+
+LOCAL_SRC_FILES := arstream2_shm_transport_test.c
+
+include $(BUILD_EXECUTABLE)
+
+include $(CLEAR_VARS)
+
+LOCAL_CATEGORY_PATH := test
+LOCAL_MODULE := ARStream2RtpGroTest
+LOCAL_DESCRIPTION := Parrot Streaming Library - RTP receiver UDP GRO split test program
+
+LOCAL_LIBRARIES := libARSAL libARStream2
+
+LOCAL_C_INCLUDES := $(LOCAL_PATH)/../src
+
+LOCAL_SRC_FILES := arstream2_rtp_gro_test.c
+
+include $(BUILD_EXECUTABLE)
+
 endif